@@ -26,6 +26,13 @@ class ControlObjectScript : public ControlProxy {
             return m_scriptConnections.first(); };
     void disconnectAllConnectionsToFunction(const QJSValue& function);
 
+    /// Returns the ControlObject of the connected control, or nullptr if it
+    /// has been deleted. Other than ControlObject::getControl() this does not
+    /// need to look up the key in the global registry.
+    ControlObject* getControlObject() const {
+        return m_pControl->getCreatorCO();
+    }
+
     // Called from update();
     void emitValueChanged() override {
         emit trigger(get(), this);
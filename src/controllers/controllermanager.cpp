@@ -25,7 +25,11 @@
 
 // http://developer.qt.nokia.com/wiki/Threads_Events_QObjects
 
-// Poll every 1ms (where possible) for good controller response
+// Poll every 1ms (where possible) for good controller response.
+// Only PortMidi input devices are polled. PortMidi has no blocking or
+// callback API for input, so the latency of MIDI input is bounded by this
+// interval. HID devices are not polled, their HidIoThread waits for input
+// reports and timestamps them on arrival.
 #ifdef __LINUX__
 // Many Linux distros ship with the system tick set to 250Hz so 1ms timer
 // reportedly causes CPU hosage. See Bug #990992 rryan 6/2012
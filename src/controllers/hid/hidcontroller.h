@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QThread>
+#include <algorithm>
 
 #include "controllers/controller.h"
 #include "controllers/hid/hiddevice.h"
@@ -99,6 +100,25 @@ class HidControllerJSProxy : public ControllerJSProxy {
                 reportID, dataArray, resendUnchangedReport);
     }
 
+    /// @brief Limits the rate of an OutputReport and orders it relative to the other OutputReports
+    /// @details Reports that are sent more often than the device can process, e.g. the
+    ///          reports of displays, delay the other reports and the InputReports.
+    ///          Data sent within the minimum interval supersede each other, only the latest
+    ///          data are sent when the interval has elapsed.
+    /// @param reportID 1...255 for HID devices that uses ReportIDs - or 0 for devices, which don't use ReportIDs
+    /// @param minimumIntervalMillis Minimum time between two transfers of this report, 0 for no limit
+    /// @param priority Reports with a higher priority are sent first, e.g. LEDs before displays. The default priority is 0.
+    Q_INVOKABLE void setOutputReportSchedule(quint8 reportID,
+            int minimumIntervalMillis,
+            int priority = 0) {
+        VERIFY_OR_DEBUG_ASSERT(m_pHidController->m_pHidIoThread) {
+            return;
+        }
+        m_pHidController->m_pHidIoThread->setOutputReportSchedule(reportID,
+                mixxx::Duration::fromMillis(std::max(minimumIntervalMillis, 0)),
+                priority);
+    }
+
     /// @brief getInputReport receives an InputReport from the HID device on request.
     /// @details This can be used on startup to initialize the knob positions in Mixxx
     ///          to the physical position of the hardware knobs on the controller.
@@ -17,7 +17,11 @@ constexpr int kMaxHidErrorMessageSize = 512;
 HidIoOutputReport::HidIoOutputReport(
         const quint8& reportId, const unsigned int& reportDataSize)
         : m_reportId(reportId),
+          m_priority(0),
+          m_numSentReports(0),
+          m_numSkippedReports(0),
           m_possiblyUnsentDataCached(false),
+          m_resendUnchangedReport(false),
           m_lastCachedDataSize(0) {
     // First byte must always contain the ReportID - also after swapping, therefore initialize both arrays
     m_cachedData.reserve(kReportIdSize + reportDataSize);
@@ -38,6 +42,7 @@ void HidIoOutputReport::updateCachedData(const QByteArray& data,
 
     } else {
         if (m_possiblyUnsentDataCached) {
+            m_numSkippedReports.fetchAndAddRelaxed(1);
             qCDebug(logOutput) << "t:" << mixxx::Time::elapsed().formatMillisWithUnit()
                                << "Skipped superseded OutputReport"
                                << deviceInfo.formatName() << "serial #"
@@ -69,16 +74,29 @@ void HidIoOutputReport::updateCachedData(const QByteArray& data,
     m_resendUnchangedReport = resendUnchangedReport;
 }
 
-bool HidIoOutputReport::sendCachedData(QMutex* pHidDeviceAndPollMutex,
-        hid_device* pHidDevice,
+void HidIoOutputReport::setSchedule(mixxx::Duration minimumInterval, int priority) {
+    auto cacheLock = lockMutex(&m_cachedDataMutex);
+    m_minimumInterval = minimumInterval;
+    m_priority.storeRelaxed(priority);
+}
+
+bool HidIoOutputReport::isReadyToSend(mixxx::Duration now, bool ignoreMinimumInterval) {
+    auto cacheLock = lockMutex(&m_cachedDataMutex);
+    if (!m_possiblyUnsentDataCached) {
+        return false;
+    }
+    // m_lastSendTime is zero before the first transfer
+    return ignoreMinimumInterval ||
+            m_lastSendTime == mixxx::Duration() ||
+            now - m_lastSendTime >= m_minimumInterval;
+}
+
+bool HidIoOutputReport::takeCachedData(mixxx::Duration now,
         const mixxx::hid::DeviceInfo& deviceInfo,
         const RuntimeLoggingCategory& logOutput) {
-    auto startOfHidWrite = mixxx::Time::elapsed();
-
     auto cacheLock = lockMutex(&m_cachedDataMutex);
 
     if (!m_possiblyUnsentDataCached) {
-        // Return with false, to signal the caller, that no time consuming IO operation was necessary
         return false;
     }
 
@@ -95,13 +113,12 @@ bool HidIoOutputReport::sendCachedData(QMutex* pHidDeviceAndPollMutex,
 
         cacheLock.unlock();
 
-        qCDebug(logOutput) << "t:" << startOfHidWrite.formatMillisWithUnit()
+        m_numSkippedReports.fetchAndAddRelaxed(1);
+        qCDebug(logOutput) << "t:" << now.formatMillisWithUnit()
                            << " Skipped identical Output Report for"
                            << deviceInfo.formatName() << "serial #"
                            << deviceInfo.serialNumber() << "(Report ID"
                            << m_reportId << ")";
-
-        // Return with false, to signal the caller, that no time consuming IO operation was necessary
         return false;
     }
 
@@ -112,8 +129,20 @@ bool HidIoOutputReport::sendCachedData(QMutex* pHidDeviceAndPollMutex,
     // and concurrent execution of this method is prevented by locking pHidDeviceMutex
     m_lastSentData.swap(m_cachedData);
     m_possiblyUnsentDataCached = false;
+    m_lastSendTime = now;
+    return true;
+}
+
+bool HidIoOutputReport::sendCachedData(QMutex* pHidDeviceAndPollMutex,
+        hid_device* pHidDevice,
+        const mixxx::hid::DeviceInfo& deviceInfo,
+        const RuntimeLoggingCategory& logOutput) {
+    auto startOfHidWrite = mixxx::Time::elapsed();
 
-    cacheLock.unlock();
+    if (!takeCachedData(startOfHidWrite, deviceInfo, logOutput)) {
+        // Return with false, to signal the caller, that no time consuming IO operation was necessary
+        return false;
+    }
 
     auto hidDeviceLock = lockMutex(pHidDeviceAndPollMutex);
 
@@ -131,8 +160,10 @@ bool HidIoOutputReport::sendCachedData(QMutex* pHidDeviceAndPollMutex,
 
     hidDeviceLock.unlock();
 
+    m_numSentReports.fetchAndAddRelaxed(1);
+
     if (result == -1) {
-        cacheLock.relock();
+        auto cacheLock = lockMutex(&m_cachedDataMutex);
         // Clear the m_lastSentData because the last send data are not reliable known.
         // These error should not occur in normal operation,
         // therefore the performance impact of additional memory allocation
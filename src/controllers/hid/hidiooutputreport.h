@@ -1,5 +1,7 @@
 #pragma once
 
+#include <QAtomicInteger>
+
 #include "controllers/controller.h"
 #include "controllers/hid/hiddevice.h"
 #include "util/compatibility/qmutex.h"
@@ -16,6 +18,39 @@ class HidIoOutputReport {
             const RuntimeLoggingCategory& logOutput,
             bool resendUnchangedReport);
 
+    /// Limits how often the report is sent. Data cached within the interval
+    /// after a report has been sent supersede each other, only the latest is
+    /// sent when the interval has elapsed. Among the reports that are ready
+    /// to be sent the report with the highest priority is sent first.
+    void setSchedule(mixxx::Duration minimumInterval, int priority);
+
+    /// Returns true if unsent data are cached and the minimum interval since
+    /// the last transfer has elapsed. The data might still turn out to be
+    /// identical to the last sent data.
+    bool isReadyToSend(mixxx::Duration now, bool ignoreMinimumInterval);
+
+    int priority() const {
+        return m_priority.loadRelaxed();
+    }
+
+    /// Returns the number of transfers and the number of skipped reports,
+    /// either superseded or identical to the last sent report, since the
+    /// last call.
+    int takeNumSentReports() {
+        return m_numSentReports.fetchAndStoreRelaxed(0);
+    }
+    int takeNumSkippedReports() {
+        return m_numSkippedReports.fetchAndStoreRelaxed(0);
+    }
+
+    /// Takes the cached data for a transfer that starts at time now, which
+    /// also starts the minimum interval until the report is ready to be sent
+    /// again. Returns false if no data are cached, or if the data are
+    /// identical to the last sent data and are skipped.
+    bool takeCachedData(mixxx::Duration now,
+            const mixxx::hid::DeviceInfo& deviceInfo,
+            const RuntimeLoggingCategory& logOutput);
+
     /// Sends the OutputReport to the HID device, when changed data are cached.
     /// Returns true if a time consuming hid_write operation was executed.
     bool sendCachedData(QMutex* pHidDeviceAndPollMutex,
@@ -27,6 +62,10 @@ class HidIoOutputReport {
     const quint8 m_reportId;
     QByteArray m_lastSentData;
 
+    QAtomicInteger<int> m_priority;
+    QAtomicInteger<int> m_numSentReports;
+    QAtomicInteger<int> m_numSkippedReports;
+
     /// Mutex must be locked when reading/writing m_cachedData
     /// or m_possiblyUnsentDataCached, m_resendUnchangedReport
     QMutex m_cachedDataMutex;
@@ -34,6 +73,9 @@ class HidIoOutputReport {
     QByteArray m_cachedData;
     bool m_possiblyUnsentDataCached;
     bool m_resendUnchangedReport;
+    mixxx::Duration m_minimumInterval;
+    /// Start time of the last hid_write
+    mixxx::Duration m_lastSendTime;
 
     /// Due to swapping of the QbyteArrays, we need to store
     /// this information independent of the QBytearray size
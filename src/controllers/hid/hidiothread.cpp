@@ -24,6 +24,17 @@ constexpr int kMaxHidErrorMessageSize = 512;
 // the fastest possible rate of HID devices with USB HighSpeed or USB SuperSpeed interface is 8kHz
 constexpr int kSleepTimeWhenIdleMicros = 250;
 
+// Maximum time the run loop waits for the next InputReport, in idle case.
+// The wait returns as soon as an InputReport arrives, but OutputReports that
+// are cached during the wait are sent afterwards. hidapi is not thread-safe,
+// so the wait holds the device mutex. Requests of other threads, e.g.
+// getInputReport, that arrive during the wait are delayed by up to this
+// time. The run loop doesn't start a wait while requests are pending.
+constexpr int kWaitTimeForInputReportWhenIdleMillis = 1;
+
+// Interval for logging the number of sent and skipped OutputReports
+constexpr mixxx::Duration kOutputReportStatisticsInterval = mixxx::Duration::fromSeconds(1);
+
 QString loggingCategoryPrefix(const QString& deviceName) {
     return QStringLiteral("controller.") +
             RuntimeLoggingCategory::removeInvalidCharsFromCategory(deviceName.toLower());
@@ -74,10 +85,18 @@ void HidIoThread::run() {
                         HidIoThreadState::Stopped)) {
                 break;
             }
-            // Sleep run loop, if no OutputReport was send
+            // Wait for the next InputReport, if no OutputReport was send.
+            // Without input, e.g. before the mapping has been initialized,
+            // sleep the run loop instead.
             // Tests on Windows and Linux showed that the thread schedulers
             // handle usleep wait times reliable under CPU load
-            usleep(kSleepTimeWhenIdleMicros);
+            if (!waitForInputReport()) {
+                usleep(kSleepTimeWhenIdleMicros);
+            }
+        }
+
+        if (m_logOutput().isDebugEnabled()) {
+            logOutputReportStatistics();
         }
     }
 }
@@ -116,6 +135,39 @@ void HidIoThread::pollBufferedInputReports() {
     }
 }
 
+bool HidIoThread::waitForInputReport() {
+    if (m_numPendingRequests.loadAcquire() > 0) {
+        // Sleep without the lock instead
+        return false;
+    }
+    auto hidDeviceLock = lockMutex(&m_hidDeviceAndPollMutex);
+    if (m_state.loadAcquire() != static_cast<int>(HidIoThreadState::InputOutputActive) ||
+            m_numPendingRequests.loadAcquire() > 0) {
+        return false;
+    }
+    // hidapi blocks on the file descriptor of the device (poll() on Linux)
+    // or an equivalent OS event, i.e. the InputReport is processed and
+    // timestamped on arrival instead of up to one sleep time later.
+    int bytesRead = hid_read_timeout(m_pHidDevice,
+            m_pPollData[m_pollingBufferIndex],
+            kBufferSize,
+            kWaitTimeForInputReportWhenIdleMillis);
+    if (bytesRead < 0) {
+        // -1 is the only error value according to hidapi documentation.
+        qCWarning(m_logInput) << "Unable to wait for HID InputReports from"
+                              << m_deviceInfo.formatName() << ":"
+                              << mixxx::convertWCStringToQString(
+                                         hid_error(m_pHidDevice),
+                                         kMaxHidErrorMessageSize);
+        DEBUG_ASSERT(bytesRead == -1);
+        return false;
+    }
+    if (bytesRead > 0) {
+        processInputReport(bytesRead);
+    }
+    return true;
+}
+
 void HidIoThread::processInputReport(int bytesRead) {
     Trace process("HidIO processInputReport");
     unsigned char* pPreviousBuffer = m_pPollData[(m_pollingBufferIndex + 1) % kNumBuffers];
@@ -145,7 +197,9 @@ void HidIoThread::processInputReport(int bytesRead) {
 
 QByteArray HidIoThread::getInputReport(quint8 reportID) {
     auto startOfHidGetInputReport = mixxx::Time::elapsed();
+    m_numPendingRequests.ref();
     auto hidDeviceLock = lockMutex(&m_hidDeviceAndPollMutex);
+    m_numPendingRequests.deref();
 
     m_pPollData[m_pollingBufferIndex][0] = reportID;
     int bytesRead = hid_get_input_report(
@@ -186,50 +240,94 @@ QByteArray HidIoThread::getInputReport(quint8 reportID) {
     return returnArray;
 }
 
-void HidIoThread::updateCachedOutputReportData(quint8 reportID,
-        const QByteArray& data,
-        bool resendUnchangedReport) {
+HidIoOutputReport* HidIoThread::getOrCreateOutputReport(
+        quint8 reportID, int reportDataSize) {
     auto mapLock = lockMutex(&m_outputReportMapMutex);
-    if (m_outputReports.find(reportID) == m_outputReports.end()) {
-        std::unique_ptr<HidIoOutputReport> pNewOutputReport;
-        m_outputReports[reportID] = std::make_unique<HidIoOutputReport>(
-                reportID, data.size());
+    auto& pOutputReport = m_outputReports[reportID];
+    if (!pOutputReport) {
+        pOutputReport = std::make_unique<HidIoOutputReport>(
+                reportID, reportDataSize);
     }
 
     // The only mutable operation on m_outputReports is insert
     // by std::map<Key,T,Compare,Allocator>::operator[]
     // The standard says that "No iterators or references are invalidated." using this operator.
-    // Therefore actualOutputReportIterator doesn't require Mutex protection.
-    auto actualOutputReportIterator = m_outputReports.find(reportID);
+    // Therefore the returned pointer doesn't require Mutex protection.
+    return pOutputReport.get();
+}
+
+void HidIoThread::updateCachedOutputReportData(quint8 reportID,
+        const QByteArray& data,
+        bool resendUnchangedReport) {
+    getOrCreateOutputReport(reportID, data.size())
+            ->updateCachedData(
+                    data, m_deviceInfo, m_logOutput, resendUnchangedReport);
+}
 
-    mapLock.unlock();
+void HidIoThread::setOutputReportSchedule(quint8 reportID,
+        mixxx::Duration minimumInterval,
+        int priority) {
+    // The size of the report is not known yet, if it has not been sent before
+    getOrCreateOutputReport(reportID, 0)->setSchedule(minimumInterval, priority);
+}
 
-    actualOutputReportIterator->second->updateCachedData(
-            data, m_deviceInfo, m_logOutput, resendUnchangedReport);
+HidIoThread::OutputReportMapIterator HidIoThread::nextOutputReportToSend(
+        bool ignoreMinimumIntervals) {
+    const auto now = mixxx::Time::elapsed();
+    auto mapLock = lockMutex(&m_outputReportMapMutex);
+    const auto nextIt = selectNextOutputReport(
+            m_outputReports, m_outputReportIterator, now, ignoreMinimumIntervals);
+    if (nextIt != m_outputReports.end()) {
+        m_outputReportIterator = nextIt;
+    }
+    return nextIt;
+}
+
+// static
+HidIoThread::OutputReportMapIterator HidIoThread::selectNextOutputReport(
+        OutputReportMap& reports,
+        OutputReportMapIterator lastSentIt,
+        mixxx::Duration now,
+        bool ignoreMinimumIntervals) {
+    // Round robin among the reports with the same priority, starting after
+    // the last sent report, which ensures that every report is sent
+    // eventually, as long as no report with a higher priority is ready.
+    auto it = lastSentIt;
+    auto nextIt = reports.end();
+    for (std::size_t i = 0; i < reports.size(); i++) {
+        if (it == reports.end() || ++it == reports.end()) {
+            it = reports.begin();
+        }
+        if (!it->second->isReadyToSend(now, ignoreMinimumIntervals)) {
+            continue;
+        }
+        if (nextIt == reports.end() ||
+                it->second->priority() > nextIt->second->priority()) {
+            nextIt = it;
+        }
+    }
+    return nextIt;
 }
 
 bool HidIoThread::sendNextCachedOutputReport() {
+    // Send all remaining reports as fast as possible when stopping
+    const bool ignoreMinimumIntervals = m_state.loadAcquire() ==
+            static_cast<int>(HidIoThreadState::StopWhenAllReportsSent);
     // m_outputReports.size() doesn't need mutex protection, because the value of i is not used.
     // i is just a counter to prevent infinite loop execution.
-    // If the map size increases, this loop will execute one iteration more,
-    // which only has the effect, that one additional lookup operation for unsent data will be executed.
+    // A report that is skipped, because its data are unchanged, is not ready
+    // to send anymore. The loop ends after each report has been skipped once.
     for (std::size_t i = 0; i < m_outputReports.size(); i++) {
-        auto mapLock = lockMutex(&m_outputReportMapMutex);
-        if (m_outputReportIterator == m_outputReports.end()) {
-            m_outputReportIterator = m_outputReports.begin();
-        } else {
-            m_outputReportIterator++;
-            if (m_outputReportIterator == m_outputReports.end()) {
-                m_outputReportIterator = m_outputReports.begin();
-            }
+        const auto nextIt = nextOutputReportToSend(ignoreMinimumIntervals);
+        if (nextIt == m_outputReports.end()) {
+            break;
         }
-        mapLock.unlock();
 
         // The only mutable operation on m_outputReports is insert
         // by std::map<Key,T,Compare,Allocator>::operator[]
         // The standard says that "No iterators or references are invalidated." using this operator.
-        // Therefore m_outputReportIterator doesn't require Mutex protection.
-        if (m_outputReportIterator->second->sendCachedData(
+        // Therefore nextIt doesn't require Mutex protection.
+        if (nextIt->second->sendCachedData(
                     &m_hidDeviceAndPollMutex, m_pHidDevice, m_deviceInfo, m_logOutput)) {
             // Return after each time consuming sendCachedData
             return true;
@@ -239,6 +337,27 @@ bool HidIoThread::sendNextCachedOutputReport() {
     return false;
 }
 
+void HidIoThread::logOutputReportStatistics() {
+    const auto now = mixxx::Time::elapsed();
+    if (now - m_lastOutputReportStatisticsTime < kOutputReportStatisticsInterval) {
+        return;
+    }
+    m_lastOutputReportStatisticsTime = now;
+
+    auto mapLock = lockMutex(&m_outputReportMapMutex);
+    for (const auto& [reportID, pOutputReport] : m_outputReports) {
+        const int numSent = pOutputReport->takeNumSentReports();
+        const int numSkipped = pOutputReport->takeNumSkippedReports();
+        if (numSent == 0 && numSkipped == 0) {
+            continue;
+        }
+        qCDebug(m_logOutput) << "OutputReports with Report ID" << reportID
+                             << "sent:" << numSent << "skipped:" << numSkipped
+                             << "in the last"
+                             << kOutputReportStatisticsInterval.formatMillisWithUnit();
+    }
+}
+
 void HidIoThread::sendFeatureReport(
         quint8 reportID, const QByteArray& reportData) {
     auto startOfHidSendFeatureReport = mixxx::Time::elapsed();
@@ -249,7 +368,9 @@ void HidIoThread::sendFeatureReport(
     dataArray.append(reportID);
     dataArray.append(reportData);
 
+    m_numPendingRequests.ref();
     auto hidDeviceLock = lockMutex(&m_hidDeviceAndPollMutex);
+    m_numPendingRequests.deref();
     int result = hid_send_feature_report(m_pHidDevice,
             reinterpret_cast<const unsigned char*>(dataArray.constData()),
             dataArray.size());
@@ -280,7 +401,9 @@ QByteArray HidIoThread::getFeatureReport(
     unsigned char dataRead[kReportIdSize + kBufferSize];
     dataRead[0] = reportID;
 
+    m_numPendingRequests.ref();
     auto hidDeviceLock = lockMutex(&m_hidDeviceAndPollMutex);
+    m_numPendingRequests.deref();
     int bytesRead = hid_get_feature_report(m_pHidDevice,
             dataRead,
             kReportIdSize + kBufferSize);
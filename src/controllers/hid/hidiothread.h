@@ -23,6 +23,9 @@ enum class HidIoThreadState {
 class HidIoThread : public QThread {
     Q_OBJECT
   public:
+    typedef std::map<unsigned char, std::unique_ptr<HidIoOutputReport>> OutputReportMap;
+    typedef OutputReportMap::iterator OutputReportMapIterator;
+
     HidIoThread(hid_device* pDevice,
             const mixxx::hid::DeviceInfo& deviceInfo);
     ~HidIoThread() override;
@@ -45,18 +48,36 @@ class HidIoThread : public QThread {
     void updateCachedOutputReportData(quint8 reportID,
             const QByteArray& reportData,
             bool resendUnchangedReport);
+    /// See HidIoOutputReport::setSchedule
+    void setOutputReportSchedule(quint8 reportID,
+            mixxx::Duration minimumInterval,
+            int priority);
     QByteArray getInputReport(quint8 reportID);
     void sendFeatureReport(quint8 reportID, const QByteArray& reportData);
     QByteArray getFeatureReport(quint8 reportID);
 
+    /// Returns the report with the highest priority among the reports that
+    /// are ready to be sent at time now. Reports with the same priority take
+    /// turns, starting with the first one after lastSentIt. Returns
+    /// reports.end() if no report is ready.
+    static OutputReportMapIterator selectNextOutputReport(
+            OutputReportMap& reports,
+            OutputReportMapIterator lastSentIt,
+            mixxx::Duration now,
+            bool ignoreMinimumIntervals);
+
   signals:
     /// Signals that a HID InputReport received by Interrupt triggered from HID device
     void receive(const QByteArray& data, mixxx::Duration timestamp);
 
   private:
+    HidIoOutputReport* getOrCreateOutputReport(quint8 reportID, int reportDataSize);
     bool sendNextCachedOutputReport();
+    OutputReportMapIterator nextOutputReportToSend(bool ignoreMinimumIntervals);
+    void logOutputReportStatistics();
 
     void pollBufferedInputReports();
+    bool waitForInputReport();
     void processInputReport(int bytesRead);
 
     const mixxx::hid::DeviceInfo m_deviceInfo;
@@ -69,6 +90,10 @@ class HidIoThread : public QThread {
     /// this mutex must not be unlocked before hid_error.
     /// This mutex must be locked also, for access to m_pPollData, m_lastPollSize, m_pollingBufferIndex.
     QMutex m_hidDeviceAndPollMutex;
+    /// The number of requests of other threads that wait for
+    /// m_hidDeviceAndPollMutex. The run loop doesn't wait for InputReports
+    /// while requests are pending.
+    QAtomicInt m_numPendingRequests;
 
     /// const pointer to the C data structure, which hidapi uses for communication between functions
     hid_device* const
@@ -84,13 +109,15 @@ class HidIoThread : public QThread {
     /// or when modify the m_outputReportIterator
     QMutex m_outputReportMapMutex;
 
-    typedef std::map<unsigned char, std::unique_ptr<HidIoOutputReport>> OutputReportMap;
     /// m_outputReports is an empty map after class initialization.
-    /// An entry is inserted each time, when an OutputReport is send for the first time.
+    /// An entry is inserted each time, when an OutputReport is send or scheduled for the first time.
     /// Until then, it's not known, which OutputReports a device/mapping has.
     /// No other modifications to the map are done, until destruction of this class.
     OutputReportMap m_outputReports;
-    OutputReportMap::iterator m_outputReportIterator;
+    OutputReportMapIterator m_outputReportIterator;
+
+    /// Only accessed by the run loop
+    mixxx::Duration m_lastOutputReportStatisticsTime;
 
     /// State of the HidIoThread lifecycle
     QAtomicInt m_state;
@@ -1,5 +1,8 @@
 #include "controllers/midi/midicontroller.h"
 
+#include <algorithm>
+
+#include "control/control.h"
 #include "control/controlobject.h"
 #include "controllers/defs_controllers.h"
 #include "controllers/midi/midiutils.h"
@@ -31,6 +34,80 @@ QString MidiController::mappingExtension() {
 
 void MidiController::setMapping(std::shared_ptr<LegacyControllerMapping> pMapping) {
     m_pMapping = downcastAndTakeOwnership<LegacyMidiControllerMapping>(std::move(pMapping));
+    compileInputMappings();
+}
+
+void MidiController::compileInputMappings() {
+    m_compiledInputMappings.clear();
+    for (auto& pRanges : m_compiledInputMappingRangesByStatus) {
+        pRanges.reset();
+    }
+    if (!m_pMapping) {
+        return;
+    }
+
+    const auto& inputMappings = m_pMapping->getInputMappings();
+    std::vector<std::pair<uint16_t, const MidiInputMapping*>> sortedInputMappings;
+    sortedInputMappings.reserve(inputMappings.size());
+    for (auto it = inputMappings.constBegin(); it != inputMappings.constEnd(); ++it) {
+        sortedInputMappings.emplace_back(it.key(), &it.value());
+    }
+    // Mappings with the same key are processed in the order of the
+    // hash, i.e. the most recently added first.
+    std::stable_sort(sortedInputMappings.begin(),
+            sortedInputMappings.end(),
+            [](const auto& lhs, const auto& rhs) {
+                return lhs.first < rhs.first;
+            });
+
+    m_compiledInputMappings.reserve(sortedInputMappings.size());
+    for (int i = 0; i < static_cast<int>(sortedInputMappings.size()); ++i) {
+        m_compiledInputMappings.emplace_back(*sortedInputMappings[i].second);
+        MidiKey key;
+        key.key = sortedInputMappings[i].first;
+        auto& pRanges = m_compiledInputMappingRangesByStatus[key.status];
+        if (!pRanges) {
+            pRanges = std::make_unique<CompiledInputMappingRanges>();
+        }
+        CompiledInputMappingRange& range = (*pRanges)[key.control];
+        if (range.begin == range.end) {
+            range.begin = i;
+        }
+        DEBUG_ASSERT(range.end == 0 || range.end == i);
+        range.end = i + 1;
+    }
+}
+
+const MidiController::CompiledInputMappingRange&
+MidiController::compiledInputMappingRange(
+        unsigned char status, unsigned char control) const {
+    static const CompiledInputMappingRange kEmptyRange;
+    const auto& pRanges = m_compiledInputMappingRangesByStatus[status];
+    if (!pRanges) {
+        return kEmptyRange;
+    }
+    return (*pRanges)[control];
+}
+
+ControlObject* MidiController::resolveControl(CompiledInputMapping* pCompiled) {
+    const QSharedPointer<ControlDoublePrivate> pControl = pCompiled->pControl.lock();
+    if (pControl) {
+        ControlObject* pCO = pControl->getCreatorCO();
+        if (pCO) {
+            return pCO;
+        }
+    }
+    // The control has not been created yet, or it has been deleted and
+    // might have been created again since.
+    const QSharedPointer<ControlDoublePrivate> pResolvedControl =
+            ControlDoublePrivate::getControl(pCompiled->mapping.control);
+    if (!pResolvedControl) {
+        return nullptr;
+    }
+    // Only a weak reference, that must neither keep the control alive
+    // nor prevent it from being created again.
+    pCompiled->pControl = pResolvedControl;
+    return pResolvedControl->getCreatorCO();
 }
 
 std::shared_ptr<LegacyControllerMapping> MidiController::cloneMapping() {
@@ -207,6 +284,7 @@ void MidiController::commitTemporaryInputMappings() {
         m_pMapping->addInputMapping(it.key(), it.value());
     }
     m_temporaryInputMappings.clear();
+    compileInputMappings();
 }
 
 void MidiController::receivedShortMessage(unsigned char status,
@@ -244,24 +322,28 @@ void MidiController::receivedShortMessage(unsigned char status,
         auto it = m_temporaryInputMappings.constFind(mappingKey.key);
         if (it != m_temporaryInputMappings.constEnd()) {
             for (; it != m_temporaryInputMappings.constEnd() && it.key() == mappingKey.key; ++it) {
-                processInputMapping(it.value(), status, control, value, timestamp);
+                // Temporary mappings are resolved for each message
+                CompiledInputMapping temporaryMapping(it.value());
+                processInputMapping(&temporaryMapping, status, control, value, timestamp);
             }
             return;
         }
     }
 
-    auto it = m_pMapping->getInputMappings().constFind(mappingKey.key);
-    for (; it != m_pMapping->getInputMappings().constEnd() && it.key() == mappingKey.key; ++it) {
-        processInputMapping(it.value(), status, control, value, timestamp);
+    const CompiledInputMappingRange& range =
+            compiledInputMappingRange(mappingKey.status, mappingKey.control);
+    for (int i = range.begin; i < range.end; ++i) {
+        processInputMapping(&m_compiledInputMappings[i], status, control, value, timestamp);
     }
 }
 
-void MidiController::processInputMapping(const MidiInputMapping& mapping,
-                                         unsigned char status,
-                                         unsigned char control,
-                                         unsigned char value,
-                                         mixxx::Duration timestamp) {
+void MidiController::processInputMapping(CompiledInputMapping* pCompiled,
+        unsigned char status,
+        unsigned char control,
+        unsigned char value,
+        mixxx::Duration timestamp) {
     Q_UNUSED(timestamp);
+    const MidiInputMapping& mapping = pCompiled->mapping;
     unsigned char channel = MidiUtils::channelFromStatus(status);
     MidiOpCode opCode = MidiUtils::opCodeFromStatus(status);
 
@@ -271,7 +353,10 @@ void MidiController::processInputMapping(const MidiInputMapping& mapping,
             return;
         }
 
-        QJSValue function = pEngine->wrapFunctionCode(mapping.control.item, 5);
+        if (pCompiled->scriptFunctionsId != pEngine->wrappedFunctionsId()) {
+            pCompiled->scriptFunction = pEngine->wrapFunctionCode(mapping.control.item, 5);
+            pCompiled->scriptFunctionsId = pEngine->wrappedFunctionsId();
+        }
         const auto args = QJSValueList{
                 channel,
                 control,
@@ -279,7 +364,10 @@ void MidiController::processInputMapping(const MidiInputMapping& mapping,
                 status,
                 mapping.control.group,
         };
-        if (!pEngine->executeFunction(function, args)) {
+        const ControllerScriptProfiler::Scope profile(
+                pEngine->profiler(), mapping.control.item);
+        const ControllerScriptEngineLegacy::DispatchScope dispatch(pEngine);
+        if (!pEngine->executeFunction(pCompiled->scriptFunction, args)) {
             qCWarning(m_logBase) << "MidiController: Invalid script function"
                                  << mapping.control.item;
         }
@@ -287,7 +375,7 @@ void MidiController::processInputMapping(const MidiInputMapping& mapping,
     }
 
     // Only pass values on to valid ControlObjects.
-    ControlObject* pCO = ControlObject::getControl(mapping.control);
+    ControlObject* pCO = resolveControl(pCompiled);
     if (pCO == nullptr) {
         return;
     }
@@ -513,9 +601,10 @@ void MidiController::receive(const QByteArray& data, mixxx::Duration timestamp)
         }
     }
 
-    auto it = m_pMapping->getInputMappings().constFind(mappingKey.key);
-    for (; it != m_pMapping->getInputMappings().constEnd() && it.key() == mappingKey.key; ++it) {
-        processInputMapping(it.value(), data, timestamp);
+    const CompiledInputMappingRange& range =
+            compiledInputMappingRange(mappingKey.status, mappingKey.control);
+    for (int i = range.begin; i < range.end; ++i) {
+        processInputMapping(m_compiledInputMappings[i].mapping, data, timestamp);
     }
 }
 
@@ -1,5 +1,11 @@
 #pragma once
 
+#include <QJSValue>
+#include <QWeakPointer>
+#include <array>
+#include <memory>
+#include <vector>
+
 #include "controllers/controller.h"
 #include "controllers/midi/legacymidicontrollermapping.h"
 #include "controllers/midi/legacymidicontrollermappingfilehandler.h"
@@ -7,6 +13,7 @@
 #include "controllers/midi/midioutputhandler.h"
 #include "controllers/softtakeover.h"
 
+class ControlDoublePrivate;
 class DlgControllerLearning;
 
 /// MIDI Controller base class
@@ -71,8 +78,38 @@ class MidiController : public Controller {
     void commitTemporaryInputMappings();
 
   private:
+    /// An input mapping with its control and script function resolved in
+    /// advance. Both are resolved again if they have become invalid, e.g.
+    /// when the control did not exist yet or the scripts have been reloaded.
+    struct CompiledInputMapping {
+        explicit CompiledInputMapping(const MidiInputMapping& mapping)
+                : mapping(mapping),
+                  scriptFunctionsId(0) {
+        }
+
+        MidiInputMapping mapping;
+        QWeakPointer<ControlDoublePrivate> pControl;
+        QJSValue scriptFunction;
+        int scriptFunctionsId;
+    };
+
+    /// The range of the compiled mappings of a MIDI key
+    struct CompiledInputMappingRange {
+        int begin = 0;
+        int end = 0;
+    };
+    typedef std::array<CompiledInputMappingRange, 256> CompiledInputMappingRanges;
+
+    /// Builds the dispatch table from the input mappings of m_pMapping.
+    /// Must be invoked whenever they have been modified.
+    void compileInputMappings();
+    const CompiledInputMappingRange& compiledInputMappingRange(
+            unsigned char status, unsigned char control) const;
+
+    ControlObject* resolveControl(CompiledInputMapping* pCompiled);
+
     void processInputMapping(
-            const MidiInputMapping& mapping,
+            CompiledInputMapping* pCompiled,
             unsigned char status,
             unsigned char control,
             unsigned char value,
@@ -88,6 +125,12 @@ class MidiController : public Controller {
     void destroyOutputHandlers();
 
     QHash<uint16_t, MidiInputMapping> m_temporaryInputMappings;
+    /// The compiled input mappings, grouped by their MIDI key
+    std::vector<CompiledInputMapping> m_compiledInputMappings;
+    /// Indexed by the status byte and then the control byte of a message.
+    /// Only allocated for status bytes with mappings.
+    std::array<std::unique_ptr<CompiledInputMappingRanges>, 256>
+            m_compiledInputMappingRangesByStatus;
     QList<MidiOutputHandler*> m_outputs;
     std::shared_ptr<LegacyMidiControllerMapping> m_pMapping;
     SoftTakeoverCtrl m_st;
@@ -71,7 +71,9 @@ class PortMidiController : public MidiController {
     void sendBytes(const QByteArray& data) override;
 
     bool isPolling() const override {
-        return true;
+        // Output-only devices have nothing to poll. They must not keep
+        // the poll timer of the ControllerManager running.
+        return m_pInputDevice && isInputDevice();
     }
 
     // For testing only so that test fixtures can install mock PortMidiDevices.
@@ -6,6 +6,7 @@
 #include "errordialoghandler.h"
 #include "mixer/playermanager.h"
 #include "moc_controllerscriptenginebase.cpp"
+#include "util/cmdlineargs.h"
 
 ControllerScriptEngineBase::ControllerScriptEngineBase(
         Controller* controller, const RuntimeLoggingCategory& logger)
@@ -13,7 +14,8 @@ ControllerScriptEngineBase::ControllerScriptEngineBase(
           m_pJSEngine(nullptr),
           m_pController(controller),
           m_logger(logger),
-          m_bTesting(false) {
+          m_bTesting(false),
+          m_profiler(CmdlineArgs::Instance().getControllerDebug()) {
     // Handle error dialog buttons
     qRegisterMetaType<QMessageBox::StandardButton>("QMessageBox::StandardButton");
 }
@@ -53,6 +55,7 @@ bool ControllerScriptEngineBase::initialize() {
 }
 
 void ControllerScriptEngineBase::shutdown() {
+    m_profiler.reportAndReset(m_logger);
     DEBUG_ASSERT(m_pJSEngine.use_count() == 1);
     m_pJSEngine.reset();
 }
@@ -7,6 +7,7 @@
 #include <memory>
 
 #include "controllers/legacycontrollermapping.h"
+#include "controllers/scripting/controllerscriptprofiler.h"
 #include "util/duration.h"
 #include "util/runtimeloggingcategory.h"
 
@@ -40,6 +41,10 @@ class ControllerScriptEngineBase : public QObject {
         return m_bTesting;
     }
 
+    ControllerScriptProfiler* profiler() {
+        return &m_profiler;
+    }
+
   protected:
     virtual void shutdown();
 
@@ -53,6 +58,8 @@ class ControllerScriptEngineBase : public QObject {
 
     bool m_bTesting;
 
+    ControllerScriptProfiler m_profiler;
+
   protected slots:
     void reload();
 
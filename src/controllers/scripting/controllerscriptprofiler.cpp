@@ -0,0 +1,61 @@
+#include "controllers/scripting/controllerscriptprofiler.h"
+
+#include <algorithm>
+
+namespace {
+
+constexpr int kMaxReportedEntries = 20;
+
+} // anonymous namespace
+
+ControllerScriptProfiler::ControllerScriptProfiler(bool enabled)
+        : m_enabled(enabled) {
+}
+
+void ControllerScriptProfiler::record(const QString& name, mixxx::Duration elapsed) {
+    Entry& entry = m_entries[name];
+    if (entry.count == 0) {
+        entry.name = name;
+    }
+    ++entry.count;
+    entry.total += elapsed;
+    if (elapsed > entry.max) {
+        entry.max = elapsed;
+    }
+}
+
+QVector<ControllerScriptProfiler::Entry> ControllerScriptProfiler::entries() const {
+    QVector<Entry> entries;
+    entries.reserve(m_entries.size());
+    for (const auto& entry : m_entries) {
+        entries.append(entry);
+    }
+    std::sort(entries.begin(),
+            entries.end(),
+            [](const Entry& lhs, const Entry& rhs) {
+                return lhs.total > rhs.total;
+            });
+    return entries;
+}
+
+void ControllerScriptProfiler::reportAndReset(const RuntimeLoggingCategory& logger) {
+    if (m_entries.isEmpty()) {
+        return;
+    }
+    const QVector<Entry> sortedEntries = entries();
+    qCInfo(logger) << "Time spent in the script callbacks, most expensive first:";
+    const int numReportedEntries =
+            std::min(kMaxReportedEntries, static_cast<int>(sortedEntries.size()));
+    for (int i = 0; i < numReportedEntries; ++i) {
+        const Entry& entry = sortedEntries[i];
+        const auto average = mixxx::Duration::fromNanos(
+                entry.total.toIntegerNanos() / entry.count);
+        qCInfo(logger).noquote()
+                << entry.name
+                << "calls:" << entry.count
+                << "total:" << entry.total.debugMillisWithUnit()
+                << "average:" << average.debugMicrosWithUnit()
+                << "max:" << entry.max.debugMicrosWithUnit();
+    }
+    m_entries.clear();
+}
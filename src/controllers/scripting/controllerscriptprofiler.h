@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+#include "util/duration.h"
+#include "util/performancetimer.h"
+#include "util/runtimeloggingcategory.h"
+
+/// ControllerScriptProfiler measures the time spent in the JS callbacks of a
+/// controller mapping by callback name, e.g. the input handlers, connection
+/// callbacks and timers. This helps mapping authors to find the handlers
+/// that keep the controller thread busy.
+///
+/// It is only enabled with --controller-debug, otherwise measuring a
+/// callback costs a single branch.
+class ControllerScriptProfiler {
+  public:
+    struct Entry {
+        QString name;
+        int count = 0;
+        mixxx::Duration total;
+        mixxx::Duration max;
+    };
+
+    /// Measures the lifetime of the scope as a call of the named callback.
+    class Scope {
+      public:
+        /// pProfiler may be nullptr
+        Scope(ControllerScriptProfiler* pProfiler, const QString& name)
+                : m_pProfiler(pProfiler && pProfiler->isEnabled() ? pProfiler : nullptr),
+                  m_name(m_pProfiler ? name : QString()) {
+            if (m_pProfiler) {
+                m_timer.start();
+            }
+        }
+        ~Scope() {
+            if (m_pProfiler) {
+                m_pProfiler->record(m_name, m_timer.elapsed());
+            }
+        }
+
+      private:
+        ControllerScriptProfiler* const m_pProfiler;
+        const QString m_name;
+        PerformanceTimer m_timer;
+    };
+
+    explicit ControllerScriptProfiler(bool enabled);
+
+    bool isEnabled() const {
+        return m_enabled;
+    }
+
+    void record(const QString& name, mixxx::Duration elapsed);
+
+    /// Returns the measured callbacks, the most expensive first.
+    QVector<Entry> entries() const;
+
+    /// Logs the most expensive callbacks and starts over.
+    void reportAndReset(const RuntimeLoggingCategory& logger);
+
+  private:
+    const bool m_enabled;
+    QHash<QString, Entry> m_entries;
+};
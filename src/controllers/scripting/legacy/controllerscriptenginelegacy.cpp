@@ -8,9 +8,22 @@
 #include "mixer/playermanager.h"
 #include "moc_controllerscriptenginelegacy.cpp"
 
+namespace {
+
+const QString kIncomingDataProfileName = QStringLiteral("incomingData");
+
+QAtomicInt s_nextWrappedFunctionsId(1);
+
+int nextWrappedFunctionsId() {
+    return s_nextWrappedFunctionsId.fetchAndAddRelaxed(1);
+}
+
+} // anonymous namespace
+
 ControllerScriptEngineLegacy::ControllerScriptEngineLegacy(
         Controller* controller, const RuntimeLoggingCategory& logger)
-        : ControllerScriptEngineBase(controller, logger) {
+        : ControllerScriptEngineBase(controller, logger),
+          m_wrappedFunctionsId(nextWrappedFunctionsId()) {
     connect(&m_fileWatcher,
             &QFileSystemWatcher::fileChanged,
             this,
@@ -21,6 +34,20 @@ ControllerScriptEngineLegacy::~ControllerScriptEngineLegacy() {
     shutdown();
 }
 
+ControllerScriptEngineLegacy::DispatchScope::DispatchScope(
+        ControllerScriptEngineLegacy* pEngine)
+        : m_pScriptInterface(pEngine ? pEngine->m_pScriptInterface.data() : nullptr) {
+    if (m_pScriptInterface) {
+        m_pScriptInterface->beginDispatch();
+    }
+}
+
+ControllerScriptEngineLegacy::DispatchScope::~DispatchScope() {
+    if (m_pScriptInterface) {
+        m_pScriptInterface->endDispatch();
+    }
+}
+
 bool ControllerScriptEngineLegacy::callFunctionOnObjects(
         const QList<QString>& scriptFunctionPrefixes,
         const QString& function,
@@ -123,6 +150,7 @@ bool ControllerScriptEngineLegacy::initialize() {
     QJSValue engineGlobalObject = m_pJSEngine->globalObject();
     ControllerScriptInterfaceLegacy* legacyScriptInterface =
             new ControllerScriptInterfaceLegacy(this, m_logger);
+    m_pScriptInterface = legacyScriptInterface;
     engineGlobalObject.setProperty(
             "engine", m_pJSEngine->newQObject(legacyScriptInterface));
 
@@ -173,6 +201,7 @@ void ControllerScriptEngineLegacy::shutdown() {
         callFunctionOnObjects(m_scriptFunctionPrefixes, "shutdown");
     }
     m_scriptWrappedFunctionCache.clear();
+    m_wrappedFunctionsId = nextWrappedFunctionsId();
     m_incomingDataFunctions.clear();
     m_scriptFunctionPrefixes.clear();
     if (m_pJSEngine) {
@@ -192,6 +221,8 @@ bool ControllerScriptEngineLegacy::handleIncomingData(const QByteArray& data) {
             static_cast<uint>(data.size()),
     };
 
+    const ControllerScriptProfiler::Scope profile(profiler(), kIncomingDataProfileName);
+    const DispatchScope dispatch(this);
     for (const QJSValue& function : std::as_const(m_incomingDataFunctions)) {
         ControllerScriptEngineBase::executeFunction(function, args);
     }
@@ -4,10 +4,13 @@
 #include <QJSEngine>
 #include <QJSValue>
 #include <QMessageBox>
+#include <QPointer>
 
 #include "controllers/legacycontrollermapping.h"
 #include "controllers/scripting/controllerscriptenginebase.h"
 
+class ControllerScriptInterfaceLegacy;
+
 /// ControllerScriptEngineLegacy loads and executes controller scripts for the legacy
 /// JS/XML hybrid controller mapping system.
 class ControllerScriptEngineLegacy : public ControllerScriptEngineBase {
@@ -21,11 +24,31 @@ class ControllerScriptEngineLegacy : public ControllerScriptEngineBase {
 
     bool handleIncomingData(const QByteArray& data);
 
+    /// Defers the engine.setValue() calls of the scripts while it exists,
+    /// see ControllerScriptInterfaceLegacy::beginDispatch(). Create one
+    /// around every callback into the scripts.
+    class DispatchScope {
+      public:
+        explicit DispatchScope(ControllerScriptEngineLegacy* pEngine);
+        ~DispatchScope();
+
+      private:
+        // The scripts may be reloaded by the callback
+        const QPointer<ControllerScriptInterfaceLegacy> m_pScriptInterface;
+    };
+
     /// Wrap a string of JS code in an anonymous function. This allows any JS
     /// string that evaluates to a function to be used in MIDI mapping XML files
     /// and ensures the function is executed with the correct 'this' object.
     QJSValue wrapFunctionCode(const QString& codeSnippet, int numberOfArgs);
 
+    /// Identifies the functions returned by wrapFunctionCode(). The id
+    /// changes when the functions become invalid, i.e. when the scripts are
+    /// reloaded. It is unique across all engines and never 0.
+    int wrappedFunctionsId() const {
+        return m_wrappedFunctionsId;
+    }
+
   public slots:
     void setScriptFiles(const QList<LegacyControllerMapping::ScriptFileInfo>& scripts);
 
@@ -43,10 +66,14 @@ class ControllerScriptEngineLegacy : public ControllerScriptEngineBase {
     QList<QString> m_scriptFunctionPrefixes;
     QList<QJSValue> m_incomingDataFunctions;
     QHash<QString, QJSValue> m_scriptWrappedFunctionCache;
+    int m_wrappedFunctionsId;
     QList<LegacyControllerMapping::ScriptFileInfo> m_scriptFiles;
 
     QFileSystemWatcher m_fileWatcher;
 
+    // Owned by the JS engine
+    QPointer<ControllerScriptInterfaceLegacy> m_pScriptInterface;
+
     // There is lots of tight coupling between ControllerScriptEngineLegacy
     // and ControllerScriptInterface. This is probably not worth improving in legacy code.
     friend class ControllerScriptInterfaceLegacy;
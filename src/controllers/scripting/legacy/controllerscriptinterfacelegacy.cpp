@@ -24,7 +24,8 @@ constexpr double kBrakeRampToRate = 0.01;
 
 ControllerScriptInterfaceLegacy::ControllerScriptInterfaceLegacy(
         ControllerScriptEngineLegacy* m_pEngine, const RuntimeLoggingCategory& logger)
-        : m_pScriptEngineLegacy(m_pEngine),
+        : m_dispatchDepth(0),
+          m_pScriptEngineLegacy(m_pEngine),
           m_logger(logger) {
     // Pre-allocate arrays for average number of virtual decks
     m_intervalAccumulator.resize(kDecks);
@@ -92,6 +93,12 @@ ControllerScriptInterfaceLegacy::~ControllerScriptInterfaceLegacy() {
 
 ControlObjectScript* ControllerScriptInterfaceLegacy::getControlObjectScript(
         const QString& group, const QString& name) {
+    applyPendingWrites();
+    return lookupControlObjectScript(group, name);
+}
+
+ControlObjectScript* ControllerScriptInterfaceLegacy::lookupControlObjectScript(
+        const QString& group, const QString& name) {
     ConfigKey key = ConfigKey(group, name);
     ControlObjectScript* coScript = m_controlCache.value(key, nullptr);
     if (coScript == nullptr) {
@@ -108,12 +115,21 @@ ControlObjectScript* ControllerScriptInterfaceLegacy::getControlObjectScript(
 }
 
 double ControllerScriptInterfaceLegacy::getValue(const QString& group, const QString& name) {
-    ControlObjectScript* coScript = getControlObjectScript(group, name);
+    ControlObjectScript* coScript = lookupControlObjectScript(group, name);
     if (coScript == nullptr) {
         qCWarning(m_logger) << "Unknown control" << group << name
                             << ", returning 0.0";
         return 0.0;
     }
+    // Reading another control does not interrupt the batch. Soft takeover
+    // may still ignore a pending write, so the value of a written control
+    // is read after applying the writes instead of taking it from them.
+    for (const auto& write : std::as_const(m_pendingWrites)) {
+        if (write.pControl == coScript) {
+            applyPendingWrites();
+            break;
+        }
+    }
     return coScript->get();
 }
 
@@ -125,19 +141,55 @@ void ControllerScriptInterfaceLegacy::setValue(
         return;
     }
 
-    ControlObjectScript* coScript = getControlObjectScript(group, name);
+    ControlObjectScript* coScript = lookupControlObjectScript(group, name);
+    if (coScript == nullptr) {
+        return;
+    }
+    if (m_dispatchDepth > 0) {
+        m_pendingWrites.append(PendingWrite{coScript, newValue});
+        return;
+    }
+    applyValue(coScript, newValue);
+}
 
-    if (coScript != nullptr) {
-        ControlObject* pControl = ControlObject::getControl(
-                coScript->getKey(), ControlFlag::AllowMissingOrInvalid);
-        if (pControl &&
-                !m_st.ignore(
-                        pControl, coScript->getParameterForValue(newValue))) {
-            coScript->set(newValue);
-        }
+void ControllerScriptInterfaceLegacy::applyValue(
+        ControlObjectScript* coScript, double newValue) {
+    ControlObject* pControl = coScript->getControlObject();
+    if (pControl &&
+            !m_st.ignore(
+                    pControl, coScript->getParameterForValue(newValue))) {
+        coScript->set(newValue);
     }
 }
 
+void ControllerScriptInterfaceLegacy::applyPendingWrites() {
+    if (m_pendingWrites.isEmpty()) {
+        return;
+    }
+    // Take the writes out first. A callback that is dispatched while they
+    // are applied applies its own writes before the remaining ones, in the
+    // same order as if they had not been deferred.
+    const QVector<PendingWrite> pendingWrites = std::move(m_pendingWrites);
+    m_pendingWrites.clear();
+    for (const auto& write : pendingWrites) {
+        applyValue(write.pControl, write.value);
+    }
+}
+
+void ControllerScriptInterfaceLegacy::beginDispatch() {
+    // Writes of an enclosing callback precede the nested callback
+    applyPendingWrites();
+    ++m_dispatchDepth;
+}
+
+void ControllerScriptInterfaceLegacy::endDispatch() {
+    VERIFY_OR_DEBUG_ASSERT(m_dispatchDepth > 0) {
+        return;
+    }
+    --m_dispatchDepth;
+    applyPendingWrites();
+}
+
 double ControllerScriptInterfaceLegacy::getParameter(const QString& group, const QString& name) {
     ControlObjectScript* coScript = getControlObjectScript(group, name);
     if (coScript == nullptr) {
@@ -159,8 +211,7 @@ void ControllerScriptInterfaceLegacy::setParameter(
     ControlObjectScript* coScript = getControlObjectScript(group, name);
 
     if (coScript != nullptr) {
-        ControlObject* pControl = ControlObject::getControl(
-                coScript->getKey(), ControlFlag::AllowMissingOrInvalid);
+        ControlObject* pControl = coScript->getControlObject();
         if (pControl && !m_st.ignore(pControl, newParameter)) {
             coScript->setParameter(newParameter);
         }
@@ -465,6 +516,12 @@ int ControllerScriptInterfaceLegacy::beginTimer(
     TimerInfo info;
     info.callback = timerCallback;
     info.oneShot = oneShot;
+    if (m_pScriptEngineLegacy->profiler()->isEnabled()) {
+        const QString functionName = timerCallback.property("name").toString();
+        info.profileName = functionName.isEmpty()
+                ? QStringLiteral("timer")
+                : QStringLiteral("timer %1").arg(functionName);
+    }
     m_timers[timerId] = info;
     if (timerId == 0) {
         qCWarning(m_logger) << "Script timer could not be created";
@@ -522,6 +579,9 @@ void ControllerScriptInterfaceLegacy::timerEvent(QTimerEvent* event) {
         stopTimer(timerId);
     }
 
+    const ControllerScriptProfiler::Scope profile(
+            m_pScriptEngineLegacy->profiler(), timerTarget.profileName);
+    const ControllerScriptEngineLegacy::DispatchScope dispatch(m_pScriptEngineLegacy);
     m_pScriptEngineLegacy->executeFunction(timerTarget.callback);
 }
 
@@ -2,6 +2,7 @@
 
 #include <QJSValue>
 #include <QObject>
+#include <QVector>
 
 #include "controllers/softtakeover.h"
 #include "util/alphabetafilter.h"
@@ -75,19 +76,41 @@ class ControllerScriptInterfaceLegacy : public QObject {
     /// Handler for timers that scripts set.
     virtual void timerEvent(QTimerEvent* event);
 
+    /// While a callback into the scripts is dispatched, engine.setValue()
+    /// only records the write. The writes are applied when the callback
+    /// returns, in the order in which they were made and without dropping
+    /// any of them. Use ControllerScriptEngineLegacy::DispatchScope.
+    void beginDispatch();
+    void endDispatch();
+
   private:
     QJSValue makeConnectionInternal(const QString& group,
             const QString& name,
             const QJSValue& callback,
             bool skipSuperseded = false);
     QHash<ConfigKey, ControlObjectScript*> m_controlCache;
+    /// Applies the pending writes first, so that they are not reordered
+    /// with the direct access to the control by the caller.
     ControlObjectScript* getControlObjectScript(const QString& group, const QString& name);
+    ControlObjectScript* lookupControlObjectScript(const QString& group, const QString& name);
+
+    void applyValue(ControlObjectScript* coScript, double newValue);
+    void applyPendingWrites();
+
+    struct PendingWrite {
+        ControlObjectScript* pControl;
+        double value;
+    };
+    QVector<PendingWrite> m_pendingWrites;
+    int m_dispatchDepth;
 
     SoftTakeoverCtrl m_st;
 
     struct TimerInfo {
         QJSValue callback;
         bool oneShot;
+        /// Only set while profiling
+        QString profileName;
     };
     QHash<int, TimerInfo> m_timers;
 
@@ -5,6 +5,13 @@
 
 void ScriptConnection::executeCallback(double value) const {
     Trace executeCallbackTrace("JS %1 callback", key.item);
+    ControllerScriptProfiler* pProfiler =
+            controllerEngine ? controllerEngine->profiler() : nullptr;
+    const ControllerScriptProfiler::Scope profile(pProfiler,
+            pProfiler && pProfiler->isEnabled()
+                    ? QStringLiteral("connection %1,%2").arg(key.group, key.item)
+                    : QString());
+    const ControllerScriptEngineLegacy::DispatchScope dispatch(controllerEngine);
     const auto args = QJSValueList{
             value,
             key.group,
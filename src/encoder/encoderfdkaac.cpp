@@ -364,19 +364,16 @@ void EncoderFdkAac::encodeBuffer(const CSAMPLE* samples, const int sampleCount)
         writeCount = writeAvailable;
     }
     if (writeCount > 0) {
-        SAMPLE* dataPtr1;
-        ring_buffer_size_t size1;
-        SAMPLE* dataPtr2;
-        ring_buffer_size_t size2;
-        // We use size1 and size2, so we can ignore the return value
-        (void)m_pInputFifo->aquireWriteRegions(writeCount, &dataPtr1, &size1, &dataPtr2, &size2);
+        const auto regions = m_pInputFifo->reserveWrite(writeCount);
         // fdk-aac doesn't support float samples, so convert
         // to integers instead
-        SampleUtil::convertFloat32ToS16(dataPtr1, samples, size1);
-        if (size2 > 0) {
-            SampleUtil::convertFloat32ToS16(dataPtr2, samples + size1, size2);
+        SampleUtil::convertFloat32ToS16(regions.first.data(), samples, regions.first.size());
+        if (!regions.second.empty()) {
+            SampleUtil::convertFloat32ToS16(regions.second.data(),
+                    samples + regions.first.size(),
+                    regions.second.size());
         }
-        m_pInputFifo->releaseWriteRegions(writeCount);
+        m_pInputFifo->commitWrite(regions.size());
     }
     processFIFO();
 }
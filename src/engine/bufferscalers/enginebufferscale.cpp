@@ -3,6 +3,15 @@
 #include "engine/engine.h"
 #include "moc_enginebufferscale.cpp"
 #include "util/defs.h"
+#include "util/math.h"
+
+namespace {
+
+// The granularity of tempo ramps. Small enough to follow the phase within a
+// large buffer, large enough to not degrade the time stretching quality.
+constexpr SINT kTempoRampStepFrames = 128;
+
+} // anonymous namespace
 
 EngineBufferScale::EngineBufferScale()
         : m_outputSignal(
@@ -25,3 +34,36 @@ void EngineBufferScale::setSampleRate(
     }
     DEBUG_ASSERT(m_outputSignal.isValid());
 }
+
+double EngineBufferScale::scaleBufferWithTempoRamp(
+        CSAMPLE* pOutputBuffer,
+        SINT iOutputBufferSize,
+        double startTempoRatio) {
+    const double baseRate = m_dBaseRate;
+    const double endTempoRatio = m_dTempoRatio;
+    const double pitchRatio = m_dPitchRatio;
+    const SINT numFrames = getOutputSignal().samples2frames(iOutputBufferSize);
+    if (startTempoRatio == endTempoRatio || numFrames <= kTempoRampStepFrames) {
+        return scaleBuffer(pOutputBuffer, iOutputBufferSize);
+    }
+
+    double framesRead = 0;
+    SINT frame = 0;
+    while (frame < numFrames) {
+        const SINT stepFrames = math_min(kTempoRampStepFrames, numFrames - frame);
+        // The last step always ends with the requested tempo, so the scaler
+        // is left in the same state as after scaleBuffer().
+        double tempoRatio = (frame + stepFrames == numFrames)
+                ? endTempoRatio
+                : startTempoRatio +
+                        (endTempoRatio - startTempoRatio) *
+                                (frame + stepFrames) / numFrames;
+        double stepPitchRatio = pitchRatio;
+        setScaleParameters(baseRate, &tempoRatio, &stepPitchRatio);
+        framesRead += scaleBuffer(
+                pOutputBuffer + getOutputSignal().frames2samples(frame),
+                getOutputSignal().frames2samples(stepFrames));
+        frame += stepFrames;
+    }
+    return framesRead;
+}
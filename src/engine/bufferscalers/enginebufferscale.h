@@ -63,6 +63,16 @@ class EngineBufferScale : public QObject {
             CSAMPLE* pOutputBuffer,
             SINT iOutputBufferSize) = 0;
 
+    // Scales the buffer like scaleBuffer(), but ramps the tempo ratio
+    // linearly from startTempoRatio to the tempo ratio of the last
+    // setScaleParameters() call in short steps across the buffer. Used for
+    // scalers that apply a tempo change at once, to avoid a rate step at
+    // every callback boundary. Returns the total number of frames read.
+    double scaleBufferWithTempoRamp(
+            CSAMPLE* pOutputBuffer,
+            SINT iOutputBufferSize,
+            double startTempoRatio);
+
   private:
     mixxx::audio::SignalInfo m_outputSignal;
 
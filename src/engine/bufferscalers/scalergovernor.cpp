@@ -0,0 +1,147 @@
+#include "engine/bufferscalers/scalergovernor.h"
+
+namespace {
+
+// Time constant of the exponential smoothing of the callback load
+constexpr double kLoadTimeConstantSeconds = 0.5;
+// Demote a deck if the smoothed load exceeds this fraction of the period
+constexpr double kHighWatermark = 0.7;
+// Promote a deck if the smoothed load stays below this fraction
+constexpr double kLowWatermark = 0.4;
+// Give the scalers time to settle before measuring the effect of a change
+constexpr double kMinSecondsBetweenChanges = 1.0;
+// Be conservative when promoting to avoid oscillation
+constexpr double kMinSecondsBeforePromotion = 5.0;
+
+using ScalerTier = ScalerGovernor::ScalerTier;
+
+ScalerTier effectiveTier(const ScalerGovernor::Deck& deck) {
+    return deck.tierLimit < deck.configuredTier ? deck.tierLimit : deck.configuredTier;
+}
+
+ScalerTier minimumTier(const ScalerGovernor::Deck& deck) {
+    // The linear scaler cannot preserve the key, so it is only acceptable
+    // for decks that cannot be heard at all.
+    return deck.audibleGain > 0 ? ScalerTier::SoundTouch : ScalerTier::Linear;
+}
+
+ScalerTier lowerTier(ScalerTier tier) {
+    return static_cast<ScalerTier>(static_cast<int>(tier) - 1);
+}
+
+ScalerTier higherTier(ScalerTier tier) {
+    return static_cast<ScalerTier>(static_cast<int>(tier) + 1);
+}
+
+} // anonymous namespace
+
+ScalerGovernor::ScalerGovernor()
+        : m_enabled(true),
+          m_limitsReset(false),
+          m_smoothedLoad(0.0),
+          m_secondsSinceLastChange(0.0),
+          m_secondsBelowLowWatermark(0.0) {
+}
+
+void ScalerGovernor::setEnabled(bool enabled) {
+    m_enabled = enabled;
+}
+
+bool ScalerGovernor::process(double callbackLoad,
+        double periodSeconds,
+        Deck* pDecks,
+        int numDecks) {
+    if (!m_enabled) {
+        if (m_limitsReset) {
+            return false;
+        }
+        for (int i = 0; i < numDecks; ++i) {
+            pDecks[i].tierLimit = ScalerTier::RubberBandFiner;
+        }
+        m_smoothedLoad = 0.0;
+        m_limitsReset = true;
+        return true;
+    }
+    m_limitsReset = false;
+
+    bool changed = false;
+    // A deck that has been demoted to the linear scaler while muted must
+    // preserve its key as soon as it becomes audible.
+    for (int i = 0; i < numDecks; ++i) {
+        Deck& deck = pDecks[i];
+        if (deck.tierLimit < minimumTier(deck)) {
+            deck.tierLimit = minimumTier(deck);
+            changed = true;
+        }
+    }
+
+    const double alpha = periodSeconds / (kLoadTimeConstantSeconds + periodSeconds);
+    m_smoothedLoad += alpha * (callbackLoad - m_smoothedLoad);
+    m_secondsSinceLastChange += periodSeconds;
+    if (m_smoothedLoad < kLowWatermark) {
+        m_secondsBelowLowWatermark += periodSeconds;
+    } else {
+        m_secondsBelowLowWatermark = 0.0;
+    }
+
+    if (m_secondsSinceLastChange < kMinSecondsBetweenChanges) {
+        return changed;
+    }
+
+    bool adjusted = false;
+    if (m_smoothedLoad > kHighWatermark) {
+        adjusted = demoteOne(pDecks, numDecks);
+    } else if (m_secondsBelowLowWatermark >= kMinSecondsBeforePromotion) {
+        adjusted = promoteOne(pDecks, numDecks);
+    }
+    if (adjusted) {
+        m_secondsSinceLastChange = 0.0;
+        m_secondsBelowLowWatermark = 0.0;
+    }
+    return changed || adjusted;
+}
+
+bool ScalerGovernor::demoteOne(Deck* pDecks, int numDecks) const {
+    // Demote the least audible deck, and among equally audible decks the
+    // one with the most expensive scaler.
+    Deck* pVictim = nullptr;
+    for (int i = 0; i < numDecks; ++i) {
+        Deck& deck = pDecks[i];
+        if (!deck.keylockActive || effectiveTier(deck) <= minimumTier(deck)) {
+            continue;
+        }
+        if (!pVictim ||
+                deck.audibleGain < pVictim->audibleGain ||
+                (deck.audibleGain == pVictim->audibleGain &&
+                        effectiveTier(deck) > effectiveTier(*pVictim))) {
+            pVictim = &deck;
+        }
+    }
+    if (!pVictim) {
+        return false;
+    }
+    pVictim->tierLimit = lowerTier(effectiveTier(*pVictim));
+    return true;
+}
+
+bool ScalerGovernor::promoteOne(Deck* pDecks, int numDecks) const {
+    // The most audible deck gets its quality back first.
+    Deck* pCandidate = nullptr;
+    for (int i = 0; i < numDecks; ++i) {
+        Deck& deck = pDecks[i];
+        if (deck.tierLimit >= deck.configuredTier) {
+            continue;
+        }
+        if (!pCandidate || deck.audibleGain > pCandidate->audibleGain) {
+            pCandidate = &deck;
+        }
+    }
+    if (!pCandidate) {
+        return false;
+    }
+    const ScalerTier tier = higherTier(pCandidate->tierLimit);
+    pCandidate->tierLimit = tier < pCandidate->configuredTier
+            ? tier
+            : ScalerTier::RubberBandFiner;
+    return true;
+}
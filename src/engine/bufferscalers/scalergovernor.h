@@ -0,0 +1,62 @@
+#pragma once
+
+#include "engine/enginebuffer.h"
+#include "util/types.h"
+
+/// Moves individual decks between keylock scaler tiers depending on the
+/// available headroom of the audio callback.
+///
+/// When the smoothed callback load stays above a high watermark, the least
+/// audible deck that uses the keylock scaler is demoted one tier, e.g. from
+/// RubberBand R3 to R2. When the load stays below a low watermark, the most
+/// audible demoted deck is promoted again. Decks are never promoted beyond
+/// the tier selected by the keylock engine preference and only decks that
+/// are completely inaudible may fall back to the linear scaler.
+///
+/// The governor only decides on the limits. EngineBuffer applies them with
+/// a crossfade in the next callback. All methods must be called from the
+/// engine thread.
+class ScalerGovernor {
+  public:
+    using ScalerTier = EngineBuffer::ScalerTier;
+
+    struct Deck {
+        /// The tier selected by the keylock engine preference
+        ScalerTier configuredTier;
+        /// The limit imposed by the governor, updated by process()
+        ScalerTier tierLimit;
+        /// Whether the deck currently plays through the keylock scaler
+        bool keylockActive;
+        /// The larger of the master and headphone gain of the deck
+        CSAMPLE_GAIN audibleGain;
+    };
+
+    ScalerGovernor();
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const {
+        return m_enabled;
+    }
+
+    /// Feeds the measured load of a callback, i.e. the time spent in the
+    /// callback divided by the period of the callback. Returns true if the
+    /// limit of any deck has been changed.
+    bool process(double callbackLoad,
+            double periodSeconds,
+            Deck* pDecks,
+            int numDecks);
+
+    double smoothedLoad() const {
+        return m_smoothedLoad;
+    }
+
+  private:
+    bool demoteOne(Deck* pDecks, int numDecks) const;
+    bool promoteOne(Deck* pDecks, int numDecks) const;
+
+    bool m_enabled;
+    bool m_limitsReset;
+    double m_smoothedLoad;
+    double m_secondsSinceLastChange;
+    double m_secondsBelowLowWatermark;
+};
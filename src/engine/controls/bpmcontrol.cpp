@@ -1,6 +1,7 @@
 #include "engine/controls/bpmcontrol.h"
 
 #include <QStringList>
+#include <cmath>
 
 #include "control/controllinpotmeter.h"
 #include "control/controlobject.h"
@@ -45,6 +46,17 @@ constexpr int kLocalBpmSpan = 4;
 // of the next beat.
 constexpr double kPastBeatMatchThreshold = 1 / 8.0;
 
+// The maximum rate adjustment to bring a follower into phase.
+constexpr double kSyncAdjustmentCap = 0.05;
+
+// Predictive sync removes a phase error with this time constant, independent
+// of the buffer size.
+constexpr double kPredictiveSyncTimeConstantSeconds = 0.5;
+// Below this error (in beats) predictive sync considers the decks in phase.
+constexpr double kPredictiveSyncErrorThreshold = 0.002;
+// Limits how fast the sync adjustment may change, to avoid audible wobble.
+constexpr double kPredictiveSyncSlewPerSecond = 1.0;
+
 } // namespace
 
 BpmControl::BpmControl(const QString& group,
@@ -52,7 +64,8 @@ BpmControl::BpmControl(const QString& group,
         : EngineControl(group, pConfig),
           m_tapFilter(this, kBpmTapFilterLength, kBpmTapMaxInterval),
           m_dSyncInstantaneousBpm(0.0),
-          m_dLastSyncAdjustment(1.0) {
+          m_dLastSyncAdjustment(1.0),
+          m_bPredictiveSyncActive(false) {
     m_dSyncTargetBeatDistance.setValue(0.0);
     m_dUserOffset.setValue(0.0);
 
@@ -129,6 +142,7 @@ BpmControl::BpmControl(const QString& group,
     m_pThisBeatDistance = new ControlProxy(group, "beat_distance", this);
     m_pSyncMode = new ControlProxy(group, "sync_mode", this);
     m_pSyncEnabled = new ControlProxy(group, "sync_enabled", this);
+    m_pPredictiveSync = new ControlProxy("[InternalClock]", "sync_predictive", this);
 }
 
 BpmControl::~BpmControl() {
@@ -299,10 +313,11 @@ double BpmControl::shortestPercentageChange(const double& current_percentage,
     }
 }
 
-double BpmControl::calcSyncedRate(double userTweak) {
+double BpmControl::calcSyncedRate(double userTweak, double bufferSeconds) {
     if (kLogger.traceEnabled()) {
         kLogger.trace() << getGroup() << "BpmControl::calcSyncedRate, tweak " << userTweak;
     }
+    m_bPredictiveSyncActive = false;
     double rate = 1.0;
     // Don't know what to do if there's no bpm.
     if (m_pLocalBpm->toBool()) {
@@ -351,11 +366,11 @@ double BpmControl::calcSyncedRate(double userTweak) {
     }
 
     // Now we have all we need to calculate the sync adjustment if any.
-    double adjustment = calcSyncAdjustment(userTweak != 0.0);
+    double adjustment = calcSyncAdjustment(userTweak != 0.0, bufferSeconds);
     return (rate + userTweak) * adjustment;
 }
 
-double BpmControl::calcSyncAdjustment(bool userTweakingSync) {
+double BpmControl::calcSyncAdjustment(bool userTweakingSync, double bufferSeconds) {
     int resetSyncAdjustment = m_resetSyncAdjustment.fetchAndStoreRelaxed(0);
     if (resetSyncAdjustment) {
         m_dLastSyncAdjustment = 1.0;
@@ -395,10 +410,12 @@ double BpmControl::calcSyncAdjustment(bool userTweakingSync) {
         // don't even know if we're ahead or behind.  This can occur when quantize was
         // off, but then it gets turned on.
         constexpr double kTrainWreckThreshold = 0.2;
-        constexpr double kSyncAdjustmentCap = 0.05;
         if (fabs(error) > kTrainWreckThreshold) {
             // Assume poor reflexes (late button push) -- speed up to catch the other track.
             adjustment = 1.0 + kSyncAdjustmentCap;
+        } else if (m_pPredictiveSync->toBool() && bufferSeconds > 0) {
+            adjustment = calcPredictiveSyncAdjustment(error, bufferSeconds);
+            m_bPredictiveSyncActive = true;
         } else if (fabs(error) > kErrorThreshold) {
             // Proportional control constant. The higher this is, the more we
             // influence sync.
@@ -432,6 +449,33 @@ double BpmControl::calcSyncAdjustment(bool userTweakingSync) {
     return adjustment;
 }
 
+double BpmControl::calcPredictiveSyncAdjustment(double error, double bufferSeconds) const {
+    // The proportional control above corrects a fixed share of the error per
+    // callback, so it reacts differently depending on the buffer size and
+    // only starts correcting once the error has become audible. Instead,
+    // predict how far this deck moves relative to the leader until the end
+    // of the upcoming buffer and choose the rate that removes the error with
+    // a fixed time constant.
+    double targetAdjustment = 1.0;
+    // Beats this deck advances during the buffer at the synced rate, which
+    // are the same beats the leader advances.
+    const double beatsPerBuffer = bufferSeconds * m_dSyncInstantaneousBpm / 60.0;
+    if (fabs(error) > kPredictiveSyncErrorThreshold && beatsPerBuffer > 0) {
+        const double correction = error *
+                (1.0 - std::exp(-bufferSeconds / kPredictiveSyncTimeConstantSeconds));
+        targetAdjustment = 1.0 - correction / beatsPerBuffer;
+    }
+
+    // Limit the slope of the adjustment per second rather than per callback.
+    const double maxDelta = kPredictiveSyncSlewPerSecond * bufferSeconds;
+    const double delta = math_clamp(
+            targetAdjustment - m_dLastSyncAdjustment, -maxDelta, maxDelta);
+    return 1.0 +
+            math_clamp(m_dLastSyncAdjustment - 1.0 + delta,
+                    -kSyncAdjustmentCap,
+                    kSyncAdjustmentCap);
+}
+
 double BpmControl::getBeatDistance(mixxx::audio::FramePos thisPosition) const {
     // We have to adjust our reported beat distance by the user offset to
     // preserve comparisons of beat distances.  Specifically, this beat distance
@@ -36,8 +36,15 @@ class BpmControl : public EngineControl {
     // how much the user is nudging the pitch to get two tracks into sync, and
     // that value is added to the rate by bpmcontrol.  The rate may be
     // further adjusted if bpmcontrol discovers that the tracks have fallen
-    // out of sync.
-    double calcSyncedRate(double userTweak);
+    // out of sync. bufferSeconds is the duration of the upcoming callback,
+    // which is used to predict the phase at its end.
+    double calcSyncedRate(double userTweak, double bufferSeconds);
+    /// Returns true if the last call to calcSyncedRate() applied a
+    /// predictive phase correction. In this case EngineBuffer ramps the
+    /// tempo of the keylock scalers across the buffer.
+    bool isPredictiveSyncActive() const {
+        return m_bPredictiveSyncActive;
+    }
     // Get the phase offset from the specified position.
     mixxx::audio::FramePos getNearestPositionInPhase(
             mixxx::audio::FramePos thisPosition,
@@ -117,7 +124,8 @@ class BpmControl : public EngineControl {
     inline bool isSynchronized() const {
         return toSynchronized(getSyncMode());
     }
-    double calcSyncAdjustment(bool userTweakingSync);
+    double calcSyncAdjustment(bool userTweakingSync, double bufferSeconds);
+    double calcPredictiveSyncAdjustment(double error, double bufferSeconds) const;
     void adjustBeatsBpm(double deltaBpm);
 
     friend class SyncControl;
@@ -166,12 +174,14 @@ class BpmControl : public EngineControl {
     QAtomicInt m_resetSyncAdjustment;
     ControlProxy* m_pSyncMode;
     ControlProxy* m_pSyncEnabled;
+    ControlProxy* m_pPredictiveSync;
 
     TapFilter m_tapFilter; // threadsafe
 
     // used in the engine thread only
     double m_dSyncInstantaneousBpm;
     double m_dLastSyncAdjustment;
+    bool m_bPredictiveSyncActive;
 
     // m_pBeats is written from an engine worker thread
     mixxx::BeatsPointer m_pBeats;
@@ -9,6 +9,7 @@
 #include "control/controlttrotary.h"
 #include "engine/controls/bpmcontrol.h"
 #include "engine/controls/enginecontrol.h"
+#include "engine/engine.h"
 #include "engine/positionscratchcontroller.h"
 #include "moc_ratecontrol.cpp"
 #include "util/rotary.h"
@@ -474,7 +475,11 @@ double RateControl::calculateSpeed(double baserate, double speed, bool paused,
                     // Only report user tweak if the user is not scratching.
                     userTweak = getTempRate() + wheelFactor + jogFactor;
                 }
-                rate = m_pBpmControl->calcSyncedRate(userTweak);
+                const double sampleRate = m_pSampleRate->get();
+                const double bufferSeconds = sampleRate > 0
+                        ? iSamplesPerBuffer / mixxx::kEngineChannelCount / sampleRate
+                        : 0.0;
+                rate = m_pBpmControl->calcSyncedRate(userTweak, bufferSeconds);
             }
             // If we are reversing (and not scratching,) flip the rate.  This is ok even when syncing.
             // Reverse with vinyl is only ok if absolute mode isn't on.
@@ -0,0 +1,121 @@
+#include "engine/engineautodjtransition.h"
+
+#include "engine/enginebuffer.h"
+#include "util/assert.h"
+#include "util/math.h"
+
+AutoDJTransitionSchedule::AutoDJTransitionSchedule()
+        : m_engineAttached(0),
+          m_lastPlanId(0) {
+    m_plan.setValue(AutoDJTransitionPlan());
+    m_progress.setValue(AutoDJTransitionProgress());
+}
+
+int AutoDJTransitionSchedule::setPlan(AutoDJTransitionPlan plan) {
+    plan.id = ++m_lastPlanId;
+    m_plan.setValue(plan);
+    return plan.id;
+}
+
+void AutoDJTransitionSchedule::clearPlan() {
+    setPlan(AutoDJTransitionPlan());
+}
+
+EngineAutoDJTransition::EngineAutoDJTransition()
+        : m_pSchedule(QSharedPointer<AutoDJTransitionSchedule>::create()),
+          m_crossfaderAtFadeBegin(0.0) {
+    m_pSchedule->m_engineAttached.ref();
+}
+
+EngineAutoDJTransition::~EngineAutoDJTransition() {
+    m_pSchedule->m_engineAttached.deref();
+}
+
+void EngineAutoDJTransition::addDeck(EngineBuffer* pBuffer) {
+    VERIFY_OR_DEBUG_ASSERT(m_decks.size() < kMaxNumberOfDecks) {
+        return;
+    }
+    m_decks.append(Deck{pBuffer, PollingControlProxy(pBuffer->getGroup(), "play")});
+}
+
+EngineAutoDJTransition::Deck* EngineAutoDJTransition::deck(int index) {
+    if (index < 0 || index >= m_decks.size()) {
+        return nullptr;
+    }
+    return &m_decks[index];
+}
+
+void EngineAutoDJTransition::setState(AutoDJTransitionProgress::State state) {
+    m_progress.state = state;
+    m_pSchedule->setProgress(m_progress);
+}
+
+bool EngineAutoDJTransition::process(
+        int iFrames, bool crossfaderReverse, double* pCrossfader) {
+    using State = AutoDJTransitionProgress::State;
+
+    const AutoDJTransitionPlan plan = m_pSchedule->plan();
+    if (plan.id != m_plan.id) {
+        m_plan = plan;
+        m_progress.planId = plan.id;
+        m_progress.progress = 0.0;
+        setState(plan.isValid() ? State::Waiting : State::Idle);
+    }
+    if (m_progress.state != State::Waiting && m_progress.state != State::Fading) {
+        return false;
+    }
+
+    Deck* pFromDeck = deck(m_plan.fromDeck);
+    Deck* pToDeck = deck(m_plan.toDeck);
+    if (!pFromDeck || !pToDeck) {
+        setState(State::Idle);
+        return false;
+    }
+    const mixxx::audio::FramePos position = pFromDeck->pBuffer->getExactPlayPos();
+    if (!position.isValid()) {
+        return false;
+    }
+
+    // AutoDJProcessor uses a crossfader that is normalized so that -1 is
+    // the left side.
+    const double crossfader = crossfaderReverse ? -*pCrossfader : *pCrossfader;
+
+    if (m_progress.state == State::Waiting) {
+        // The to deck starts playing with the next callback. Start it in the
+        // callback that ends closest to the fade begin position.
+        const double framesPerCallback = iFrames * fabs(pFromDeck->pBuffer->getSpeed());
+        if (position + framesPerCallback / 2 < m_plan.fadeBeginPosition) {
+            return false;
+        }
+        if (!pToDeck->play.toBool()) {
+            pToDeck->play.set(1.0);
+        }
+        m_crossfaderAtFadeBegin = crossfader;
+        setState(State::Fading);
+    }
+
+    double progress;
+    if (m_plan.fadeEndPosition <= m_plan.fadeBeginPosition) {
+        // A jump cut
+        progress = position >= m_plan.fadeBeginPosition ? 1.0 : 0.0;
+    } else {
+        progress = (position - m_plan.fadeBeginPosition) /
+                (m_plan.fadeEndPosition - m_plan.fadeBeginPosition);
+    }
+    // Backward seeks pause the transition, forward seeks speed it up.
+    progress = math_clamp(progress, m_progress.progress, 1.0);
+    m_progress.progress = progress;
+
+    const double newCrossfader = m_crossfaderAtFadeBegin +
+            (m_plan.crossfaderTarget - m_crossfaderAtFadeBegin) * progress;
+    *pCrossfader = crossfaderReverse ? -newCrossfader : newCrossfader;
+
+    if (progress >= 1.0) {
+        // The from deck is silent now
+        pFromDeck->play.set(0.0);
+        setState(State::Done);
+    } else {
+        m_pSchedule->setProgress(m_progress);
+    }
+    return newCrossfader != crossfader;
+}
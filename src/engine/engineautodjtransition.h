@@ -0,0 +1,138 @@
+#pragma once
+
+#include <QAtomicInt>
+#include <QSharedPointer>
+#include <QVarLengthArray>
+
+#include "audio/frame.h"
+#include "control/controlvalue.h"
+#include "control/pollingcontrolproxy.h"
+#include "util/defs.h"
+
+class EngineBuffer;
+
+/// A crossfade between two decks as calculated by
+/// AutoDJProcessor::calculateTransition().
+struct AutoDJTransitionPlan {
+    /// Every new plan gets a new id, 0 is never used
+    int id = 0;
+    /// Deck indices as used by PlayerManager::groupForDeck(). There is no
+    /// transition if any of them is negative.
+    int fromDeck = -1;
+    int toDeck = -1;
+    /// Play positions of the from deck where the crossfade begins and ends.
+    /// The to deck starts playing at fadeBeginPosition.
+    mixxx::audio::FramePos fadeBeginPosition;
+    mixxx::audio::FramePos fadeEndPosition;
+    /// The crossfader position after the transition, -1 for the left side
+    /// and 1 for the right side. xFaderReverse is applied by the engine.
+    /// The crossfader moves linearly with the play position of the from
+    /// deck.
+    double crossfaderTarget = 0.0;
+
+    bool isValid() const {
+        return id != 0 && fromDeck >= 0 && toDeck >= 0 &&
+                fadeBeginPosition.isValid() && fadeEndPosition.isValid();
+    }
+};
+
+/// The state of the plan that is executed by the engine.
+struct AutoDJTransitionProgress {
+    enum class State {
+        /// There is no plan to execute
+        Idle,
+        /// Waiting for the from deck to reach the fade begin position
+        Waiting,
+        /// The to deck has been started and the crossfader is moving
+        Fading,
+        /// The crossfader has reached its target and the from deck has
+        /// been stopped
+        Done,
+    };
+
+    int planId = 0;
+    State state = State::Idle;
+    /// The position of the crossfade between 0 and 1
+    double progress = 0.0;
+};
+
+/// Passes the plans from AutoDJProcessor to the engine and the progress
+/// back without locking. It is created by EngineAutoDJTransition and
+/// handed to AutoDJProcessor by PlayerManager.
+class AutoDJTransitionSchedule {
+  public:
+    AutoDJTransitionSchedule();
+
+    /// Returns true if there is an engine that executes the plans.
+    /// Otherwise AutoDJProcessor has to move the crossfader itself.
+    bool isEngineAttached() const {
+        return m_engineAttached.loadAcquire() > 0;
+    }
+
+    /// Replaces the current plan. Returns the id of the new plan.
+    /// Called from the main thread.
+    int setPlan(AutoDJTransitionPlan plan);
+    /// Cancels the current plan. Called from the main thread.
+    void clearPlan();
+    AutoDJTransitionPlan plan() const {
+        return m_plan.getValue();
+    }
+
+    void setProgress(const AutoDJTransitionProgress& progress) {
+        m_progress.setValue(progress);
+    }
+    AutoDJTransitionProgress progress() const {
+        return m_progress.getValue();
+    }
+
+  private:
+    friend class EngineAutoDJTransition;
+
+    ControlValueAtomic<AutoDJTransitionPlan> m_plan;
+    ControlValueAtomic<AutoDJTransitionProgress> m_progress;
+    QAtomicInt m_engineAttached;
+    int m_lastPlanId;
+};
+
+/// Executes the AutoDJ transitions inside the audio callback. The to deck
+/// is started and the crossfader is moved depending on the play position
+/// of the from deck as processed by the engine, so the transition does not
+/// depend on how busy the main thread is. EngineMaster applies crossfader
+/// changes with a gain ramp across the buffer.
+class EngineAutoDJTransition {
+  public:
+    EngineAutoDJTransition();
+    ~EngineAutoDJTransition();
+
+    /// The schedule through which AutoDJProcessor passes the plans. It
+    /// outlives the engine if AutoDJProcessor still holds a reference.
+    QSharedPointer<AutoDJTransitionSchedule> schedule() const {
+        return m_pSchedule;
+    }
+
+    /// Registers the deck with the next index (main thread)
+    void addDeck(EngineBuffer* pBuffer);
+    int numDecks() const {
+        return m_decks.size();
+    }
+
+    /// Executes the current plan after all channels have been processed.
+    /// Returns true and updates pCrossfader, which is the value of
+    /// [Master],crossfader, if the crossfader has been moved.
+    bool process(int iFrames, bool crossfaderReverse, double* pCrossfader);
+
+  private:
+    struct Deck {
+        EngineBuffer* pBuffer;
+        PollingControlProxy play;
+    };
+
+    Deck* deck(int index);
+    void setState(AutoDJTransitionProgress::State state);
+
+    QSharedPointer<AutoDJTransitionSchedule> m_pSchedule;
+    QVarLengthArray<Deck, kMaxNumberOfDecks> m_decks;
+    AutoDJTransitionPlan m_plan;
+    AutoDJTransitionProgress m_progress;
+    double m_crossfaderAtFadeBegin;
+};
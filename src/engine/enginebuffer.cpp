@@ -93,6 +93,11 @@ EngineBuffer::EngineBuffer(const QString& group,
           m_pRepeat(nullptr),
           m_startButton(nullptr),
           m_endButton(nullptr),
+          m_pScaleKeylock(nullptr),
+          m_pScaleRBFiner(nullptr),
+          m_keylockScalerTier(ScalerTier::RubberBandFaster),
+          m_scalerTierLimit(ScalerTier::RubberBandFiner),
+          m_bKeylockScalerInUse(false),
           m_bScalerOverride(false),
           m_iSeekPhaseQueued(0),
           m_iEnableSyncQueued(SYNC_REQUEST_NONE),
@@ -262,13 +267,13 @@ EngineBuffer::EngineBuffer(const QString& group,
 
     m_pKeylockEngine = new ControlProxy("[Master]", "keylock_engine", this);
     m_pKeylockEngine->connectValueChanged(this,
-            &EngineBuffer::slotKeylockEngineChanged,
-            Qt::DirectConnection);
+            &EngineBuffer::slotKeylockEngineChanged);
     // Construct scaling objects
     m_pScaleLinear = new EngineBufferScaleLinear(m_pReadAheadManager);
     m_pScaleST = new EngineBufferScaleST(m_pReadAheadManager);
     m_pScaleRB = new EngineBufferScaleRubberBand(m_pReadAheadManager);
     slotKeylockEngineChanged(m_pKeylockEngine->get());
+    updateKeylockScaler();
     m_pScaleVinyl = m_pScaleLinear;
     m_pScale = m_pScaleVinyl;
     m_pScale->clear();
@@ -319,6 +324,7 @@ EngineBuffer::~EngineBuffer() {
     delete m_pScaleLinear;
     delete m_pScaleST;
     delete m_pScaleRB;
+    delete m_pScaleRBFiner.loadAcquire();
 
     delete m_pKeylock;
 
@@ -364,6 +370,9 @@ void EngineBuffer::enableIndependentPitchTempoScaling(bool bEnable,
         m_pScale->clear();
         m_bScalerChanged = true;
     }
+    // The scalers may be the same object if keylock is demoted to the
+    // linear tier, so the selected path is tracked separately.
+    m_bKeylockScalerInUse = bEnable;
 }
 
 mixxx::Bpm EngineBuffer::getBpm() const {
@@ -795,27 +804,64 @@ void EngineBuffer::slotControlStop(double v)
 }
 
 void EngineBuffer::slotKeylockEngineChanged(double dIndex) {
+    if (scalerTierForKeylockEngine(static_cast<KeylockEngine>(static_cast<int>(dIndex))) !=
+                    ScalerTier::RubberBandFiner ||
+            m_pScaleRBFiner.loadAcquire()) {
+        return;
+    }
+    // The R3 instance is only created once it is selected, because it
+    // allocates several megabytes per deck. This happens outside of the
+    // engine thread, which picks it up in updateKeylockScaler().
+    auto* pScaleRBFiner = new EngineBufferScaleRubberBand(m_pReadAheadManager);
+    const auto sampleRate = mixxx::audio::SampleRate::fromDouble(m_pSampleRate->get());
+    if (sampleRate.isValid()) {
+        // Prevent a reallocation when the engine sets the sample rate
+        pScaleRBFiner->setSampleRate(sampleRate);
+    }
+    pScaleRBFiner->useEngineFiner(true);
+    m_pScaleRBFiner.storeRelease(pScaleRBFiner);
+}
+
+EngineBuffer::ScalerTier EngineBuffer::getConfiguredScalerTier() const {
+    return scalerTierForKeylockEngine(
+            static_cast<KeylockEngine>(static_cast<int>(m_pKeylockEngine->get())));
+}
+
+void EngineBuffer::updateKeylockScaler() {
     if (m_bScalerOverride) {
         return;
     }
-    const KeylockEngine engine = static_cast<KeylockEngine>(dIndex);
-    switch (engine) {
-    case KeylockEngine::SoundTouch:
-        m_pScaleKeylock = m_pScaleST;
-        break;
-    case KeylockEngine::RubberBandFaster:
-        m_pScaleRB->useEngineFiner(false);
-        m_pScaleKeylock = m_pScaleRB;
+    ScalerTier tier = getConfiguredScalerTier();
+    if (m_scalerTierLimit < tier) {
+        tier = m_scalerTierLimit;
+    }
+    if (tier == m_keylockScalerTier && m_pScaleKeylock) {
+        return;
+    }
+    switch (tier) {
+    case ScalerTier::Linear:
+        // Inaudible decks only: the pitch follows the tempo.
+        m_pScaleKeylock = m_pScaleLinear;
         break;
-    case KeylockEngine::RubberBandFiner:
-        m_pScaleRB->useEngineFiner(
-                true); // in case of Rubberband V2 it falls back to RUBBERBAND_FASTER
-        m_pScaleKeylock = m_pScaleRB;
+    case ScalerTier::SoundTouch:
+        m_pScaleKeylock = m_pScaleST;
         break;
+    case ScalerTier::RubberBandFiner:
+        if (EngineBufferScaleRubberBand* pScaleRBFiner = m_pScaleRBFiner.loadAcquire()) {
+            m_pScaleKeylock = pScaleRBFiner;
+            break;
+        }
+        // Not created yet, retry in the next callback
+        tier = ScalerTier::RubberBandFaster;
+        [[fallthrough]];
+    case ScalerTier::RubberBandFaster:
     default:
-        slotKeylockEngineChanged(static_cast<double>(defaultKeylockEngine()));
+        m_pScaleKeylock = m_pScaleRB;
         break;
     }
+    // If the keylock scaler is in use, enableIndependentPitchTempoScaling()
+    // crossfades to the new scaler in this callback.
+    m_keylockScalerTier = tier;
 }
 
 void EngineBuffer::processTrackLocked(
@@ -864,6 +910,8 @@ void EngineBuffer::processTrackLocked(
             &is_scratching,
             &is_reverse);
 
+    updateKeylockScaler();
+
     bool useIndependentPitchAndTempoScaling = false;
 
     // TODO(owen): Maybe change this so that rubberband doesn't disable
@@ -961,6 +1009,16 @@ void EngineBuffer::processTrackLocked(
     // If pitch ratio and tempo ratio are equal, a linear scaler is used,
     // otherwise tempo and pitch are processed individual
 
+    // Predictive sync adjusts the rate of the keylock scalers at every
+    // callback. These scalers would apply the new tempo at once, so ramp it
+    // from the previous tempo across the buffer instead.
+    const double previousSpeed = m_speed_old;
+    const bool rampTempo = m_pScale == m_pScaleKeylock &&
+            !m_bCrossfadeReady && !is_scratching &&
+            previousSpeed * speed > 0 &&
+            toSynchronized(m_pSyncControl->getSyncMode()) &&
+            m_pBpmControl->isPredictiveSyncActive();
+
     double rate = 0;
     // If the baserate, speed, or pitch has changed, we need to update the
     // scaler. Also, if we have changed scalers then we need to update the
@@ -1037,7 +1095,9 @@ void EngineBuffer::processTrackLocked(
     // If the buffer is not paused, then scale the audio.
     if (!bCurBufferPaused) {
         // Perform scaling of Reader buffer into buffer.
-        const auto framesRead = m_pScale->scaleBuffer(pOutput, iBufferSize);
+        const auto framesRead = rampTempo
+                ? m_pScale->scaleBufferWithTempoRamp(pOutput, iBufferSize, previousSpeed)
+                : m_pScale->scaleBuffer(pOutput, iBufferSize);
 
         // TODO(XXX): The result framesRead might not be an integer value.
         // Converting to samples here does not make sense. All positional
@@ -1136,6 +1196,9 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
     m_pScaleLinear->setSampleRate(m_sampleRate);
     m_pScaleST->setSampleRate(m_sampleRate);
     m_pScaleRB->setSampleRate(m_sampleRate);
+    if (EngineBufferScaleRubberBand* pScaleRBFiner = m_pScaleRBFiner.loadAcquire()) {
+        pScaleRBFiner->setSampleRate(m_sampleRate);
+    }
 
     bool bTrackLoading = m_iTrackLoading.loadAcquire() != 0;
     if (!bTrackLoading && m_pause.tryLock()) {
@@ -1524,6 +1587,7 @@ void EngineBuffer::setScalerForTest(
     m_pScale = m_pScaleVinyl;
     m_pScale->clear();
     m_bScalerChanged = true;
+    m_bKeylockScalerInUse = false;
     // This bool is permanently set and can't be undone.
     m_bScalerOverride = true;
 }
@@ -91,6 +91,16 @@ class EngineBuffer : public EngineObject {
             KeylockEngine::RubberBandFiner,
     };
 
+    /// Quality tiers of the scaler used for keylock, ordered by CPU cost.
+    /// The ScalerGovernor may temporarily limit a deck to a cheaper tier
+    /// than the one selected by the keylock engine preference.
+    enum class ScalerTier {
+        Linear = 0,
+        SoundTouch = 1,
+        RubberBandFaster = 2,
+        RubberBandFiner = 3,
+    };
+
     EngineBuffer(const QString& group, UserSettingsPointer pConfig,
                  EngineChannel* pChannel, EngineMaster* pMixingEngine);
     virtual ~EngineBuffer();
@@ -145,6 +155,26 @@ class EngineBuffer : public EngineObject {
 
     void collectFeatures(GroupFeatureState* pGroupFeatures) const;
 
+    /// Returns the scaler tier selected by the keylock engine preference.
+    ScalerTier getConfiguredScalerTier() const;
+    /// Returns the scaler tier that is used for keylock (engine thread only)
+    ScalerTier getKeylockScalerTier() const {
+        return m_keylockScalerTier;
+    }
+    /// Limits the keylock scaler to the given tier. The switch happens
+    /// with a crossfade in the next callback (engine thread only).
+    void setScalerTierLimit(ScalerTier limit) {
+        m_scalerTierLimit = limit;
+    }
+    ScalerTier getScalerTierLimit() const {
+        return m_scalerTierLimit;
+    }
+    /// Returns true if the keylock scaler is processing audio
+    /// (engine thread only)
+    bool isKeylockScalerActive() const {
+        return m_speed_old != 0.0 && m_bKeylockScalerInUse;
+    }
+
     // For dependency injection of scalers.
     void setScalerForTest(
             EngineBufferScale* pScaleVinyl,
@@ -186,6 +216,21 @@ class EngineBuffer : public EngineObject {
         return KeylockEngine::RubberBandFaster;
     }
 
+    static ScalerTier scalerTierForKeylockEngine(KeylockEngine engine) {
+        switch (engine) {
+        case KeylockEngine::SoundTouch:
+            return ScalerTier::SoundTouch;
+        case KeylockEngine::RubberBandFiner:
+            if (EngineBufferScaleRubberBand::isEngineFinerAvailable()) {
+                return ScalerTier::RubberBandFiner;
+            }
+            [[fallthrough]];
+        case KeylockEngine::RubberBandFaster:
+        default:
+            return ScalerTier::RubberBandFaster;
+        }
+    }
+
     // Request that the EngineBuffer load a track. Since the process is
     // asynchronous, EngineBuffer will emit a trackLoaded signal when the load
     // has completed.
@@ -234,6 +279,8 @@ class EngineBuffer : public EngineObject {
 
     void enableIndependentPitchTempoScaling(bool bEnable,
                                             const int iBufferSize);
+    // Selects m_pScaleKeylock from the preference and the tier limit.
+    void updateKeylockScaler();
 
     void updateIndicators(double rate, int iBufferSize);
 
@@ -400,15 +447,25 @@ class EngineBuffer : public EngineObject {
     FRIEND_TEST(EngineBufferTest, RateTempTest);
     FRIEND_TEST(EngineBufferTest, RatePermTest);
     EngineBufferScale* m_pScaleVinyl;
-    // The keylock engine is configurable, so it could flip flop between
-    // ScaleST and ScaleRB during a single callback.
-    EngineBufferScale* volatile m_pScaleKeylock;
+    // The keylock scaler is selected at the start of each callback from
+    // the keylock engine preference and the tier limit.
+    EngineBufferScale* m_pScaleKeylock;
 
     // Object used for vinyl-style interpolation scaling of the audio
     EngineBufferScaleLinear* m_pScaleLinear;
     // Objects used for pitch-indep time stretch (key lock) scaling of the audio
     EngineBufferScaleST* m_pScaleST;
     EngineBufferScaleRubberBand* m_pScaleRB;
+    // A separate instance for the R3 engine, because switching the engine
+    // of a RubberBand instance reallocates. Created outside of the engine
+    // thread when R3 is first selected, nullptr until then.
+    QAtomicPointer<EngineBufferScaleRubberBand> m_pScaleRBFiner;
+
+    ScalerTier m_keylockScalerTier;
+    ScalerTier m_scalerTierLimit;
+    // Whether m_pScale has been selected as the keylock scaler. Compared
+    // pointers are ambiguous when keylock uses the linear tier.
+    bool m_bKeylockScalerInUse;
 
     // Indicates whether the scaler has changed since the last process()
     bool m_bScalerChanged;
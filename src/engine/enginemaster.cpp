@@ -8,10 +8,12 @@
 #include "control/controlpotmeter.h"
 #include "control/controlpushbutton.h"
 #include "effects/effectsmanager.h"
+#include "engine/bufferscalers/scalergovernor.h"
 #include "engine/channelmixer.h"
 #include "engine/channels/enginechannel.h"
 #include "engine/channels/enginedeck.h"
 #include "engine/effects/engineeffectsmanager.h"
+#include "engine/engineautodjtransition.h"
 #include "engine/enginebuffer.h"
 #include "engine/enginedelay.h"
 #include "engine/enginetalkoverducking.h"
@@ -24,6 +26,9 @@
 #include "moc_enginemaster.cpp"
 #include "preferences/usersettings.h"
 #include "util/defs.h"
+#include "util/math.h"
+#include "util/performancetimer.h"
+#include "util/rtsafety.h"
 #include "util/sample.h"
 #include "util/timer.h"
 #include "util/trace.h"
@@ -176,6 +181,16 @@ EngineMaster::EngineMaster(
     m_pKeylockEngine->set(pConfig->getValue(ConfigKey(group, "keylock_engine"),
             static_cast<double>(EngineBuffer::defaultKeylockEngine())));
 
+    // Adaptively limits the keylock scaler quality of individual decks when
+    // the audio callback runs out of headroom.
+    m_pKeylockGovernor = new ControlPushButton(
+            ConfigKey(group, "keylock_governor"), true, 1.0);
+    m_pKeylockGovernor->setButtonMode(ControlPushButton::TOGGLE);
+    m_pScalerGovernor = std::make_unique<ScalerGovernor>();
+
+    // Executes the crossfades planned by AutoDJ inside the callback
+    m_pAutoDJTransition = std::make_unique<EngineAutoDJTransition>();
+
     // TODO: Make this read only and make EngineMaster decide whether
     // processing the master mix is necessary.
     m_pMasterEnabled = new ControlObject(ConfigKey(group, "enabled"),
@@ -195,6 +210,7 @@ EngineMaster::EngineMaster(
 EngineMaster::~EngineMaster() {
     //qDebug() << "in ~EngineMaster()";
     delete m_pKeylockEngine;
+    delete m_pKeylockGovernor;
     delete m_pCrossfader;
     delete m_pBalance;
     delete m_pHeadMix;
@@ -389,7 +405,12 @@ void EngineMaster::process(const int iBufferSize) {
         QThread::currentThread()->setObjectName("Engine");
         haveSetName = true;
     }
+    // Everything below runs on the realtime path and must not allocate
+    // or block. This is verified by the RT-safety mode of the tests.
+    mixxx::rtsafety::ScopedRealtimeContext realtimeContext;
     //Trace t("EngineMaster::process");
+    PerformanceTimer callbackTimer;
+    callbackTimer.start();
 
     bool masterEnabled = m_pMasterEnabled->toBool();
     bool boothEnabled = m_pBoothEnabled->toBool();
@@ -500,6 +521,14 @@ void EngineMaster::process(const int iBufferSize) {
         break;
     }
 
+    // Move the crossfader according to the AutoDJ transition. The new gains
+    // are ramped across this buffer.
+    double crossfader = m_pCrossfader->get();
+    if (m_pAutoDJTransition->process(
+                iFrames, m_pXFaderReverse->toBool(), &crossfader)) {
+        m_pCrossfader->set(crossfader);
+    }
+
     // Calculate the crossfader gains for left and right side of the crossfader
     CSAMPLE_GAIN crossfaderLeftGain, crossfaderRightGain;
     EngineXfader::getXfadeGains(m_pCrossfader->get(), m_pXFaderCurve->get(),
@@ -765,11 +794,53 @@ void EngineMaster::process(const int iBufferSize) {
         m_pBoothDelay->process(m_pBooth, m_iBufferSize);
     }
 
+    processScalerGovernor(callbackTimer.elapsed().toDoubleSeconds());
+
     // We're close to the end of the callback. Wake up the engine worker
     // scheduler so that it runs the workers.
     m_pWorkerScheduler->runWorkers();
 }
 
+QSharedPointer<AutoDJTransitionSchedule> EngineMaster::getAutoDJTransitionSchedule() const {
+    return m_pAutoDJTransition->schedule();
+}
+
+void EngineMaster::processScalerGovernor(double callbackSeconds) {
+    if (!m_sampleRate.isValid() || m_iBufferSize == 0) {
+        return;
+    }
+    // TODO: remove assumption of stereo buffer
+    const double periodSeconds = m_iBufferSize / 2 / m_sampleRate.toDouble();
+
+    // The deck states live on the stack to avoid allocations
+    ScalerGovernor::Deck decks[kPreallocatedChannels];
+    EngineBuffer* buffers[kPreallocatedChannels];
+    int numDecks = 0;
+    for (int i = 0; i < m_channels.size() && numDecks < kPreallocatedChannels; ++i) {
+        EngineChannel* pChannel = m_channels[i]->m_pChannel;
+        EngineBuffer* pBuffer = pChannel ? pChannel->getEngineBuffer() : nullptr;
+        if (!pBuffer) {
+            continue;
+        }
+        buffers[numDecks] = pBuffer;
+        decks[numDecks] = ScalerGovernor::Deck{
+                pBuffer->getConfiguredScalerTier(),
+                pBuffer->getScalerTierLimit(),
+                pBuffer->isKeylockScalerActive(),
+                math_max(m_channelMasterGainCache[i].m_gain,
+                        m_channelHeadphoneGainCache[i].m_gain)};
+        ++numDecks;
+    }
+
+    m_pScalerGovernor->setEnabled(m_pKeylockGovernor->toBool());
+    if (m_pScalerGovernor->process(
+                callbackSeconds / periodSeconds, periodSeconds, decks, numDecks)) {
+        for (int i = 0; i < numDecks; ++i) {
+            buffers[i]->setScalerTierLimit(decks[i].tierLimit);
+        }
+    }
+}
+
 void EngineMaster::applyMasterEffects() {
     // Apply master effects
     if (m_pEngineEffectsManager) {
@@ -844,6 +915,9 @@ void EngineMaster::addChannel(EngineChannel* pChannel) {
     EngineBuffer* pBuffer = pChannelInfo->m_pChannel->getEngineBuffer();
     if (pBuffer != nullptr) {
         pBuffer->bindWorkers(m_pWorkerScheduler);
+        if (group == PlayerManager::groupForDeck(m_pAutoDJTransition->numDecks())) {
+            m_pAutoDJTransition->addDeck(pBuffer);
+        }
     }
 }
 
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <QObject>
+#include <QSharedPointer>
 #include <QVarLengthArray>
+#include <memory>
 
 #include "audio/types.h"
 #include "control/controlobject.h"
@@ -30,6 +32,9 @@ class GuiTick;
 class EngineSync;
 class EngineTalkoverDucking;
 class EngineDelay;
+class ScalerGovernor;
+class EngineAutoDJTransition;
+class AutoDJTransitionSchedule;
 
 // The number of channels to pre-allocate in various structures in the
 // engine. Prevents memory allocation in EngineMaster::addChannel.
@@ -106,6 +111,10 @@ class EngineMaster : public QObject, public AudioSource {
         return m_pEngineSideChain;
     }
 
+    /// The schedule of the AutoDJ transitions that are executed inside
+    /// the audio callback.
+    QSharedPointer<AutoDJTransitionSchedule> getAutoDJTransitionSchedule() const;
+
     CSAMPLE_GAIN getMasterGain(int channelIndex) const;
 
     struct ChannelInfo {
@@ -264,6 +273,7 @@ class EngineMaster : public QObject, public AudioSource {
 
     ChannelHandleFactoryPointer m_pChannelHandleFactory;
     void applyMasterEffects();
+    void processScalerGovernor(double callbackSeconds);
     void processHeadphones(const CSAMPLE_GAIN masterMixGainInHeadphones);
     bool sidechainMixRequired() const;
 
@@ -326,6 +336,9 @@ class EngineMaster : public QObject, public AudioSource {
     ControlPushButton* m_pXFaderReverse;
     ControlPushButton* m_pHeadSplitEnabled;
     ControlObject* m_pKeylockEngine;
+    ControlPushButton* m_pKeylockGovernor;
+    std::unique_ptr<ScalerGovernor> m_pScalerGovernor;
+    std::unique_ptr<EngineAutoDJTransition> m_pAutoDJTransition;
 
     PflGainCalculator m_headphoneGain;
     TalkoverGainCalculator m_talkoverGain;
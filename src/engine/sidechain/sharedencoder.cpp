@@ -0,0 +1,188 @@
+#include "engine/sidechain/sharedencoder.h"
+
+#include <QHash>
+
+#include "util/assert.h"
+#include "util/compatibility/qmutex.h"
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("SharedEncoder");
+
+QString encoderKey(const EncoderSettingsPointer& pSettings,
+        mixxx::audio::SampleRate sampleRate) {
+    return QStringLiteral("%1/%2/%3/%4")
+            .arg(pSettings->getFormat(),
+                    QString::number(pSettings->getQuality()),
+                    QString::number(static_cast<int>(pSettings->getChannelMode())),
+                    QString::number(sampleRate.value()));
+}
+
+} // anonymous namespace
+
+SharedEncoder::PacketQueue::PacketQueue(int maxBytes)
+        : m_maxBytes(maxBytes),
+          m_bytesQueued(0),
+          m_overflow(false) {
+}
+
+void SharedEncoder::PacketQueue::push(const unsigned char* header,
+        const unsigned char* body,
+        int headerLen,
+        int bodyLen) {
+    const auto locker = lockMutex(&m_mutex);
+    if (m_bytesQueued > m_maxBytes) {
+        m_overflow = true;
+        return;
+    }
+    QByteArray packet;
+    packet.reserve(headerLen + bodyLen);
+    if (headerLen > 0) {
+        packet.append(reinterpret_cast<const char*>(header), headerLen);
+    }
+    packet.append(reinterpret_cast<const char*>(body), bodyLen);
+    m_bytesQueued += packet.size();
+    m_packets.append(std::move(packet));
+}
+
+bool SharedEncoder::PacketQueue::takeAll(QList<QByteArray>* pPackets) {
+    const auto locker = lockMutex(&m_mutex);
+    pPackets->swap(m_packets);
+    m_packets.clear();
+    m_bytesQueued = 0;
+    const bool overflow = m_overflow;
+    m_overflow = false;
+    return !overflow;
+}
+
+void SharedEncoder::PacketQueue::clear() {
+    const auto locker = lockMutex(&m_mutex);
+    m_packets.clear();
+    m_bytesQueued = 0;
+    m_overflow = false;
+}
+
+int SharedEncoder::PacketQueue::bytesQueued() const {
+    const auto locker = lockMutex(&m_mutex);
+    return m_bytesQueued;
+}
+
+// static
+std::shared_ptr<SharedEncoder> SharedEncoder::acquire(
+        const EncoderSettingsPointer& pSettings,
+        mixxx::audio::SampleRate sampleRate,
+        QString* pUserErrorMessage) {
+    static QMutex s_registryMutex;
+    static QHash<QString, std::weak_ptr<SharedEncoder>> s_registry;
+
+    const QString key = encoderKey(pSettings, sampleRate);
+    const auto locker = lockMutex(&s_registryMutex);
+    auto it = s_registry.begin();
+    while (it != s_registry.end()) {
+        if (it.value().expired()) {
+            it = s_registry.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    std::shared_ptr<SharedEncoder> pSharedEncoder = s_registry.value(key).lock();
+    if (pSharedEncoder) {
+        kLogger.debug() << "Sharing encoder" << key;
+        return pSharedEncoder;
+    }
+
+    pSharedEncoder = std::make_shared<SharedEncoder>();
+    EncoderPointer pEncoder = EncoderFactory::getFactory().createEncoder(
+            pSettings, pSharedEncoder.get());
+    if (!pEncoder || pEncoder->initEncoder(sampleRate, pUserErrorMessage) < 0) {
+        return nullptr;
+    }
+    pSharedEncoder->setEncoder(std::move(pEncoder));
+    s_registry.insert(key, pSharedEncoder);
+    kLogger.debug() << "Created encoder" << key;
+    return pSharedEncoder;
+}
+
+SharedEncoder::SharedEncoder(mixxx::Duration feederTimeout)
+        : m_feederTimeout(feederTimeout),
+          m_pFeeder(nullptr) {
+}
+
+SharedEncoder::~SharedEncoder() {
+    // Deleting the encoder may flush it, which calls write()
+    DEBUG_ASSERT(m_sinks.isEmpty());
+    m_sinks.clear();
+    m_pEncoder.reset();
+}
+
+void SharedEncoder::setEncoder(EncoderPointer pEncoder) {
+    const auto locker = lockMutex(&m_mutex);
+    m_pEncoder = std::move(pEncoder);
+}
+
+void SharedEncoder::addSink(PacketQueue* pSink) {
+    const auto locker = lockMutex(&m_mutex);
+    VERIFY_OR_DEBUG_ASSERT(!m_sinks.contains(pSink)) {
+        return;
+    }
+    m_sinks.append(pSink);
+    if (!m_pFeeder) {
+        m_pFeeder = pSink;
+        m_feederTimer.start();
+    }
+}
+
+void SharedEncoder::removeSink(PacketQueue* pSink) {
+    const auto locker = lockMutex(&m_mutex);
+    if (!m_sinks.removeOne(pSink)) {
+        return;
+    }
+    if (m_pFeeder == pSink) {
+        // The connection that has been added next continues the stream
+        m_pFeeder = m_sinks.isEmpty() ? nullptr : m_sinks.first();
+        m_feederTimer.start();
+    }
+}
+
+int SharedEncoder::numSinks() const {
+    const auto locker = lockMutex(&m_mutex);
+    return m_sinks.size();
+}
+
+void SharedEncoder::encodeBuffer(const PacketQueue* pSink,
+        const CSAMPLE* pBuffer,
+        int size) {
+    const auto locker = lockMutex(&m_mutex);
+    if (!m_pEncoder) {
+        return;
+    }
+    if (pSink != m_pFeeder) {
+        if (!m_sinks.contains(const_cast<PacketQueue*>(pSink))) {
+            return;
+        }
+        if (m_feederTimer.elapsed() < m_feederTimeout) {
+            // The feeder has already passed this part of the mix
+            return;
+        }
+        // The feeder is stalled. Taking over may repeat or skip a few
+        // samples once, but the other connections keep streaming.
+        kLogger.info() << "Feeder stalled for"
+                       << m_feederTimer.elapsed().formatMillisWithUnit()
+                       << "- switching to another connection";
+        m_pFeeder = pSink;
+    }
+    m_feederTimer.start();
+    // The encoded packets are received by the write() callback
+    m_pEncoder->encodeBuffer(pBuffer, size);
+}
+
+void SharedEncoder::write(const unsigned char* header,
+        const unsigned char* body,
+        int headerLen,
+        int bodyLen) {
+    for (auto* pSink : std::as_const(m_sinks)) {
+        pSink->push(header, body, headerLen, bodyLen);
+    }
+}
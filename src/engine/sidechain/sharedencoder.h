@@ -0,0 +1,112 @@
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <memory>
+
+#include "audio/types.h"
+#include "encoder/encoder.h"
+#include "encoder/encodercallback.h"
+#include "encoder/encodersettings.h"
+#include "util/duration.h"
+#include "util/performancetimer.h"
+#include "util/types.h"
+
+/// Encodes the broadcast mix once for all connections that use identical
+/// encoder settings and fans the encoded packets out to each of them.
+///
+/// Only formats that a listener can join at any frame are suitable for
+/// sharing, i.e. MP3 and AAC. Ogg based streams start with stream headers
+/// that every connection has to send itself.
+///
+/// The FIFOs of the connections are not fed with identical sample streams:
+/// each one drops samples on overflow, compensates drift by duplicating or
+/// skipping single frames and starts at the moment its connection has been
+/// established. Therefore only one connection, the feeder, passes its mix
+/// to the encoder and all others discard theirs. The feeder is the
+/// connection that has been added first. If it stops passing samples for
+/// longer than the feeder timeout, e.g. because it is blocked by a slow
+/// server, the next connection that passes samples takes over. Every
+/// connection drains its own PacketQueue from its own thread, so a slow
+/// server only delays the connection talking to it.
+class SharedEncoder : public EncoderCallback {
+  public:
+    /// The encoded packets waiting to be sent by a single connection.
+    class PacketQueue {
+      public:
+        explicit PacketQueue(int maxBytes);
+
+        /// Called by the thread that drives the encoder. The packet is
+        /// dropped if the queue already holds more than maxBytes.
+        void push(const unsigned char* header,
+                const unsigned char* body,
+                int headerLen,
+                int bodyLen);
+        /// Moves all queued packets to pPackets. Returns false if packets
+        /// have been dropped since the last call.
+        bool takeAll(QList<QByteArray>* pPackets);
+        void clear();
+
+        int bytesQueued() const;
+
+      private:
+        mutable QMutex m_mutex;
+        QList<QByteArray> m_packets;
+        const int m_maxBytes;
+        int m_bytesQueued;
+        bool m_overflow;
+    };
+
+    /// Returns the encoder that is shared by all callers with the same
+    /// settings and sample rate. A new encoder is created and initialized
+    /// if there is none yet. Returns nullptr if initialization failed.
+    static std::shared_ptr<SharedEncoder> acquire(
+            const EncoderSettingsPointer& pSettings,
+            mixxx::audio::SampleRate sampleRate,
+            QString* pUserErrorMessage);
+
+    explicit SharedEncoder(
+            mixxx::Duration feederTimeout = mixxx::Duration::fromMillis(500));
+    ~SharedEncoder() override;
+
+    void setEncoder(EncoderPointer pEncoder);
+
+    void addSink(PacketQueue* pSink);
+    void removeSink(PacketQueue* pSink);
+    int numSinks() const;
+
+    /// Encodes the buffer if pSink is the feeder, or if the feeder has not
+    /// passed any samples within the feeder timeout. Then pSink becomes
+    /// the new feeder. Otherwise the buffer is discarded, because the
+    /// feeder has already passed the same part of the mix.
+    void encodeBuffer(const PacketQueue* pSink, const CSAMPLE* pBuffer, int size);
+
+    // Called by the encoder with m_mutex held
+    void write(const unsigned char* header,
+            const unsigned char* body,
+            int headerLen,
+            int bodyLen) override;
+    // These are not used for streaming, but the interface requires them
+    int tell() override {
+        return -1;
+    }
+    void seek(int pos) override {
+        Q_UNUSED(pos);
+    }
+    int filelen() override {
+        return 0;
+    }
+
+  private:
+    const mixxx::Duration m_feederTimeout;
+
+    mutable QMutex m_mutex;
+    EncoderPointer m_pEncoder;
+    QList<PacketQueue*> m_sinks;
+    // The sink whose mix is encoded, nullptr if there are no sinks
+    const PacketQueue* m_pFeeder;
+    // Restarted whenever the feeder passes samples
+    PerformanceTimer m_feederTimer;
+};
@@ -30,6 +30,7 @@
 #include "track/track.h"
 #include "util/compatibility/qatomic.h"
 #include "util/logger.h"
+#include "util/stat.h"
 
 namespace {
 
@@ -58,6 +59,7 @@ ShoutConnection::ShoutConnection(BroadcastProfilePtr profile,
           m_pConfig(pConfig),
           m_pProfile(profile),
           m_encoder(nullptr),
+          m_packetQueue(kMaxNetworkCache),
           m_masterSamplerate("[Master]", "samplerate"),
           m_broadcastEnabled(BROADCAST_PREF_KEY, "enabled"),
           m_custom_metadata(false),
@@ -127,6 +129,10 @@ ShoutConnection::~ShoutConnection() {
        qWarning() << "ShoutOutput::~ShoutOutput(): Thread didn't die.\
        Ignored but file a bug report if problems rise!";
     }
+
+    if (m_pSharedEncoder) {
+        m_pSharedEncoder->removeSink(&m_packetQueue);
+    }
 }
 
 bool ShoutConnection::isConnected() {
@@ -188,9 +194,7 @@ void ShoutConnection::updateFromPreferences() {
     setState(NETWORKSTREAMWORKER_STATE_BUSY);
 
     // Delete m_encoder if it has been initialized (with maybe) different bitrate.
-    // delete m_encoder calls write() check if it will be exit early
-    DEBUG_ASSERT(m_iShoutStatus != SHOUTERR_CONNECTED);
-    m_encoder.reset();
+    resetEncoder();
 
     m_format_is_mp3 = false;
     m_format_is_ov = false;
@@ -457,20 +461,27 @@ void ShoutConnection::updateFromPreferences() {
     // Initialize m_encoder
     EncoderSettingsPointer pBroadcastSettings =
             std::make_shared<EncoderBroadcastSettings>(m_pProfile);
-    m_encoder = EncoderFactory::getFactory().createEncoder(
-                    pBroadcastSettings, this);
-
     QString userErrorMsg;
     int ret = -1;
-    if (m_encoder) {
-        ret = m_encoder->initEncoder(masterSamplerate, &userErrorMsg);
+    if (m_format_is_mp3 || m_format_is_aac) {
+        // Listeners can join these streams at any frame, so all connections
+        // with the same settings share a single encoder.
+        m_pSharedEncoder = SharedEncoder::acquire(
+                pBroadcastSettings, masterSamplerate, &userErrorMsg);
+        if (m_pSharedEncoder) {
+            ret = 0;
+        }
+    } else {
+        m_encoder = EncoderFactory::getFactory().createEncoder(
+                pBroadcastSettings, this);
+        if (m_encoder) {
+            ret = m_encoder->initEncoder(masterSamplerate, &userErrorMsg);
+        }
     }
 
     // TODO(XXX): Use mixxx::audio::SampleRate instead of int in initEncoder
     if (ret < 0) {
-        // delete m_encoder calls write() make sure it will be exit early
-        DEBUG_ASSERT(m_iShoutStatus != SHOUTERR_CONNECTED);
-        m_encoder.reset();
+        resetEncoder();
 
         setState(NETWORKSTREAMWORKER_STATE_ERROR);
 
@@ -503,7 +514,7 @@ bool ShoutConnection::processConnect() {
     // Make sure that we call updateFromPreferences always
     updateFromPreferences();
 
-    if (!m_encoder) {
+    if (!m_encoder && !m_pSharedEncoder) {
         // updateFromPreferences failed
         setStatus(BroadcastProfile::STATUS_FAILURE);
         kLogger.warning() << "ShoutOutput::processConnect() returning false";
@@ -599,6 +610,10 @@ bool ShoutConnection::processConnect() {
             if(m_pOutputFifo->readAvailable()) {
             	m_pOutputFifo->flushReadData(m_pOutputFifo->readAvailable());
             }
+            if (m_pSharedEncoder) {
+                m_packetQueue.clear();
+                m_pSharedEncoder->addSink(&m_packetQueue);
+            }
             m_threadWaiting = true;
 
             setStatus(BroadcastProfile::STATUS_CONNECTED);
@@ -621,9 +636,7 @@ bool ShoutConnection::processConnect() {
 
     // no connection, clean up
     shout_close(m_pShout);
-    // delete m_encoder calls write() check if it will be exit early
-    DEBUG_ASSERT(m_iShoutStatus != SHOUTERR_CONNECTED);
-    m_encoder.reset();
+    resetEncoder();
     if (m_pProfile->getEnabled()) {
         setStatus(BroadcastProfile::STATUS_FAILURE);
     } else {
@@ -646,10 +659,19 @@ bool ShoutConnection::processDisconnect() {
         emit broadcastDisconnected();
         disconnected = true;
     }
+    resetEncoder();
+    return disconnected;
+}
+
+void ShoutConnection::resetEncoder() {
     // delete m_encoder calls write() check if it will be exit early
     DEBUG_ASSERT(m_iShoutStatus != SHOUTERR_CONNECTED);
+    if (m_pSharedEncoder) {
+        m_pSharedEncoder->removeSink(&m_packetQueue);
+        m_pSharedEncoder.reset();
+    }
+    m_packetQueue.clear();
     m_encoder.reset();
-    return disconnected;
 }
 
 void ShoutConnection::write(const unsigned char* header, const unsigned char* body,
@@ -723,6 +745,27 @@ bool ShoutConnection::writeSingle(const unsigned char* data, size_t len) {
     return true;
 }
 
+void ShoutConnection::sendQueuedPackets() {
+    Stat::track(m_packetQueueStatTag,
+            Stat::UNSPECIFIED,
+            Stat::experimentFlags(Stat::COUNT | Stat::AVERAGE | Stat::MAX),
+            m_packetQueue.bytesQueued());
+
+    QList<QByteArray> packets;
+    if (!m_packetQueue.takeAll(&packets)) {
+        // The server does not keep up with the shared encoder
+        m_lastErrorStr = tr("Network cache overflow");
+        tryReconnect();
+        return;
+    }
+    for (const auto& packet : std::as_const(packets)) {
+        write(nullptr,
+                reinterpret_cast<const unsigned char*>(packet.constData()),
+                0,
+                packet.size());
+    }
+}
+
 void ShoutConnection::process(const CSAMPLE* pBuffer, const int iBufferSize) {
     setFunctionCode(4);
     if (!m_pProfile->getEnabled()) {
@@ -740,9 +783,16 @@ void ShoutConnection::process(const CSAMPLE* pBuffer, const int iBufferSize) {
     // to prevent race conditions when resetting the member
     // pointer while disconnecting in the worker thread!
     const EncoderPointer pEncoder = m_encoder;
+    const std::shared_ptr<SharedEncoder> pSharedEncoder = m_pSharedEncoder;
 
     // If we are connected, encode the samples.
-    if (iBufferSize > 0 && pEncoder) {
+    if (iBufferSize > 0 && pSharedEncoder) {
+        setFunctionCode(6);
+        // The mix is only encoded by the feeder connection, but every
+        // connection sends the packets from its own thread.
+        pSharedEncoder->encodeBuffer(&m_packetQueue, pBuffer, iBufferSize);
+        sendQueuedPackets();
+    } else if (iBufferSize > 0 && pEncoder) {
         setFunctionCode(6);
         pEncoder->encodeBuffer(pBuffer, iBufferSize);
         // the encoded frames are received by the write() callback.
@@ -993,6 +1043,8 @@ bool ShoutConnection::threadWaiting() {
 void ShoutConnection::run() {
     QThread::currentThread()->setObjectName(
             QString("ShoutOutput '%1'").arg(m_pProfile->getProfileName()));
+    m_packetQueueStatTag = QStringLiteral("ShoutOutput '%1' packet queue bytes")
+                                   .arg(m_pProfile->getProfileName());
     kLogger.debug() << "run: Starting thread";
 
 #ifndef __WINDOWS__
@@ -1038,22 +1090,15 @@ void ShoutConnection::run() {
         int readAvailable = m_pOutputFifo->readAvailable();
         if (readAvailable) {
             setFunctionCode(3);
-            CSAMPLE* dataPtr1;
-            ring_buffer_size_t size1;
-            CSAMPLE* dataPtr2;
-            ring_buffer_size_t size2;
-
-            // We use size1 and size2, so we can ignore the return value
-            (void)m_pOutputFifo->aquireReadRegions(readAvailable, &dataPtr1, &size1,
-                    &dataPtr2, &size2);
+            const auto regions = m_pOutputFifo->reserveRead(readAvailable);
 
             // Push frames to the encoder.
-            process(dataPtr1, size1);
-            if (size2 > 0) {
-                process(dataPtr2, size2);
+            process(regions.first.data(), static_cast<int>(regions.first.size()));
+            if (!regions.second.empty()) {
+                process(regions.second.data(), static_cast<int>(regions.second.size()));
             }
 
-            m_pOutputFifo->releaseReadRegions(readAvailable);
+            m_pOutputFifo->commitRead(regions.size());
         }
     }
 
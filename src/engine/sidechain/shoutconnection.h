@@ -16,6 +16,7 @@
 #include "control/pollingcontrolproxy.h"
 #include "encoder/encoder.h"
 #include "encoder/encodercallback.h"
+#include "engine/sidechain/sharedencoder.h"
 #include "errordialoghandler.h"
 #include "preferences/broadcastprofile.h"
 #include "preferences/usersettings.h"
@@ -107,6 +108,12 @@ class ShoutConnection
 #endif
 
     bool writeSingle(const unsigned char *data, size_t len);
+    // Sends the packets of the shared encoder that are queued for this
+    // connection.
+    void sendQueuedPackets();
+    // Deleting the encoder calls write(), so make sure the connection is
+    // down before.
+    void resetEncoder();
 
     QByteArray encodeString(const QString& string);
 
@@ -125,6 +132,11 @@ class ShoutConnection
     UserSettingsPointer m_pConfig;
     BroadcastProfilePtr m_pProfile;
     EncoderPointer m_encoder;
+    // Used instead of m_encoder if the stream can be shared with other
+    // connections that use the same encoder settings.
+    std::shared_ptr<SharedEncoder> m_pSharedEncoder;
+    SharedEncoder::PacketQueue m_packetQueue;
+    QString m_packetQueueStatTag;
     PollingControlProxy m_masterSamplerate;
     PollingControlProxy m_broadcastEnabled;
     // static metadata according to prefereneces
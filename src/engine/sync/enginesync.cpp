@@ -3,6 +3,7 @@
 #include <QMetaType>
 #include <QStringList>
 
+#include "control/controlpushbutton.h"
 #include "engine/channels/enginechannel.h"
 #include "engine/enginebuffer.h"
 #include "engine/sync/internalclock.h"
@@ -21,6 +22,10 @@ EngineSync::EngineSync(UserSettingsPointer pConfig)
           m_pLeaderSyncable(nullptr) {
     qRegisterMetaType<SyncMode>("SyncMode");
     m_pInternalClock->updateLeaderBpm(kDefaultBpm);
+
+    m_pPredictiveSync.reset(new ControlPushButton(
+            ConfigKey(kInternalClockGroup, "sync_predictive"), true));
+    m_pPredictiveSync->setButtonMode(ControlPushButton::TOGGLE);
 }
 
 EngineSync::~EngineSync() {
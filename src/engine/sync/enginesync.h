@@ -2,12 +2,15 @@
 
 #include <gtest/gtest_prod.h>
 
+#include <QScopedPointer>
+
 #include "audio/types.h"
 #include "engine/sync/syncable.h"
 #include "preferences/usersettings.h"
 
 class InternalClock;
 class EngineChannel;
+class ControlPushButton;
 
 /// EngineSync is the heart of the Mixxx Sync Lock engine.  It knows which objects
 /// (Decks, Internal Clock, etc) are participating in Sync and what their statuses
@@ -166,4 +169,7 @@ class EngineSync : public SyncableListener {
     Syncable* m_pLeaderSyncable;
     /// The list of all Syncables registered via addSyncableDeck.
     QList<Syncable*> m_syncables;
+    /// Toggles the predictive phase correction of followers, see
+    /// BpmControl::calcSyncAdjustment.
+    QScopedPointer<ControlPushButton> m_pPredictiveSync;
 };
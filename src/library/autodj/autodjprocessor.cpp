@@ -3,6 +3,7 @@
 #include "control/controlproxy.h"
 #include "control/controlpushbutton.h"
 #include "engine/engine.h"
+#include "library/autodj/autodjtransitionplanner.h"
 #include "library/trackcollection.h"
 #include "mixer/basetrackplayer.h"
 #include "mixer/playermanager.h"
@@ -117,13 +118,18 @@ AutoDJProcessor::AutoDJProcessor(
         : QObject(pParent),
           m_pConfig(pConfig),
           m_pAutoDJTableModel(nullptr),
+          m_pTransitionPlanner(nullptr),
           m_eState(ADJ_DISABLED),
           m_transitionProgress(0.0),
-          m_transitionTime(kTransitionPreferenceDefault) {
+          m_transitionTime(kTransitionPreferenceDefault),
+          m_pTransitionSchedule(pPlayerManager->getAutoDJTransitionSchedule()),
+          m_scheduledTransitionId(0) {
     m_pAutoDJTableModel = new StemsMixTableModel(this, pTrackCollectionManager,
                                                  "mixxx.db.model.autodj");
     m_pAutoDJTableModel->setTableModel(iAutoDJStemsMixId);
     m_pAutoDJTableModel->select();
+    m_pTransitionPlanner = new AutoDJTransitionPlanner(
+            this, pTrackCollectionManager, m_pAutoDJTableModel);
 
     m_pSkipNext = new ControlPushButton(
             ConfigKey("[AutoDJ]", "skip_next"));
@@ -178,6 +184,7 @@ AutoDJProcessor::AutoDJProcessor(
 }
 
 AutoDJProcessor::~AutoDJProcessor() {
+    cancelScheduledTransition();
     qDeleteAll(m_decks);
     m_decks.clear();
     delete m_pCOCrossfader;
@@ -188,6 +195,7 @@ AutoDJProcessor::~AutoDJProcessor() {
     delete m_pEnabledAutoDJ;
     delete m_pFadeNow;
 
+    delete m_pTransitionPlanner;
     delete m_pAutoDJTableModel;
 }
 
@@ -319,6 +327,8 @@ void AutoDJProcessor::fadeNow() {
     VERIFY_OR_DEBUG_ASSERT(pFromDeck->fadeBeginPos <= 1) {
         pFromDeck->fadeBeginPos = 1;
     }
+
+    scheduleTransition(pFromDeck, pToDeck);
 }
 
 AutoDJProcessor::AutoDJError AutoDJProcessor::skipNext() {
@@ -552,6 +562,7 @@ AutoDJProcessor::AutoDJError AutoDJProcessor::toggleAutoDJ(bool enable) {
         m_pEnabledAutoDJ->set(0.0);
         qDebug() << "Auto DJ disabled";
         m_eState = ADJ_DISABLED;
+        cancelScheduledTransition();
         disconnect(m_pCOCrossfader,
                 &ControlProxy::valueChanged,
                 this,
@@ -587,6 +598,14 @@ void AutoDJProcessor::controlAddRandomTrack(double value) {
 }
 
 void AutoDJProcessor::crossfaderChanged(double value) {
+    if (m_eState == ADJ_IDLE && isTransitionExecutedByEngine()) {
+        // The engine has started the transition before we noticed that the
+        // from deck passed the fade begin position, e.g. for a jump cut or
+        // if the main thread is busy. This is not a manual crossfade, the
+        // engine already starts and stops the decks.
+        followEngineTransition();
+        return;
+    }
     if (m_eState == ADJ_IDLE) {
         // The user is changing the crossfader manually. If the user has
         // moved it all the way to the other side, make the deck faded away
@@ -729,6 +748,7 @@ void AutoDJProcessor::playerPositionChanged(DeckAttributes* pAttributes,
             thisDeck->fadeBeginPos = 1.0;
             thisDeck->fadeEndPos = 1.0;
             otherDeck->isFromDeck = false;
+            cancelScheduledTransition();
             // Load the next track to otherDeck.
             loadNextTrackFromQueue(*otherDeck);
             emitAutoDJStateChanged(m_eState);
@@ -774,7 +794,9 @@ void AutoDJProcessor::playerPositionChanged(DeckAttributes* pAttributes,
                         (thisDeck->fadeEndPos - thisDeck->fadeBeginPos) *
                         getEndSecond(thisDeck) / getEndSecond(otherDeck);
                 // Re-cue the track if the user has seeked forward and will miss the fadeBeginPos
-                if (otherDeck->playPosition() >= otherDeck->fadeBeginPos - toDeckFadeDistance) {
+                // The engine may have started the track already.
+                if (!isTransitionExecutedByEngine() &&
+                        otherDeck->playPosition() >= otherDeck->fadeBeginPos - toDeckFadeDistance) {
                     otherDeck->setPlayPosition(otherDeck->startPos);
                 }
 
@@ -822,6 +844,10 @@ void AutoDJProcessor::playerPositionChanged(DeckAttributes* pAttributes,
             // Note: If the user has stopped the toDeck during the transition.
             // this deck just stops as well. In this case a stopped AutoDJ is accepted
             // because the use did it intentionally
+        } else if (isTransitionExecutedByEngine()) {
+            // The engine moves the crossfader in the audio callback,
+            // we only follow its progress.
+            m_transitionProgress = m_pTransitionSchedule->progress().progress;
         } else {
             // We are in Fading state.
             // Calculate the current transitionProgress, the place between begin
@@ -1264,6 +1290,9 @@ void AutoDJProcessor::calculateTransition(DeckAttributes* pFromDeck,
 
     switch (m_transitionMode) {
     case TransitionMode::FullIntroOutro: {
+        if (usePlannedTransition(pFromDeck, pToDeck, fromDeckPosition, introStart)) {
+            break;
+        }
         // Use the outro or intro length for the transition time, whichever is
         // shorter. Let the full outro and intro play; do not cut off any part
         // of either.
@@ -1416,6 +1445,8 @@ void AutoDJProcessor::calculateTransition(DeckAttributes* pFromDeck,
                  << pFromDeck->fadeBeginPos << pFromDeck->fadeEndPos
                  << pToDeck->startPos;
     }
+
+    scheduleTransition(pFromDeck, pToDeck);
 }
 
 void AutoDJProcessor::useFixedFadeTime(
@@ -1466,6 +1497,107 @@ void AutoDJProcessor::useFixedFadeTime(
     }
 }
 
+bool AutoDJProcessor::usePlannedTransition(DeckAttributes* pFromDeck,
+        DeckAttributes* pToDeck,
+        double fromDeckSecond,
+        double toDeckStartSecond) {
+    const TrackPointer pFromTrack = pFromDeck->getLoadedTrack();
+    const TrackPointer pToTrack = pToDeck->getLoadedTrack();
+    if (!pFromTrack || !pToTrack) {
+        return false;
+    }
+    const AutoDJPlannedTransition plan = m_pTransitionPlanner->plannedTransition(
+            pFromTrack->getId(), pToTrack->getId());
+    if (!plan.isValid()) {
+        return false;
+    }
+    // The plan is outdated if the cues have been moved after the track has
+    // been loaded.
+    if (plan.fromOutroStartPosition != pFromDeck->outroStartPosition() ||
+            plan.fromOutroEndPosition != pFromDeck->outroEndPosition() ||
+            plan.toIntroStartPosition != pToDeck->introStartPosition() ||
+            plan.toIntroEndPosition != pToDeck->introEndPosition()) {
+        return false;
+    }
+    // The plan assumes that the next track starts at its intro
+    if (toDeckStartSecond != getIntroStartSecond(pToDeck)) {
+        return false;
+    }
+    const double fadeBeginSecond = framePositionToSeconds(plan.fadeBeginPosition, pFromDeck);
+    const double fadeEndSecond = framePositionToSeconds(plan.fadeEndPosition, pFromDeck);
+    const double toDeckPlannedStartSecond =
+            framePositionToSeconds(plan.toStartPosition, pToDeck);
+    if (fadeBeginSecond < fromDeckSecond ||
+            toDeckPlannedStartSecond + fadeEndSecond - fadeBeginSecond >
+                    pToDeck->fadeBeginPos) {
+        // Too late or the transition would overlap the next one
+        return false;
+    }
+    pFromDeck->fadeBeginPos = fadeBeginSecond;
+    pFromDeck->fadeEndPos = fadeEndSecond;
+    pToDeck->startPos = toDeckPlannedStartSecond;
+    return true;
+}
+
+void AutoDJProcessor::scheduleTransition(
+        DeckAttributes* pFromDeck, DeckAttributes* pToDeck) {
+    if (!m_pTransitionSchedule) {
+        // No engine, the crossfader is moved in playerPositionChanged()
+        return;
+    }
+    const mixxx::audio::FramePos trackEndPosition = pFromDeck->trackEndPosition();
+    if (!trackEndPosition.isValid()) {
+        cancelScheduledTransition();
+        return;
+    }
+    AutoDJTransitionPlan plan;
+    plan.fromDeck = pFromDeck->index;
+    plan.toDeck = pToDeck->index;
+    plan.fadeBeginPosition = mixxx::audio::FramePos(
+            pFromDeck->fadeBeginPos * trackEndPosition.value());
+    plan.fadeEndPosition = mixxx::audio::FramePos(
+            pFromDeck->fadeEndPos * trackEndPosition.value());
+    plan.crossfaderTarget = pFromDeck->isLeft() ? 1.0 : -1.0;
+    m_scheduledTransitionId = m_pTransitionSchedule->setPlan(plan);
+}
+
+void AutoDJProcessor::cancelScheduledTransition() {
+    if (m_scheduledTransitionId == 0 || !m_pTransitionSchedule) {
+        return;
+    }
+    m_pTransitionSchedule->clearPlan();
+    m_scheduledTransitionId = 0;
+}
+
+bool AutoDJProcessor::isTransitionExecutedByEngine() {
+    if (m_scheduledTransitionId == 0 || !m_pTransitionSchedule ||
+            !m_pTransitionSchedule->isEngineAttached()) {
+        return false;
+    }
+    const AutoDJTransitionProgress progress = m_pTransitionSchedule->progress();
+    return progress.planId == m_scheduledTransitionId &&
+            (progress.state == AutoDJTransitionProgress::State::Fading ||
+                    progress.state == AutoDJTransitionProgress::State::Done);
+}
+
+void AutoDJProcessor::followEngineTransition() {
+    DeckAttributes* pFromDeck = getFromDeck();
+    VERIFY_OR_DEBUG_ASSERT(pFromDeck) {
+        return;
+    }
+    DeckAttributes* pToDeck = getOtherDeck(pFromDeck);
+    if (!pToDeck) {
+        return;
+    }
+    m_eState = pFromDeck->isLeft() ? ADJ_LEFT_FADING : ADJ_RIGHT_FADING;
+    m_transitionProgress = m_pTransitionSchedule->progress().progress;
+    emitAutoDJStateChanged(m_eState);
+    // Like in playerPositionChanged() when the fade begins. Once the engine
+    // has stopped the from deck, the next position change of the to deck
+    // returns to ADJ_IDLE and loads the next track.
+    removeLoadedTrackFromTopOfQueue(*pToDeck);
+}
+
 void AutoDJProcessor::playerTrackLoaded(DeckAttributes* pDeck, TrackPointer pTrack) {
     if constexpr (sDebug) {
         qDebug() << this << "playerTrackLoaded" << pDeck->group
@@ -7,11 +7,13 @@
 #include "control/controlproxy.h"
 #include "engine/channels/enginechannel.h"
 #include "engine/controls/cuecontrol.h"
+#include "engine/engineautodjtransition.h"
 #include "library/autodj/stemsmixtablemodel.h"
 #include "preferences/usersettings.h"
 #include "track/track_decl.h"
 #include "util/class.h"
 
+class AutoDJTransitionPlanner;
 class ControlPushButton;
 class TrackCollectionManager;
 class PlayerManagerInterface;
@@ -262,6 +264,22 @@ class AutoDJProcessor : public QObject {
             double fromDeckSecond,
             double fadeEndSecond,
             double toDeckStartSecond);
+    // Uses the transition that has been planned in advance for the tracks
+    // in both decks. Returns false if there is no matching plan.
+    bool usePlannedTransition(DeckAttributes* pFromDeck,
+            DeckAttributes* pToDeck,
+            double fromDeckSecond,
+            double toDeckStartSecond);
+    // Hands the transition calculated for pFromDeck over to the engine,
+    // which executes it inside the audio callback.
+    void scheduleTransition(DeckAttributes* pFromDeck, DeckAttributes* pToDeck);
+    void cancelScheduledTransition();
+    // Returns true if the engine is moving the crossfader for the current
+    // transition.
+    bool isTransitionExecutedByEngine();
+    // Enters the fading state for a transition that has been started by
+    // the engine while we were still idle.
+    void followEngineTransition();
     DeckAttributes* getLeftDeck();
     DeckAttributes* getRightDeck();
     DeckAttributes* getOtherDeck(const DeckAttributes* pThisDeck);
@@ -277,6 +295,7 @@ class AutoDJProcessor : public QObject {
     void maybeFillRandomTracks();
     UserSettingsPointer m_pConfig;
     StemsMixTableModel* m_pAutoDJTableModel;
+    AutoDJTransitionPlanner* m_pTransitionPlanner;
 
     AutoDJState m_eState;
     double m_transitionProgress;
@@ -288,6 +307,9 @@ class AutoDJProcessor : public QObject {
     ControlProxy* m_pCOCrossfader;
     ControlProxy* m_pCOCrossfaderReverse;
 
+    QSharedPointer<AutoDJTransitionSchedule> m_pTransitionSchedule;
+    int m_scheduledTransitionId;
+
     ControlPushButton* m_pSkipNext;
     ControlPushButton* m_pAddRandomTrack;
     ControlPushButton* m_pFadeNow;
@@ -0,0 +1,516 @@
+#include "library/autodj/autodjtransitionplanner.h"
+
+#include <QSqlQuery>
+#include <QtConcurrentRun>
+
+#include "library/autodj/stemsmixtablemodel.h"
+#include "library/dao/cuedao.h"
+#include "library/dao/trackschema.h"
+#include "library/queryutil.h"
+#include "library/trackcollection.h"
+#include "library/trackcollectionmanager.h"
+#include "moc_autodjtransitionplanner.cpp"
+#include "track/keyutils.h"
+#include "util/assert.h"
+#include "util/db/dbconnectionpooled.h"
+#include "util/db/dbconnectionpooler.h"
+#include "util/logger.h"
+#include "util/math.h"
+
+namespace {
+
+const mixxx::Logger kLogger("AutoDJTransitionPlanner");
+
+/// The first beat marker is placed on a downbeat, bars are counted from
+/// there.
+constexpr int kBeatsPerBar = 4;
+
+/// The tracks at the top of the queue are planned while the rest is
+/// still loading.
+constexpr int kLoadBatchSize = 64;
+
+constexpr double kUnknownKeyCompatibility = 0.5;
+
+/// Keys at least three steps apart on the Circle of Fifths clash. The fade
+/// between them is limited, so that both tracks overlap only briefly.
+constexpr double kClashingKeyCompatibility = 0.25;
+constexpr double kMaxClashingKeysTransitionSeconds = 4.0;
+
+mixxx::audio::FramePos firstValid(mixxx::audio::FramePos position,
+        mixxx::audio::FramePos fallback) {
+    return position.isValid() ? position : fallback;
+}
+
+/// Returns the iterator of the downbeat closest to position.
+mixxx::Beats::ConstIterator closestDownbeat(
+        const mixxx::Beats& beats, mixxx::audio::FramePos position) {
+    const auto firstMarkerIt = beats.cfirstmarker();
+    const int beatIndex = beats.iteratorFrom(position) - firstMarkerIt;
+    const int beatInBar = ((beatIndex % kBeatsPerBar) + kBeatsPerBar) % kBeatsPerBar;
+    auto prevDownbeatIt = beats.cfirstmarker() + (beatIndex - beatInBar);
+    auto nextDownbeatIt = prevDownbeatIt + kBeatsPerBar;
+    if (*nextDownbeatIt - position < position - *prevDownbeatIt) {
+        return nextDownbeatIt;
+    }
+    return prevDownbeatIt;
+}
+
+/// Moves the fade of the plan onto the bars of the from track without
+/// changing its length by more than half a bar.
+bool alignFadeToBars(const AutoDJTrackSnapshot& from,
+        AutoDJPlannedTransition* pPlan) {
+    if (!from.pBeats || !from.pBeats->isValid()) {
+        return false;
+    }
+    const mixxx::Beats& beats = *from.pBeats;
+    auto fadeBeginIt = closestDownbeat(beats, pPlan->fadeBeginPosition);
+    const mixxx::audio::FramePos fadeBegin = *fadeBeginIt;
+    const mixxx::audio::FrameDiff_t barLength = *(fadeBeginIt + kBeatsPerBar) - fadeBegin;
+    if (fadeBegin < mixxx::audio::kStartFramePos || barLength <= 0) {
+        return false;
+    }
+    int numBars = math_max(1,
+            static_cast<int>(std::round(
+                    (pPlan->fadeEndPosition - pPlan->fadeBeginPosition) / barLength)));
+    mixxx::audio::FramePos fadeEnd = *(fadeBeginIt + numBars * kBeatsPerBar);
+    while (fadeEnd > from.endPosition && numBars > 1) {
+        --numBars;
+        fadeEnd = *(fadeBeginIt + numBars * kBeatsPerBar);
+    }
+    if (fadeEnd > from.endPosition) {
+        return false;
+    }
+    pPlan->fadeBeginPosition = fadeBegin;
+    pPlan->fadeEndPosition = fadeEnd;
+    return true;
+}
+
+} // anonymous namespace
+
+void AutoDJTrackSnapshot::setCues(const QList<CuePointer>& cues) {
+    for (const auto& pCue : cues) {
+        switch (pCue->getType()) {
+        case mixxx::CueType::Intro:
+            introStartPosition = pCue->getPosition();
+            introEndPosition = pCue->getEndPosition();
+            break;
+        case mixxx::CueType::Outro:
+            outroStartPosition = pCue->getPosition();
+            outroEndPosition = pCue->getEndPosition();
+            break;
+        case mixxx::CueType::AudibleSound: {
+            const Cue::StartAndEndPositions pos = pCue->getStartAndEndPosition();
+            firstSoundPosition = pos.startPosition;
+            if (pos.endPosition > mixxx::audio::kStartFramePos &&
+                    (pos.endPosition - pos.startPosition) > 0) {
+                lastSoundPosition = pos.endPosition;
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+}
+
+AutoDJTransitionPlanner::AutoDJTransitionPlanner(QObject* pParent,
+        TrackCollectionManager* pTrackCollectionManager,
+        StemsMixTableModel* pTableModel)
+        : QObject(pParent),
+          m_pTrackCollectionManager(pTrackCollectionManager),
+          m_pTableModel(pTableModel),
+          m_pDbConnectionPool(pTrackCollectionManager
+                          ? pTrackCollectionManager->dbConnectionPool()
+                          : mixxx::DbConnectionPoolPtr()),
+          m_loading(false),
+          m_planning(false) {
+    m_queueChangedTimer.setSingleShot(true);
+    m_queueChangedTimer.setInterval(0);
+    connect(&m_queueChangedTimer,
+            &QTimer::timeout,
+            this,
+            &AutoDJTransitionPlanner::slotQueueChanged);
+    connect(&m_loadingWatcher,
+            &QFutureWatcher<QList<AutoDJTrackSnapshot>>::finished,
+            this,
+            &AutoDJTransitionPlanner::slotTracksLoaded);
+    connect(&m_planningWatcher,
+            &QFutureWatcher<QList<AutoDJPlannedTransition>>::finished,
+            this,
+            &AutoDJTransitionPlanner::slotTransitionsPlanned);
+
+    if (m_pTrackCollectionManager) {
+        // Analysis results and edited cues are only picked up once they
+        // have been saved.
+        connect(m_pTrackCollectionManager->internalCollection(),
+                &TrackCollection::tracksChanged,
+                this,
+                &AutoDJTransitionPlanner::slotTracksChanged);
+    }
+
+    if (m_pTableModel) {
+        const auto startQueueChangedTimer = [this] {
+            m_queueChangedTimer.start();
+        };
+        connect(m_pTableModel, &QAbstractItemModel::modelReset, this, startQueueChangedTimer);
+        connect(m_pTableModel, &QAbstractItemModel::layoutChanged, this, startQueueChangedTimer);
+        connect(m_pTableModel, &QAbstractItemModel::rowsInserted, this, startQueueChangedTimer);
+        connect(m_pTableModel, &QAbstractItemModel::rowsRemoved, this, startQueueChangedTimer);
+        connect(m_pTableModel, &QAbstractItemModel::rowsMoved, this, startQueueChangedTimer);
+        m_queueChangedTimer.start();
+    }
+}
+
+AutoDJTransitionPlanner::~AutoDJTransitionPlanner() {
+    // The worker threads only work on snapshots and their own database
+    // connection, but the watchers must not outlive the futures.
+    m_loadingWatcher.waitForFinished();
+    m_planningWatcher.waitForFinished();
+}
+
+void AutoDJTransitionPlanner::slotQueueChanged() {
+    VERIFY_OR_DEBUG_ASSERT(m_pTableModel) {
+        return;
+    }
+    QList<TrackId> trackIds;
+    const int rowCount = m_pTableModel->rowCount();
+    trackIds.reserve(rowCount);
+    for (int row = 0; row < rowCount; ++row) {
+        const TrackId trackId = m_pTableModel->getTrackId(m_pTableModel->index(row, 0));
+        if (trackId.isValid()) {
+            trackIds.append(trackId);
+        }
+    }
+    setQueue(trackIds);
+}
+
+void AutoDJTransitionPlanner::setQueue(const QList<TrackId>& trackIds) {
+    m_queue = trackIds;
+
+    const QSet<TrackId> queuedTrackIds(m_queue.constBegin(), m_queue.constEnd());
+    auto snapshotIt = m_snapshots.begin();
+    while (snapshotIt != m_snapshots.end()) {
+        if (queuedTrackIds.contains(snapshotIt.key())) {
+            ++snapshotIt;
+        } else {
+            snapshotIt = m_snapshots.erase(snapshotIt);
+        }
+    }
+    m_tracksInLoading.intersect(queuedTrackIds);
+
+    // Only the plans of pairs that are no longer consecutive are dropped
+    QSet<TrackIdPair> consecutivePairs;
+    for (int i = 1; i < m_queue.size(); ++i) {
+        consecutivePairs.insert(TrackIdPair(m_queue[i - 1], m_queue[i]));
+    }
+    auto it = m_plans.begin();
+    while (it != m_plans.end()) {
+        if (consecutivePairs.contains(it.key())) {
+            ++it;
+        } else {
+            it = m_plans.erase(it);
+        }
+    }
+    m_pairsInPlanning.intersect(consecutivePairs);
+
+    m_tracksToLoad.clear();
+    m_tracksToLoadSet.clear();
+    for (const TrackId& trackId : std::as_const(m_queue)) {
+        if (!m_snapshots.contains(trackId) &&
+                !m_tracksInLoading.contains(trackId)) {
+            addTrackToLoad(trackId);
+        }
+    }
+    loadMissingTracks();
+    planMissingTransitions();
+}
+
+void AutoDJTransitionPlanner::addTrackToLoad(TrackId trackId) {
+    if (!m_tracksToLoadSet.contains(trackId)) {
+        m_tracksToLoadSet.insert(trackId);
+        m_tracksToLoad.append(trackId);
+    }
+}
+
+void AutoDJTransitionPlanner::loadMissingTracks() {
+    if (m_loading || m_tracksToLoad.isEmpty()) {
+        // Called again when the running job has finished
+        return;
+    }
+    VERIFY_OR_DEBUG_ASSERT(m_pDbConnectionPool) {
+        m_tracksToLoad.clear();
+        m_tracksToLoadSet.clear();
+        return;
+    }
+    const QList<TrackId> trackIds = m_tracksToLoad.mid(0, kLoadBatchSize);
+    m_tracksToLoad.erase(m_tracksToLoad.begin(), m_tracksToLoad.begin() + trackIds.size());
+    for (const TrackId& trackId : trackIds) {
+        m_tracksToLoadSet.remove(trackId);
+    }
+    m_tracksInLoading = QSet<TrackId>(trackIds.constBegin(), trackIds.constEnd());
+    m_loading = true;
+    m_loadingWatcher.setFuture(QtConcurrent::run(
+            &AutoDJTransitionPlanner::loadSnapshots, m_pDbConnectionPool, trackIds));
+}
+
+void AutoDJTransitionPlanner::slotTracksLoaded() {
+    m_loading = false;
+    const QList<AutoDJTrackSnapshot> snapshots = m_loadingWatcher.result();
+    for (const auto& snapshot : snapshots) {
+        // Tracks that have been removed from the queue or changed in the
+        // meantime are skipped.
+        if (m_tracksInLoading.remove(snapshot.trackId)) {
+            m_snapshots.insert(snapshot.trackId, snapshot);
+        }
+    }
+    m_tracksInLoading.clear();
+    loadMissingTracks();
+    // Plan the transitions at the top of the queue while loading the rest
+    planMissingTransitions();
+}
+
+void AutoDJTransitionPlanner::slotTracksChanged(const QSet<TrackId>& trackIds) {
+    bool queuedTrackChanged = false;
+    for (const TrackId& trackId : trackIds) {
+        if (m_snapshots.contains(trackId) || m_tracksInLoading.contains(trackId)) {
+            invalidateTrack(trackId);
+            queuedTrackChanged = true;
+        }
+    }
+    if (queuedTrackChanged) {
+        loadMissingTracks();
+    }
+}
+
+void AutoDJTransitionPlanner::invalidateTrack(TrackId trackId) {
+    m_snapshots.remove(trackId);
+    // Results for this track are outdated before they arrive
+    m_tracksInLoading.remove(trackId);
+    addTrackToLoad(trackId);
+
+    auto it = m_plans.begin();
+    while (it != m_plans.end()) {
+        if (it.key().first == trackId || it.key().second == trackId) {
+            it = m_plans.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    auto pairIt = m_pairsInPlanning.begin();
+    while (pairIt != m_pairsInPlanning.end()) {
+        if (pairIt->first == trackId || pairIt->second == trackId) {
+            pairIt = m_pairsInPlanning.erase(pairIt);
+        } else {
+            ++pairIt;
+        }
+    }
+}
+
+void AutoDJTransitionPlanner::planMissingTransitions() {
+    if (m_planning) {
+        // Called again when the running job has finished
+        return;
+    }
+    QList<SnapshotPair> pairs;
+    for (int i = 1; i < m_queue.size(); ++i) {
+        const TrackIdPair pair(m_queue[i - 1], m_queue[i]);
+        if (m_plans.contains(pair) || m_pairsInPlanning.contains(pair)) {
+            continue;
+        }
+        const auto fromIt = m_snapshots.constFind(pair.first);
+        const auto toIt = m_snapshots.constFind(pair.second);
+        if (fromIt == m_snapshots.constEnd() || toIt == m_snapshots.constEnd()) {
+            // Not loaded yet
+            continue;
+        }
+        m_pairsInPlanning.insert(pair);
+        pairs.append(SnapshotPair(*fromIt, *toIt));
+    }
+    if (pairs.isEmpty()) {
+        return;
+    }
+    m_planning = true;
+    m_planningWatcher.setFuture(QtConcurrent::run(
+            &AutoDJTransitionPlanner::planTransitions, pairs));
+}
+
+void AutoDJTransitionPlanner::slotTransitionsPlanned() {
+    m_planning = false;
+    const QList<AutoDJPlannedTransition> plans = m_planningWatcher.result();
+    int numPlanned = 0;
+    for (const auto& plan : plans) {
+        const TrackIdPair pair(plan.fromTrackId, plan.toTrackId);
+        // Pairs that have been invalidated in the meantime are planned
+        // again with the new snapshots.
+        if (m_pairsInPlanning.remove(pair)) {
+            m_plans.insert(pair, plan);
+            ++numPlanned;
+        }
+    }
+    m_pairsInPlanning.clear();
+    kLogger.debug() << "Planned" << numPlanned << "transitions";
+    if (numPlanned > 0) {
+        emit transitionsPlanned();
+    }
+    planMissingTransitions();
+}
+
+AutoDJPlannedTransition AutoDJTransitionPlanner::plannedTransition(
+        TrackId fromTrackId, TrackId toTrackId) const {
+    return m_plans.value(TrackIdPair(fromTrackId, toTrackId));
+}
+
+bool AutoDJTransitionPlanner::isIdle() const {
+    return !m_loading && !m_planning && m_tracksToLoad.isEmpty();
+}
+
+// static
+QList<AutoDJTrackSnapshot> AutoDJTransitionPlanner::loadSnapshots(
+        const mixxx::DbConnectionPoolPtr& pDbConnectionPool,
+        const QList<TrackId>& trackIds) {
+    QList<AutoDJTrackSnapshot> snapshots;
+    // The thread-local database connection must not be closed
+    // before returning from this function.
+    const mixxx::DbConnectionPooler dbConnectionPooler(pDbConnectionPool);
+    if (!dbConnectionPooler.isPooling()) {
+        kLogger.warning() << "Failed to obtain database connection";
+        return snapshots;
+    }
+    const QSqlDatabase database = mixxx::DbConnectionPooled(pDbConnectionPool);
+    CueDAO cueDao;
+    cueDao.initialize(database);
+
+    QSqlQuery query(database);
+    query.prepare(QStringLiteral(
+            "SELECT samplerate,duration,bpm,beats_version,beats_sub_version,"
+            "beats,key_id FROM " LIBRARY_TABLE " WHERE id=:id"));
+    snapshots.reserve(trackIds.size());
+    for (const TrackId& trackId : trackIds) {
+        query.bindValue(":id", trackId.toVariant());
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query);
+            continue;
+        }
+        if (!query.next()) {
+            kLogger.warning() << "Queued track not found" << trackId;
+            continue;
+        }
+        AutoDJTrackSnapshot snapshot;
+        snapshot.trackId = trackId;
+        snapshot.sampleRate = mixxx::audio::SampleRate(query.value(0).toUInt());
+        if (snapshot.sampleRate.isValid()) {
+            snapshot.endPosition = mixxx::audio::FramePos(
+                    std::floor(query.value(1).toDouble() * snapshot.sampleRate.value()));
+            // See setTrackBeats() in TrackDAO
+            const QString beatsVersion = query.value(3).toString();
+            if (!beatsVersion.isEmpty()) {
+                snapshot.pBeats = mixxx::Beats::fromByteArray(snapshot.sampleRate,
+                        beatsVersion,
+                        query.value(4).toString(),
+                        query.value(5).toByteArray());
+            }
+            const auto bpm = mixxx::Bpm(query.value(2).toDouble());
+            if (!snapshot.pBeats && bpm.isValid()) {
+                snapshot.pBeats = mixxx::Beats::fromConstTempo(
+                        snapshot.sampleRate, mixxx::audio::kStartFramePos, bpm);
+            }
+        }
+        snapshot.key = static_cast<mixxx::track::io::key::ChromaticKey>(
+                query.value(6).toInt());
+        snapshot.setCues(cueDao.getCuesForTrack(trackId));
+        snapshots.append(snapshot);
+    }
+    return snapshots;
+}
+
+// static
+QList<AutoDJPlannedTransition> AutoDJTransitionPlanner::planTransitions(
+        const QList<SnapshotPair>& pairs) {
+    QList<AutoDJPlannedTransition> plans;
+    plans.reserve(pairs.size());
+    for (const auto& pair : pairs) {
+        plans.append(planTransition(pair.first, pair.second));
+    }
+    return plans;
+}
+
+// static
+AutoDJPlannedTransition AutoDJTransitionPlanner::planTransition(
+        const AutoDJTrackSnapshot& from,
+        const AutoDJTrackSnapshot& to) {
+    AutoDJPlannedTransition plan;
+    plan.fromTrackId = from.trackId;
+    plan.toTrackId = to.trackId;
+    plan.fromOutroStartPosition = from.outroStartPosition;
+    plan.fromOutroEndPosition = from.outroEndPosition;
+    plan.toIntroStartPosition = to.introStartPosition;
+    plan.toIntroEndPosition = to.introEndPosition;
+    plan.keyCompatibility = keyCompatibility(from.key, to.key);
+    if (!from.sampleRate.isValid() || !to.sampleRate.isValid() ||
+            !from.endPosition.isValid()) {
+        return plan;
+    }
+
+    // The same fallbacks as in AutoDJProcessor
+    const mixxx::audio::FramePos outroEnd = firstValid(from.outroEndPosition,
+            firstValid(from.lastSoundPosition, from.endPosition));
+    const mixxx::audio::FramePos outroStart = firstValid(from.outroStartPosition, outroEnd);
+    const mixxx::audio::FramePos introStart = firstValid(to.introStartPosition,
+            firstValid(to.firstSoundPosition, mixxx::audio::kStartFramePos));
+    const double outroLength = (outroEnd - outroStart) / from.sampleRate.value();
+    double introLength = 0;
+    if (to.introEndPosition.isValid() && introStart < to.introEndPosition) {
+        introLength = (to.introEndPosition - introStart) / to.sampleRate.value();
+    }
+
+    // See TransitionMode::FullIntroOutro in
+    // AutoDJProcessor::calculateTransition()
+    double transitionLength = introLength;
+    if (outroLength > 0) {
+        if (transitionLength <= 0 || transitionLength > outroLength) {
+            transitionLength = outroLength;
+        }
+    }
+    if (transitionLength <= 0) {
+        // A fixed transition time is used
+        return plan;
+    }
+    if (plan.keyCompatibility <= kClashingKeyCompatibility) {
+        // Keep the overlap of clashing keys short. The fade still ends at
+        // the end of the outro.
+        transitionLength = math_min(transitionLength, kMaxClashingKeysTransitionSeconds);
+    }
+    plan.fadeEndPosition = outroEnd;
+    plan.fadeBeginPosition = outroEnd - transitionLength * from.sampleRate.value();
+    plan.toStartPosition = introStart;
+
+    plan.barAligned = alignFadeToBars(from, &plan);
+    if (plan.barAligned && to.pBeats && to.pBeats->isValid()) {
+        const mixxx::audio::FramePos beat = to.pBeats->findClosestBeat(introStart);
+        if (beat.isValid() && beat >= mixxx::audio::kStartFramePos) {
+            plan.toStartPosition = beat;
+        }
+    }
+    return plan;
+}
+
+// static
+double AutoDJTransitionPlanner::keyCompatibility(
+        mixxx::track::io::key::ChromaticKey fromKey,
+        mixxx::track::io::key::ChromaticKey toKey) {
+    if (fromKey == mixxx::track::io::key::INVALID ||
+            toKey == mixxx::track::io::key::INVALID) {
+        return kUnknownKeyCompatibility;
+    }
+    if (fromKey == toKey) {
+        return 1.0;
+    }
+    if (KeyUtils::getCompatibleKeys(fromKey).contains(toKey)) {
+        return 0.75;
+    }
+    // The OpenKey number is the position on the Circle of Fifths
+    const int distance = abs(KeyUtils::keyToOpenKeyNumber(fromKey) -
+            KeyUtils::keyToOpenKeyNumber(toKey));
+    const int steps = math_min(distance, 12 - distance);
+    return 0.5 * (1.0 - steps / 6.0);
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <QFutureWatcher>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPair>
+#include <QSet>
+#include <QTimer>
+
+#include "audio/frame.h"
+#include "audio/types.h"
+#include "proto/keys.pb.h"
+#include "track/beats.h"
+#include "track/cue.h"
+#include "track/trackid.h"
+#include "util/db/dbconnectionpool.h"
+
+class StemsMixTableModel;
+class TrackCollectionManager;
+
+/// The analysis data of a queued track that is needed for planning a
+/// transition. It is read from the database on a worker thread, so that
+/// neither the Track objects nor the main thread are involved.
+struct AutoDJTrackSnapshot {
+    TrackId trackId;
+    mixxx::audio::SampleRate sampleRate;
+    mixxx::audio::FramePos endPosition;
+    mixxx::BeatsPointer pBeats;
+    mixxx::track::io::key::ChromaticKey key = mixxx::track::io::key::INVALID;
+    /// Invalid if the cue is not placed
+    mixxx::audio::FramePos introStartPosition;
+    mixxx::audio::FramePos introEndPosition;
+    mixxx::audio::FramePos outroStartPosition;
+    mixxx::audio::FramePos outroEndPosition;
+    /// The boundaries of the AudibleSound cue, invalid if not analyzed
+    mixxx::audio::FramePos firstSoundPosition;
+    mixxx::audio::FramePos lastSoundPosition;
+
+    /// Sets the intro, outro and audible sound positions from the cues
+    void setCues(const QList<CuePointer>& cues);
+};
+
+/// A transition between two consecutive tracks of the AutoDJ queue that
+/// has been calculated in advance. The positions follow the rules of
+/// AutoDJProcessor::TransitionMode::FullIntroOutro for the case that the
+/// next track is cued to its intro start. If the tracks have beats, the
+/// fade begins on a bar of the from track, lasts a whole number of bars
+/// and the to track starts on a beat.
+struct AutoDJPlannedTransition {
+    TrackId fromTrackId;
+    TrackId toTrackId;
+    /// The cue positions the transition is based on. AutoDJProcessor must
+    /// not use the plan if the cues of the loaded tracks differ.
+    mixxx::audio::FramePos fromOutroStartPosition;
+    mixxx::audio::FramePos fromOutroEndPosition;
+    mixxx::audio::FramePos toIntroStartPosition;
+    mixxx::audio::FramePos toIntroEndPosition;
+    /// Play positions of the from track
+    mixxx::audio::FramePos fadeBeginPosition;
+    mixxx::audio::FramePos fadeEndPosition;
+    /// Play position of the to track when the fade begins
+    mixxx::audio::FramePos toStartPosition;
+    bool barAligned = false;
+    /// How well the keys of both tracks fit together, from 0 (clash) to 1
+    /// (same key). The fade is shortened if the keys clash.
+    double keyCompatibility = 0.0;
+
+    /// A plan is invalid if neither an intro nor an outro is marked. The
+    /// transition time from the preferences is used in this case.
+    bool isValid() const {
+        return fadeBeginPosition.isValid() && fadeEndPosition.isValid() &&
+                toStartPosition.isValid();
+    }
+};
+
+/// Plans the transitions between all consecutive tracks of the AutoDJ
+/// queue in the background. The analysis data of the queued tracks is
+/// read from the database on a worker thread with its own connection and
+/// only these snapshots are kept, no Track objects. Only pairs of tracks
+/// that are new in the queue or whose analysis has been changed in the
+/// database are planned again.
+class AutoDJTransitionPlanner : public QObject {
+    Q_OBJECT
+  public:
+    typedef QPair<TrackId, TrackId> TrackIdPair;
+    typedef QPair<AutoDJTrackSnapshot, AutoDJTrackSnapshot> SnapshotPair;
+
+    /// pTableModel is the queue and may be null if the queue is set with
+    /// setQueue(). pTrackCollectionManager provides the database and
+    /// notifies about changed tracks.
+    AutoDJTransitionPlanner(QObject* pParent,
+            TrackCollectionManager* pTrackCollectionManager,
+            StemsMixTableModel* pTableModel);
+    ~AutoDJTransitionPlanner() override;
+
+    /// Replaces the queue. Cached plans of pairs that are still
+    /// consecutive are kept.
+    void setQueue(const QList<TrackId>& trackIds);
+    const QList<TrackId>& queue() const {
+        return m_queue;
+    }
+
+    /// Returns the cached plan for the transition from fromTrackId to
+    /// toTrackId. The plan is invalid if it has not been calculated yet.
+    AutoDJPlannedTransition plannedTransition(
+            TrackId fromTrackId, TrackId toTrackId) const;
+    int numPlannedTransitions() const {
+        return m_plans.size();
+    }
+
+    /// Returns true if all transitions of the queue have been planned.
+    bool isIdle() const;
+
+    /// Reads the snapshots of the given tracks from the database using a
+    /// thread-local connection. Tracks that are not found are skipped.
+    /// Thread safe.
+    static QList<AutoDJTrackSnapshot> loadSnapshots(
+            const mixxx::DbConnectionPoolPtr& pDbConnectionPool,
+            const QList<TrackId>& trackIds);
+    /// Plans the transition between two tracks. Thread safe.
+    static AutoDJPlannedTransition planTransition(
+            const AutoDJTrackSnapshot& from,
+            const AutoDJTrackSnapshot& to);
+    /// Plans the transitions between all given pairs. Thread safe.
+    static QList<AutoDJPlannedTransition> planTransitions(
+            const QList<SnapshotPair>& pairs);
+    /// Returns a score between 0 and 1 for mixing from fromKey to toKey,
+    /// based on the distance on the Circle of Fifths. Unknown keys get a
+    /// neutral score of 0.5.
+    static double keyCompatibility(
+            mixxx::track::io::key::ChromaticKey fromKey,
+            mixxx::track::io::key::ChromaticKey toKey);
+
+  signals:
+    /// Emitted on the main thread when new plans have been cached.
+    void transitionsPlanned();
+
+  private slots:
+    void slotQueueChanged();
+    void slotTracksLoaded();
+    void slotTransitionsPlanned();
+    void slotTracksChanged(const QSet<TrackId>& trackIds);
+
+  private:
+    void invalidateTrack(TrackId trackId);
+    void addTrackToLoad(TrackId trackId);
+    void loadMissingTracks();
+    void planMissingTransitions();
+
+    TrackCollectionManager* const m_pTrackCollectionManager;
+    StemsMixTableModel* const m_pTableModel;
+    const mixxx::DbConnectionPoolPtr m_pDbConnectionPool;
+
+    QList<TrackId> m_queue;
+    QHash<TrackId, AutoDJTrackSnapshot> m_snapshots;
+    /// The tracks to load in queue order, and the same tracks as a set
+    /// for fast lookups in long queues
+    QList<TrackId> m_tracksToLoad;
+    QSet<TrackId> m_tracksToLoadSet;
+    QHash<TrackIdPair, AutoDJPlannedTransition> m_plans;
+
+    /// Collapses all row changes of one event loop iteration
+    QTimer m_queueChangedTimer;
+
+    QFutureWatcher<QList<AutoDJTrackSnapshot>> m_loadingWatcher;
+    bool m_loading;
+    /// The tracks that are currently read on the worker thread. Tracks
+    /// that are removed from this set while loading are not cached.
+    QSet<TrackId> m_tracksInLoading;
+
+    QFutureWatcher<QList<AutoDJPlannedTransition>> m_planningWatcher;
+    bool m_planning;
+    /// The pairs that are currently planned on the worker thread. Pairs
+    /// that are removed from this set while planning are not cached.
+    QSet<TrackIdPair> m_pairsInPlanning;
+};
@@ -215,6 +215,24 @@ void StemsMixTableModel::moveTrack(const QModelIndex& sourceIndex,
     m_pTrackCollectionManager->internalCollection()->getStemsMixDAO().moveTrack(m_iStemsMixId, oldPosition, newPosition);
 }
 
+bool StemsMixTableModel::moveTracks(const QModelIndexList& sourceIndices,
+        const QModelIndex& destIndex) {
+    const auto move = positionRangeMove(sourceIndices,
+            destIndex,
+            fieldIndex(ColumnCache::COLUMN_STEMSMIXTRACKSTABLE_POSITION));
+    if (!move) {
+        return false;
+    }
+    if (move->newPosition == move->firstPosition) {
+        return true;
+    }
+    StemsMixDAO& dao = m_pTrackCollectionManager->internalCollection()->getStemsMixDAO();
+    const int newPosition = move->newPosition > 0
+            ? move->newPosition
+            : dao.getMaxPosition(m_iStemsMixId) - move->count + 1;
+    return dao.moveTracks(m_iStemsMixId, move->firstPosition, move->count, newPosition);
+}
+
 bool StemsMixTableModel::isLocked() {
     return m_pTrackCollectionManager->internalCollection()->getStemsMixDAO().isStemsMixLocked(m_iStemsMixId);
 }
@@ -31,6 +31,13 @@ const bool sDebug = false;
 constexpr int kIdColumn = 0;
 constexpr int kMaxSortColumns = 3;
 
+// The table columns are loaded on demand in pages of rows. A page and its
+// adjacent pages are loaded at once, so that scrolling in either direction
+// finds the next rows loaded. The cached pages cover the rows of a view
+// with plenty of margin.
+constexpr int kRowsPerMetadataPage = 256;
+constexpr int kMaxCachedMetadataPages = 64;
+
 // Constant for getModelSetting(name)
 const QString COLUMNS_SORTING = QStringLiteral("ColumnsSorting");
 
@@ -45,6 +52,8 @@ BaseSqlTableModel::BaseSqlTableModel(
         : BaseTrackTableModel(parent, pTrackCollectionManager, settingsNamespace),
           m_pTrackCollectionManager(pTrackCollectionManager),
           m_database(pTrackCollectionManager->internalCollection()->database()),
+          m_bLazyMetadata(false),
+          m_metadataPages(kMaxCachedMetadataPages),
           m_bInitialized(false) {
 }
 
@@ -168,21 +177,26 @@ void BaseSqlTableModel::initSortColumnMapping() {
 }
 
 void BaseSqlTableModel::clearRows() {
-    DEBUG_ASSERT(m_rowInfo.empty() == m_trackIdToRows.empty());
-    DEBUG_ASSERT(m_rowInfo.size() >= m_trackIdToRows.size());
+    DEBUG_ASSERT(m_rowInfo.empty() ==
+            (m_trackIdToRows.empty() && m_trackIdToRow.empty()));
+    DEBUG_ASSERT(m_rowInfo.size() >= m_trackIdToRows.size() + m_trackIdToRow.size());
     if (!m_rowInfo.isEmpty()) {
         beginRemoveRows(QModelIndex(), 0, m_rowInfo.size() - 1);
         m_rowInfo.clear();
         m_trackIdToRows.clear();
+        m_trackIdToRow.clear();
+        m_metadataPages.clear();
         endRemoveRows();
     }
     DEBUG_ASSERT(m_rowInfo.isEmpty());
     DEBUG_ASSERT(m_trackIdToRows.isEmpty());
+    DEBUG_ASSERT(m_trackIdToRow.isEmpty());
 }
 
 void BaseSqlTableModel::replaceRows(
         QVector<RowInfo>&& rows,
-        TrackId2Rows&& trackIdToRows) {
+        TrackId2Rows&& trackIdToRows,
+        TrackId2Row&& trackIdToRow) {
     // NOTE(uklotzde): Use r-value references for parameters here, because
     // conceptually those parameters should replace the corresponding internal
     // member variables. Currently Qt4/5 doesn't support move semantics and
@@ -190,14 +204,16 @@ void BaseSqlTableModel::replaceRows(
     // behind the scenes. Moving would be more efficient, although implicit
     // sharing meets all requirements. If Qt will ever add move support for
     // its container types in the future this code becomes even more efficient.
-    DEBUG_ASSERT(rows.empty() == trackIdToRows.empty());
-    DEBUG_ASSERT(rows.size() >= trackIdToRows.size());
+    DEBUG_ASSERT(rows.empty() == (trackIdToRows.empty() && trackIdToRow.empty()));
+    DEBUG_ASSERT(rows.size() >= trackIdToRows.size() + trackIdToRow.size());
     if (rows.isEmpty()) {
         clearRows();
     } else {
         beginInsertRows(QModelIndex(), 0, rows.size() - 1);
         m_rowInfo = rows;
         m_trackIdToRows = trackIdToRows;
+        m_trackIdToRow = trackIdToRow;
+        m_metadataPages.clear();
         endInsertRows();
     }
 }
@@ -224,25 +240,22 @@ void BaseSqlTableModel::select() {
     PerformanceTimer time;
     time.start();
 
-    // Prepare query for id and all columns not in m_trackSource
-    QString queryString = QString("SELECT %1 FROM %2 %3")
-                                  .arg(m_tableColumns.join(","), m_tableName, m_tableOrderBy);
-
-    if (sDebug) {
-        qDebug() << this << "select() executing:" << queryString;
-    }
-
-    QSqlQuery query(m_database);
-    // This causes a memory savings since QSqlCachedResult (what QtSQLite uses)
-    // won't allocate a giant in-memory table that we won't use at all.
-    query.setForwardOnly(true);
-    if (!query.prepare(queryString)) {
-        LOG_FAILED_QUERY(query);
+    // Only the ids are loaded for all rows. If the table contains a track
+    // multiple times, e.g. a history playlist, its rows cannot be told apart
+    // by the id and the table columns of all rows are loaded instead.
+    QVector<RowInfo> rowInfos;
+    QSet<TrackId> trackIds;
+    bool lazyMetadata = true;
+    if (!queryRows(false, &rowInfos, &trackIds)) {
         return;
     }
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
-        return;
+    if (trackIds.size() < rowInfos.size()) {
+        rowInfos.clear();
+        trackIds.clear();
+        lazyMetadata = false;
+        if (!queryRows(true, &rowInfos, &trackIds)) {
+            return;
+        }
     }
 
     // Remove all the rows from the table after(!) the query has been
@@ -250,44 +263,6 @@ void BaseSqlTableModel::select() {
     // TODO(rryan) we could edit the table in place instead of clearing it?
     clearRows();
 
-    // The size of the result set is not known in advance for a
-    // forward-only query, so we cannot reserve memory for rows
-    // in advance.
-    QVector<RowInfo> rowInfos;
-    QSet<TrackId> trackIds;
-    int idColumn = -1;
-    while (query.next()) {
-        QSqlRecord sqlRecord = query.record();
-
-        if (idColumn < 0) {
-            idColumn = sqlRecord.indexOf(m_idColumn);
-        }
-
-        // TODO(XXX): Can we get rid of the hard-coded assumption that
-        // the the first column always contains the id?
-        DEBUG_ASSERT(idColumn == kIdColumn);
-
-        VERIFY_OR_DEBUG_ASSERT(idColumn >= 0) {
-            qCritical()
-                    << "ID column not available in database query results:"
-                    << m_idColumn;
-            return;
-        }
-
-        TrackId trackId(sqlRecord.value(idColumn));
-        trackIds.insert(trackId);
-
-        RowInfo rowInfo;
-        rowInfo.trackId = trackId;
-        // current position defines the ordering
-        rowInfo.order = rowInfos.size();
-        rowInfo.metadata.reserve(sqlRecord.count());
-        for (int i = 0; i < m_tableColumns.size(); ++i) {
-            rowInfo.metadata.push_back(sqlRecord.value(i));
-        }
-        rowInfos.push_back(rowInfo);
-    }
-
     if (sDebug) {
         qDebug() << "Rows actually received:" << rowInfos.size();
     }
@@ -322,9 +297,14 @@ void BaseSqlTableModel::select() {
     std::stable_sort(rowInfos.begin(), rowInfos.end());
 
     TrackId2Rows trackIdToRows;
+    TrackId2Row trackIdToRow;
     // We expect almost all rows to be valid and that only a few tracks
     // are contained multiple times in rowInfos (e.g. in history playlists)
-    trackIdToRows.reserve(rowInfos.size());
+    if (lazyMetadata) {
+        trackIdToRow.reserve(rowInfos.size());
+    } else {
+        trackIdToRows.reserve(rowInfos.size());
+    }
     for (int i = 0; i < rowInfos.size(); ++i) {
         const RowInfo& rowInfo = rowInfos[i];
 
@@ -334,16 +314,22 @@ void BaseSqlTableModel::select() {
             rowInfos.resize(i);
             break;
         }
-        trackIdToRows[rowInfo.trackId].push_back(i);
+        if (lazyMetadata) {
+            trackIdToRow.insert(rowInfo.trackId, i);
+        } else {
+            trackIdToRows[rowInfo.trackId].push_back(i);
+        }
     }
     // The number of unique tracks cannot be greater than the
     // number of total rows returned by the query
-    DEBUG_ASSERT(trackIdToRows.size() <= rowInfos.size());
+    DEBUG_ASSERT(trackIdToRows.size() + trackIdToRow.size() <= rowInfos.size());
 
     // We're done! Issue the update signals and replace the master maps.
+    m_bLazyMetadata = lazyMetadata;
     replaceRows(
             std::move(rowInfos),
-            std::move(trackIdToRows));
+            std::move(trackIdToRows),
+            std::move(trackIdToRow));
     // Both rowInfo and trackIdToRows (might) have been moved and
     // must not be used afterwards!
 
@@ -351,6 +337,174 @@ void BaseSqlTableModel::select() {
              << m_rowInfo.size();
 }
 
+bool BaseSqlTableModel::queryRows(
+        bool withMetadata,
+        QVector<RowInfo>* pRowInfos,
+        QSet<TrackId>* pTrackIds) const {
+    // Only the id column if the table columns are loaded on demand
+    const QStringList columns =
+            withMetadata ? m_tableColumns : m_tableColumns.mid(kIdColumn, 1);
+    QString queryString = QString("SELECT %1 FROM %2 %3")
+                                  .arg(columns.join(","), m_tableName, m_tableOrderBy);
+
+    if (sDebug) {
+        qDebug() << this << "select() executing:" << queryString;
+    }
+
+    QSqlQuery query(m_database);
+    // This causes a memory savings since QSqlCachedResult (what QtSQLite uses)
+    // won't allocate a giant in-memory table that we won't use at all.
+    query.setForwardOnly(true);
+    if (!query.prepare(queryString)) {
+        LOG_FAILED_QUERY(query);
+        return false;
+    }
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return false;
+    }
+
+    const int idColumn = query.record().indexOf(m_idColumn);
+    // TODO(XXX): Can we get rid of the hard-coded assumption that
+    // the the first column always contains the id?
+    DEBUG_ASSERT(idColumn == kIdColumn);
+    VERIFY_OR_DEBUG_ASSERT(idColumn >= 0) {
+        qCritical()
+                << "ID column not available in database query results:"
+                << m_idColumn;
+        return false;
+    }
+
+    const int metadataColumnCount = withMetadata ? columns.size() : 0;
+
+    // The size of the result set is not known in advance for a
+    // forward-only query, so we cannot reserve memory for rows
+    // in advance.
+    while (query.next()) {
+        TrackId trackId(query.value(idColumn));
+        pTrackIds->insert(trackId);
+
+        RowInfo rowInfo;
+        rowInfo.trackId = trackId;
+        // current position defines the ordering
+        rowInfo.order = pRowInfos->size();
+        rowInfo.metadata.reserve(metadataColumnCount);
+        for (int i = 0; i < metadataColumnCount; ++i) {
+            rowInfo.metadata.push_back(query.value(i));
+        }
+        pRowInfos->push_back(rowInfo);
+    }
+    return true;
+}
+
+const QVector<QVariant>* BaseSqlTableModel::lazyMetadata(int row) const {
+    DEBUG_ASSERT(m_bLazyMetadata);
+    const int page = row / kRowsPerMetadataPage;
+    if (!m_metadataPages.contains(page)) {
+        // Views load the rows they paint with prefetchRows(). This is
+        // only reached by other callers, e.g. when moving tracks, which
+        // need the values immediately.
+        fetchMetadataPages(page, page);
+    }
+    const MetadataPage* pPage = m_metadataPages.object(page);
+    if (!pPage) {
+        // The query has failed
+        return nullptr;
+    }
+    const int rowInPage = row % kRowsPerMetadataPage;
+    VERIFY_OR_DEBUG_ASSERT(rowInPage < pPage->size()) {
+        return nullptr;
+    }
+    return &pPage->at(rowInPage);
+}
+
+const QVector<int> BaseSqlTableModel::getTrackRows(TrackId trackId) const {
+    if (m_bLazyMetadata) {
+        const auto it = m_trackIdToRow.constFind(trackId);
+        if (it == m_trackIdToRow.constEnd()) {
+            return {};
+        }
+        return {it.value()};
+    }
+    return m_trackIdToRows.value(trackId);
+}
+
+void BaseSqlTableModel::prefetchRows(int firstRow, int lastRow) {
+    if (!m_bLazyMetadata) {
+        return;
+    }
+    // The adjacent pages are loaded as well, so that scrolling by
+    // less than a page does not need to query the database.
+    fetchMetadataPages(
+            std::max(firstRow / kRowsPerMetadataPage - 1, 0),
+            lastRow / kRowsPerMetadataPage + 1);
+}
+
+void BaseSqlTableModel::fetchMetadataPages(int firstPage, int lastPage) const {
+    const int rowCount = m_rowInfo.size();
+    if (rowCount == 0) {
+        return;
+    }
+    lastPage = std::min(lastPage, (rowCount - 1) / kRowsPerMetadataPage);
+
+    QVector<int> pages;
+    QStringList idStrings;
+    for (int page = firstPage; page <= lastPage; ++page) {
+        if (m_metadataPages.contains(page)) {
+            continue;
+        }
+        pages.append(page);
+        const int endRow = std::min((page + 1) * kRowsPerMetadataPage, rowCount);
+        for (int row = page * kRowsPerMetadataPage; row < endRow; ++row) {
+            idStrings.append(m_rowInfo[row].trackId.toString());
+        }
+    }
+    if (pages.isEmpty()) {
+        return;
+    }
+
+    QString queryString = QString("SELECT %1 FROM %2 WHERE %3 IN (%4)")
+                                  .arg(m_tableColumns.join(","),
+                                          m_tableName,
+                                          m_idColumn,
+                                          idStrings.join(","));
+    if (sDebug) {
+        qDebug() << this << "fetchMetadataPages() executing:" << queryString;
+    }
+
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
+    if (!query.exec(queryString)) {
+        LOG_FAILED_QUERY(query);
+        return;
+    }
+    // Each track is contained only once, otherwise the table columns
+    // would have been loaded by select().
+    QHash<TrackId, QVector<QVariant>> metadataByTrackId;
+    metadataByTrackId.reserve(idStrings.size());
+    while (query.next()) {
+        QVector<QVariant> metadata;
+        metadata.reserve(m_tableColumns.size());
+        for (int i = 0; i < m_tableColumns.size(); ++i) {
+            metadata.push_back(query.value(i));
+        }
+        metadataByTrackId.insert(TrackId(query.value(kIdColumn)), metadata);
+    }
+
+    for (int page : qAsConst(pages)) {
+        const int firstRow = page * kRowsPerMetadataPage;
+        const int endRow = std::min(firstRow + kRowsPerMetadataPage, rowCount);
+        auto* pPage = new MetadataPage;
+        pPage->reserve(endRow - firstRow);
+        for (int row = firstRow; row < endRow; ++row) {
+            // Tracks that have been removed from the table since
+            // select() have no values.
+            pPage->append(metadataByTrackId.value(m_rowInfo[row].trackId));
+        }
+        m_metadataPages.insert(page, pPage);
+    }
+}
+
 void BaseSqlTableModel::setTable(const QString& tableName,
         const QString& idColumn,
         const QStringList& tableColumns,
@@ -661,7 +815,17 @@ QVariant BaseSqlTableModel::rawValue(
             return previewDeckTrackId() == trackId;
         }
 
-        const QVector<QVariant>& columns = rowInfo.metadata;
+        const QVector<QVariant>* pColumns = &rowInfo.metadata;
+        if (m_bLazyMetadata) {
+            if (column == kIdColumn) {
+                return trackId.toVariant();
+            }
+            pColumns = lazyMetadata(row);
+            if (!pColumns || column >= pColumns->size()) {
+                return QVariant();
+            }
+        }
+        const QVector<QVariant>& columns = *pColumns;
         if (sDebug) {
             qDebug() << "Returning table-column value"
                     << columns.at(column)
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <QCache>
 #include <QHash>
 #include <QtSql>
 
@@ -13,6 +14,10 @@ class TrackCollectionManager;
 
 // BaseSqlTableModel is a custom-written SQL-backed table which aggressively
 // caches the contents of the table and supports lightweight updates.
+//
+// Only the track ids of all rows are loaded by select(). The values of the
+// other table columns are loaded on demand in pages of rows around the rows
+// that are displayed, unless the table contains a track multiple times.
 class BaseSqlTableModel : public BaseTrackTableModel {
     Q_OBJECT
   public:
@@ -53,9 +58,9 @@ class BaseSqlTableModel : public BaseTrackTableModel {
 
     CoverInfo getCoverInfo(const QModelIndex& index) const override;
 
-    const QVector<int> getTrackRows(TrackId trackId) const override {
-        return m_trackIdToRows.value(trackId);
-    }
+    const QVector<int> getTrackRows(TrackId trackId) const override;
+
+    void prefetchRows(int firstRow, int lastRow) override;
 
     void search(const QString& searchText, const QString& extraFilter = QString()) override;
     const QString currentSearch() const override;
@@ -121,6 +126,7 @@ class BaseSqlTableModel : public BaseTrackTableModel {
     struct RowInfo {
         TrackId trackId;
         int order;
+        // Only populated if the table columns are not loaded on demand
         QVector<QVariant> metadata;
 
         bool operator<(const RowInfo& other) const {
@@ -135,21 +141,41 @@ class BaseSqlTableModel : public BaseTrackTableModel {
     };
 
     typedef QHash<TrackId, QVector<int>> TrackId2Rows;
+    // For tables that contain each track only once. This avoids
+    // allocating a vector for each of the rows.
+    typedef QHash<TrackId, int> TrackId2Row;
+
+    // The values of the table columns of each row in a page
+    typedef QVector<QVector<QVariant>> MetadataPage;
+
+    bool queryRows(
+            bool withMetadata,
+            QVector<RowInfo>* pRowInfos,
+            QSet<TrackId>* pTrackIds) const;
+    const QVector<QVariant>* lazyMetadata(int row) const;
+    void fetchMetadataPages(int firstPage, int lastPage) const;
 
     void clearRows();
     void replaceRows(
             QVector<RowInfo>&& rows,
-            TrackId2Rows&& trackIdToRows);
+            TrackId2Rows&& trackIdToRows,
+            TrackId2Row&& trackIdToRow);
 
     QVector<RowInfo> m_rowInfo;
 
+    // True if the table columns are loaded on demand by lazyMetadata()
+    bool m_bLazyMetadata;
+    mutable QCache<int, MetadataPage> m_metadataPages;
+
     QString m_idColumn;
     QSharedPointer<BaseTrackCache> m_trackSource;
     QStringList m_tableColumns;
     QList<SortColumn> m_sortColumns;
     bool m_bInitialized;
     QHash<TrackId, int> m_trackSortOrder;
+    // Only one of them is populated, depending on m_bLazyMetadata
     TrackId2Rows m_trackIdToRows;
+    TrackId2Row m_trackIdToRow;
     QString m_currentSearch;
     QString m_currentSearchFilter;
     QVector<QHash<int, QVariant>> m_headerInfo;
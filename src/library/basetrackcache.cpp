@@ -474,12 +474,25 @@ void BaseTrackCache::filterAndSort(const QSet<TrackId>& trackIds,
     // TODO(rryan) consider making this the data passed in and a separate
     // QVector for output
     QSet<TrackId> dirtyTracks;
+    // The index contains all tracks of the table. If the given tracks are
+    // exactly those tracks, e.g. for the library view, the filter on the
+    // ids can be omitted. Parsing the ids of a large library would take
+    // longer than the sorted query itself.
+    bool filterByIds = trackIds.size() != m_trackInfo.size();
     for (const auto& trackId: trackIds) {
-        idStrings << trackId.toString();
+        if (!filterByIds && !m_trackInfo.contains(trackId)) {
+            filterByIds = true;
+        }
         if (m_dirtyTracks.contains(trackId)) {
             dirtyTracks.insert(trackId);
         }
     }
+    if (filterByIds) {
+        idStrings.reserve(trackIds.size());
+        for (const auto& trackId : trackIds) {
+            idStrings << trackId.toString();
+        }
+    }
 
     QStringList queryFragments;
     if (!extraFilter.isNull() && extraFilter != "") {
@@ -1,34 +1,44 @@
 #include "library/coverartcache.h"
 
 #include <QFutureWatcher>
-#include <QPixmapCache>
+#include <QThread>
 #include <QtConcurrentRun>
 #include <QtDebug>
 
+#include "library/coverartthumbnailstore.h"
 #include "library/coverartutils.h"
 #include "moc_coverartcache.cpp"
 #include "track/track.h"
 #include "util/logger.h"
+#include "util/math.h"
 #include "util/thread_affinity.h"
 
 namespace {
 
 mixxx::Logger kLogger("CoverArtCache");
 
-// The initial QPixmapCache limit is 10MB.
-// But it is not used just by the coverArt stuff,
-// it is also used by Qt to handle other things behind the scenes.
-// Consequently coverArt cache will always have less than those
-// 10MB available to store the pixmaps.
-// So, we must increase this size a bit more,
-// in order to allow CoverCache handle more covers (performance gain).
-constexpr int kPixmapCacheLimit = 20480;
+// The memory cache for scaled covers is independent of the QPixmapCache
+// that is also used by Qt internally. 32 MiB are enough for about 2000
+// covers of 64x64 pixels on a HiDPI screen.
+constexpr int kPixmapCacheBytes = 32 * 1024 * 1024;
+
+// Loading covers is mostly bound by disk I/O. A few threads suffice to
+// keep up with scrolling and don't compete with the analysis.
+constexpr int kMaxThreadCount = 4;
+
+// Larger covers are only requested occasionally and would waste space
+// in the thumbnail store.
+constexpr int kMaxThumbnailWidth = 512;
 
 QString pixmapCacheKey(mixxx::cache_key_t hash, int width) {
     return QString("CoverArtCache_%1_%2")
             .arg(QString::number(hash), QString::number(width));
 }
 
+int pixmapCost(const QPixmap& pixmap) {
+    return pixmap.width() * pixmap.height() * pixmap.depth() / 8;
+}
+
 // The transformation mode when scaling images
 const Qt::TransformationMode kTransformationMode = Qt::SmoothTransformation;
 
@@ -37,10 +47,60 @@ inline QImage resizeImageWidth(const QImage& image, int width) {
     return image.scaledToWidth(width, kTransformationMode);
 }
 
+// Only covers with an image digest are stored, because the legacy
+// hash is refreshed when loading the original image.
+bool isThumbnailStoreApplicable(const CoverInfo& coverInfo, int desiredWidth) {
+    return desiredWidth > 0 &&
+            desiredWidth <= kMaxThumbnailWidth &&
+            !coverInfo.imageDigest().isEmpty();
+}
+
 } // anonymous namespace
 
-CoverArtCache::CoverArtCache() {
-    QPixmapCache::setCacheLimit(kPixmapCacheLimit);
+CoverArtCache::CoverArtCache()
+        : m_nextSequenceNumber(0),
+          m_numStartedRequests(0),
+          m_pixmapCache(kPixmapCacheBytes) {
+    m_threadPool.setMaxThreadCount(
+            math_clamp(QThread::idealThreadCount() / 2, 1, kMaxThreadCount));
+}
+
+CoverArtCache::~CoverArtCache() {
+    m_pendingRequests.clear();
+    m_threadPool.waitForDone();
+}
+
+void CoverArtCache::setThumbnailDirectory(const QDir& directory) {
+    DEBUG_ASSERT(m_runningRequests.isEmpty());
+    m_pThumbnailStore = std::make_shared<const CoverArtThumbnailStore>(directory);
+    // Thumbnails from previous sessions are only accounted for by
+    // scanning the directory
+    QtConcurrent::run(&m_threadPool, [pThumbnailStore = m_pThumbnailStore] {
+        pThumbnailStore->prune();
+    });
+}
+
+QList<mixxx::cache_key_t> CoverArtCache::cancelPendingRequests(
+        const QObject* pRequestor) {
+    QList<mixxx::cache_key_t> cacheKeys;
+    for (auto it = m_pendingRequests.begin(); it != m_pendingRequests.end();) {
+        if (it->pRequestor == pRequestor) {
+            const auto cacheKey = it->coverInfo.cacheKey();
+            m_runningRequests.remove(qMakePair(pRequestor, cacheKey));
+            cacheKeys.append(cacheKey);
+            it = m_pendingRequests.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (kLogger.traceEnabled() && !cacheKeys.isEmpty()) {
+        kLogger.trace()
+                << "Canceled"
+                << cacheKeys.size()
+                << "pending requests of"
+                << pRequestor;
+    }
+    return cacheKeys;
 }
 
 //static
@@ -113,8 +173,9 @@ QPixmap CoverArtCache::tryLoadCover(
     // performance issues).
     QString cacheKey = pixmapCacheKey(requestedCacheKey, desiredWidth);
 
-    QPixmap pixmap;
-    if (QPixmapCache::find(cacheKey, &pixmap)) {
+    const QPixmap* pCachedPixmap = m_pixmapCache.object(cacheKey);
+    if (pCachedPixmap) {
+        const QPixmap pixmap = *pCachedPixmap;
         if (kLogger.traceEnabled()) {
             kLogger.trace()
                     << "requestCover cache hit"
@@ -136,34 +197,72 @@ QPixmap CoverArtCache::tryLoadCover(
 
     if (kLogger.traceEnabled()) {
         kLogger.trace()
-                << "requestCover starting future for"
+                << "requestCover queueing"
                 << coverInfo;
     }
     m_runningRequests.insert(requestId);
-    // The watcher will be deleted in coverLoaded()
-    QFutureWatcher<FutureResult>* watcher = new QFutureWatcher<FutureResult>(this);
-    QFuture<FutureResult> future = QtConcurrent::run(
-            &CoverArtCache::loadCover,
+    m_pendingRequests.append(PendingRequest{
             pRequestor,
             pTrack,
             coverInfo,
             desiredWidth,
-            loading == Loading::Default);
-    connect(watcher,
-            &QFutureWatcher<FutureResult>::finished,
-            this,
-            &CoverArtCache::coverLoaded);
-    watcher->setFuture(future);
+            loading == Loading::Default,
+            desiredWidth > 0 ? Priority::Low : Priority::High,
+            m_nextSequenceNumber++});
+    startPendingRequests();
     return QPixmap();
 }
 
+void CoverArtCache::startPendingRequests() {
+    while (!m_pendingRequests.isEmpty() &&
+            m_numStartedRequests < m_threadPool.maxThreadCount()) {
+        // Requests are started by priority and in reverse order
+        auto next = m_pendingRequests.begin();
+        for (auto it = next + 1; it != m_pendingRequests.end(); ++it) {
+            if (it->priority > next->priority ||
+                    (it->priority == next->priority &&
+                            it->sequenceNumber > next->sequenceNumber)) {
+                next = it;
+            }
+        }
+        const PendingRequest request = std::move(*next);
+        m_pendingRequests.erase(next);
+
+        if (kLogger.traceEnabled()) {
+            kLogger.trace()
+                    << "requestCover starting future for"
+                    << request.coverInfo;
+        }
+        ++m_numStartedRequests;
+        // The watcher will be deleted in coverLoaded()
+        QFutureWatcher<FutureResult>* watcher = new QFutureWatcher<FutureResult>(this);
+        QFuture<FutureResult> future = QtConcurrent::run(
+                &m_threadPool,
+                [request, pThumbnailStore = m_pThumbnailStore] {
+                    return loadCover(
+                            request.pRequestor,
+                            request.pTrack,
+                            request.coverInfo,
+                            request.desiredWidth,
+                            request.signalWhenDone,
+                            pThumbnailStore);
+                });
+        connect(watcher,
+                &QFutureWatcher<FutureResult>::finished,
+                this,
+                &CoverArtCache::coverLoaded);
+        watcher->setFuture(future);
+    }
+}
+
 //static
 CoverArtCache::FutureResult CoverArtCache::loadCover(
         const QObject* pRequestor,
         TrackPointer pTrack,
         CoverInfo coverInfo,
         int desiredWidth,
-        bool signalWhenDone) {
+        bool signalWhenDone,
+        const std::shared_ptr<const CoverArtThumbnailStore>& pThumbnailStore) {
     if (kLogger.traceEnabled()) {
         kLogger.trace()
                 << "loadCover"
@@ -180,6 +279,23 @@ CoverArtCache::FutureResult CoverArtCache::loadCover(
             signalWhenDone);
     DEBUG_ASSERT(!res.coverInfoUpdated);
 
+    const bool useThumbnailStore = pThumbnailStore &&
+            isThumbnailStoreApplicable(coverInfo, desiredWidth);
+    if (useThumbnailStore) {
+        const auto cacheKey = coverInfo.cacheKey();
+        auto thumbnail = CoverInfo::LoadedImage(CoverInfo::LoadedImage::Result::Ok);
+        thumbnail.image = pThumbnailStore->load(cacheKey, desiredWidth);
+        if (!thumbnail.image.isNull()) {
+            thumbnail.location = pThumbnailStore->filePath(cacheKey, desiredWidth);
+            res.loadedFromThumbnailStore = true;
+            res.coverArt = CoverArt(
+                    std::move(coverInfo),
+                    std::move(thumbnail),
+                    desiredWidth);
+            return res;
+        }
+    }
+
     auto loadedImage = coverInfo.loadImage(
             pTrack ? pTrack->getFileAccess().token() : SecurityTokenPointer());
     if (!loadedImage.image.isNull()) {
@@ -197,6 +313,10 @@ CoverArtCache::FutureResult CoverArtCache::loadCover(
             // Adjust the cover size according to the request
             // or downsize the image for efficiency.
             loadedImage.image = resizeImageWidth(loadedImage.image, desiredWidth);
+            // The digest might have been updated from the legacy hash
+            if (useThumbnailStore && !res.coverInfoUpdated) {
+                pThumbnailStore->save(coverInfo.cacheKey(), loadedImage.image);
+            }
         }
     }
 
@@ -219,6 +339,8 @@ void CoverArtCache::coverLoaded() {
         res = pFutureWatcher->result();
         pFutureWatcher->deleteLater();
     }
+    --m_numStartedRequests;
+    DEBUG_ASSERT(m_numStartedRequests >= 0);
 
     if (kLogger.traceEnabled()) {
         kLogger.trace() << "coverLoaded" << res.coverArt;
@@ -261,11 +383,12 @@ void CoverArtCache::coverLoaded() {
             // be displayed when loaded from the cache.
             QString cacheKey = pixmapCacheKey(
                     res.coverArt.cacheKey(), res.coverArt.resizedToWidth);
-            QPixmapCache::insert(cacheKey, pixmap);
+            m_pixmapCache.insert(cacheKey, new QPixmap(pixmap), pixmapCost(pixmap));
         }
     }
 
     m_runningRequests.remove(qMakePair(res.pRequestor, res.requestedCacheKey));
+    startPendingRequests();
 
     if (res.signalWhenDone) {
         emit coverFound(
@@ -1,15 +1,22 @@
 #pragma once
 
+#include <QCache>
+#include <QDir>
+#include <QList>
 #include <QObject>
 #include <QPair>
 #include <QPixmap>
 #include <QSet>
+#include <QThreadPool>
 #include <QtDebug>
+#include <memory>
 
 #include "library/coverart.h"
 #include "track/track_decl.h"
 #include "util/singleton.h"
 
+class CoverArtThumbnailStore;
+
 class CoverArtCache : public QObject, public Singleton<CoverArtCache> {
     Q_OBJECT
   public:
@@ -52,13 +59,24 @@ class CoverArtCache : public QObject, public Singleton<CoverArtCache> {
                 loading);
     }
 
+    /// Enables the persistent store for scaled covers in directory.
+    /// Covers that are not in the memory cache are loaded from there
+    /// instead of decoding and scaling the original image again.
+    void setThumbnailDirectory(const QDir& directory);
+
+    /// Drops all requests of pRequestor that have not been started yet,
+    /// e.g. because the rows are no longer visible. Returns the cache keys
+    /// of the dropped requests, no coverFound signal is emitted for them.
+    QList<mixxx::cache_key_t> cancelPendingRequests(const QObject* pRequestor);
+
     // Only public for testing
     struct FutureResult {
         FutureResult()
                 : pRequestor(nullptr),
                   requestedCacheKey(CoverImageUtils::defaultCacheKey()),
                   signalWhenDone(false),
-                  coverInfoUpdated(false) {
+                  coverInfoUpdated(false),
+                  loadedFromThumbnailStore(false) {
         }
         FutureResult(
                 const QObject* pRequestorArg,
@@ -67,7 +85,8 @@ class CoverArtCache : public QObject, public Singleton<CoverArtCache> {
                 : pRequestor(pRequestorArg),
                   requestedCacheKey(requestedCacheKeyArg),
                   signalWhenDone(signalWhenDoneArg),
-                  coverInfoUpdated(false) {
+                  coverInfoUpdated(false),
+                  loadedFromThumbnailStore(false) {
         }
 
         const QObject* pRequestor;
@@ -76,15 +95,19 @@ class CoverArtCache : public QObject, public Singleton<CoverArtCache> {
 
         CoverArt coverArt;
         bool coverInfoUpdated;
+        bool loadedFromThumbnailStore;
     };
-    // Load cover from path indicated in coverInfo. WARNING: This is run in a
-    // worker thread.
+    // Load cover from path indicated in coverInfo. Scaled covers are read
+    // from and written to pThumbnailStore if available. WARNING: This is
+    // run in a worker thread.
     static FutureResult loadCover(
             const QObject* pRequestor,
             TrackPointer pTrack,
             CoverInfo coverInfo,
             int desiredWidth,
-            bool emitSignals);
+            bool emitSignals,
+            const std::shared_ptr<const CoverArtThumbnailStore>& pThumbnailStore =
+                    nullptr);
 
   private slots:
     // Called when loadCover is complete in the main thread.
@@ -100,7 +123,7 @@ class CoverArtCache : public QObject, public Singleton<CoverArtCache> {
 
   protected:
     CoverArtCache();
-    ~CoverArtCache() override = default;
+    ~CoverArtCache() override;
     friend class Singleton<CoverArtCache>;
 
   private:
@@ -116,7 +139,37 @@ class CoverArtCache : public QObject, public Singleton<CoverArtCache> {
             int desiredWidth,
             Loading loading);
 
+    /// Full size covers are displayed in widgets and are loaded before
+    /// the scaled covers of the library table.
+    enum class Priority {
+        Low,
+        High,
+    };
+
+    struct PendingRequest {
+        const QObject* pRequestor;
+        TrackPointer pTrack;
+        CoverInfo coverInfo;
+        int desiredWidth;
+        bool signalWhenDone;
+        Priority priority;
+        /// Newer requests are started first. They are more likely to be
+        /// visible while the user is scrolling.
+        quint64 sequenceNumber;
+    };
+
+    void startPendingRequests();
+
+    /// Requests that are either pending or running
     QSet<QPair<const QObject*, mixxx::cache_key_t>> m_runningRequests;
+    QList<PendingRequest> m_pendingRequests;
+    quint64 m_nextSequenceNumber;
+    int m_numStartedRequests;
+
+    /// The cost of each entry is the size of the pixmap in bytes
+    QCache<QString, QPixmap> m_pixmapCache;
+    std::shared_ptr<const CoverArtThumbnailStore> m_pThumbnailStore;
+    QThreadPool m_threadPool;
 };
 
 inline
@@ -57,7 +57,21 @@ void CoverArtDelegate::emitRowsChanged(
 void CoverArtDelegate::slotInhibitLazyLoading(
         bool inhibitLazyLoading) {
     m_inhibitLazyLoading = inhibitLazyLoading;
-    if (m_inhibitLazyLoading || m_cacheMissRows.isEmpty()) {
+    if (m_inhibitLazyLoading) {
+        // Requests that have not been started yet are most likely
+        // for rows that are scrolled out of view. Their rows are
+        // requested again when lazy loading is resumed and only
+        // the visible ones will actually be painted.
+        if (m_pCache) {
+            const auto canceledCacheKeys = m_pCache->cancelPendingRequests(this);
+            for (const auto cacheKey : canceledCacheKeys) {
+                m_cacheMissRows.append(m_pendingCacheRows.values(cacheKey));
+                m_pendingCacheRows.remove(cacheKey);
+            }
+        }
+        return;
+    }
+    if (m_cacheMissRows.isEmpty()) {
         return;
     }
     // If we can request non-cache covers now, request updates
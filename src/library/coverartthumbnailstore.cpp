@@ -0,0 +1,178 @@
+#include "library/coverartthumbnailstore.h"
+
+#include <QDateTime>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageWriter>
+#include <QSaveFile>
+#include <algorithm>
+#include <vector>
+
+#include "util/assert.h"
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("CoverArtThumbnailStore");
+
+// Thumbnails without transparency are stored as JPEG. They are small
+// and the difference in quality is not visible in the library table.
+constexpr int kJpegQuality = 90;
+
+// Pruning leaves some headroom, so that the whole directory is not
+// scanned again after saving the next few thumbnails.
+constexpr qint64 kPruneTargetPercent = 80;
+
+// Updating the modification time costs a write. The order of thumbnails
+// that have been used on the same day doesn't matter.
+constexpr qint64 kTouchIntervalSecs = 24 * 60 * 60;
+
+void touchFile(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadWrite)) {
+        return;
+    }
+    file.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+}
+
+} // anonymous namespace
+
+CoverArtThumbnailStore::CoverArtThumbnailStore(const QDir& directory,
+        qint64 maxBytes)
+        : m_directory(directory),
+          m_maxBytes(maxBytes),
+          m_estimatedBytes(0) {
+    DEBUG_ASSERT(m_maxBytes > 0);
+}
+
+QString CoverArtThumbnailStore::filePath(
+        mixxx::cache_key_t cacheKey, int width) const {
+    // The file has no suffix, because the format depends on the image.
+    // QImage detects it from the contents when loading.
+    return m_directory.filePath(
+            QStringLiteral("%1/%2_%3")
+                    .arg(cacheKey & 0xff, 2, 16, QChar('0'))
+                    .arg(cacheKey, 16, 16, QChar('0'))
+                    .arg(width));
+}
+
+QImage CoverArtThumbnailStore::load(
+        mixxx::cache_key_t cacheKey, int width) const {
+    DEBUG_ASSERT(width > 0);
+    QImage image;
+    const QString path = filePath(cacheKey, width);
+    if (!QFile::exists(path)) {
+        return image;
+    }
+    if (!image.load(path) || image.width() != width) {
+        kLogger.warning()
+                << "Ignoring invalid thumbnail"
+                << path;
+        QFile::remove(path);
+        return QImage();
+    }
+    if (QFileInfo(path).lastModified().secsTo(QDateTime::currentDateTime()) >
+            kTouchIntervalSecs) {
+        touchFile(path);
+    }
+    return image;
+}
+
+bool CoverArtThumbnailStore::save(
+        mixxx::cache_key_t cacheKey, const QImage& image) const {
+    VERIFY_OR_DEBUG_ASSERT(!image.isNull()) {
+        return false;
+    }
+    const QString path = filePath(cacheKey, image.width());
+    if (!m_directory.mkpath(QFileInfo(path).path())) {
+        kLogger.warning()
+                << "Failed to create directory for"
+                << path;
+        return false;
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        kLogger.warning()
+                << "Failed to open"
+                << path
+                << file.errorString();
+        return false;
+    }
+    const bool hasAlpha = image.hasAlphaChannel();
+    QImageWriter writer(&file, hasAlpha ? "png" : "jpg");
+    if (!hasAlpha) {
+        writer.setQuality(kJpegQuality);
+    }
+    if (!writer.write(image)) {
+        kLogger.warning()
+                << "Failed to write"
+                << path
+                << writer.errorString();
+        file.cancelWriting();
+        return false;
+    }
+    const qint64 fileSize = file.size();
+    if (!file.commit()) {
+        return false;
+    }
+    // Replaced files are counted twice until the next prune()
+    if (m_estimatedBytes.fetch_add(fileSize, std::memory_order_relaxed) +
+                    fileSize >
+            m_maxBytes) {
+        prune();
+    }
+    return true;
+}
+
+int CoverArtThumbnailStore::prune() const {
+    if (!m_pruneMutex.tryLock()) {
+        return 0;
+    }
+
+    struct Thumbnail {
+        QDateTime lastModified;
+        qint64 size;
+        QString path;
+    };
+    std::vector<Thumbnail> thumbnails;
+    qint64 totalBytes = 0;
+    QDirIterator it(m_directory.path(), QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        const QFileInfo fileInfo = it.fileInfo();
+        thumbnails.push_back(Thumbnail{
+                fileInfo.lastModified(), fileInfo.size(), fileInfo.filePath()});
+        totalBytes += fileInfo.size();
+    }
+
+    int numDeleted = 0;
+    if (totalBytes > m_maxBytes) {
+        std::sort(thumbnails.begin(),
+                thumbnails.end(),
+                [](const Thumbnail& lhs, const Thumbnail& rhs) {
+                    return lhs.lastModified < rhs.lastModified;
+                });
+        const qint64 targetBytes = m_maxBytes * kPruneTargetPercent / 100;
+        for (const auto& thumbnail : thumbnails) {
+            if (totalBytes <= targetBytes) {
+                break;
+            }
+            if (QFile::remove(thumbnail.path)) {
+                totalBytes -= thumbnail.size;
+                ++numDeleted;
+            }
+        }
+        kLogger.info()
+                << "Deleted"
+                << numDeleted
+                << "least recently used thumbnails,"
+                << totalBytes
+                << "bytes left";
+    }
+    m_estimatedBytes.store(totalBytes, std::memory_order_relaxed);
+
+    m_pruneMutex.unlock();
+    return numDeleted;
+}
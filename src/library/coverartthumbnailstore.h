@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QDir>
+#include <QImage>
+#include <QMutex>
+#include <QString>
+#include <atomic>
+
+#include "util/cache.h"
+
+/// A persistent store for scaled cover art images.
+///
+/// Thumbnails are keyed by the cache key of the original image, i.e. its
+/// digest, and the width they have been scaled to. They are stored as
+/// individual files that are distributed over 256 subdirectories to keep
+/// the directories small for large libraries.
+///
+/// The size of the store is limited to maxBytes. If it grows beyond,
+/// the least recently used thumbnails are deleted. The modification time
+/// of the files is used for this and updated at most once a day when a
+/// thumbnail is loaded. The store should be pruned once on startup,
+/// because the size is only tracked for the files saved afterwards.
+///
+/// All member functions are thread-safe. Writes are atomic, so a
+/// concurrent read either sees the complete thumbnail or none.
+class CoverArtThumbnailStore {
+  public:
+    static constexpr qint64 kDefaultMaxBytes = 100 * 1024 * 1024;
+
+    explicit CoverArtThumbnailStore(const QDir& directory,
+            qint64 maxBytes = kDefaultMaxBytes);
+
+    const QDir& directory() const {
+        return m_directory;
+    }
+
+    /// Returns a null image if no thumbnail has been stored
+    QImage load(mixxx::cache_key_t cacheKey, int width) const;
+    bool save(mixxx::cache_key_t cacheKey, const QImage& image) const;
+
+    QString filePath(mixxx::cache_key_t cacheKey, int width) const;
+
+    qint64 maxBytes() const {
+        return m_maxBytes;
+    }
+    /// The total size of all thumbnails as of the last prune() plus the
+    /// thumbnails that have been saved since.
+    qint64 estimatedBytes() const {
+        return m_estimatedBytes.load(std::memory_order_relaxed);
+    }
+
+    /// Scans the whole store and deletes the least recently used
+    /// thumbnails if it exceeds maxBytes, until 80% of maxBytes are left.
+    /// Returns the number of deleted files. Does nothing and returns 0 if
+    /// another thread is pruning the store.
+    int prune() const;
+
+  private:
+    const QDir m_directory;
+    const qint64 m_maxBytes;
+
+    mutable std::atomic<qint64> m_estimatedBytes;
+    mutable QMutex m_pruneMutex;
+};
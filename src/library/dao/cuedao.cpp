@@ -10,6 +10,7 @@
 #include "util/assert.h"
 #include "util/color/rgbcolor.h"
 #include "util/db/fwdsqlquery.h"
+#include "util/db/sqlstatementcache.h"
 #include "util/logger.h"
 #include "util/performancetimer.h"
 
@@ -67,14 +68,13 @@ QList<CuePointer> CueDAO::getCuesForTrack(TrackId trackId) const {
     //qDebug() << "CueDAO::getCuesForTrack" << QThread::currentThread() << m_database.connectionName();
     QList<CuePointer> cues;
 
-    FwdSqlQuery query(
+    CachedSqlQuery query(
             m_database,
             QStringLiteral("SELECT * FROM " CUE_TABLE " WHERE track_id=:id"));
-    DEBUG_ASSERT(
-            query.isPrepared() &&
-            !query.hasError());
-    query.bindValue(":id", trackId.toVariant());
-    if (!query.execPrepared()) {
+    DEBUG_ASSERT(query.isPrepared());
+    query->bindValue(":id", trackId.toVariant());
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(*query);
         kLogger.warning()
                 << "Failed to load cues of track"
                 << trackId;
@@ -82,8 +82,8 @@ QList<CuePointer> CueDAO::getCuesForTrack(TrackId trackId) const {
         return cues;
     }
     QMap<int, CuePointer> hotCuesByNumber;
-    while (query.next()) {
-        CuePointer pCue = cueFromRow(query.record());
+    while (query->next()) {
+        CuePointer pCue = cueFromRow(query->record());
         VERIFY_OR_DEBUG_ASSERT(pCue) {
             continue;
         }
@@ -107,13 +107,13 @@ QList<CuePointer> CueDAO::getCuesForTrack(TrackId trackId) const {
 
 bool CueDAO::deleteCuesForTrack(TrackId trackId) const {
     qDebug() << "CueDAO::deleteCuesForTrack" << QThread::currentThread() << m_database.connectionName();
-    QSqlQuery query(m_database);
-    query.prepare(QStringLiteral("DELETE FROM " CUE_TABLE " WHERE track_id=:track_id"));
-    query.bindValue(":track_id", trackId.toVariant());
+    CachedSqlQuery query(m_database,
+            QStringLiteral("DELETE FROM " CUE_TABLE " WHERE track_id=:track_id"));
+    query->bindValue(":track_id", trackId.toVariant());
     if (query.exec()) {
         return true;
     } else {
-        LOG_FAILED_QUERY(query);
+        LOG_FAILED_QUERY(*query);
     }
     return false;
 }
@@ -144,44 +144,43 @@ bool CueDAO::saveCue(TrackId trackId, Cue* cue) const {
     }
 
     // Prepare query
-    QSqlQuery query(m_database);
+    CachedSqlQuery query(m_database,
+            cue->getId().isValid()
+                    // Update cue
+                    ? QStringLiteral("UPDATE " CUE_TABLE " SET "
+                                     "track_id=:track_id,"
+                                     "type=:type,"
+                                     "position=:position,"
+                                     "length=:length,"
+                                     "hotcue=:hotcue,"
+                                     "label=:label,"
+                                     "color=:color"
+                                     " WHERE id=:id")
+                    // New cue
+                    : QStringLiteral("INSERT INTO " CUE_TABLE
+                                     " (track_id, type, position, length, hotcue, "
+                                     "label, color) VALUES (:track_id, :type, "
+                                     ":position, :length, :hotcue, :label, :color)"));
     if (cue->getId().isValid()) {
-        // Update cue
-        query.prepare(QStringLiteral("UPDATE " CUE_TABLE " SET "
-                        "track_id=:track_id,"
-                        "type=:type,"
-                        "position=:position,"
-                        "length=:length,"
-                        "hotcue=:hotcue,"
-                        "label=:label,"
-                        "color=:color"
-                        " WHERE id=:id"));
-        query.bindValue(":id", cue->getId().toVariant());
-    } else {
-        // New cue
-        query.prepare(
-                QStringLiteral("INSERT INTO " CUE_TABLE
-                               " (track_id, type, position, length, hotcue, "
-                               "label, color) VALUES (:track_id, :type, "
-                               ":position, :length, :hotcue, :label, :color)"));
+        query->bindValue(":id", cue->getId().toVariant());
     }
 
     // Bind values and execute query
-    query.bindValue(":track_id", trackId.toVariant());
-    query.bindValue(":type", static_cast<int>(cue->getType()));
-    query.bindValue(":position", cue->getPosition().toEngineSamplePosMaybeInvalid());
-    query.bindValue(":length", cue->getLengthFrames() * mixxx::kEngineChannelCount);
-    query.bindValue(":hotcue", cue->getHotCue());
-    query.bindValue(":label", labelToQVariant(cue->getLabel()));
-    query.bindValue(":color", mixxx::RgbColor::toQVariant(cue->getColor()));
+    query->bindValue(":track_id", trackId.toVariant());
+    query->bindValue(":type", static_cast<int>(cue->getType()));
+    query->bindValue(":position", cue->getPosition().toEngineSamplePosMaybeInvalid());
+    query->bindValue(":length", cue->getLengthFrames() * mixxx::kEngineChannelCount);
+    query->bindValue(":hotcue", cue->getHotCue());
+    query->bindValue(":label", labelToQVariant(cue->getLabel()));
+    query->bindValue(":color", mixxx::RgbColor::toQVariant(cue->getColor()));
     if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
+        LOG_FAILED_QUERY(*query);
         return false;
     }
 
     if (!cue->getId().isValid()) {
         // New cue
-        const auto newId = DbId(query.lastInsertId());
+        const auto newId = DbId(query->lastInsertId());
         DEBUG_ASSERT(newId.isValid());
         cue->setId(newId);
     }
@@ -195,11 +194,11 @@ bool CueDAO::deleteCue(Cue* cue) const {
     if (!cue->getId().isValid()) {
         return false;
     }
-    QSqlQuery query(m_database);
-    query.prepare(QStringLiteral("DELETE FROM " CUE_TABLE " WHERE id=:id"));
-    query.bindValue(":id", cue->getId().toVariant());
+    CachedSqlQuery query(m_database,
+            QStringLiteral("DELETE FROM " CUE_TABLE " WHERE id=:id"));
+    query->bindValue(":id", cue->getId().toVariant());
     if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
+        LOG_FAILED_QUERY(*query);
         return false;
     }
     return true;
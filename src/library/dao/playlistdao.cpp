@@ -17,34 +17,34 @@ PlaylistDAO::PlaylistDAO()
         : m_pAutoDJProcessor(nullptr) {
 }
 
-void PlaylistDAO::initialize(const QSqlDatabase& database) {
-    DAO::initialize(database);
-    populatePlaylistMembershipCache();
+void PlaylistDAO::populateMembershipIndexInBackground(
+        const mixxx::DbConnectionPoolPtr& pDbConnectionPool) {
+    m_playlistMembership.populateInBackground(pDbConnectionPool,
+            QStringLiteral(PLAYLIST_TRACKS_TABLE),
+            PLAYLISTTRACKSTABLE_PLAYLISTID);
 }
 
-void PlaylistDAO::populatePlaylistMembershipCache() {
-    // Minor optimization: reserve space in m_playlistsTrackIsIn.
-    QSqlQuery query(m_database);
-    query.prepare(QStringLiteral("SELECT COUNT(*) from " PLAYLIST_TRACKS_TABLE));
-    if (query.exec() && query.next()) {
-        m_playlistsTrackIsIn.reserve(query.value(0).toInt());
-    } else {
-        LOG_FAILED_QUERY(query);
+bool PlaylistDAO::isMembershipIndexAvailable() const {
+    if (m_playlistMembership.isPopulated()) {
+        return true;
     }
-
-    // now fetch all Tracks from all playlists and insert them into the hashmap
-    query.prepare(QStringLiteral(
-            "SELECT track_id, playlist_id from " PLAYLIST_TRACKS_TABLE));
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
+    if (m_playlistMembership.isPopulatingInBackground()) {
+        // Don't wait for the worker thread
+        return m_playlistMembership.finishPopulatingInBackground();
     }
+    return m_playlistMembership.populate(m_database,
+            QStringLiteral(PLAYLIST_TRACKS_TABLE),
+            PLAYLISTTRACKSTABLE_PLAYLISTID);
+}
 
-    const int trackIdColumn = query.record().indexOf(PLAYLISTTRACKSTABLE_TRACKID);
-    const int playlistIdColumn = query.record().indexOf(PLAYLISTTRACKSTABLE_PLAYLISTID);
-    while (query.next()) {
-        m_playlistsTrackIsIn.insert(TrackId(query.value(trackIdColumn)),
-                query.value(playlistIdColumn).toInt());
+QSet<int> PlaylistDAO::containerIdsOfTrack(TrackId trackId) const {
+    if (isMembershipIndexAvailable()) {
+        return m_playlistMembership.containerIdSet(trackId);
     }
+    return TrackMembershipIndex::queryContainerIdSet(m_database,
+            QStringLiteral(PLAYLIST_TRACKS_TABLE),
+            PLAYLISTTRACKSTABLE_PLAYLISTID,
+            trackId);
 }
 
 int PlaylistDAO::createPlaylist(const QString& name, const HiddenType hidden) {
@@ -212,14 +212,7 @@ void PlaylistDAO::deletePlaylist(const int playlistId) {
     transaction.commit();
     //TODO: Crap, we need to shuffle the positions of all the playlists?
 
-    for (QMultiHash<TrackId, int>::iterator it = m_playlistsTrackIsIn.begin();
-            it != m_playlistsTrackIsIn.end();) {
-        if (it.value() == playlistId) {
-            it = m_playlistsTrackIsIn.erase(it);
-        } else {
-            ++it;
-        }
-    }
+    m_playlistMembership.removeContainer(playlistId);
 
     emit deleted(playlistId);
     if (!playedTrackIds.isEmpty()) {
@@ -325,6 +318,20 @@ bool PlaylistDAO::removeTracksFromPlaylist(int playlistId, int startIndex) {
     // Retain the first track if it is loaded in a deck
     ScopedTransaction transaction(m_database);
     QSqlQuery query(m_database);
+    query.prepare(QStringLiteral(
+            "SELECT track_id FROM PlaylistTracks "
+            "WHERE playlist_id=:id AND position>=:pos"));
+    query.bindValue(":id", playlistId);
+    query.bindValue(":pos", startIndex);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return false;
+    }
+    QList<TrackId> removedTrackIds;
+    while (query.next()) {
+        removedTrackIds.append(TrackId(query.value(0)));
+    }
+
     query.prepare(QStringLiteral(
             "DELETE FROM PlaylistTracks "
             "WHERE playlist_id=:id AND position>=:pos"));
@@ -335,6 +342,10 @@ bool PlaylistDAO::removeTracksFromPlaylist(int playlistId, int startIndex) {
         return false;
     }
     transaction.commit();
+
+    for (const auto& trackId : qAsConst(removedTrackIds)) {
+        m_playlistMembership.remove(trackId, playlistId);
+    }
     emit tracksChanged(QSet<int>{playlistId});
     return true;
 }
@@ -373,7 +384,7 @@ bool PlaylistDAO::appendTracksToPlaylist(const QList<TrackId>& trackIds, const i
 
     insertPosition = position;
     for (const auto& trackId : trackIds) {
-        m_playlistsTrackIsIn.insert(trackId, playlistId);
+        m_playlistMembership.insert(trackId, playlistId);
         // TODO(XXX) don't emit if the track didn't add successfully.
         emit trackAdded(playlistId, trackId, insertPosition++);
     }
@@ -526,17 +537,86 @@ void PlaylistDAO::removeTrackFromPlaylist(int playlistId, int position) {
 }
 
 void PlaylistDAO::removeTracksFromPlaylist(int playlistId, const QList<int>& positions) {
-    // get positions in reversed order
-    auto sortedPositons = positions;
-    std::sort(sortedPositons.begin(), sortedPositons.end(), std::greater<int>());
+    auto sortedPositions = positions;
+    std::sort(sortedPositions.begin(), sortedPositions.end());
+    sortedPositions.erase(
+            std::unique(sortedPositions.begin(), sortedPositions.end()),
+            sortedPositions.end());
+    if (sortedPositions.isEmpty()) {
+        return;
+    }
+    QStringList positionList;
+    positionList.reserve(sortedPositions.size());
+    for (const auto position : qAsConst(sortedPositions)) {
+        positionList.append(QString::number(position));
+    }
+    const QString positionsSql = positionList.join(QChar(','));
 
     //qDebug() << "PlaylistDAO::removeTrackFromPlaylist"
     //         << QThread::currentThread() << m_database.connectionName();
     ScopedTransaction transaction(m_database);
-    for (const auto position : qAsConst(sortedPositons)) {
-        removeTracksFromPlaylistInner(playlistId, position);
+    QSqlQuery query(m_database);
+    query.prepare(QStringLiteral(
+            "SELECT track_id, position FROM PlaylistTracks "
+            "WHERE playlist_id=:id AND position IN (%1) "
+            "ORDER BY position DESC")
+                          .arg(positionsSql));
+    query.bindValue(":id", playlistId);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return;
+    }
+    QList<QPair<TrackId, int>> removedTracks;
+    const int trackIdColumn = query.record().indexOf("track_id");
+    const int positionColumn = query.record().indexOf("position");
+    while (query.next()) {
+        removedTracks.append(qMakePair(
+                TrackId(query.value(trackIdColumn)),
+                query.value(positionColumn).toInt()));
+    }
+    if (removedTracks.isEmpty()) {
+        qDebug() << "removeTracksFromPlaylist no tracks exist at positions:"
+                 << positions << "in playlist:" << playlistId;
+        return;
+    }
+
+    query.prepare(QStringLiteral(
+            "DELETE FROM PlaylistTracks "
+            "WHERE playlist_id=:id AND position IN (%1)")
+                          .arg(positionsSql));
+    query.bindValue(":id", playlistId);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return;
+    }
+
+    // Close all gaps with a single statement
+    const QString numRemovedBelow = sqlNumValuesBelowExpression(
+            m_database, QStringLiteral("PlaylistTracks.position"), sortedPositions);
+    if (numRemovedBelow.isNull()) {
+        return;
+    }
+    query.prepare(QStringLiteral(
+            "UPDATE PlaylistTracks SET position=position-(%1) "
+            "WHERE playlist_id=:id AND position>:position")
+                          .arg(numRemovedBelow));
+    query.bindValue(":id", playlistId);
+    query.bindValue(":position", sortedPositions.first());
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return;
     }
     transaction.commit();
+
+    QSet<TrackId> removedTrackIds;
+    for (const auto& removedTrack : qAsConst(removedTracks)) {
+        m_playlistMembership.remove(removedTrack.first, playlistId);
+        removedTrackIds.insert(removedTrack.first);
+        emit trackRemoved(playlistId, removedTrack.first, removedTrack.second);
+    }
+    if (getHiddenType(playlistId) == PLHT_SET_LOG) {
+        emit tracksRemovedFromPlayedHistory(removedTrackIds);
+    }
     emit tracksChanged(QSet<int>{playlistId});
 }
 
@@ -582,7 +662,7 @@ void PlaylistDAO::removeTracksFromPlaylistInner(int playlistId, int position) {
         LOG_FAILED_QUERY(query);
     }
 
-    m_playlistsTrackIsIn.remove(trackId, playlistId);
+    m_playlistMembership.remove(trackId, playlistId);
 
     emit trackRemoved(playlistId, trackId, position);
     if (getHiddenType(playlistId) == PLHT_SET_LOG) {
@@ -630,7 +710,7 @@ bool PlaylistDAO::insertTrackIntoPlaylist(TrackId trackId, const int playlistId,
     }
     transaction.commit();
 
-    m_playlistsTrackIsIn.insert(trackId, playlistId);
+    m_playlistMembership.insert(trackId, playlistId);
     emit trackAdded(playlistId, trackId, position);
     emit tracksChanged(QSet<int>{playlistId});
     return true;
@@ -643,7 +723,18 @@ int PlaylistDAO::insertTracksIntoPlaylist(const QList<TrackId>& trackIds,
         return 0;
     }
 
-    int tracksAdded = 0;
+    QVariantList insertTrackIds;
+    insertTrackIds.reserve(trackIds.size());
+    for (const auto& trackId : trackIds) {
+        if (trackId.isValid()) {
+            insertTrackIds.append(trackId.toVariant());
+        }
+    }
+    if (insertTrackIds.isEmpty()) {
+        return 0;
+    }
+    const int tracksAdded = static_cast<int>(insertTrackIds.size());
+
     ScopedTransaction transaction(m_database);
 
     int max_position = getMaxPosition(playlistId) + 1;
@@ -652,51 +743,48 @@ int PlaylistDAO::insertTracksIntoPlaylist(const QList<TrackId>& trackIds,
         position = max_position;
     }
 
-    QSqlQuery insertQuery(m_database);
-    insertQuery.prepare(QStringLiteral(
-            "INSERT INTO PlaylistTracks (playlist_id, track_id, position)"
-            "VALUES (:playlist_id, :track_id, :position)"));
+    // Make room for all tracks at once
     QSqlQuery query(m_database);
-    int insertPositon = position;
-    for (const auto& trackId : trackIds) {
-        if (!trackId.isValid()) {
-            continue;
-        }
-        // Move all tracks in playlist up by 1.
-        // TODO(XXX) We could do this in one query before the for loop.
-        query.prepare(QStringLiteral(
-                "UPDATE PlaylistTracks SET position=position+1 "
-                "WHERE position>=:position AND "
-                "playlist_id=:id"));
-        query.bindValue(":id", playlistId);
-        query.bindValue(":position", insertPositon);
-
-        if (!query.exec()) {
-            LOG_FAILED_QUERY(query);
-            continue;
-        }
-
-        // Insert the track at the given position
-        insertQuery.bindValue(":playlist_id", playlistId);
-        insertQuery.bindValue(":track_id", trackId.toVariant());
-        insertQuery.bindValue(":position", insertPositon);
-        if (!insertQuery.exec()) {
-            LOG_FAILED_QUERY(insertQuery);
-            continue;
-        }
+    query.prepare(QStringLiteral(
+            "UPDATE PlaylistTracks SET position=position+:count "
+            "WHERE position>=:position AND "
+            "playlist_id=:id"));
+    query.bindValue(":id", playlistId);
+    query.bindValue(":position", position);
+    query.bindValue(":count", tracksAdded);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return 0;
+    }
 
-        // Increment the insert position for the track.
-        ++insertPositon;
-        ++tracksAdded;
+    QVariantList insertPlaylistIds;
+    QVariantList insertPositions;
+    insertPlaylistIds.reserve(tracksAdded);
+    insertPositions.reserve(tracksAdded);
+    for (int i = 0; i < tracksAdded; ++i) {
+        insertPlaylistIds.append(playlistId);
+        insertPositions.append(position + i);
+    }
+    query.prepare(QStringLiteral(
+            "INSERT INTO PlaylistTracks (playlist_id, track_id, position)"
+            "VALUES (:playlist_id, :track_id, :position)"));
+    query.bindValue(":playlist_id", insertPlaylistIds);
+    query.bindValue(":track_id", insertTrackIds);
+    query.bindValue(":position", insertPositions);
+    if (!query.execBatch()) {
+        LOG_FAILED_QUERY(query);
+        return 0;
     }
 
     transaction.commit();
 
-    insertPositon = position;
+    int insertPosition = position;
     for (const auto& trackId : trackIds) {
-        m_playlistsTrackIsIn.insert(trackId, playlistId);
-        // TODO(XXX) The position is wrong if any track failed to insert.
-        emit trackAdded(playlistId, trackId, insertPositon++);
+        if (!trackId.isValid()) {
+            continue;
+        }
+        m_playlistMembership.insert(trackId, playlistId);
+        emit trackAdded(playlistId, trackId, insertPosition++);
     }
     emit tracksChanged(QSet<int>{playlistId});
     return tracksAdded;
@@ -804,7 +892,7 @@ bool PlaylistDAO::copyPlaylistTracks(const int sourcePlaylistID, const int targe
     while (query.next()) {
         TrackId copiedTrackId(query.value(0));
         int copiedPosition = query.value(1).toInt();
-        m_playlistsTrackIsIn.insert(copiedTrackId, targetPlaylistID);
+        m_playlistMembership.insert(copiedTrackId, targetPlaylistID);
         emit trackAdded(targetPlaylistID, copiedTrackId, copiedPosition);
     }
     emit tracksChanged(QSet<int>{targetPlaylistID});
@@ -832,24 +920,19 @@ int PlaylistDAO::getMaxPosition(const int playlistId) const {
 }
 
 void PlaylistDAO::removeTracksFromPlaylists(const QList<TrackId>& trackIds) {
-    // copy the hash, because there is no guarantee that "it" is valid after remove
-    QMultiHash<TrackId, int> playlistsTrackIsInCopy = m_playlistsTrackIsIn;
     QSet<int> playlistIds;
 
     ScopedTransaction transaction(m_database);
     for (const auto& trackId : trackIds) {
-        for (auto it = playlistsTrackIsInCopy.constBegin();
-                it != playlistsTrackIsInCopy.constEnd();
-                ++it) {
-            if (it.key() == trackId) {
-                const auto playlistId = it.value();
-                // keep tracks in history playlists
-                if (getHiddenType(playlistId) == PlaylistDAO::PLHT_SET_LOG) {
-                    continue;
-                }
-                removeTracksFromPlaylistByIdInner(playlistId, trackId);
-                playlistIds.insert(playlistId);
+        // Copy the ids, because the index is modified while removing
+        const QSet<int> trackContainerIds = containerIdsOfTrack(trackId);
+        for (const int playlistId : trackContainerIds) {
+            // keep tracks in history playlists
+            if (getHiddenType(playlistId) == PlaylistDAO::PLHT_SET_LOG) {
+                continue;
             }
+            removeTracksFromPlaylistByIdInner(playlistId, trackId);
+            playlistIds.insert(playlistId);
         }
     }
     transaction.commit();
@@ -877,70 +960,64 @@ int PlaylistDAO::tracksInPlaylist(const int playlistId) const {
 }
 
 void PlaylistDAO::moveTrack(const int playlistId, const int oldPosition, const int newPosition) {
-    ScopedTransaction transaction(m_database);
-    QSqlQuery query(m_database);
+    moveTracks(playlistId, oldPosition, 1, newPosition);
+}
 
-    // Algorithm for code below
-    // Case 1: destination < source (newPositon < oldPosition)
-    //    1) Set position = -1 where pos=source -- Gives that track a dummy index to keep stuff simple.
-    //    2) Decrement position where pos >= dest AND pos < source
-    //    3) Set position = dest where pos=-1 -- Move track from dummy pos to final destination.
+bool PlaylistDAO::moveTracks(const int playlistId,
+        const int firstPosition,
+        const int count,
+        int newPosition) {
+    if (playlistId < 0 || firstPosition < 1 || count < 1 || newPosition < 1) {
+        return false;
+    }
 
-    // Case 2: destination > source (newPos > oldPos)
-    //   1) Set position=-1 where pos=source -- Give track a dummy index again.
-    //   2) Decrement position where pos > source AND pos <= dest
-    //   3) Set position=dest where pos=-1 -- Move that track from dummy pos to final destination
+    ScopedTransaction transaction(m_database);
 
-    // Move moved track to dummy position -1
-    query.prepare(QStringLiteral(
-            "UPDATE PlaylistTracks SET position=-1 "
-            "WHERE position=:position AND "
-            "playlist_id=:id"));
-    query.bindValue(":position", oldPosition);
-    query.bindValue(":id", playlistId);
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
+    const int maxPosition = getMaxPosition(playlistId);
+    if (firstPosition + count - 1 > maxPosition) {
+        return false;
+    }
+    if (newPosition + count - 1 > maxPosition) {
+        newPosition = maxPosition - count + 1;
+    }
+    if (newPosition == firstPosition) {
+        return true;
     }
 
-    if (newPosition < oldPosition) {
+    // The moved tracks and the tracks they pass are updated by a single
+    // statement. The tracks that are passed shift by count in the opposite
+    // direction.
+    QSqlQuery query(m_database);
+    if (newPosition < firstPosition) {
         query.prepare(QStringLiteral(
-                "UPDATE PlaylistTracks SET position=position+1 "
-                "WHERE position >= :new_position AND position < :old_position AND "
-                "playlist_id=:id"));
-        query.bindValue(":new_position", newPosition);
-        query.bindValue(":old_position", oldPosition);
-        query.bindValue(":id", playlistId);
+                "UPDATE PlaylistTracks SET position=CASE "
+                "WHEN position>=:first_position "
+                "THEN position-:first_position+:new_position "
+                "ELSE position+:count END "
+                "WHERE playlist_id=:id AND "
+                "position>=:new_position AND position<:first_position+:count"));
     } else {
         query.prepare(QStringLiteral(
-                "UPDATE PlaylistTracks SET position=position-1 "
-                "WHERE position > :old_position AND position <= :new_position AND "
-                "playlist_id=:id"));
-        query.bindValue(":new_position", newPosition);
-        query.bindValue(":old_position", oldPosition);
-        query.bindValue(":id", playlistId);
-    }
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
+                "UPDATE PlaylistTracks SET position=CASE "
+                "WHEN position<:first_position+:count "
+                "THEN position-:first_position+:new_position "
+                "ELSE position-:count END "
+                "WHERE playlist_id=:id AND "
+                "position>=:first_position AND position<:new_position+:count"));
     }
-
-    query.prepare(QStringLiteral(
-            "UPDATE PlaylistTracks SET position=:new_position "
-            "WHERE position=-1 AND "
-            "playlist_id=:id"));
-    query.bindValue(":new_position", newPosition);
     query.bindValue(":id", playlistId);
+    query.bindValue(":first_position", firstPosition);
+    query.bindValue(":new_position", newPosition);
+    query.bindValue(":count", count);
     if (!query.exec()) {
         LOG_FAILED_QUERY(query);
+        return false;
     }
 
     transaction.commit();
 
-    // Print out any SQL error, if there was one.
-    if (query.lastError().isValid()) {
-        qDebug() << query.lastError();
-    }
-
     emit tracksChanged(QSet<int>{playlistId});
+    return true;
 }
 
 void PlaylistDAO::searchForDuplicateTrack(const int fromPosition,
@@ -1150,17 +1227,15 @@ void PlaylistDAO::shuffleTracks(const int playlistId,
 }
 
 bool PlaylistDAO::isTrackInPlaylist(TrackId trackId, const int playlistId) const {
-    return m_playlistsTrackIsIn.contains(trackId, playlistId);
+    if (isMembershipIndexAvailable()) {
+        return m_playlistMembership.contains(trackId, playlistId);
+    }
+    return containerIdsOfTrack(trackId).contains(playlistId);
 }
 
 void PlaylistDAO::getPlaylistsTrackIsIn(TrackId trackId,
         QSet<int>* playlistSet) const {
-    playlistSet->clear();
-    for (auto it = m_playlistsTrackIsIn.constFind(trackId);
-            it != m_playlistsTrackIsIn.constEnd() && it.key() == trackId;
-            ++it) {
-        playlistSet->insert(it.value());
-    }
+    *playlistSet = containerIdsOfTrack(trackId);
 }
 
 void PlaylistDAO::setAutoDJProcessor(AutoDJProcessor* pAutoDJProcessor) {
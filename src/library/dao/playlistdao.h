@@ -6,6 +6,7 @@
 #include <QSet>
 
 #include "library/dao/dao.h"
+#include "library/dao/trackmembershipindex.h"
 #include "track/trackid.h"
 #include "util/class.h"
 
@@ -47,8 +48,6 @@ class PlaylistDAO : public QObject, public virtual DAO {
     PlaylistDAO();
     ~PlaylistDAO() override = default;
 
-    void initialize(const QSqlDatabase& database) override;
-
     // Create a playlist, fails with -1 if already exists
     int createPlaylist(const QString& name, const HiddenType type = PLHT_NOT_HIDDEN);
     // Create a playlist, appends "(n)" if already exists, name becomes the new name
@@ -93,11 +92,14 @@ class PlaylistDAO : public QObject, public virtual DAO {
     void removeHiddenTracks(const int playlistId);
     // Remove a track from a playlist
     void removeTrackFromPlaylist(int playlistId, int position);
+    // Remove the tracks at the given positions. All following tracks are
+    // moved up by a single statement.
     void removeTracksFromPlaylist(int playlistId, const QList<int>& positions);
     void removeTracksFromPlaylistById(int playlistId, TrackId trackId);
     // Insert a track into a specific position in a playlist
     bool insertTrackIntoPlaylist(TrackId trackId, int playlistId, int position);
-    // Inserts a list of tracks into playlist
+    // Inserts a list of tracks into playlist. The following tracks are moved
+    // down by a single statement. Returns the number of inserted tracks.
     int insertTracksIntoPlaylist(const QList<TrackId>& trackIds, const int playlistId, int position);
     // Add a playlist to the Auto-DJ Queue
     void addPlaylistToAutoDJQueue(const int playlistId, AutoDJSendLoc loc);
@@ -113,8 +115,20 @@ class PlaylistDAO : public QObject, public virtual DAO {
     // moved Track to a new position
     void moveTrack(const int playlistId,
             const int oldPosition, const int newPosition);
+    // Moves count tracks starting at firstPosition, so that the first of
+    // them ends up at newPosition. All affected positions are rewritten by a
+    // single statement.
+    bool moveTracks(const int playlistId,
+            const int firstPosition,
+            const int count,
+            int newPosition);
     // shuffles all tracks in the position List
     void shuffleTracks(const int playlistId, const QList<int>& positions, const QHash<int,TrackId>& allIds);
+    /// Reads the track memberships on a worker thread, so that the first
+    /// lookup does not have to wait for them. Until then lookups go to the
+    /// database.
+    void populateMembershipIndexInBackground(
+            const mixxx::DbConnectionPoolPtr& pDbConnectionPool);
     bool isTrackInPlaylist(TrackId trackId, const int playlistId) const;
 
     void getPlaylistsTrackIsIn(TrackId trackId, QSet<int>* playlistSet) const;
@@ -142,9 +156,13 @@ class PlaylistDAO : public QObject, public virtual DAO {
                                  const int otherTrackPosition,
                                  const QHash<int,TrackId>* pTrackPositionIds,
                                  int* pTrackDistance);
-    void populatePlaylistMembershipCache();
+    /// Returns false while the index is populated in the background.
+    /// Otherwise it is populated synchronously on first use.
+    bool isMembershipIndexAvailable() const;
+    /// Falls back to the database while the index is not available
+    QSet<int> containerIdsOfTrack(TrackId trackId) const;
 
-    QMultiHash<TrackId, int> m_playlistsTrackIsIn;
+    mutable TrackMembershipIndex m_playlistMembership;
     AutoDJProcessor* m_pAutoDJProcessor;
     DISALLOW_COPY_AND_ASSIGN(PlaylistDAO);
 };
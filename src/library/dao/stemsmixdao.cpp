@@ -17,35 +17,34 @@ StemsMixDAO::StemsMixDAO()
         : m_pAutoDJProcessor(nullptr) {
 }
 
-void StemsMixDAO::initialize(const QSqlDatabase& database) {
-    DAO::initialize(database);
-    populateStemsMixMembershipCache();
+void StemsMixDAO::populateMembershipIndexInBackground(
+        const mixxx::DbConnectionPoolPtr& pDbConnectionPool) {
+    m_stemsMixMembership.populateInBackground(pDbConnectionPool,
+            QStringLiteral(STEMSMIX_TRACKS_TABLE),
+            STEMSMIXTRACKSTABLE_STEMSMIXID);
 }
 
-void StemsMixDAO::populateStemsMixMembershipCache() {
-    qDebug() << "StemsMixDAO::populateStemsMixMembershipCache" << this << m_database.connectionName();
-    // Minor optimization: reserve space in m_stemsmixsTrackIsIn.
-    QSqlQuery query(m_database);
-    query.prepare(QStringLiteral("SELECT COUNT(*) from " STEMSMIX_TRACKS_TABLE));
-    if (query.exec() && query.next()) {
-        m_stemsmixsTrackIsIn.reserve(query.value(0).toInt());
-    } else {
-        LOG_FAILED_QUERY(query);
+bool StemsMixDAO::isMembershipIndexAvailable() const {
+    if (m_stemsMixMembership.isPopulated()) {
+        return true;
     }
-
-    // now fetch all Tracks from all stemsmixs and insert them into the hashmap
-    query.prepare(QStringLiteral(
-            "SELECT track_id, stemsmix_id from " STEMSMIX_TRACKS_TABLE));
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
+    if (m_stemsMixMembership.isPopulatingInBackground()) {
+        // Don't wait for the worker thread
+        return m_stemsMixMembership.finishPopulatingInBackground();
     }
+    return m_stemsMixMembership.populate(m_database,
+            QStringLiteral(STEMSMIX_TRACKS_TABLE),
+            STEMSMIXTRACKSTABLE_STEMSMIXID);
+}
 
-    const int trackIdColumn = query.record().indexOf(STEMSMIXTRACKSTABLE_TRACKID);
-    const int stemsmixIdColumn = query.record().indexOf(STEMSMIXTRACKSTABLE_STEMSMIXID);
-    while (query.next()) {
-        m_stemsmixsTrackIsIn.insert(TrackId(query.value(trackIdColumn)),
-                query.value(stemsmixIdColumn).toInt());
+QSet<int> StemsMixDAO::containerIdsOfTrack(TrackId trackId) const {
+    if (isMembershipIndexAvailable()) {
+        return m_stemsMixMembership.containerIdSet(trackId);
     }
+    return TrackMembershipIndex::queryContainerIdSet(m_database,
+            QStringLiteral(STEMSMIX_TRACKS_TABLE),
+            STEMSMIXTRACKSTABLE_STEMSMIXID,
+            trackId);
 }
 
 int StemsMixDAO::createStemsMix(const QString& name, const HiddenType hidden) {
@@ -212,14 +211,7 @@ void StemsMixDAO::deleteStemsMix(const int stemsmixId) {
 
     transaction.commit();
 
-    for (QMultiHash<TrackId, int>::iterator it = m_stemsmixsTrackIsIn.begin();
-            it != m_stemsmixsTrackIsIn.end();) {
-        if (it.value() == stemsmixId) {
-            it = m_stemsmixsTrackIsIn.erase(it);
-        } else {
-            ++it;
-        }
-    }
+    m_stemsMixMembership.removeContainer(stemsmixId);
 
     emit deleted(stemsmixId);
     if (!playedTrackIds.isEmpty()) {
@@ -325,6 +317,20 @@ bool StemsMixDAO::removeTracksFromStemsMix(int stemsmixId, int startIndex) {
     // Retain the first track if it is loaded in a deck
     ScopedTransaction transaction(m_database);
     QSqlQuery query(m_database);
+    query.prepare(QStringLiteral(
+            "SELECT track_id FROM StemsMixTracks "
+            "WHERE stemsmix_id=:id AND position>=:pos"));
+    query.bindValue(":id", stemsmixId);
+    query.bindValue(":pos", startIndex);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return false;
+    }
+    QList<TrackId> removedTrackIds;
+    while (query.next()) {
+        removedTrackIds.append(TrackId(query.value(0)));
+    }
+
     query.prepare(QStringLiteral(
             "DELETE FROM StemsMixTracks "
             "WHERE stemsmix_id=:id AND position>=:pos"));
@@ -335,6 +341,10 @@ bool StemsMixDAO::removeTracksFromStemsMix(int stemsmixId, int startIndex) {
         return false;
     }
     transaction.commit();
+
+    for (const auto& trackId : qAsConst(removedTrackIds)) {
+        m_stemsMixMembership.remove(trackId, stemsmixId);
+    }
     emit tracksChanged(QSet<int>{stemsmixId});
     return true;
 }
@@ -373,7 +383,7 @@ bool StemsMixDAO::appendTracksToStemsMix(const QList<TrackId>& trackIds, const i
 
     insertPosition = position;
     for (const auto& trackId : trackIds) {
-        m_stemsmixsTrackIsIn.insert(trackId, stemsmixId);
+        m_stemsMixMembership.insert(trackId, stemsmixId);
         // TODO(XXX) don't emit if the track didn't add successfully.
         emit trackAdded(stemsmixId, trackId, insertPosition++);
     }
@@ -526,17 +536,86 @@ void StemsMixDAO::removeTrackFromStemsMix(int stemsmixId, int position) {
 }
 
 void StemsMixDAO::removeTracksFromStemsMix(int stemsmixId, const QList<int>& positions) {
-    // get positions in reversed order
-    auto sortedPositons = positions;
-    std::sort(sortedPositons.begin(), sortedPositons.end(), std::greater<int>());
+    auto sortedPositions = positions;
+    std::sort(sortedPositions.begin(), sortedPositions.end());
+    sortedPositions.erase(
+            std::unique(sortedPositions.begin(), sortedPositions.end()),
+            sortedPositions.end());
+    if (sortedPositions.isEmpty()) {
+        return;
+    }
+    QStringList positionList;
+    positionList.reserve(sortedPositions.size());
+    for (const auto position : qAsConst(sortedPositions)) {
+        positionList.append(QString::number(position));
+    }
+    const QString positionsSql = positionList.join(QChar(','));
 
     //qDebug() << "StemsMixDAO::removeTrackFromStemsMix"
     //         << QThread::currentThread() << m_database.connectionName();
     ScopedTransaction transaction(m_database);
-    for (const auto position : qAsConst(sortedPositons)) {
-        removeTracksFromStemsMixInner(stemsmixId, position);
+    QSqlQuery query(m_database);
+    query.prepare(QStringLiteral(
+            "SELECT track_id, position FROM StemsMixTracks "
+            "WHERE stemsmix_id=:id AND position IN (%1) "
+            "ORDER BY position DESC")
+                          .arg(positionsSql));
+    query.bindValue(":id", stemsmixId);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return;
+    }
+    QList<QPair<TrackId, int>> removedTracks;
+    const int trackIdColumn = query.record().indexOf("track_id");
+    const int positionColumn = query.record().indexOf("position");
+    while (query.next()) {
+        removedTracks.append(qMakePair(
+                TrackId(query.value(trackIdColumn)),
+                query.value(positionColumn).toInt()));
+    }
+    if (removedTracks.isEmpty()) {
+        qDebug() << "removeTracksFromStemsMix no tracks exist at positions:"
+                 << positions << "in stemsmix:" << stemsmixId;
+        return;
+    }
+
+    query.prepare(QStringLiteral(
+            "DELETE FROM StemsMixTracks "
+            "WHERE stemsmix_id=:id AND position IN (%1)")
+                          .arg(positionsSql));
+    query.bindValue(":id", stemsmixId);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return;
+    }
+
+    // Close all gaps with a single statement
+    const QString numRemovedBelow = sqlNumValuesBelowExpression(
+            m_database, QStringLiteral("StemsMixTracks.position"), sortedPositions);
+    if (numRemovedBelow.isNull()) {
+        return;
+    }
+    query.prepare(QStringLiteral(
+            "UPDATE StemsMixTracks SET position=position-(%1) "
+            "WHERE stemsmix_id=:id AND position>:position")
+                          .arg(numRemovedBelow));
+    query.bindValue(":id", stemsmixId);
+    query.bindValue(":position", sortedPositions.first());
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return;
     }
     transaction.commit();
+
+    QSet<TrackId> removedTrackIds;
+    for (const auto& removedTrack : qAsConst(removedTracks)) {
+        m_stemsMixMembership.remove(removedTrack.first, stemsmixId);
+        removedTrackIds.insert(removedTrack.first);
+        emit trackRemoved(stemsmixId, removedTrack.first, removedTrack.second);
+    }
+    if (getHiddenType(stemsmixId) == PLHT_SET_LOG) {
+        emit tracksRemovedFromPlayedHistory(removedTrackIds);
+    }
     emit tracksChanged(QSet<int>{stemsmixId});
 }
 
@@ -582,7 +661,7 @@ void StemsMixDAO::removeTracksFromStemsMixInner(int stemsmixId, int position) {
         LOG_FAILED_QUERY(query);
     }
 
-    m_stemsmixsTrackIsIn.remove(trackId, stemsmixId);
+    m_stemsMixMembership.remove(trackId, stemsmixId);
 
     emit trackRemoved(stemsmixId, trackId, position);
     if (getHiddenType(stemsmixId) == PLHT_SET_LOG) {
@@ -630,7 +709,7 @@ bool StemsMixDAO::insertTrackIntoStemsMix(TrackId trackId, const int stemsmixId,
     }
     transaction.commit();
 
-    m_stemsmixsTrackIsIn.insert(trackId, stemsmixId);
+    m_stemsMixMembership.insert(trackId, stemsmixId);
     emit trackAdded(stemsmixId, trackId, position);
     emit tracksChanged(QSet<int>{stemsmixId});
     return true;
@@ -643,7 +722,18 @@ int StemsMixDAO::insertTracksIntoStemsMix(const QList<TrackId>& trackIds,
         return 0;
     }
 
-    int tracksAdded = 0;
+    QVariantList insertTrackIds;
+    insertTrackIds.reserve(trackIds.size());
+    for (const auto& trackId : trackIds) {
+        if (trackId.isValid()) {
+            insertTrackIds.append(trackId.toVariant());
+        }
+    }
+    if (insertTrackIds.isEmpty()) {
+        return 0;
+    }
+    const int tracksAdded = static_cast<int>(insertTrackIds.size());
+
     ScopedTransaction transaction(m_database);
 
     int max_position = getMaxPosition(stemsmixId) + 1;
@@ -652,51 +742,48 @@ int StemsMixDAO::insertTracksIntoStemsMix(const QList<TrackId>& trackIds,
         position = max_position;
     }
 
-    QSqlQuery insertQuery(m_database);
-    insertQuery.prepare(QStringLiteral(
-            "INSERT INTO StemsMixTracks (stemsmix_id, track_id, position)"
-            "VALUES (:stemsmix_id, :track_id, :position)"));
+    // Make room for all tracks at once
     QSqlQuery query(m_database);
-    int insertPositon = position;
-    for (const auto& trackId : trackIds) {
-        if (!trackId.isValid()) {
-            continue;
-        }
-        // Move all tracks in stemsmix up by 1.
-        // TODO(XXX) We could do this in one query before the for loop.
-        query.prepare(QStringLiteral(
-                "UPDATE StemsMixTracks SET position=position+1 "
-                "WHERE position>=:position AND "
-                "stemsmix_id=:id"));
-        query.bindValue(":id", stemsmixId);
-        query.bindValue(":position", insertPositon);
-
-        if (!query.exec()) {
-            LOG_FAILED_QUERY(query);
-            continue;
-        }
-
-        // Insert the track at the given position
-        insertQuery.bindValue(":stemsmix_id", stemsmixId);
-        insertQuery.bindValue(":track_id", trackId.toVariant());
-        insertQuery.bindValue(":position", insertPositon);
-        if (!insertQuery.exec()) {
-            LOG_FAILED_QUERY(insertQuery);
-            continue;
-        }
+    query.prepare(QStringLiteral(
+            "UPDATE StemsMixTracks SET position=position+:count "
+            "WHERE position>=:position AND "
+            "stemsmix_id=:id"));
+    query.bindValue(":id", stemsmixId);
+    query.bindValue(":position", position);
+    query.bindValue(":count", tracksAdded);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return 0;
+    }
 
-        // Increment the insert position for the track.
-        ++insertPositon;
-        ++tracksAdded;
+    QVariantList insertStemsMixIds;
+    QVariantList insertPositions;
+    insertStemsMixIds.reserve(tracksAdded);
+    insertPositions.reserve(tracksAdded);
+    for (int i = 0; i < tracksAdded; ++i) {
+        insertStemsMixIds.append(stemsmixId);
+        insertPositions.append(position + i);
+    }
+    query.prepare(QStringLiteral(
+            "INSERT INTO StemsMixTracks (stemsmix_id, track_id, position)"
+            "VALUES (:stemsmix_id, :track_id, :position)"));
+    query.bindValue(":stemsmix_id", insertStemsMixIds);
+    query.bindValue(":track_id", insertTrackIds);
+    query.bindValue(":position", insertPositions);
+    if (!query.execBatch()) {
+        LOG_FAILED_QUERY(query);
+        return 0;
     }
 
     transaction.commit();
 
-    insertPositon = position;
+    int insertPosition = position;
     for (const auto& trackId : trackIds) {
-        m_stemsmixsTrackIsIn.insert(trackId, stemsmixId);
-        // TODO(XXX) The position is wrong if any track failed to insert.
-        emit trackAdded(stemsmixId, trackId, insertPositon++);
+        if (!trackId.isValid()) {
+            continue;
+        }
+        m_stemsMixMembership.insert(trackId, stemsmixId);
+        emit trackAdded(stemsmixId, trackId, insertPosition++);
     }
     emit tracksChanged(QSet<int>{stemsmixId});
     return tracksAdded;
@@ -804,7 +891,7 @@ bool StemsMixDAO::copyStemsMixTracks(const int sourceStemsMixID, const int targe
     while (query.next()) {
         TrackId copiedTrackId(query.value(0));
         int copiedPosition = query.value(1).toInt();
-        m_stemsmixsTrackIsIn.insert(copiedTrackId, targetStemsMixID);
+        m_stemsMixMembership.insert(copiedTrackId, targetStemsMixID);
         emit trackAdded(targetStemsMixID, copiedTrackId, copiedPosition);
     }
     emit tracksChanged(QSet<int>{targetStemsMixID});
@@ -832,24 +919,19 @@ int StemsMixDAO::getMaxPosition(const int stemsmixId) const {
 }
 
 void StemsMixDAO::removeTracksFromStemsMixs(const QList<TrackId>& trackIds) {
-    // copy the hash, because there is no guarantee that "it" is valid after remove
-    QMultiHash<TrackId, int> stemsmixsTrackIsInCopy = m_stemsmixsTrackIsIn;
     QSet<int> stemsmixIds;
 
     ScopedTransaction transaction(m_database);
     for (const auto& trackId : trackIds) {
-        for (auto it = stemsmixsTrackIsInCopy.constBegin();
-                it != stemsmixsTrackIsInCopy.constEnd();
-                ++it) {
-            if (it.key() == trackId) {
-                const auto stemsmixId = it.value();
-                // keep tracks in history stemsmixs
-                if (getHiddenType(stemsmixId) == StemsMixDAO::PLHT_SET_LOG) {
-                    continue;
-                }
-                removeTracksFromStemsMixByIdInner(stemsmixId, trackId);
-                stemsmixIds.insert(stemsmixId);
+        // Copy the ids, because the index is modified while removing
+        const QSet<int> trackContainerIds = containerIdsOfTrack(trackId);
+        for (const int stemsmixId : trackContainerIds) {
+            // keep tracks in history stemsmixs
+            if (getHiddenType(stemsmixId) == StemsMixDAO::PLHT_SET_LOG) {
+                continue;
             }
+            removeTracksFromStemsMixByIdInner(stemsmixId, trackId);
+            stemsmixIds.insert(stemsmixId);
         }
     }
     transaction.commit();
@@ -877,70 +959,64 @@ int StemsMixDAO::tracksInStemsMix(const int stemsmixId) const {
 }
 
 void StemsMixDAO::moveTrack(const int stemsmixId, const int oldPosition, const int newPosition) {
-    ScopedTransaction transaction(m_database);
-    QSqlQuery query(m_database);
+    moveTracks(stemsmixId, oldPosition, 1, newPosition);
+}
 
-    // Algorithm for code below
-    // Case 1: destination < source (newPositon < oldPosition)
-    //    1) Set position = -1 where pos=source -- Gives that track a dummy index to keep stuff simple.
-    //    2) Decrement position where pos >= dest AND pos < source
-    //    3) Set position = dest where pos=-1 -- Move track from dummy pos to final destination.
+bool StemsMixDAO::moveTracks(const int stemsmixId,
+        const int firstPosition,
+        const int count,
+        int newPosition) {
+    if (stemsmixId < 0 || firstPosition < 1 || count < 1 || newPosition < 1) {
+        return false;
+    }
 
-    // Case 2: destination > source (newPos > oldPos)
-    //   1) Set position=-1 where pos=source -- Give track a dummy index again.
-    //   2) Decrement position where pos > source AND pos <= dest
-    //   3) Set position=dest where pos=-1 -- Move that track from dummy pos to final destination
+    ScopedTransaction transaction(m_database);
 
-    // Move moved track to dummy position -1
-    query.prepare(QStringLiteral(
-            "UPDATE StemsMixTracks SET position=-1 "
-            "WHERE position=:position AND "
-            "stemsmix_id=:id"));
-    query.bindValue(":position", oldPosition);
-    query.bindValue(":id", stemsmixId);
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
+    const int maxPosition = getMaxPosition(stemsmixId);
+    if (firstPosition + count - 1 > maxPosition) {
+        return false;
+    }
+    if (newPosition + count - 1 > maxPosition) {
+        newPosition = maxPosition - count + 1;
+    }
+    if (newPosition == firstPosition) {
+        return true;
     }
 
-    if (newPosition < oldPosition) {
+    // The moved tracks and the tracks they pass are updated by a single
+    // statement. The tracks that are passed shift by count in the opposite
+    // direction.
+    QSqlQuery query(m_database);
+    if (newPosition < firstPosition) {
         query.prepare(QStringLiteral(
-                "UPDATE StemsMixTracks SET position=position+1 "
-                "WHERE position >= :new_position AND position < :old_position AND "
-                "stemsmix_id=:id"));
-        query.bindValue(":new_position", newPosition);
-        query.bindValue(":old_position", oldPosition);
-        query.bindValue(":id", stemsmixId);
+                "UPDATE StemsMixTracks SET position=CASE "
+                "WHEN position>=:first_position "
+                "THEN position-:first_position+:new_position "
+                "ELSE position+:count END "
+                "WHERE stemsmix_id=:id AND "
+                "position>=:new_position AND position<:first_position+:count"));
     } else {
         query.prepare(QStringLiteral(
-                "UPDATE StemsMixTracks SET position=position-1 "
-                "WHERE position > :old_position AND position <= :new_position AND "
-                "stemsmix_id=:id"));
-        query.bindValue(":new_position", newPosition);
-        query.bindValue(":old_position", oldPosition);
-        query.bindValue(":id", stemsmixId);
-    }
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
+                "UPDATE StemsMixTracks SET position=CASE "
+                "WHEN position<:first_position+:count "
+                "THEN position-:first_position+:new_position "
+                "ELSE position-:count END "
+                "WHERE stemsmix_id=:id AND "
+                "position>=:first_position AND position<:new_position+:count"));
     }
-
-    query.prepare(QStringLiteral(
-            "UPDATE StemsMixTracks SET position=:new_position "
-            "WHERE position=-1 AND "
-            "stemsmix_id=:id"));
-    query.bindValue(":new_position", newPosition);
     query.bindValue(":id", stemsmixId);
+    query.bindValue(":first_position", firstPosition);
+    query.bindValue(":new_position", newPosition);
+    query.bindValue(":count", count);
     if (!query.exec()) {
         LOG_FAILED_QUERY(query);
+        return false;
     }
 
     transaction.commit();
 
-    // Print out any SQL error, if there was one.
-    if (query.lastError().isValid()) {
-        qDebug() << query.lastError();
-    }
-
     emit tracksChanged(QSet<int>{stemsmixId});
+    return true;
 }
 
 void StemsMixDAO::searchForDuplicateTrack(const int fromPosition,
@@ -964,17 +1040,15 @@ void StemsMixDAO::searchForDuplicateTrack(const int fromPosition,
 }
 
 bool StemsMixDAO::isTrackInStemsMix(TrackId trackId, const int stemsmixId) const {
-    return m_stemsmixsTrackIsIn.contains(trackId, stemsmixId);
+    if (isMembershipIndexAvailable()) {
+        return m_stemsMixMembership.contains(trackId, stemsmixId);
+    }
+    return containerIdsOfTrack(trackId).contains(stemsmixId);
 }
 
 void StemsMixDAO::getStemsMixsTrackIsIn(TrackId trackId,
         QSet<int>* stemsmixSet) const {
-    stemsmixSet->clear();
-    for (auto it = m_stemsmixsTrackIsIn.constFind(trackId);
-            it != m_stemsmixsTrackIsIn.constEnd() && it.key() == trackId;
-            ++it) {
-        stemsmixSet->insert(it.value());
-    }
+    *stemsmixSet = containerIdsOfTrack(trackId);
 }
 
 void StemsMixDAO::setAutoDJProcessor(AutoDJProcessor* pAutoDJProcessor) {
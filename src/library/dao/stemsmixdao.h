@@ -6,6 +6,7 @@
 #include <QSet>
 
 #include "library/dao/dao.h"
+#include "library/dao/trackmembershipindex.h"
 #include "track/trackid.h"
 #include "util/class.h"
 
@@ -52,8 +53,6 @@ class StemsMixDAO : public QObject, public virtual DAO {
     StemsMixDAO();
     ~StemsMixDAO() override = default;
 
-    void initialize(const QSqlDatabase& database) override;
-
     // Create a stemsmix, fails with -1 if already exists
     int createStemsMix(const QString& name, const HiddenType type = PLHT_NOT_HIDDEN);
     // Create a stemsmix, appends "(n)" if already exists, name becomes the new name
@@ -98,11 +97,14 @@ class StemsMixDAO : public QObject, public virtual DAO {
     void removeHiddenTracks(const int stemsmixId);
     // Remove a track from a stemsmix
     void removeTrackFromStemsMix(int stemsmixId, int position);
+    // Remove the tracks at the given positions. All following tracks are
+    // moved up by a single statement.
     void removeTracksFromStemsMix(int stemsmixId, const QList<int>& positions);
     void removeTracksFromStemsMixById(int stemsmixId, TrackId trackId);
     // Insert a track into a specific position in a stemsmix
     bool insertTrackIntoStemsMix(TrackId trackId, int stemsmixId, int position);
-    // Inserts a list of tracks into stemsmix
+    // Inserts a list of tracks into stemsmix. The following tracks are moved
+    // down by a single statement. Returns the number of inserted tracks.
     int insertTracksIntoStemsMix(const QList<TrackId>& trackIds, const int stemsmixId, int position);
     // Add a stemsmix to the Auto-DJ Queue
     void addStemsMixToAutoDJQueue(const int stemsmixId, AutoDJSendLoc loc);
@@ -118,6 +120,18 @@ class StemsMixDAO : public QObject, public virtual DAO {
     // moved Track to a new position
     void moveTrack(const int stemsmixId,
             const int oldPosition, const int newPosition);
+    // Moves count tracks starting at firstPosition, so that the first of
+    // them ends up at newPosition. All affected positions are rewritten by a
+    // single statement.
+    bool moveTracks(const int stemsmixId,
+            const int firstPosition,
+            const int count,
+            int newPosition);
+    /// Reads the track memberships on a worker thread, so that the first
+    /// lookup does not have to wait for them. Until then lookups go to the
+    /// database.
+    void populateMembershipIndexInBackground(
+            const mixxx::DbConnectionPoolPtr& pDbConnectionPool);
     bool isTrackInStemsMix(TrackId trackId, const int stemsmixId) const;
 
     void getStemsMixsTrackIsIn(TrackId trackId, QSet<int>* stemsmixSet) const;
@@ -145,9 +159,13 @@ class StemsMixDAO : public QObject, public virtual DAO {
                                  const int otherTrackPosition,
                                  const QHash<int,TrackId>* pTrackPositionIds,
                                  int* pTrackDistance);
-    void populateStemsMixMembershipCache();
+    /// Returns false while the index is populated in the background.
+    /// Otherwise it is populated synchronously on first use.
+    bool isMembershipIndexAvailable() const;
+    /// Falls back to the database while the index is not available
+    QSet<int> containerIdsOfTrack(TrackId trackId) const;
 
-    QMultiHash<TrackId, int> m_stemsmixsTrackIsIn;
+    mutable TrackMembershipIndex m_stemsMixMembership;
     AutoDJProcessor* m_pAutoDJProcessor;
     DISALLOW_COPY_AND_ASSIGN(StemsMixDAO);
 };
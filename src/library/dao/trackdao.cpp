@@ -34,6 +34,7 @@
 #include "util/datetime.h"
 #include "util/db/fwdsqlquery.h"
 #include "util/db/sqlite.h"
+#include "util/db/sqlstatementcache.h"
 #include "util/db/sqlstringformatter.h"
 #include "util/db/sqltransaction.h"
 #include "util/fileinfo.h"
@@ -149,22 +150,22 @@ TrackId TrackDAO::getTrackIdByLocation(const QString& location) const {
         return {};
     }
 
-    QSqlQuery query(m_database);
-    query.prepare(
-            "SELECT library.id FROM library "
-            "INNER JOIN track_locations ON library.location = track_locations.id "
-            "WHERE track_locations.location=:location");
-    query.bindValue(":location", location);
+    CachedSqlQuery query(m_database,
+            QStringLiteral(
+                    "SELECT library.id FROM library "
+                    "INNER JOIN track_locations ON library.location = track_locations.id "
+                    "WHERE track_locations.location=:location"));
+    query->bindValue(":location", location);
     if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
+        LOG_FAILED_QUERY(*query);
         DEBUG_ASSERT(!"Failed query");
         return {};
     }
-    if (!query.next()) {
+    if (!query->next()) {
         qDebug() << "TrackDAO::getTrackId(): Track location not found in library:" << location;
         return {};
     }
-    const auto trackId = TrackId(query.value(query.record().indexOf("id")));
+    const auto trackId = TrackId(query->value(0));
     DEBUG_ASSERT(trackId.isValid());
     return trackId;
 }
@@ -1429,26 +1430,29 @@ TrackPointer TrackDAO::getTrackById(TrackId trackId) const {
             columnsStr.append(columns[i].name);
         }
 
-        QSqlQuery query(m_database);
-        query.prepare(QString(
-                "SELECT %1 FROM Library "
-                "INNER JOIN track_locations ON library.location = track_locations.id "
-                "WHERE library.id = %2")
-                              .arg(columnsStr, trackId.toString()));
+        // The id is bound as a placeholder so that the prepared statement
+        // is reused for all tracks.
+        CachedSqlQuery query(m_database,
+                QString(
+                        "SELECT %1 FROM Library "
+                        "INNER JOIN track_locations ON library.location = track_locations.id "
+                        "WHERE library.id=:id")
+                        .arg(columnsStr));
+        query->bindValue(":id", trackId.toVariant());
         if (!query.exec()) {
-            LOG_FAILED_QUERY(query)
+            LOG_FAILED_QUERY(*query)
                     << QString("getTrack(%1)").arg(trackId.toString());
             DEBUG_ASSERT(!"Failed query");
             return nullptr;
         }
 
-        if (!query.next()) {
+        if (!query->next()) {
             qDebug() << "Track with id =" << trackId << "not found";
             return nullptr;
         }
-        queryRecord = query.record();
+        queryRecord = query->record();
         // Only a single record is expected
-        DEBUG_ASSERT(!query.next());
+        DEBUG_ASSERT(!query->next());
     }
 
     {
@@ -0,0 +1,240 @@
+#include "library/dao/trackmembershipindex.h"
+
+#include <QSqlQuery>
+#include <QtConcurrentRun>
+#include <algorithm>
+
+#include "library/queryutil.h"
+#include "util/db/dbconnectionpooled.h"
+#include "util/db/dbconnectionpooler.h"
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("TrackMembershipIndex");
+
+const TrackMembershipIndex::ContainerIds kEmptyContainerIds;
+
+} // anonymous namespace
+
+bool TrackMembershipIndex::populate(const QSqlDatabase& database,
+        const QString& tableName,
+        const QString& containerIdColumn) {
+    invalidate();
+
+    Rows rows;
+    if (!queryRows(&rows, database, tableName, containerIdColumn)) {
+        return false;
+    }
+    m_containerIds = std::move(rows.containerIds);
+    m_size = rows.size;
+    m_populated = true;
+    return true;
+}
+
+void TrackMembershipIndex::populateInBackground(
+        const mixxx::DbConnectionPoolPtr& pDbConnectionPool,
+        const QString& tableName,
+        const QString& containerIdColumn) {
+    invalidate();
+    m_pDbConnectionPool = pDbConnectionPool;
+    m_tableName = tableName;
+    m_containerIdColumn = containerIdColumn;
+    m_populatingInBackground = true;
+    startQueryRowsInBackground();
+}
+
+void TrackMembershipIndex::startQueryRowsInBackground() {
+    m_backgroundModificationCount = m_modificationCount;
+    // The worker thread only gets copies, so the index may be destroyed
+    // or invalidated without waiting for it.
+    m_backgroundRows = QtConcurrent::run(&TrackMembershipIndex::queryRowsPooled,
+            m_pDbConnectionPool,
+            m_tableName,
+            m_containerIdColumn);
+}
+
+bool TrackMembershipIndex::finishPopulatingInBackground() {
+    if (!m_populatingInBackground) {
+        return m_populated;
+    }
+    if (!m_backgroundRows.isFinished()) {
+        return false;
+    }
+    if (m_modificationCount != m_backgroundModificationCount) {
+        kLogger.debug() << "Modified while populating" << m_tableName;
+        startQueryRowsInBackground();
+        return false;
+    }
+    std::optional<Rows> rows = m_backgroundRows.result();
+    m_backgroundRows = QFuture<std::optional<Rows>>();
+    m_populatingInBackground = false;
+    if (!rows) {
+        // Populated synchronously on the next access
+        kLogger.warning() << "Failed to populate" << m_tableName << "in background";
+        return false;
+    }
+    m_containerIds = std::move(rows->containerIds);
+    m_size = rows->size;
+    m_populated = true;
+    return true;
+}
+
+// static
+std::optional<TrackMembershipIndex::Rows> TrackMembershipIndex::queryRowsPooled(
+        const mixxx::DbConnectionPoolPtr& pDbConnectionPool,
+        const QString& tableName,
+        const QString& containerIdColumn) {
+    // The thread-local database connection must not be closed
+    // before returning from this function.
+    const mixxx::DbConnectionPooler dbConnectionPooler(pDbConnectionPool);
+    if (!dbConnectionPooler.isPooling()) {
+        return std::nullopt;
+    }
+    Rows rows;
+    if (!queryRows(&rows,
+                mixxx::DbConnectionPooled(pDbConnectionPool),
+                tableName,
+                containerIdColumn)) {
+        return std::nullopt;
+    }
+    return rows;
+}
+
+// static
+bool TrackMembershipIndex::queryRows(Rows* pRows,
+        const QSqlDatabase& database,
+        const QString& tableName,
+        const QString& containerIdColumn) {
+    QSqlQuery query(database);
+    query.setForwardOnly(true);
+    query.prepare(QStringLiteral(
+            "SELECT track_id, %2 FROM %1 ORDER BY track_id, %2")
+                          .arg(tableName, containerIdColumn));
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return false;
+    }
+
+    ContainerIds* pContainerIds = nullptr;
+    TrackId lastTrackId;
+    while (query.next()) {
+        const TrackId trackId(query.value(0));
+        if (!pContainerIds || trackId != lastTrackId) {
+            pContainerIds = &pRows->containerIds[trackId];
+            lastTrackId = trackId;
+        }
+        pContainerIds->append(query.value(1).toInt());
+        ++pRows->size;
+    }
+    return true;
+}
+
+// static
+QSet<int> TrackMembershipIndex::queryContainerIdSet(const QSqlDatabase& database,
+        const QString& tableName,
+        const QString& containerIdColumn,
+        TrackId trackId) {
+    QSet<int> result;
+    QSqlQuery query(database);
+    query.prepare(QStringLiteral("SELECT %2 FROM %1 WHERE track_id=:track_id")
+                          .arg(tableName, containerIdColumn));
+    query.bindValue(":track_id", trackId.toVariant());
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return result;
+    }
+    while (query.next()) {
+        result.insert(query.value(0).toInt());
+    }
+    return result;
+}
+
+void TrackMembershipIndex::invalidate() {
+    m_containerIds.clear();
+    m_size = 0;
+    m_populated = false;
+    // A pending result is dropped when the future is replaced
+    m_populatingInBackground = false;
+    m_backgroundRows = QFuture<std::optional<Rows>>();
+}
+
+void TrackMembershipIndex::insert(TrackId trackId, int containerId) {
+    ++m_modificationCount;
+    if (!m_populated) {
+        return;
+    }
+    ContainerIds& containerIds = m_containerIds[trackId];
+    containerIds.insert(
+            std::upper_bound(containerIds.begin(), containerIds.end(), containerId),
+            containerId);
+    ++m_size;
+}
+
+void TrackMembershipIndex::remove(TrackId trackId, int containerId) {
+    ++m_modificationCount;
+    if (!m_populated) {
+        return;
+    }
+    const auto it = m_containerIds.find(trackId);
+    if (it == m_containerIds.end()) {
+        return;
+    }
+    ContainerIds& containerIds = it.value();
+    const auto idIt = std::lower_bound(
+            containerIds.begin(), containerIds.end(), containerId);
+    if (idIt == containerIds.end() || *idIt != containerId) {
+        return;
+    }
+    containerIds.erase(idIt);
+    --m_size;
+    if (containerIds.isEmpty()) {
+        m_containerIds.erase(it);
+    }
+}
+
+void TrackMembershipIndex::removeContainer(int containerId) {
+    ++m_modificationCount;
+    if (!m_populated) {
+        return;
+    }
+    for (auto it = m_containerIds.begin(); it != m_containerIds.end();) {
+        ContainerIds& containerIds = it.value();
+        const auto range = std::equal_range(
+                containerIds.begin(), containerIds.end(), containerId);
+        const auto count = static_cast<int>(range.second - range.first);
+        if (count > 0) {
+            containerIds.erase(range.first, range.second);
+            m_size -= count;
+        }
+        if (containerIds.isEmpty()) {
+            it = m_containerIds.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool TrackMembershipIndex::contains(TrackId trackId, int containerId) const {
+    const ContainerIds& ids = containerIds(trackId);
+    return std::binary_search(ids.begin(), ids.end(), containerId);
+}
+
+const TrackMembershipIndex::ContainerIds& TrackMembershipIndex::containerIds(
+        TrackId trackId) const {
+    const auto it = m_containerIds.constFind(trackId);
+    if (it == m_containerIds.constEnd()) {
+        return kEmptyContainerIds;
+    }
+    return it.value();
+}
+
+QSet<int> TrackMembershipIndex::containerIdSet(TrackId trackId) const {
+    const ContainerIds& ids = containerIds(trackId);
+    QSet<int> result;
+    result.reserve(ids.size());
+    for (const int id : ids) {
+        result.insert(id);
+    }
+    return result;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <QFuture>
+#include <QHash>
+#include <QSet>
+#include <QSqlDatabase>
+#include <QString>
+#include <QVarLengthArray>
+#include <optional>
+
+#include "track/trackid.h"
+#include "util/db/dbconnectionpool.h"
+
+/// Maps tracks to the ids of the playlists or stems mixes (containers)
+/// they are in.
+///
+/// The ids of each track are kept in a sorted small vector that is stored
+/// inline for the common case of a track in only a few containers, so the
+/// index needs one hash node per track instead of one per row. A track may
+/// occur several times in the same container. Each occurrence is stored and
+/// remove() only removes a single one.
+///
+/// The index is populated from the database by populate(), either lazily
+/// or on a worker thread by populateInBackground(). All modifications are
+/// ignored until then, because the rows that are written before will be
+/// read with the index.
+class TrackMembershipIndex {
+  public:
+    typedef QVarLengthArray<int, 4> ContainerIds;
+
+    bool isPopulated() const {
+        return m_populated;
+    }
+    /// Loads all (track, container) rows from the given table. The rows
+    /// are read ordered, so every vector is filled by appending.
+    bool populate(const QSqlDatabase& database,
+            const QString& tableName,
+            const QString& containerIdColumn);
+    /// Drops the index. It is populated again on the next access.
+    void invalidate();
+
+    /// Reads all rows on a worker thread with its own thread-local
+    /// database connection. The index stays unpopulated until the rows
+    /// are taken over by finishPopulatingInBackground().
+    void populateInBackground(const mixxx::DbConnectionPoolPtr& pDbConnectionPool,
+            const QString& tableName,
+            const QString& containerIdColumn);
+    bool isPopulatingInBackground() const {
+        return m_populatingInBackground;
+    }
+    /// Takes over the rows that have been read in the background if they
+    /// are available. If the index has been modified in the meantime the
+    /// rows may or may not contain the modification, so they are discarded
+    /// and read again. Never blocks. Returns isPopulated().
+    bool finishPopulatingInBackground();
+
+    /// Reads the containers of a single track from the database. For
+    /// lookups while the index is populated in the background.
+    static QSet<int> queryContainerIdSet(const QSqlDatabase& database,
+            const QString& tableName,
+            const QString& containerIdColumn,
+            TrackId trackId);
+
+    void insert(TrackId trackId, int containerId);
+    /// Removes a single occurrence of trackId in containerId
+    void remove(TrackId trackId, int containerId);
+    /// Removes all tracks of containerId
+    void removeContainer(int containerId);
+
+    bool contains(TrackId trackId, int containerId) const;
+    /// Returns the sorted ids of all containers that contain trackId.
+    /// An id occurs as often as the track occurs in the container.
+    const ContainerIds& containerIds(TrackId trackId) const;
+    QSet<int> containerIdSet(TrackId trackId) const;
+
+    /// The number of (track, container) rows
+    int size() const {
+        return m_size;
+    }
+    int numTracks() const {
+        return m_containerIds.size();
+    }
+
+  private:
+    struct Rows {
+        QHash<TrackId, ContainerIds> containerIds;
+        int size = 0;
+    };
+    static bool queryRows(Rows* pRows,
+            const QSqlDatabase& database,
+            const QString& tableName,
+            const QString& containerIdColumn);
+    static std::optional<Rows> queryRowsPooled(
+            const mixxx::DbConnectionPoolPtr& pDbConnectionPool,
+            const QString& tableName,
+            const QString& containerIdColumn);
+    void startQueryRowsInBackground();
+
+    QHash<TrackId, ContainerIds> m_containerIds;
+    int m_size = 0;
+    bool m_populated = false;
+
+    /// Counts all modifications, including the ignored ones
+    quint64 m_modificationCount = 0;
+
+    bool m_populatingInBackground = false;
+    mixxx::DbConnectionPoolPtr m_pDbConnectionPool;
+    QString m_tableName;
+    QString m_containerIdColumn;
+    QFuture<std::optional<Rows>> m_backgroundRows;
+    quint64 m_backgroundModificationCount = 0;
+};
@@ -1,8 +1,11 @@
 #include "library/export/engineprimeexportjob.h"
 
+#include <QFuture>
 #include <QHash>
 #include <QMetaMethod>
+#include <QQueue>
 #include <QStringList>
+#include <QtConcurrentRun>
 #include <QtGlobal>
 #include <array>
 #include <chrono>
@@ -11,6 +14,7 @@
 #include <memory>
 #include <stdexcept>
 
+#include "library/export/exportfilecopier.h"
 #include "library/trackcollection.h"
 #include "library/trackset/crate/crate.h"
 #include "track/track.h"
@@ -30,6 +34,10 @@ constexpr int kMaxHotCues = 8;
 
 constexpr uint8_t kDefaultWaveformOpacity = 127;
 
+// Bounds the number of tracks that are copied and converted ahead of the
+// database writes, and with it the number of waveforms held in memory.
+constexpr int kMaxPendingTracks = 16;
+
 const QStringList kSupportedFileTypes = {
         "aac",
         "m4a",
@@ -74,8 +82,7 @@ std::optional<djinterop::musical_key> toDjinteropKey(
     return keyMap[key];
 }
 
-QString exportFile(const QSharedPointer<EnginePrimeExportRequest> pRequest,
-        TrackPointer pTrack) {
+void verifyExportDirectories(const QSharedPointer<EnginePrimeExportRequest> pRequest) {
     if (!pRequest->engineLibraryDbDir.exists()) {
         const auto msg = QStringLiteral(
                 "Engine Library DB directory %1 has been removed from disk!")
@@ -87,22 +94,13 @@ QString exportFile(const QSharedPointer<EnginePrimeExportRequest> pRequest,
                                  .arg(pRequest->musicFilesDir.absolutePath());
         throw std::runtime_error{msg.toStdString()};
     }
+}
 
-    // Copy music files into the Mixxx export dir, if the source file has
-    // been modified (or the destination doesn't exist).  To ensure no
-    // chance of filename clashes, and to keep things simple, we will prefix
-    // the destination files with the DB track identifier.
-    mixxx::FileInfo srcFileInfo = pTrack->getFileInfo();
+QString exportFileName(TrackPointer pTrack) {
+    // To ensure no chance of filename clashes, and to keep things simple, we
+    // will prefix the destination files with the DB track identifier.
     const auto trackId = pTrack->getId().value();
-    QString dstFilename = QString::number(trackId) + " - " + srcFileInfo.fileName();
-    QString dstPath = pRequest->musicFilesDir.filePath(dstFilename);
-    if (!QFile::exists(dstPath) ||
-            srcFileInfo.lastModified() > QFileInfo{dstPath}.lastModified()) {
-        const auto srcPath = srcFileInfo.location();
-        QFile::copy(srcPath, dstPath);
-    }
-
-    return pRequest->engineLibraryDbDir.relativeFilePath(dstPath);
+    return QString::number(trackId) + " - " + pTrack->getFileInfo().fileName();
 }
 
 std::optional<djinterop::track> getTrackByRelativePath(
@@ -168,10 +166,63 @@ bool tryGetBeatgrid(BeatsPointer pBeats,
     return true;
 }
 
+/// The beat grid and waveform of a track in the Engine Prime format.
+///
+/// Converting them does not access the external database, so it is done
+/// on worker threads while the music files are copied.
+struct ConvertedTrackData {
+    std::optional<std::vector<djinterop::beatgrid_marker>> beatgrid;
+    std::optional<std::vector<djinterop::waveform_entry>> waveform;
+};
+
+ConvertedTrackData convertTrackData(
+        TrackPointer pTrack,
+        std::shared_ptr<const Waveform> pWaveform) {
+    ConvertedTrackData convertedData;
+
+    // Frames used interchangeably with "samples" here.
+    const auto frameCount = static_cast<int64_t>(pTrack->getDuration() * pTrack->getSampleRate());
+
+    BeatsPointer beats = pTrack->getBeats();
+    if (beats != nullptr) {
+        std::vector<djinterop::beatgrid_marker> beatgrid;
+        if (tryGetBeatgrid(beats, pTrack->getMainCuePosition(), frameCount, &beatgrid)) {
+            convertedData.beatgrid = std::move(beatgrid);
+        } else {
+            qWarning() << "Beats data exists but is invalid for track"
+                       << pTrack->getId() << "("
+                       << pTrack->getFileInfo().fileName() << ")";
+        }
+    } else {
+        qInfo() << "No beats data found for track" << pTrack->getId()
+                << "(" << pTrack->getFileInfo().fileName() << ")";
+    }
+
+    if (pWaveform) {
+        int64_t samplesPerEntry =
+                el::required_waveform_samples_per_entry(pTrack->getSampleRate());
+        int64_t externalWaveformSize = (frameCount + samplesPerEntry - 1) / samplesPerEntry;
+        std::vector<djinterop::waveform_entry> externalWaveform;
+        externalWaveform.reserve(externalWaveformSize);
+        for (int64_t i = 0; i < externalWaveformSize; ++i) {
+            int64_t j = pWaveform->getDataSize() * i / externalWaveformSize;
+            externalWaveform.push_back({{pWaveform->getLow(j), kDefaultWaveformOpacity},
+                    {pWaveform->getMid(j), kDefaultWaveformOpacity},
+                    {pWaveform->getHigh(j), kDefaultWaveformOpacity}});
+        }
+        convertedData.waveform = std::move(externalWaveform);
+    } else {
+        qInfo() << "No waveform data found for track" << pTrack->getId()
+                << "(" << pTrack->getFileInfo().fileName() << ")";
+    }
+
+    return convertedData;
+}
+
 void exportMetadata(djinterop::database* pDatabase,
         QHash<TrackId, int64_t>* pMixxxToEnginePrimeTrackIdMap,
         TrackPointer pTrack,
-        const Waveform* pWaveform,
+        ConvertedTrackData convertedData,
         const QString& relativePath) {
     // Attempt to load the track in the database, using the relative path to
     // the music file.  If it exists already, take a snapshot of the track and
@@ -233,20 +284,9 @@ void exportMetadata(djinterop::database* pDatabase,
     snapshot.adjusted_main_cue = cuePlayPosValue;
 
     // Fill in beat grid.
-    BeatsPointer beats = pTrack->getBeats();
-    if (beats != nullptr) {
-        std::vector<djinterop::beatgrid_marker> beatgrid;
-        if (tryGetBeatgrid(beats, cuePlayPos, frameCount, &beatgrid)) {
-            snapshot.default_beatgrid = beatgrid;
-            snapshot.adjusted_beatgrid = beatgrid;
-        } else {
-            qWarning() << "Beats data exists but is invalid for track"
-                       << pTrack->getId() << "("
-                       << pTrack->getFileInfo().fileName() << ")";
-        }
-    } else {
-        qInfo() << "No beats data found for track" << pTrack->getId()
-                << "(" << pTrack->getFileInfo().fileName() << ")";
+    if (convertedData.beatgrid) {
+        snapshot.default_beatgrid = *convertedData.beatgrid;
+        snapshot.adjusted_beatgrid = *convertedData.beatgrid;
     }
 
     // Note that any existing hot cues on the track are kept in place, if Mixxx
@@ -305,22 +345,8 @@ void exportMetadata(djinterop::database* pDatabase,
     // Write waveform.
     // Note that writing a single waveform will automatically calculate an
     // overview waveform too.
-    if (pWaveform) {
-        int64_t samplesPerEntry =
-                el::required_waveform_samples_per_entry(pTrack->getSampleRate());
-        int64_t externalWaveformSize = (frameCount + samplesPerEntry - 1) / samplesPerEntry;
-        std::vector<djinterop::waveform_entry> externalWaveform;
-        externalWaveform.reserve(externalWaveformSize);
-        for (int64_t i = 0; i < externalWaveformSize; ++i) {
-            int64_t j = pWaveform->getDataSize() * i / externalWaveformSize;
-            externalWaveform.push_back({{pWaveform->getLow(j), kDefaultWaveformOpacity},
-                    {pWaveform->getMid(j), kDefaultWaveformOpacity},
-                    {pWaveform->getHigh(j), kDefaultWaveformOpacity}});
-        }
-        snapshot.waveform = std::move(externalWaveform);
-    } else {
-        qInfo() << "No waveform data found for track" << pTrack->getId()
-                << "(" << pTrack->getFileInfo().fileName() << ")";
+    if (convertedData.waveform) {
+        snapshot.waveform = std::move(*convertedData.waveform);
     }
 
     int externalTrackId;
@@ -336,30 +362,12 @@ void exportMetadata(djinterop::database* pDatabase,
     pMixxxToEnginePrimeTrackIdMap->insert(pTrack->getId(), externalTrackId);
 }
 
-void exportTrack(
-        const QSharedPointer<EnginePrimeExportRequest> pRequest,
-        djinterop::database* pDatabase,
-        QHash<TrackId, int64_t>* pMixxxToEnginePrimeTrackIdMap,
-        const TrackPointer pTrack,
-        const Waveform* pWaveform) {
-    // Only export supported file types.
-    if (!kSupportedFileTypes.contains(pTrack->getType())) {
-        qInfo() << "Skipping file" << pTrack->getFileInfo().fileName()
-                << "(id" << pTrack->getId() << ") as its file type"
-                << pTrack->getType() << "is not supported";
-        return;
-    }
-
-    // Copy the file, if required.
-    const auto musicFileRelativePath = exportFile(pRequest, pTrack);
-
-    // Export meta-data.
-    exportMetadata(pDatabase,
-            pMixxxToEnginePrimeTrackIdMap,
-            pTrack,
-            pWaveform,
-            musicFileRelativePath);
-}
+struct PendingTrack {
+    TrackPointer pTrack;
+    QString relativePath;
+    QFuture<ExportFileCopier::CopyResult> copyResult;
+    QFuture<ConvertedTrackData> convertedData;
+};
 
 void exportCrate(
         djinterop::crate* pExtRootCrate,
@@ -539,6 +547,74 @@ void EnginePrimeExportJob::run() {
     // We will build up a map from Mixxx track id to EL track id during export.
     QHash<TrackId, int64_t> mixxxToEnginePrimeTrackIdMap;
 
+    // Music files are copied with bounded parallelism and the beat grids and
+    // waveforms are converted on worker threads, while the tracks are written
+    // to the database in order on this thread, because the database must not
+    // be accessed concurrently.  Files that have been copied by an earlier,
+    // interrupted export are skipped, and writing a track that already exists
+    // in the database updates it, so the export can simply be restarted.
+    ExportFileCopier copier(m_pRequest->musicFilesDir, &m_cancellationRequested);
+    QQueue<PendingTrack> pendingTracks;
+    const auto cancelPendingTracks = [&copier, &pendingTracks] {
+        copier.cancel();
+        while (!pendingTracks.isEmpty()) {
+            pendingTracks.dequeue().convertedData.waitForFinished();
+        }
+        copier.waitForDone();
+    };
+    // Waits for the oldest pending track and writes it to the database
+    const auto exportPendingTrack = [&]() -> bool {
+        PendingTrack pendingTrack = pendingTracks.dequeue();
+        const TrackPointer pTrack = pendingTrack.pTrack;
+        try {
+            const ExportFileCopier::CopyResult copyResult =
+                    pendingTrack.copyResult.result();
+            if (copyResult.status == ExportFileCopier::Status::Canceled) {
+                return false;
+            }
+            if (copyResult.status == ExportFileCopier::Status::Failed) {
+                const auto msg = QStringLiteral("Failed to copy %1: %2")
+                                         .arg(pTrack->getFileInfo().location(),
+                                                 copyResult.errorString);
+                throw std::runtime_error{msg.toStdString()};
+            }
+            exportMetadata(pDb.get(),
+                    &mixxxToEnginePrimeTrackIdMap,
+                    pTrack,
+                    pendingTrack.convertedData.result(),
+                    pendingTrack.relativePath);
+        } catch (std::exception& e) {
+            qWarning() << "Failed to export track"
+                       << pTrack->getId().value() << ":"
+                       << e.what();
+            m_lastErrorMessage = e.what();
+            return false;
+        }
+        return true;
+    };
+    // Writes the pending tracks that are ready, or all of them after the
+    // last track has been loaded.  Returns false if the export has been
+    // aborted.
+    const auto exportPendingTracks = [&](bool exportAll) -> bool {
+        while (!pendingTracks.isEmpty() &&
+                (exportAll || pendingTracks.size() >= kMaxPendingTracks ||
+                        (pendingTracks.head().copyResult.isFinished() &&
+                                pendingTracks.head().convertedData.isFinished()))) {
+            if (!exportPendingTrack()) {
+                cancelPendingTracks();
+                if (m_cancellationRequested.loadAcquire() != 0) {
+                    qInfo() << "Cancelling export";
+                } else {
+                    emit failed(m_lastErrorMessage);
+                }
+                return false;
+            }
+            ++currProgress;
+            emit jobProgress(currProgress);
+        }
+        return true;
+    };
+
     for (const auto& trackRef : qAsConst(m_trackRefs)) {
         // Load each track.
         // Note that loading must happen on the same thread as the track collection
@@ -551,32 +627,54 @@ void EnginePrimeExportJob::run() {
 
         if (m_cancellationRequested.loadAcquire() != 0) {
             qInfo() << "Cancelling export";
+            cancelPendingTracks();
             return;
         }
 
         DEBUG_ASSERT(m_pLastLoadedTrack != nullptr);
+        const TrackPointer pTrack = std::move(m_pLastLoadedTrack);
+        std::shared_ptr<const Waveform> pWaveform = std::move(m_pLastLoadedWaveform);
+
+        if (kSupportedFileTypes.contains(pTrack->getType())) {
+            qInfo() << "Exporting track" << pTrack->getId().value()
+                    << "at" << pTrack->getFileInfo().location() << "...";
+            try {
+                verifyExportDirectories(m_pRequest);
+            } catch (std::exception& e) {
+                qWarning() << "Failed to export track"
+                           << pTrack->getId().value() << ":"
+                           << e.what();
+                cancelPendingTracks();
+                m_lastErrorMessage = e.what();
+                emit failed(m_lastErrorMessage);
+                return;
+            }
+            const QString fileName = exportFileName(pTrack);
+            PendingTrack pendingTrack;
+            pendingTrack.pTrack = pTrack;
+            pendingTrack.relativePath = m_pRequest->engineLibraryDbDir.relativeFilePath(
+                    m_pRequest->musicFilesDir.filePath(fileName));
+            pendingTrack.copyResult = copier.copyIfChanged(pTrack->getFileInfo(), fileName);
+            pendingTrack.convertedData = QtConcurrent::run(
+                    [pTrack, pWaveform = std::move(pWaveform)] {
+                        return convertTrackData(pTrack, pWaveform);
+                    });
+            pendingTracks.enqueue(std::move(pendingTrack));
+        } else {
+            // Only export supported file types.
+            qInfo() << "Skipping file" << pTrack->getFileInfo().fileName()
+                    << "(id" << pTrack->getId() << ") as its file type"
+                    << pTrack->getType() << "is not supported";
+            ++currProgress;
+            emit jobProgress(currProgress);
+        }
 
-        qInfo() << "Exporting track" << m_pLastLoadedTrack->getId().value()
-                << "at" << m_pLastLoadedTrack->getFileInfo().location() << "...";
-        try {
-            exportTrack(m_pRequest,
-                    pDb.get(),
-                    &mixxxToEnginePrimeTrackIdMap,
-                    m_pLastLoadedTrack,
-                    m_pLastLoadedWaveform.get());
-        } catch (std::exception& e) {
-            qWarning() << "Failed to export track"
-                       << m_pLastLoadedTrack->getId().value() << ":"
-                       << e.what();
-            m_lastErrorMessage = e.what();
-            emit failed(m_lastErrorMessage);
+        if (!exportPendingTracks(false)) {
             return;
         }
-
-        m_pLastLoadedTrack.reset();
-
-        ++currProgress;
-        emit jobProgress(currProgress);
+    }
+    if (!exportPendingTracks(true)) {
+        return;
     }
 
     // We will ensure that there is a special top-level crate representing the
@@ -63,7 +63,7 @@ class EnginePrimeExportJob : public QThread {
     QList<TrackRef> m_trackRefs;
     QList<CrateId> m_crateIds;
     TrackPointer m_pLastLoadedTrack;
-    std::unique_ptr<Waveform> m_pLastLoadedWaveform;
+    std::shared_ptr<const Waveform> m_pLastLoadedWaveform;
     Crate m_lastLoadedCrate;
     QList<TrackId> m_lastLoadedCrateTrackIds;
 
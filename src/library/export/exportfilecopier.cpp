@@ -0,0 +1,312 @@
+#include "library/export/exportfilecopier.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QtConcurrentRun>
+
+#include "util/assert.h"
+#include "util/compatibility/qmutex.h"
+#include "util/logger.h"
+
+namespace mixxx {
+
+namespace {
+
+const Logger kLogger("ExportFileCopier");
+
+// The checkpoint is stored in a subdirectory that is hidden on most
+// platforms and does not show up in listings of the exported files.
+const QString kCheckpointDirName = QStringLiteral(".mixxx-export");
+const QString kCheckpointFileName = QStringLiteral("checkpoint.jsonl");
+
+const QString kFileKey = QStringLiteral("file");
+const QString kSourceKey = QStringLiteral("source");
+const QString kSizeKey = QStringLiteral("size");
+const QString kLastModifiedKey = QStringLiteral("lastModified");
+const QString kHashKey = QStringLiteral("sha1");
+
+constexpr qint64 kCopyBufferSize = 1024 * 1024;
+
+qint64 lastModifiedMs(const QFileInfo& fileInfo) {
+    const QDateTime lastModified = fileInfo.lastModified();
+    return lastModified.isValid() ? lastModified.toMSecsSinceEpoch() : 0;
+}
+
+QByteArray hashFile(const QString& location) {
+    QFile file(location);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (!hash.addData(&file)) {
+        return QByteArray();
+    }
+    return hash.result().toHex();
+}
+
+} // anonymous namespace
+
+ExportFileCopier::ExportFileCopier(const QDir& destDir,
+        const QAtomicInteger<int>* pCancellationRequested,
+        int maxConcurrentCopies)
+        : m_destDir(destDir),
+          m_pCancellationRequested(pCancellationRequested),
+          m_canceled(0) {
+    DEBUG_ASSERT(maxConcurrentCopies > 0);
+    m_threadPool.setMaxThreadCount(maxConcurrentCopies);
+    m_threadPool.setObjectName(QStringLiteral("ExportFileCopier"));
+    loadCheckpoint();
+}
+
+ExportFileCopier::~ExportFileCopier() {
+    waitForDone();
+    compactCheckpoint();
+}
+
+//static
+QString ExportFileCopier::checkpointFilePath(const QDir& destDir) {
+    return destDir.filePath(kCheckpointDirName + QChar('/') + kCheckpointFileName);
+}
+
+bool ExportFileCopier::isCancellationRequested() const {
+    return m_canceled.loadAcquire() != 0 ||
+            (m_pCancellationRequested &&
+                    m_pCancellationRequested->loadAcquire() != 0);
+}
+
+void ExportFileCopier::cancel() {
+    m_canceled = 1;
+}
+
+void ExportFileCopier::waitForDone() {
+    m_threadPool.waitForDone();
+}
+
+bool ExportFileCopier::isUnchanged(
+        const FileInfo& sourceFileInfo, const QString& destFileName) {
+    return isUnchangedEntry(QFileInfo(sourceFileInfo.location()), destFileName, false);
+}
+
+bool ExportFileCopier::isUnchangedEntry(const QFileInfo& sourceInfo,
+        const QString& destFileName,
+        bool adoptUnrecordedFiles) {
+    const QFileInfo destInfo(m_destDir.filePath(destFileName));
+    if (!sourceInfo.exists() || !destInfo.exists()) {
+        return false;
+    }
+    const QString sourceLocation = sourceInfo.absoluteFilePath();
+
+    Entry entry;
+    bool recorded;
+    {
+        const auto locked = lockMutex(&m_mutex);
+        const auto it = m_entries.constFind(destFileName);
+        recorded = it != m_entries.constEnd();
+        if (recorded) {
+            entry = it.value();
+        }
+    }
+    if (!recorded) {
+        if (!adoptUnrecordedFiles ||
+                destInfo.size() != sourceInfo.size() ||
+                destInfo.lastModified() < sourceInfo.lastModified()) {
+            return false;
+        }
+        // The hash is unknown. The file is copied again if the source
+        // is modified, even if its contents are the same.
+        entry.sourceLocation = sourceLocation;
+        entry.size = sourceInfo.size();
+        entry.lastModifiedMs = lastModifiedMs(sourceInfo);
+        recordEntry(destFileName, entry);
+        return true;
+    }
+
+    if (entry.sourceLocation != sourceLocation ||
+            entry.size != sourceInfo.size() ||
+            entry.size != destInfo.size()) {
+        return false;
+    }
+    const qint64 sourceLastModifiedMs = lastModifiedMs(sourceInfo);
+    if (entry.lastModifiedMs == sourceLastModifiedMs) {
+        return true;
+    }
+    // The file has been touched, e.g. by rewriting its tags with the same
+    // values or by copying the library to a new disk.
+    if (entry.hash.isEmpty() || hashFile(sourceLocation) != entry.hash) {
+        return false;
+    }
+    entry.lastModifiedMs = sourceLastModifiedMs;
+    recordEntry(destFileName, entry);
+    return true;
+}
+
+QFuture<ExportFileCopier::CopyResult> ExportFileCopier::copy(
+        const FileInfo& sourceFileInfo, const QString& destFileName) {
+    return QtConcurrent::run(&m_threadPool,
+            [this, sourceLocation = sourceFileInfo.location(), destFileName] {
+                return copyFile(sourceLocation, destFileName);
+            });
+}
+
+QFuture<ExportFileCopier::CopyResult> ExportFileCopier::copyIfChanged(
+        const FileInfo& sourceFileInfo, const QString& destFileName) {
+    return QtConcurrent::run(&m_threadPool,
+            [this, sourceLocation = sourceFileInfo.location(), destFileName] {
+                if (isCancellationRequested()) {
+                    return CopyResult{Status::Canceled, QString()};
+                }
+                if (isUnchangedEntry(QFileInfo(sourceLocation), destFileName, true)) {
+                    return CopyResult{Status::Unchanged, QString()};
+                }
+                return copyFile(sourceLocation, destFileName);
+            });
+}
+
+ExportFileCopier::CopyResult ExportFileCopier::copyFile(
+        const QString& sourceLocation, const QString& destFileName) {
+    if (isCancellationRequested()) {
+        return CopyResult{Status::Canceled, QString()};
+    }
+
+    // Capture the source attributes before reading, so a file that is
+    // modified while it is copied will be copied again next time.
+    const QFileInfo sourceInfo(sourceLocation);
+    Entry entry;
+    entry.sourceLocation = sourceInfo.absoluteFilePath();
+    entry.lastModifiedMs = lastModifiedMs(sourceInfo);
+
+    QFile source(sourceLocation);
+    if (!source.open(QIODevice::ReadOnly)) {
+        return CopyResult{Status::Failed, source.errorString()};
+    }
+    const QString destPath = m_destDir.filePath(destFileName);
+    QSaveFile dest(destPath);
+    if (!dest.open(QIODevice::WriteOnly)) {
+        return CopyResult{Status::Failed, dest.errorString()};
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    QByteArray buffer;
+    qint64 size = 0;
+    while (!source.atEnd()) {
+        if (isCancellationRequested()) {
+            dest.cancelWriting();
+            return CopyResult{Status::Canceled, QString()};
+        }
+        buffer = source.read(kCopyBufferSize);
+        if (buffer.isEmpty()) {
+            if (source.error() != QFileDevice::NoError) {
+                dest.cancelWriting();
+                return CopyResult{Status::Failed, source.errorString()};
+            }
+            break;
+        }
+        hash.addData(buffer);
+        if (dest.write(buffer) != buffer.size()) {
+            dest.cancelWriting();
+            return CopyResult{Status::Failed, dest.errorString()};
+        }
+        size += buffer.size();
+    }
+    if (!dest.commit()) {
+        return CopyResult{Status::Failed, dest.errorString()};
+    }
+
+    entry.size = size;
+    entry.hash = hash.result().toHex();
+    recordEntry(destFileName, entry);
+    if (kLogger.traceEnabled()) {
+        kLogger.trace() << "Copied" << sourceLocation << "to" << destPath;
+    }
+    return CopyResult{Status::Copied, QString()};
+}
+
+void ExportFileCopier::loadCheckpoint() {
+    QFile file(checkpointFilePath(m_destDir));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    // Later lines replace earlier lines of the same file. A line that
+    // is incomplete, because the export has been interrupted while it has
+    // been written, is ignored.
+    while (!file.atEnd()) {
+        const QJsonObject object = QJsonDocument::fromJson(file.readLine()).object();
+        const QString fileName = object.value(kFileKey).toString();
+        if (fileName.isEmpty()) {
+            continue;
+        }
+        Entry entry;
+        entry.sourceLocation = object.value(kSourceKey).toString();
+        entry.size = static_cast<qint64>(object.value(kSizeKey).toDouble(-1));
+        entry.lastModifiedMs = static_cast<qint64>(object.value(kLastModifiedKey).toDouble());
+        entry.hash = object.value(kHashKey).toString().toLatin1();
+        m_entries.insert(fileName, entry);
+    }
+    kLogger.info()
+            << "Resuming export with"
+            << m_entries.size()
+            << "files from"
+            << file.fileName();
+}
+
+//static
+QByteArray ExportFileCopier::journalLine(const QString& destFileName, const Entry& entry) {
+    QJsonObject object;
+    object.insert(kFileKey, destFileName);
+    object.insert(kSourceKey, entry.sourceLocation);
+    // JSON numbers are doubles, which represent sizes and timestamps exactly
+    object.insert(kSizeKey, static_cast<double>(entry.size));
+    object.insert(kLastModifiedKey, static_cast<double>(entry.lastModifiedMs));
+    if (!entry.hash.isEmpty()) {
+        object.insert(kHashKey, QString::fromLatin1(entry.hash));
+    }
+    return QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n';
+}
+
+void ExportFileCopier::recordEntry(const QString& destFileName, const Entry& entry) {
+    const QByteArray line = journalLine(destFileName, entry);
+
+    const auto locked = lockMutex(&m_mutex);
+    m_entries.insert(destFileName, entry);
+    if (!m_journal.isOpen()) {
+        m_destDir.mkpath(kCheckpointDirName);
+        m_journal.setFileName(checkpointFilePath(m_destDir));
+        if (!m_journal.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            kLogger.warning()
+                    << "Failed to open checkpoint"
+                    << m_journal.fileName()
+                    << m_journal.errorString();
+            return;
+        }
+    }
+    // Flush every line, so the copy is recorded even if Mixxx is killed
+    m_journal.write(line);
+    m_journal.flush();
+}
+
+bool ExportFileCopier::compactCheckpoint() {
+    const auto locked = lockMutex(&m_mutex);
+    if (!m_journal.isOpen()) {
+        // Nothing has been appended since the checkpoint has been loaded
+        return true;
+    }
+    m_journal.close();
+
+    QSaveFile file(checkpointFilePath(m_destDir));
+    if (!file.open(QIODevice::WriteOnly)) {
+        kLogger.warning()
+                << "Failed to compact checkpoint"
+                << file.fileName()
+                << file.errorString();
+        return false;
+    }
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        file.write(journalLine(it.key(), it.value()));
+    }
+    return file.commit();
+}
+
+} // namespace mixxx
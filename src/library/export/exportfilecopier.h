@@ -0,0 +1,114 @@
+#pragma once
+
+#include <QAtomicInteger>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QThreadPool>
+
+#include "util/fileinfo.h"
+
+namespace mixxx {
+
+/// Copies music files into an export directory, typically on removable
+/// media, with a bounded number of concurrent copies.
+///
+/// Every completed copy is recorded in a checkpoint inside the export
+/// directory. The checkpoint is an append-only journal with one line per
+/// copy, so recording a copy costs a single small write and an export that
+/// has been interrupted can be resumed from what has been recorded. A file
+/// is unchanged if its size and modification time match the checkpoint.
+/// If only the modification time differs the contents are compared by hash.
+///
+/// Files are written to a temporary file first and renamed when complete,
+/// so the destination never contains partially copied files.
+class ExportFileCopier {
+  public:
+    /// USB sticks and SD cards get slower with more concurrent writers.
+    /// Two copies keep the device busy while the next file is read.
+    static constexpr int kDefaultMaxConcurrentCopies = 2;
+
+    enum class Status {
+        Copied,
+        Unchanged,
+        Failed,
+        Canceled,
+    };
+
+    struct CopyResult {
+        Status status;
+        QString errorString;
+    };
+
+    /// The copier checks pCancellationRequested, if given, before and
+    /// while copying a file. Copies are canceled when it is non-zero.
+    explicit ExportFileCopier(const QDir& destDir,
+            const QAtomicInteger<int>* pCancellationRequested = nullptr,
+            int maxConcurrentCopies = kDefaultMaxConcurrentCopies);
+    /// Waits for all running copies and compacts the checkpoint.
+    ~ExportFileCopier();
+
+    const QDir& destDir() const {
+        return m_destDir;
+    }
+
+    /// Returns true if destFileName has been copied from sourceFileInfo
+    /// before and neither file has changed since.
+    bool isUnchanged(const FileInfo& sourceFileInfo, const QString& destFileName);
+
+    /// Copies the file in the background and replaces an existing file.
+    QFuture<CopyResult> copy(const FileInfo& sourceFileInfo, const QString& destFileName);
+
+    /// Like copy(), but skips the file if it is unchanged. An existing file
+    /// that is not in the checkpoint is also considered unchanged if it has
+    /// the same size and is not older than the source, i.e. if it has been
+    /// exported before the checkpoint existed.
+    QFuture<CopyResult> copyIfChanged(
+            const FileInfo& sourceFileInfo, const QString& destFileName);
+
+    /// Cancels all copies that have not finished yet. They finish with
+    /// Status::Canceled and leave the destination untouched.
+    void cancel();
+    void waitForDone();
+
+    /// Rewrites the checkpoint with a single line per file
+    bool compactCheckpoint();
+
+    static QString checkpointFilePath(const QDir& destDir);
+
+  private:
+    struct Entry {
+        QString sourceLocation;
+        qint64 size = -1;
+        qint64 lastModifiedMs = 0;
+        QByteArray hash;
+    };
+
+    bool isCancellationRequested() const;
+
+    CopyResult copyFile(const QString& sourceLocation, const QString& destFileName);
+    bool isUnchangedEntry(const QFileInfo& sourceInfo,
+            const QString& destFileName,
+            bool adoptUnrecordedFiles);
+
+    static QByteArray journalLine(const QString& destFileName, const Entry& entry);
+    void loadCheckpoint();
+    void recordEntry(const QString& destFileName, const Entry& entry);
+
+    const QDir m_destDir;
+    const QAtomicInteger<int>* const m_pCancellationRequested;
+    QAtomicInteger<int> m_canceled;
+
+    QThreadPool m_threadPool;
+
+    // Guards the entries and the journal
+    QMutex m_mutex;
+    QHash<QString, Entry> m_entries;
+    QFile m_journal;
+};
+
+} // namespace mixxx
@@ -3,12 +3,16 @@
 #include <QDebug>
 #include <QFileInfo>
 #include <QMessageBox>
+#include <QQueue>
 
 #include "moc_trackexportworker.cpp"
 #include "track/track.h"
 
 namespace {
 
+// Bounds the number of files that have been checked ahead of the copies
+constexpr int kMaxPendingCopies = 16;
+
 QString rewriteFilename(const mixxx::FileInfo& fileinfo, int index) {
     // We don't have total control over the inputs, so definitely
     // don't use .arg().arg().arg().
@@ -69,80 +73,124 @@ QMap<QString, mixxx::FileInfo> createCopylist(const TrackPointerList& tracks) {
 }  // namespace
 
 void TrackExportWorker::run() {
+    const QMap<QString, mixxx::FileInfo> copy_list = createCopylist(m_tracks);
+    const int count = copy_list.size();
+
+    // Files are copied in the background while the next files are checked.
+    // Copies that have been completed by an earlier, interrupted export
+    // to the same directory are skipped.
+    mixxx::ExportFileCopier copier(QDir(m_destDir), &m_bStop);
+    QQueue<PendingCopy> pending_copies;
     int i = 0;
-    QMap<QString, mixxx::FileInfo> copy_list = createCopylist(m_tracks);
     for (auto it = copy_list.constBegin(); it != copy_list.constEnd(); ++it) {
-        // We emit progress twice per loop, which may seem excessive, but it
+        // We emit progress twice per file, which may seem excessive, but it
         // guarantees that we emit a sane progress before we start and after
         // we end.  In between, each filename will get its own visible tick
         // on the bar, which looks really nice.
-        emit progress(it->fileName(), i, copy_list.size());
-        copyFile(*it, it.key());
+        emit progress(it->fileName(), i, count);
+        PendingCopy pending_copy;
+        pending_copy.source_fileinfo = *it;
+        pending_copy.dest_filename = it.key();
+        if (shouldCopyFile(&copier, *it, it.key())) {
+            pending_copy.result = copier.copy(*it, it.key());
+            pending_copy.skipped = false;
+        }
         if (m_bStop.loadAcquire()) {
-            emit canceled();
-            return;
+            break;
+        }
+        pending_copies.enqueue(pending_copy);
+
+        // Report the progress in order of the copy list
+        while (!pending_copies.isEmpty() &&
+                (pending_copies.size() > kMaxPendingCopies ||
+                        pending_copies.head().isFinished())) {
+            const PendingCopy finished_copy = pending_copies.dequeue();
+            finishCopy(finished_copy);
+            if (m_bStop.loadAcquire()) {
+                break;
+            }
+            ++i;
+            emit progress(finished_copy.source_fileinfo.fileName(), i, count);
+        }
+        if (m_bStop.loadAcquire()) {
+            break;
+        }
+    }
+    while (!pending_copies.isEmpty()) {
+        const PendingCopy pending_copy = pending_copies.dequeue();
+        finishCopy(pending_copy);
+        if (m_bStop.loadAcquire()) {
+            break;
         }
         ++i;
-        emit progress(it->fileName(), i, copy_list.size());
+        emit progress(pending_copy.source_fileinfo.fileName(), i, count);
+    }
+    if (m_bStop.loadAcquire()) {
+        // Discard the copies that are still running
+        copier.cancel();
+        copier.waitForDone();
+        emit canceled();
     }
 }
 
-void TrackExportWorker::copyFile(
+bool TrackExportWorker::shouldCopyFile(
+        mixxx::ExportFileCopier* pCopier,
         const mixxx::FileInfo& source_fileinfo,
         const QString& dest_filename) {
     QString sourceFilename = source_fileinfo.canonicalLocation();
     const QString dest_path = QDir(m_destDir).filePath(dest_filename);
     QFileInfo dest_fileinfo(dest_path);
 
-    if (dest_fileinfo.exists()) {
-        switch (m_overwriteMode) {
-        // Give the user the option to overwrite existing files in the destination.
-        case OverwriteMode::ASK:
-            switch (makeOverwriteRequest(dest_path)) {
-            case OverwriteAnswer::SKIP:
-            case OverwriteAnswer::SKIP_ALL:
-                qDebug() << "skipping" << sourceFilename;
-                return;
-            case OverwriteAnswer::OVERWRITE:
-            case OverwriteAnswer::OVERWRITE_ALL:
-                break;
-            case OverwriteAnswer::CANCEL:
-                m_errorMessage = tr("Export process was canceled");
-                stop();
-                return;
-            }
-            break;
-        case OverwriteMode::SKIP_ALL:
+    if (!dest_fileinfo.exists()) {
+        return true;
+    }
+    if (pCopier->isUnchanged(source_fileinfo, dest_filename)) {
+        qDebug() << "skipping unchanged" << sourceFilename;
+        return false;
+    }
+    switch (m_overwriteMode) {
+    // Give the user the option to overwrite existing files in the destination.
+    case OverwriteMode::ASK:
+        switch (makeOverwriteRequest(dest_path)) {
+        case OverwriteAnswer::SKIP:
+        case OverwriteAnswer::SKIP_ALL:
             qDebug() << "skipping" << sourceFilename;
-            return;
-        case OverwriteMode::OVERWRITE_ALL:;
-        }
-
-        // Remove the existing file in preparation for overwriting.
-        QFile dest_file(dest_path);
-        qDebug() << "Removing existing file" << dest_path;
-        if (!dest_file.remove()) {
-            const QString error_message = tr(
-                    "Error removing file %1: %2. Stopping.").arg(
-                    dest_path, dest_file.errorString());
-            qWarning() << error_message;
-            m_errorMessage = error_message;
+            return false;
+        case OverwriteAnswer::OVERWRITE:
+        case OverwriteAnswer::OVERWRITE_ALL:
+            return true;
+        case OverwriteAnswer::CANCEL:
+            m_errorMessage = tr("Export process was canceled");
             stop();
-            return;
+            return false;
         }
+        return false;
+    case OverwriteMode::SKIP_ALL:
+        qDebug() << "skipping" << sourceFilename;
+        return false;
+    case OverwriteMode::OVERWRITE_ALL:
+        // The existing file is replaced when the copy is complete
+        return true;
     }
+    return false;
+}
 
-    qDebug() << "Copying" << sourceFilename << "to" << dest_path;
-    QFile source_file(sourceFilename);
-    if (!source_file.copy(dest_path)) {
-        const QString error_message = tr(
-                "Error exporting track %1 to %2: %3. Stopping.").arg(
-                sourceFilename, dest_path, source_file.errorString());
-        qWarning() << error_message;
-        m_errorMessage = error_message;
-        stop();
+void TrackExportWorker::finishCopy(const PendingCopy& pending_copy) {
+    if (pending_copy.skipped) {
+        return;
+    }
+    const mixxx::ExportFileCopier::CopyResult result = pending_copy.result.result();
+    if (result.status != mixxx::ExportFileCopier::Status::Failed) {
         return;
     }
+    const QString sourceFilename = pending_copy.source_fileinfo.canonicalLocation();
+    const QString dest_path = QDir(m_destDir).filePath(pending_copy.dest_filename);
+    const QString error_message = tr(
+            "Error exporting track %1 to %2: %3. Stopping.").arg(
+            sourceFilename, dest_path, result.errorString);
+    qWarning() << error_message;
+    m_errorMessage = error_message;
+    stop();
 }
 
 TrackExportWorker::OverwriteAnswer TrackExportWorker::makeOverwriteRequest(
@@ -191,6 +239,6 @@ TrackExportWorker::OverwriteAnswer TrackExportWorker::makeOverwriteRequest(
 }
 
 void TrackExportWorker::stop() {
-    // We'll wait for the current file to finish copying, then stop.
+    // Running copies check the flag and discard what they have written.
     m_bStop = true;
 }
@@ -1,18 +1,22 @@
 #pragma once
 
+#include <QFuture>
 #include <QObject>
 #include <QScopedPointer>
 #include <QString>
 #include <QThread>
 #include <future>
 
+#include "library/export/exportfilecopier.h"
 #include "track/track_decl.h"
 #include "util/fileinfo.h"
 
 // A QThread class for copying a list of files to a single destination directory.
-// Currently does not preserve subdirectory relationships.  This class performs
-// all copies in a blocking style within its own thread.  May be canceled from
-// another thread.
+// Currently does not preserve subdirectory relationships.  Files are checked
+// and the user is asked about existing files within this thread, while the
+// copies run concurrently in the background.  Files that are unchanged since
+// an earlier export to the same directory are skipped, so an interrupted
+// export can simply be restarted.  May be canceled from another thread.
 class TrackExportWorker : public QThread {
     Q_OBJECT
   public:
@@ -48,7 +52,7 @@ class TrackExportWorker : public QThread {
         return m_errorMessage;
     }
 
-    // Cancels the export after the current copy operation.
+    // Cancels the export.  Copies that have not been completed are discarded.
     // May be called from another thread.
     void stop();
 
@@ -65,14 +69,30 @@ class TrackExportWorker : public QThread {
     void canceled();
 
   private:
-    // Copies the file at source_fileinfo to the destination directory with the
-    // name given by dest_filename (not a full path).  If the destination file
-    // exists, will emit an overwrite request signal to ask how to proceed.
-    // On unrecoverable error, sets the error message and stops the export
-    // process entirely.
-    void copyFile(const mixxx::FileInfo& source_fileinfo,
+    struct PendingCopy {
+        mixxx::FileInfo source_fileinfo;
+        QString dest_filename;
+        QFuture<mixxx::ExportFileCopier::CopyResult> result;
+        bool skipped = true;
+
+        bool isFinished() const {
+            return skipped || result.isFinished();
+        }
+    };
+
+    // Returns true if the file at source_fileinfo needs to be copied to the
+    // destination directory with the name given by dest_filename (not a full
+    // path).  If the destination file exists and has not been exported from
+    // the same source before, will emit an overwrite request signal to ask
+    // how to proceed.
+    bool shouldCopyFile(mixxx::ExportFileCopier* pCopier,
+            const mixxx::FileInfo& source_fileinfo,
             const QString& dest_filename);
 
+    // Waits for the copy.  On unrecoverable error, sets the error message
+    // and stops the export process entirely.
+    void finishCopy(const PendingCopy& pending_copy);
+
     // Emit a signal requesting overwrite mode, and block until we get an
     // answer.  Updates m_overwriteMode appropriately.
     OverwriteAnswer makeOverwriteRequest(const QString& filename);
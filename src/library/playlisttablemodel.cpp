@@ -263,6 +263,24 @@ void PlaylistTableModel::moveTrack(const QModelIndex& sourceIndex,
     m_pTrackCollectionManager->internalCollection()->getPlaylistDAO().moveTrack(m_iPlaylistId, oldPosition, newPosition);
 }
 
+bool PlaylistTableModel::moveTracks(const QModelIndexList& sourceIndices,
+        const QModelIndex& destIndex) {
+    const auto move = positionRangeMove(sourceIndices,
+            destIndex,
+            fieldIndex(ColumnCache::COLUMN_PLAYLISTTRACKSTABLE_POSITION));
+    if (!move) {
+        return false;
+    }
+    if (move->newPosition == move->firstPosition) {
+        return true;
+    }
+    PlaylistDAO& dao = m_pTrackCollectionManager->internalCollection()->getPlaylistDAO();
+    const int newPosition = move->newPosition > 0
+            ? move->newPosition
+            : dao.getMaxPosition(m_iPlaylistId) - move->count + 1;
+    return dao.moveTracks(m_iPlaylistId, move->firstPosition, move->count, newPosition);
+}
+
 bool PlaylistTableModel::isLocked() {
     return m_pTrackCollectionManager->internalCollection()->getPlaylistDAO().isPlaylistLocked(m_iPlaylistId);
 }
@@ -17,6 +17,8 @@ class PlaylistTableModel final : public TrackSetTableModel {
 
     bool appendTrack(TrackId trackId);
     void moveTrack(const QModelIndex& sourceIndex, const QModelIndex& destIndex) override;
+    /// Moves a contiguous range of tracks with a single statement.
+    bool moveTracks(const QModelIndexList& sourceIndices, const QModelIndex& destIndex) override;
     void removeTrack(const QModelIndex& index);
     void shuffleTracks(const QModelIndexList& shuffle, const QModelIndex& exclude);
 
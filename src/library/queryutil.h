@@ -7,10 +7,56 @@
 #define LOG_FAILED_QUERY(query) qWarning() << __FILE__ << __LINE__ << "FAILED QUERY [" \
     << (query).executedQuery() << "]" << (query).lastError()
 
+/// Returns an SQL expression for the number of sortedValues that are lower
+/// than the value of column, e.g. for closing the gaps in a list of
+/// positions after removing rows. The values are stored in a temporary
+/// table of the connection, which the expression looks up through its
+/// primary key. Unlike a CASE expression, this does not grow with the
+/// number of values. Column must be qualified with its table name.
+///
+/// Returns a null string if the temporary table could not be filled.
+inline QString sqlNumValuesBelowExpression(const QSqlDatabase& database,
+        const QString& column,
+        const QList<int>& sortedValues) {
+    QSqlQuery query(database);
+    if (!query.exec(QStringLiteral(
+                "CREATE TEMP TABLE IF NOT EXISTS num_values_below "
+                "(value INTEGER PRIMARY KEY, num_values INTEGER NOT NULL)")) ||
+            !query.exec(QStringLiteral("DELETE FROM temp.num_values_below"))) {
+        LOG_FAILED_QUERY(query);
+        return QString();
+    }
+    query.prepare(QStringLiteral(
+            "INSERT INTO temp.num_values_below (value, num_values) "
+            "VALUES (:value, :num_values)"));
+    for (int i = 0; i < sortedValues.size(); ++i) {
+        query.bindValue(":value", sortedValues[i]);
+        query.bindValue(":num_values", i + 1);
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query);
+            return QString();
+        }
+    }
+    return QStringLiteral(
+            "COALESCE((SELECT num_values FROM temp.num_values_below "
+            "WHERE value<%1 ORDER BY value DESC LIMIT 1),0)")
+            .arg(column);
+}
+
 class ScopedTransaction {
   public:
-    explicit ScopedTransaction(const QSqlDatabase& database) :
+    enum class Mode {
+        Deferred,
+        /// Acquires the write lock when the transaction begins instead of
+        /// on the first write. Needed if rows that are written depend on
+        /// values that have been read in the same transaction, e.g. ids
+        /// that are assigned from MAX(id).
+        Immediate,
+    };
+
+    explicit ScopedTransaction(const QSqlDatabase& database, Mode mode = Mode::Deferred) :
             m_database(database),
+            m_mode(mode),
             m_active(false) {
         if (!transaction()) {
             qDebug() << "ERROR: Could not start transaction on"
@@ -31,7 +77,17 @@ class ScopedTransaction {
                      << m_database.connectionName();
             return false;
         }
-        m_active = m_database.transaction();
+        if (m_mode == Mode::Immediate) {
+            // QSqlDatabase::transaction() always starts a deferred
+            // transaction. It is committed and rolled back as usual.
+            QSqlQuery query(m_database);
+            m_active = query.exec(QStringLiteral("BEGIN IMMEDIATE"));
+            if (!m_active) {
+                LOG_FAILED_QUERY(query);
+            }
+        } else {
+            m_active = m_database.transaction();
+        }
         return m_active;
     }
     bool commit() {
@@ -67,6 +123,7 @@ class ScopedTransaction {
     }
   private:
     QSqlDatabase m_database;
+    const Mode m_mode;
     bool m_active;
 };
 
@@ -0,0 +1,174 @@
+#include "library/rekordbox/rekordboxanlzcache.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QTextCodec>
+#include <QThread>
+#include <QtConcurrentRun>
+#include <QtDebug>
+#include <fstream>
+
+#include "library/rekordbox/rekordbox_anlz.h"
+#include "util/compatibility/qmutex.h"
+
+namespace {
+
+// Parsed files are small, mostly beat grids with a few thousand beats.
+// This is enough for the tracks of a large device.
+constexpr int kMaxCacheCostKiB = 32 * 1024;
+
+QString toUnicode(const std::string& toConvert) {
+    return QTextCodec::codecForName("UTF-16BE")
+            ->toUnicode(toConvert.data(), static_cast<int>(toConvert.length()));
+}
+
+qint64 lastModifiedMs(const QFileInfo& fileInfo) {
+    const QDateTime lastModified = fileInfo.lastModified();
+    return lastModified.isValid() ? lastModified.toMSecsSinceEpoch() : 0;
+}
+
+RekordboxAnlzData::CueList cueList(rekordbox_anlz_t::cue_list_type_t type) {
+    return type == rekordbox_anlz_t::CUE_LIST_TYPE_HOT_CUES
+            ? RekordboxAnlzData::CueList::HotCues
+            : RekordboxAnlzData::CueList::MemoryCues;
+}
+
+} // anonymous namespace
+
+//static
+std::shared_ptr<const RekordboxAnlzData> RekordboxAnlzData::parse(
+        const QString& filePath) {
+    auto pData = std::make_shared<RekordboxAnlzData>();
+    try {
+        std::ifstream ifs(filePath.toStdString(), std::ifstream::binary);
+        kaitai::kstream ks(&ifs);
+        rekordbox_anlz_t anlz = rekordbox_anlz_t(&ks);
+
+        for (rekordbox_anlz_t::tagged_section_t* pSection : *anlz.sections()) {
+            switch (pSection->fourcc()) {
+            case rekordbox_anlz_t::SECTION_TAGS_BEAT_GRID: {
+                auto* pBeatGridTag =
+                        static_cast<rekordbox_anlz_t::beat_grid_tag_t*>(
+                                pSection->body());
+                pData->hasBeatGrid = true;
+                pData->beatTimesMs.reserve(
+                        static_cast<int>(pBeatGridTag->beats()->size()));
+                for (auto* pBeat : *pBeatGridTag->beats()) {
+                    pData->beatTimesMs.append(static_cast<int>(pBeat->time()));
+                }
+            } break;
+            case rekordbox_anlz_t::SECTION_TAGS_CUES: {
+                auto* pCuesTag =
+                        static_cast<rekordbox_anlz_t::cue_tag_t*>(
+                                pSection->body());
+                for (auto* pCueEntry : *pCuesTag->cues()) {
+                    Cue cue;
+                    cue.list = cueList(pCuesTag->type());
+                    cue.isLoop = pCueEntry->type() == rekordbox_anlz_t::CUE_ENTRY_TYPE_LOOP;
+                    cue.hotCue = static_cast<int>(pCueEntry->hot_cue());
+                    cue.timeMs = static_cast<int>(pCueEntry->time());
+                    cue.loopTimeMs = static_cast<int>(pCueEntry->loop_time());
+                    pData->cues.append(cue);
+                }
+            } break;
+            case rekordbox_anlz_t::SECTION_TAGS_CUES_2: {
+                auto* pCuesExtendedTag =
+                        static_cast<rekordbox_anlz_t::cue_extended_tag_t*>(
+                                pSection->body());
+                for (auto* pCueExtendedEntry : *pCuesExtendedTag->cues()) {
+                    Cue cue;
+                    cue.list = cueList(pCuesExtendedTag->type());
+                    cue.extended = true;
+                    cue.isLoop = pCueExtendedEntry->type() ==
+                            rekordbox_anlz_t::CUE_ENTRY_TYPE_LOOP;
+                    cue.hotCue = static_cast<int>(pCueExtendedEntry->hot_cue());
+                    cue.timeMs = static_cast<int>(pCueExtendedEntry->time());
+                    cue.loopTimeMs = static_cast<int>(pCueExtendedEntry->loop_time());
+                    cue.comment = toUnicode(pCueExtendedEntry->comment());
+                    cue.colorId = static_cast<int>(pCueExtendedEntry->color_id());
+                    cue.hotCueColor = qRgb(
+                            static_cast<int>(pCueExtendedEntry->color_red()),
+                            static_cast<int>(pCueExtendedEntry->color_green()),
+                            static_cast<int>(pCueExtendedEntry->color_blue()));
+                    pData->cues.append(cue);
+                }
+            } break;
+            default:
+                break;
+            }
+        }
+    } catch (const std::exception& e) {
+        qWarning() << "Failed to parse Rekordbox ANLZ file" << filePath << e.what();
+        return nullptr;
+    }
+    return pData;
+}
+
+int RekordboxAnlzData::sizeInBytes() const {
+    int size = static_cast<int>(sizeof(*this)) +
+            beatTimesMs.size() * static_cast<int>(sizeof(int)) +
+            cues.size() * static_cast<int>(sizeof(Cue));
+    for (const auto& cue : cues) {
+        size += cue.comment.size() * static_cast<int>(sizeof(QChar));
+    }
+    return size;
+}
+
+RekordboxAnlzCache::RekordboxAnlzCache()
+        : m_entries(kMaxCacheCostKiB),
+          m_prefetchGeneration(0) {
+    // The files are read from removable devices. Reading them concurrently
+    // would not be faster.
+    m_prefetchThreadPool.setMaxThreadCount(1);
+    m_prefetchThreadPool.setObjectName(QStringLiteral("RekordboxAnlzCache"));
+}
+
+RekordboxAnlzCache::~RekordboxAnlzCache() {
+    cancelPrefetch();
+    m_prefetchThreadPool.waitForDone();
+}
+
+std::shared_ptr<const RekordboxAnlzData> RekordboxAnlzCache::get(const QString& filePath) {
+    const QFileInfo fileInfo(filePath);
+    if (!fileInfo.exists()) {
+        return nullptr;
+    }
+    const qint64 size = fileInfo.size();
+    const qint64 lastModified = lastModifiedMs(fileInfo);
+    {
+        const auto locked = lockMutex(&m_mutex);
+        const Entry* pEntry = m_entries.object(filePath);
+        if (pEntry && pEntry->size == size && pEntry->lastModifiedMs == lastModified) {
+            return pEntry->pData;
+        }
+    }
+
+    // Concurrent requests for the same file may parse it twice, which is
+    // harmless and rare.
+    auto pData = RekordboxAnlzData::parse(filePath);
+    if (!pData) {
+        return nullptr;
+    }
+    const auto locked = lockMutex(&m_mutex);
+    m_entries.insert(filePath,
+            new Entry{size, lastModified, pData},
+            1 + pData->sizeInBytes() / 1024);
+    return pData;
+}
+
+void RekordboxAnlzCache::prefetch(const QStringList& filePaths) {
+    const int generation = ++m_prefetchGeneration;
+    QtConcurrent::run(&m_prefetchThreadPool, [this, filePaths, generation] {
+        QThread::currentThread()->setPriority(QThread::LowPriority);
+        for (const auto& filePath : filePaths) {
+            if (m_prefetchGeneration.loadAcquire() != generation) {
+                return;
+            }
+            get(filePath);
+        }
+    });
+}
+
+void RekordboxAnlzCache::cancelPrefetch() {
+    ++m_prefetchGeneration;
+}
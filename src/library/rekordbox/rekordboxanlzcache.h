@@ -0,0 +1,85 @@
+#pragma once
+
+#include <QAtomicInteger>
+#include <QCache>
+#include <QMutex>
+#include <QRgb>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+#include <memory>
+
+/// The sections of a Rekordbox ANLZ file that Mixxx imports, with all
+/// values as stored in the file. Times are in milliseconds.
+struct RekordboxAnlzData {
+    enum class CueList {
+        MemoryCues,
+        HotCues,
+    };
+
+    struct Cue {
+        CueList list = CueList::MemoryCues;
+        /// True for cues from the extended list (PCO2) that have comments
+        /// and colors.
+        bool extended = false;
+        bool isLoop = false;
+        /// 1-based, only for hot cues
+        int hotCue = 0;
+        int timeMs = 0;
+        int loopTimeMs = 0;
+        QString comment;
+        /// The palette color of memory cues and loops
+        int colorId = 0;
+        /// The RGB color of hot cues
+        QRgb hotCueColor = 0;
+    };
+
+    bool hasBeatGrid = false;
+    QVector<int> beatTimesMs;
+    /// In the order of the file
+    QVector<Cue> cues;
+
+    /// Parses the file. Returns nullptr if it cannot be parsed.
+    static std::shared_ptr<const RekordboxAnlzData> parse(const QString& filePath);
+
+    int sizeInBytes() const;
+};
+
+/// Caches parsed ANLZ files, keyed by the file identity, i.e. its path,
+/// size and modification time.
+///
+/// Parsing an ANLZ file takes longer than loading the track. The files of
+/// a device are prefetched in the background after its database has been
+/// imported, so loading a track usually finds them parsed. The cache stays
+/// valid when a device is removed, so re-mounting the same device does not
+/// parse the files again, unless they have been modified.
+class RekordboxAnlzCache {
+  public:
+    RekordboxAnlzCache();
+    /// Cancels the prefetching and waits until it has stopped
+    ~RekordboxAnlzCache();
+
+    /// Returns the parsed file, parsing it if it has not been cached or
+    /// has been modified since. Returns nullptr if the file does not exist
+    /// or cannot be parsed. Thread-safe.
+    std::shared_ptr<const RekordboxAnlzData> get(const QString& filePath);
+
+    /// Parses the files in the background with a low priority. Replaces
+    /// the files of a previous prefetch that have not been parsed yet.
+    void prefetch(const QStringList& filePaths);
+    void cancelPrefetch();
+
+  private:
+    struct Entry {
+        qint64 size;
+        qint64 lastModifiedMs;
+        std::shared_ptr<const RekordboxAnlzData> pData;
+    };
+
+    QMutex m_mutex;
+    QCache<QString, Entry> m_entries;
+
+    QThreadPool m_prefetchThreadPool;
+    QAtomicInteger<int> m_prefetchGeneration;
+};
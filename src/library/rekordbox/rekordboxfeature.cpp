@@ -2,8 +2,11 @@
 
 #include <mp3guessenc.h>
 
+#include <QHash>
 #include <QMap>
 #include <QMessageBox>
+#include <QMutex>
+#include <QSet>
 #include <QSettings>
 #include <QTextCodec>
 #include <QtDebug>
@@ -12,9 +15,9 @@
 #include "library/dao/trackschema.h"
 #include "library/library.h"
 #include "library/queryutil.h"
-#include "library/rekordbox/rekordbox_anlz.h"
 #include "library/rekordbox/rekordbox_pdb.h"
 #include "library/rekordbox/rekordboxconstants.h"
+#include "library/rekordbox/rekordboxpdbreader.h"
 #include "library/trackcollection.h"
 #include "library/trackcollectionmanager.h"
 #include "library/treeitem.h"
@@ -24,8 +27,10 @@
 #include "track/keyfactory.h"
 #include "track/track.h"
 #include "util/color/color.h"
+#include "util/compatibility/qmutex.h"
 #include "util/db/dbconnectionpooled.h"
 #include "util/db/dbconnectionpooler.h"
+#include "util/db/sqlbatchinserter.h"
 #include "util/sandbox.h"
 #include "waveform/waveform.h"
 #include "widget/wlibrary.h"
@@ -43,6 +48,28 @@ const QString kRekordboxPlaylistTracksTable = QStringLiteral("rekordbox_playlist
 const QString kPdbPath = QStringLiteral("PIONEER/rekordbox/export.pdb");
 const QString kPLaylistPathDelimiter = QStringLiteral("-->");
 
+// The columns of kRekordboxLibraryTable that are inserted by insertTrack()
+const QStringList kLibraryColumns = {
+        QStringLiteral("id"),
+        QStringLiteral("rb_id"),
+        QStringLiteral("artist"),
+        QStringLiteral("title"),
+        QStringLiteral("album"),
+        QStringLiteral("year"),
+        QStringLiteral("genre"),
+        QStringLiteral("comment"),
+        QStringLiteral("tracknumber"),
+        QStringLiteral("bpm"),
+        QStringLiteral("bitrate"),
+        QStringLiteral("duration"),
+        QStringLiteral("location"),
+        QStringLiteral("rating"),
+        QStringLiteral("key"),
+        QStringLiteral("analyze_path"),
+        QStringLiteral("device"),
+        QStringLiteral("color"),
+};
+
 enum class IDForColor : uint8_t {
     Pink = 1,
     Red,
@@ -341,97 +368,91 @@ mixxx::RgbColor colorFromID(int colorID) {
     return kColorForIDNoColor;
 }
 
-void insertTrack(
-        QSqlDatabase& database,
+enum class InsertTrackResult {
+    Inserted,
+    /// A track with the same location or analysis file has already been
+    /// inserted, which the table does not allow.
+    Duplicate,
+    Failed,
+};
+
+/// Appends the track to the library table with the given id.
+InsertTrackResult insertTrack(
+        SqlBatchInserter* pLibraryInserter,
         rekordbox_pdb_t::track_row_t* track,
-        QSqlQuery& query,
-        QSqlQuery& queryInsertIntoDevicePlaylistTracks,
-        QMap<uint32_t, QString>& artistsMap,
-        QMap<uint32_t, QString>& albumsMap,
-        QMap<uint32_t, QString>& genresMap,
-        QMap<uint32_t, QString>& keysMap,
+        int trackID,
+        const QMap<uint32_t, QString>& artistsMap,
+        const QMap<uint32_t, QString>& albumsMap,
+        const QMap<uint32_t, QString>& genresMap,
+        const QMap<uint32_t, QString>& keysMap,
+        QSet<QString>* pLocations,
+        QSet<QString>* pAnlzPaths,
         const QString& devicePath,
-        const QString& device,
-        int audioFilesCount) {
+        const QString& device) {
     int rbID = static_cast<int>(track->id());
     QString title = getText(track->title());
-    QString artist = artistsMap[track->artist_id()];
-    QString album = albumsMap[track->album_id()];
+    QString artist = artistsMap.value(track->artist_id());
+    QString album = albumsMap.value(track->album_id());
     QString year = QString::number(track->year());
-    QString genre = genresMap[track->genre_id()];
+    QString genre = genresMap.value(track->genre_id());
     QString location = devicePath + getText(track->file_path());
     float bpm = static_cast<float>(track->tempo() / 100.0);
     int bitrate = static_cast<int>(track->bitrate());
-    QString key = keysMap[track->key_id()];
+    QString key = keysMap.value(track->key_id());
     int playtime = static_cast<int>(track->duration());
     int rating = static_cast<int>(track->rating());
     QString comment = getText(track->comment());
     QString tracknumber = QString::number(track->track_number());
     QString anlzPath = devicePath + getText(track->analyze_path());
 
-    query.bindValue(":rb_id", rbID);
-    query.bindValue(":artist", artist);
-    query.bindValue(":title", title);
-    query.bindValue(":album", album);
-    query.bindValue(":genre", genre);
-    query.bindValue(":year", year);
-    query.bindValue(":duration", playtime);
-    query.bindValue(":location", location);
-    query.bindValue(":rating", rating);
-    query.bindValue(":comment", comment);
-    query.bindValue(":tracknumber", tracknumber);
-    query.bindValue(":key", key);
-    query.bindValue(":bpm", bpm);
-    query.bindValue(":bitrate", bitrate);
-    query.bindValue(":analyze_path", anlzPath);
-    query.bindValue(":device", device);
-    query.bindValue(":color",
-            mixxx::RgbColor::toQVariant(
-                    colorFromID(static_cast<int>(track->color_id()))));
-
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
-    }
-
-    int trackID = -1;
-    QSqlQuery finderQuery(database);
-    finderQuery.prepare("select id from " + kRekordboxLibraryTable +
-            " where rb_id=:rb_id and device=:device");
-    finderQuery.bindValue(":rb_id", rbID);
-    finderQuery.bindValue(":device", device);
-
-    if (!finderQuery.exec()) {
-        LOG_FAILED_QUERY(finderQuery)
-                << "rbID:" << rbID;
-    }
-
-    if (finderQuery.next()) {
-        trackID = finderQuery.value(finderQuery.record().indexOf("id")).toInt();
-    }
-
-    // Insert into device all tracks playlist
-    queryInsertIntoDevicePlaylistTracks.bindValue(":track_id", trackID);
-    queryInsertIntoDevicePlaylistTracks.bindValue(":position", audioFilesCount);
-
-    if (!queryInsertIntoDevicePlaylistTracks.exec()) {
-        LOG_FAILED_QUERY(queryInsertIntoDevicePlaylistTracks)
-                << "trackID:" << trackID
-                << "position:" << audioFilesCount;
+    if (pLocations->contains(location) || pAnlzPaths->contains(anlzPath)) {
+        qWarning() << "Skipping duplicate Rekordbox track" << rbID << location;
+        return InsertTrackResult::Duplicate;
     }
+    pLocations->insert(location);
+    pAnlzPaths->insert(anlzPath);
+
+    // In the order of kLibraryColumns
+    const bool inserted = pLibraryInserter->append({
+            trackID,
+            rbID,
+            artist,
+            title,
+            album,
+            year,
+            genre,
+            comment,
+            tracknumber,
+            bpm,
+            bitrate,
+            playtime,
+            location,
+            rating,
+            key,
+            anlzPath,
+            device,
+            mixxx::RgbColor::toQVariant(
+                    colorFromID(static_cast<int>(track->color_id()))),
+    });
+    return inserted ? InsertTrackResult::Inserted : InsertTrackResult::Failed;
 }
 
-void buildPlaylistTree(
+/// Returns false if inserting a playlist or its tracks failed.
+bool buildPlaylistTree(
         QSqlDatabase& database,
+        SqlBatchInserter* pPlaylistTracksInserter,
         TreeItem* parent,
         uint32_t parentID,
         QMap<uint32_t, QString>& playlistNameMap,
         QMap<uint32_t, bool>& playlistIsFolderMap,
         QMap<uint32_t, QMap<uint32_t, uint32_t>>& playlistTreeMap,
         QMap<uint32_t, QMap<uint32_t, uint32_t>>& playlistTrackMap,
-        const QString& playlistPath,
-        const QString& device);
+        const QHash<uint32_t, int>& trackIDs,
+        const QString& playlistPath);
 
-QString parseDeviceDB(mixxx::DbConnectionPoolPtr dbConnectionPool, TreeItem* deviceItem) {
+QString parseDeviceDB(mixxx::DbConnectionPoolPtr dbConnectionPool,
+        TreeItem* deviceItem,
+        std::shared_ptr<RekordboxAnlzCache> pAnlzCache) {
     QString device = deviceItem->getLabel();
     QString devicePath = deviceItem->getData().toList()[0].toString();
 
@@ -459,39 +480,67 @@ QString parseDeviceDB(mixxx::DbConnectionPoolPtr dbConnectionPool, TreeItem* dev
     QThread* thisThread = QThread::currentThread();
     thisThread->setPriority(QThread::LowPriority);
 
-    ScopedTransaction transaction(database);
+    mixxx::FileInfo fileInfo(dbPath);
+    if (!Sandbox::askForAccess(&fileInfo)) {
+        return QString();
+    }
+    RekordboxPdbReader reader(dbPath);
+    if (!reader.open()) {
+        return QString();
+    }
 
-    QSqlQuery query(database);
-    query.prepare("INSERT INTO " + kRekordboxLibraryTable +
-            " (rb_id, artist, title, album, year,"
-            "genre,comment,tracknumber,bpm, bitrate,duration, location,"
-            "rating,key,analyze_path,device,color) VALUES (:rb_id, :artist, "
-            ":title, :album, :year,:genre,"
-            ":comment, :tracknumber,:bpm, :bitrate,:duration, :location,"
-            ":rating,:key,:analyze_path,:device,:color)");
+    // The ids of the tracks are assigned here, so that the playlists can
+    // refer to them without looking up every inserted track. Several
+    // devices may be imported at the same time, so the write lock must be
+    // held from reading MAX(id) until the rows have been committed. The
+    // imports are serialized before, otherwise the transaction of the
+    // second one would fail if the first one takes longer than the busy
+    // timeout of the connection.
+    static QMutex s_importMutex;
+    const auto importLocker = lockMutex(&s_importMutex);
+    ScopedTransaction transaction(database, ScopedTransaction::Mode::Immediate);
+    if (!transaction.active()) {
+        return QString();
+    }
+    int lastTrackID = 0;
+    {
+        QSqlQuery maxIDQuery(database);
+        maxIDQuery.prepare("SELECT MAX(id) FROM " + kRekordboxLibraryTable);
+        if (!maxIDQuery.exec()) {
+            LOG_FAILED_QUERY(maxIDQuery);
+            return QString();
+        }
+        if (maxIDQuery.next()) {
+            lastTrackID = maxIDQuery.value(0).toInt();
+        }
+    }
+
+    // Declared after the transaction, so that rows that are still pending
+    // when returning are written inside of it.
+    SqlBatchInserter libraryInserter(database, kRekordboxLibraryTable, kLibraryColumns);
+    SqlBatchInserter playlistTracksInserter(database,
+            kRekordboxPlaylistTracksTable,
+            {QStringLiteral("playlist_id"),
+                    QStringLiteral("track_id"),
+                    QStringLiteral("position")});
+    // Any failed batch fails the whole import. Nothing is committed and the
+    // playlist items that have been added to the sidebar are removed.
+    bool failed = false;
+    const int numDeviceChildRows = deviceItem->childRows();
+    const auto rollback = [&]() {
+        qWarning() << "Failed to import Rekordbox device" << device;
+        libraryInserter.discard();
+        playlistTracksInserter.discard();
+        deviceItem->removeChildren(numDeviceChildRows,
+                deviceItem->childRows() - numDeviceChildRows);
+        return QString();
+    };
 
     int audioFilesCount = 0;
 
     // Create a playlist for all the tracks on a device
     int playlistID = createDevicePlaylist(database, devicePath);
 
-    QSqlQuery queryInsertIntoDevicePlaylistTracks(database);
-    queryInsertIntoDevicePlaylistTracks.prepare(
-            "INSERT INTO " + kRekordboxPlaylistTracksTable +
-            " (playlist_id, track_id, position) "
-            "VALUES (:playlist_id, :track_id, :position)");
-
-    queryInsertIntoDevicePlaylistTracks.bindValue(":playlist_id", playlistID);
-
-    mixxx::FileInfo fileInfo(dbPath);
-    if (!Sandbox::askForAccess(&fileInfo)) {
-        return QString();
-    }
-    std::ifstream ifs(dbPath.toStdString(), std::ifstream::binary);
-    kaitai::kstream ks(&ifs);
-
-    rekordbox_pdb_t reckordboxDB = rekordbox_pdb_t(&ks);
-
     // There are other types of tables (eg. COLOR), these are the only ones we are
     // interested at the moment. Perhaps when/if
     // https://bugs.launchpad.net/mixxx/+bug/1100882
@@ -499,18 +548,8 @@ QString parseDeviceDB(mixxx::DbConnectionPoolPtr dbConnectionPool, TreeItem* dev
     // Attempt was made to also recover HISTORY
     // playlists (which are found on removable Rekordbox devices), however
     // they didn't appear to contain valid row_ref_t structures.
-    constexpr int totalTables = 8;
-
-    rekordbox_pdb_t::page_type_t tableOrder[totalTables] = {
-            rekordbox_pdb_t::PAGE_TYPE_KEYS,
-            rekordbox_pdb_t::PAGE_TYPE_GENRES,
-            rekordbox_pdb_t::PAGE_TYPE_ARTISTS,
-            rekordbox_pdb_t::PAGE_TYPE_ALBUMS,
-            rekordbox_pdb_t::PAGE_TYPE_PLAYLIST_ENTRIES,
-            rekordbox_pdb_t::PAGE_TYPE_TRACKS,
-            rekordbox_pdb_t::PAGE_TYPE_PLAYLIST_TREE,
-            rekordbox_pdb_t::PAGE_TYPE_HISTORY};
-
+    // The tables are read in this order, because the tracks refer to the
+    // keys, genres, artists and albums.
     QMap<uint32_t, QString> keysMap;
     QMap<uint32_t, QString> genresMap;
     QMap<uint32_t, QString> artistsMap;
@@ -519,167 +558,133 @@ QString parseDeviceDB(mixxx::DbConnectionPoolPtr dbConnectionPool, TreeItem* dev
     QMap<uint32_t, bool> playlistIsFolderMap;
     QMap<uint32_t, QMap<uint32_t, uint32_t>> playlistTreeMap;
     QMap<uint32_t, QMap<uint32_t, uint32_t>> playlistTrackMap;
-
-    bool folderOrPlaylistFound = false;
-
-    for (int tableOrderIndex = 0; tableOrderIndex < totalTables; tableOrderIndex++) {
-        for (std::vector<rekordbox_pdb_t::table_t*>::iterator table =
-                        reckordboxDB.tables()->begin();
-                table != reckordboxDB.tables()->end();
-                ++table) {
-            if ((*table)->type() == tableOrder[tableOrderIndex]) {
-                uint16_t lastIndex = (*table)->last_page()->index();
-                rekordbox_pdb_t::page_ref_t* currentRef = (*table)->first_page();
-
-                while (true) {
-                    rekordbox_pdb_t::page_t* page = currentRef->body();
-
-                    if (page->is_data_page()) {
-                        for (std::vector<rekordbox_pdb_t::row_group_t*>::
-                                        iterator rowGroup =
-                                                page->row_groups()->begin();
-                                rowGroup != page->row_groups()->end();
-                                ++rowGroup) {
-                            for (std::vector<rekordbox_pdb_t::row_ref_t*>::
-                                            iterator rowRef = (*rowGroup)
-                                                                      ->rows()
-                                                                      ->begin();
-                                    rowRef != (*rowGroup)->rows()->end();
-                                    ++rowRef) {
-                                if ((*rowRef)->present()) {
-                                    switch (tableOrder[tableOrderIndex]) {
-                                    case rekordbox_pdb_t::PAGE_TYPE_KEYS: {
-                                        // Key found, update map
-                                        rekordbox_pdb_t::key_row_t* key =
-                                                static_cast<rekordbox_pdb_t::
-                                                                key_row_t*>(
-                                                        (*rowRef)->body());
-                                        keysMap[key->id()] = getText(key->name());
-                                    } break;
-                                    case rekordbox_pdb_t::PAGE_TYPE_GENRES: {
-                                        // Genre found, update map
-                                        rekordbox_pdb_t::genre_row_t* genre =
-                                                static_cast<rekordbox_pdb_t::
-                                                                genre_row_t*>(
-                                                        (*rowRef)->body());
-                                        genresMap[genre->id()] = getText(genre->name());
-                                    } break;
-                                    case rekordbox_pdb_t::PAGE_TYPE_ARTISTS: {
-                                        // Artist found, update map
-                                        rekordbox_pdb_t::artist_row_t* artist =
-                                                static_cast<rekordbox_pdb_t::
-                                                                artist_row_t*>(
-                                                        (*rowRef)->body());
-                                        artistsMap[artist->id()] = getText(artist->name());
-                                    } break;
-                                    case rekordbox_pdb_t::PAGE_TYPE_ALBUMS: {
-                                        // Album found, update map
-                                        rekordbox_pdb_t::album_row_t* album =
-                                                static_cast<rekordbox_pdb_t::
-                                                                album_row_t*>(
-                                                        (*rowRef)->body());
-                                        albumsMap[album->id()] = getText(album->name());
-                                    } break;
-                                    case rekordbox_pdb_t::PAGE_TYPE_PLAYLIST_ENTRIES: {
-                                        // Playlist to track mapping found, update map
-                                        rekordbox_pdb_t::playlist_entry_row_t*
-                                                playlistEntry = static_cast<
-                                                        rekordbox_pdb_t::
-                                                                playlist_entry_row_t*>(
-                                                        (*rowRef)->body());
-                                        playlistTrackMap
-                                                [playlistEntry->playlist_id()]
-                                                [playlistEntry->entry_index()] =
-                                                        playlistEntry
-                                                                ->track_id();
-                                    } break;
-                                    case rekordbox_pdb_t::PAGE_TYPE_TRACKS: {
-                                        // Track found, insert into database
-                                        insertTrack(database,
-                                                static_cast<rekordbox_pdb_t::
-                                                                track_row_t*>(
-                                                        (*rowRef)->body()),
-                                                query,
-                                                queryInsertIntoDevicePlaylistTracks,
-                                                artistsMap,
-                                                albumsMap,
-                                                genresMap,
-                                                keysMap,
-                                                devicePath,
-                                                device,
-                                                audioFilesCount);
-
-                                        audioFilesCount++;
-                                    } break;
-                                    case rekordbox_pdb_t::PAGE_TYPE_PLAYLIST_TREE: {
-                                        // Playlist tree node found, update map
-                                        rekordbox_pdb_t::playlist_tree_row_t*
-                                                playlistTree = static_cast<
-                                                        rekordbox_pdb_t::
-                                                                playlist_tree_row_t*>(
-                                                        (*rowRef)->body());
-
-                                        playlistNameMap[playlistTree->id()] =
-                                                getText(playlistTree->name());
-                                        playlistIsFolderMap[playlistTree
-                                                                    ->id()] =
-                                                playlistTree->is_folder();
-                                        playlistTreeMap
-                                                [playlistTree->parent_id()]
-                                                [playlistTree->sort_order()] =
-                                                        playlistTree->id();
-
-                                        folderOrPlaylistFound = true;
-                                    } break;
-                                    default:
-                                        break;
-                                    }
-                                }
-                            }
-                        }
-                    }
-
-                    if (currentRef->index() == lastIndex) {
-                        break;
-                    } else {
-                        currentRef = page->next_page();
-                    }
-                }
+    QHash<uint32_t, int> trackIDs;
+    QSet<QString> locations;
+    QSet<QString> anlzPaths;
+
+    reader.forEachRow(rekordbox_pdb_t::PAGE_TYPE_KEYS, [&](kaitai::kstruct* pRow) {
+        auto* key = static_cast<rekordbox_pdb_t::key_row_t*>(pRow);
+        keysMap[key->id()] = getText(key->name());
+    });
+    reader.forEachRow(rekordbox_pdb_t::PAGE_TYPE_GENRES, [&](kaitai::kstruct* pRow) {
+        auto* genre = static_cast<rekordbox_pdb_t::genre_row_t*>(pRow);
+        genresMap[genre->id()] = getText(genre->name());
+    });
+    reader.forEachRow(rekordbox_pdb_t::PAGE_TYPE_ARTISTS, [&](kaitai::kstruct* pRow) {
+        auto* artist = static_cast<rekordbox_pdb_t::artist_row_t*>(pRow);
+        artistsMap[artist->id()] = getText(artist->name());
+    });
+    reader.forEachRow(rekordbox_pdb_t::PAGE_TYPE_ALBUMS, [&](kaitai::kstruct* pRow) {
+        auto* album = static_cast<rekordbox_pdb_t::album_row_t*>(pRow);
+        albumsMap[album->id()] = getText(album->name());
+    });
+    reader.forEachRow(rekordbox_pdb_t::PAGE_TYPE_PLAYLIST_ENTRIES,
+            [&](kaitai::kstruct* pRow) {
+                auto* playlistEntry =
+                        static_cast<rekordbox_pdb_t::playlist_entry_row_t*>(pRow);
+                playlistTrackMap[playlistEntry->playlist_id()]
+                                [playlistEntry->entry_index()] =
+                                        playlistEntry->track_id();
+            });
+    reader.forEachRow(rekordbox_pdb_t::PAGE_TYPE_TRACKS, [&](kaitai::kstruct* pRow) {
+        if (failed) {
+            return;
+        }
+        auto* track = static_cast<rekordbox_pdb_t::track_row_t*>(pRow);
+        const int trackID = lastTrackID + 1;
+        switch (insertTrack(&libraryInserter,
+                track,
+                trackID,
+                artistsMap,
+                albumsMap,
+                genresMap,
+                keysMap,
+                &locations,
+                &anlzPaths,
+                devicePath,
+                device)) {
+        case InsertTrackResult::Inserted:
+            lastTrackID = trackID;
+            trackIDs.insert(track->id(), trackID);
+            // Insert into device all tracks playlist
+            if (!playlistTracksInserter.append({playlistID, trackID, audioFilesCount})) {
+                failed = true;
             }
+            break;
+        case InsertTrackResult::Duplicate:
+            break;
+        case InsertTrackResult::Failed:
+            failed = true;
+            break;
         }
+        audioFilesCount++;
+    });
+    if (failed) {
+        return rollback();
+    }
+    reader.forEachRow(rekordbox_pdb_t::PAGE_TYPE_PLAYLIST_TREE,
+            [&](kaitai::kstruct* pRow) {
+                auto* playlistTree =
+                        static_cast<rekordbox_pdb_t::playlist_tree_row_t*>(pRow);
+                playlistNameMap[playlistTree->id()] = getText(playlistTree->name());
+                playlistIsFolderMap[playlistTree->id()] = playlistTree->is_folder();
+                playlistTreeMap[playlistTree->parent_id()]
+                               [playlistTree->sort_order()] = playlistTree->id();
+            });
+
+    // The playlists refer to the tracks
+    if (!libraryInserter.flush()) {
+        return rollback();
     }
 
-    if (audioFilesCount > 0 || folderOrPlaylistFound) {
+    if (audioFilesCount > 0 || !playlistNameMap.isEmpty()) {
         // If we have found anything, recursively build playlist/folder TreeItem children
         // for the original device TreeItem
-        buildPlaylistTree(database,
+        failed = !buildPlaylistTree(database,
+                &playlistTracksInserter,
                 deviceItem,
                 0,
                 playlistNameMap,
                 playlistIsFolderMap,
                 playlistTreeMap,
                 playlistTrackMap,
-                devicePath,
-                device);
+                trackIDs,
+                devicePath);
+    }
+    if (failed || !playlistTracksInserter.flush()) {
+        return rollback();
     }
 
     qDebug() << "Found: " << audioFilesCount << " audio files in Rekordbox device " << device;
 
-    transaction.commit();
+    if (!transaction.commit()) {
+        return rollback();
+    }
+
+    // Tracks that are loaded from the device need the analysis files. The
+    // cues are read from the extended file, if it exists.
+    QStringList anlzPathsToPrefetch;
+    anlzPathsToPrefetch.reserve(2 * anlzPaths.size());
+    for (const auto& anlzPath : std::as_const(anlzPaths)) {
+        anlzPathsToPrefetch << anlzPath;
+        anlzPathsToPrefetch << anlzPath.left(anlzPath.length() - 3) + "EXT";
+    }
+    pAnlzCache->prefetch(anlzPathsToPrefetch);
 
     return devicePath;
 }
 
-void buildPlaylistTree(
+bool buildPlaylistTree(
         QSqlDatabase& database,
+        SqlBatchInserter* pPlaylistTracksInserter,
         TreeItem* parent,
         uint32_t parentID,
         QMap<uint32_t, QString>& playlistNameMap,
         QMap<uint32_t, bool>& playlistIsFolderMap,
         QMap<uint32_t, QMap<uint32_t, uint32_t>>& playlistTreeMap,
         QMap<uint32_t, QMap<uint32_t, uint32_t>>& playlistTrackMap,
-        const QString& playlistPath,
-        const QString& device) {
+        const QHash<uint32_t, int>& trackIDs,
+        const QString& playlistPath) {
     for (uint32_t childIndex = 0;
             childIndex < (uint32_t)playlistTreeMap[parentID].size();
             childIndex++) {
@@ -707,29 +712,10 @@ void buildPlaylistTree(
         if (!queryInsertIntoPlaylist.exec()) {
             LOG_FAILED_QUERY(queryInsertIntoPlaylist)
                     << "currentPath" << currentPath;
-            return;
-        }
-
-        QSqlQuery idQuery(database);
-        idQuery.prepare("select id from " + kRekordboxPlaylistsTable + " where name=:path");
-        idQuery.bindValue(":path", currentPath);
-
-        if (!idQuery.exec()) {
-            LOG_FAILED_QUERY(idQuery)
-                    << "currentPath" << currentPath;
-            return;
+            return false;
         }
 
-        int playlistID = -1;
-        while (idQuery.next()) {
-            playlistID = idQuery.value(idQuery.record().indexOf("id")).toInt();
-        }
-
-        QSqlQuery queryInsertIntoPlaylistTracks(database);
-        queryInsertIntoPlaylistTracks.prepare(
-                "INSERT INTO " + kRekordboxPlaylistTracksTable +
-                " (playlist_id, track_id, position) "
-                "VALUES (:playlist_id, :track_id, :position)");
+        const int playlistID = queryInsertIntoPlaylist.lastInsertId().toInt();
 
         if (playlistTrackMap.count(childID)) {
             // Add playlist tracks for children
@@ -737,53 +723,34 @@ void buildPlaylistTree(
                     static_cast<uint32_t>(playlistTrackMap[childID].size());
                     trackIndex++) {
                 uint32_t rbTrackID = playlistTrackMap[childID][trackIndex];
+                int trackID = trackIDs.value(rbTrackID, -1);
 
-                int trackID = -1;
-                QSqlQuery finderQuery(database);
-                finderQuery.prepare("select id from " + kRekordboxLibraryTable +
-                        " where rb_id=:rb_id and device=:device");
-                finderQuery.bindValue(":rb_id", rbTrackID);
-                finderQuery.bindValue(":device", device);
-
-                if (!finderQuery.exec()) {
-                    LOG_FAILED_QUERY(finderQuery)
-                            << "rbTrackID:" << rbTrackID
-                            << "device:" << device;
-                    return;
-                }
-
-                if (finderQuery.next()) {
-                    trackID = finderQuery.value(finderQuery.record().indexOf("id")).toInt();
-                }
-
-                queryInsertIntoPlaylistTracks.bindValue(":playlist_id", playlistID);
-                queryInsertIntoPlaylistTracks.bindValue(":track_id", trackID);
-                queryInsertIntoPlaylistTracks.bindValue(":position", static_cast<int>(trackIndex));
-
-                if (!queryInsertIntoPlaylistTracks.exec()) {
-                    LOG_FAILED_QUERY(queryInsertIntoPlaylistTracks)
-                            << "playlistID:" << playlistID
-                            << "trackID:" << trackID
-                            << "trackIndex:" << trackIndex;
-
-                    return;
+                if (!pPlaylistTracksInserter->append(
+                            {playlistID, trackID, static_cast<int>(trackIndex)})) {
+                    qWarning() << "Failed to insert Rekordbox playlist tracks"
+                               << "playlistID:" << playlistID;
+                    return false;
                 }
             }
         }
 
         if (playlistIsFolderMap[childID]) {
             // If this child is a folder (playlists are only leaf nodes), build playlist tree for it
-            buildPlaylistTree(database,
-                    child,
-                    childID,
-                    playlistNameMap,
-                    playlistIsFolderMap,
-                    playlistTreeMap,
-                    playlistTrackMap,
-                    currentPath,
-                    device);
+            if (!buildPlaylistTree(database,
+                        pPlaylistTracksInserter,
+                        child,
+                        childID,
+                        playlistNameMap,
+                        playlistIsFolderMap,
+                        playlistTreeMap,
+                        playlistTrackMap,
+                        trackIDs,
+                        currentPath)) {
+                return false;
+            }
         }
     }
+    return true;
 }
 
 void clearDeviceTables(QSqlDatabase& database, TreeItem* child) {
@@ -889,200 +856,81 @@ void setHotCue(TrackPointer track,
     }
 }
 
-void readAnalyze(TrackPointer track,
+void applyAnalyze(TrackPointer track,
         mixxx::audio::SampleRate sampleRate,
         int timingOffset,
         bool ignoreCues,
+        RekordboxAnlzCache* pAnlzCache,
         const QString& anlzPath) {
-    if (!QFile(anlzPath).exists()) {
+    const auto pAnlzData = pAnlzCache->get(anlzPath);
+    if (!pAnlzData) {
         return;
     }
 
     qDebug() << "Rekordbox ANLZ path:" << anlzPath << " for: " << track->getTitle();
 
-    std::ifstream ifs(anlzPath.toStdString(), std::ifstream::binary);
-    kaitai::kstream ks(&ifs);
+    const double sampleRateKhz = sampleRate / 1000.0;
+    const auto framePos = [sampleRateKhz, timingOffset](int timeMs) {
+        int time = timeMs - timingOffset;
+        // Ensure no offset times are less than 1
+        if (time < 1) {
+            time = 1;
+        }
+        return mixxx::audio::FramePos(sampleRateKhz * static_cast<double>(time));
+    };
 
-    rekordbox_anlz_t anlz = rekordbox_anlz_t(&ks);
+    if (ignoreCues) {
+        if (!pAnlzData->hasBeatGrid) {
+            return;
+        }
+        QVector<mixxx::audio::FramePos> beats;
+        beats.reserve(pAnlzData->beatTimesMs.size());
+        for (const int beatTimeMs : pAnlzData->beatTimesMs) {
+            beats << framePos(beatTimeMs);
+        }
 
-    const double sampleRateKhz = sampleRate / 1000.0;
+        const auto pBeats = mixxx::Beats::fromBeatPositions(
+                sampleRate,
+                beats,
+                mixxx::rekordboxconstants::beatsSubversion);
+        track->trySetBeats(pBeats);
+        return;
+    }
 
     QList<memory_cue_loop_t> memoryCuesAndLoops;
     int lastHotCueIndex = 0;
 
-    for (std::vector<rekordbox_anlz_t::tagged_section_t*>::iterator section =
-                    anlz.sections()->begin();
-            section != anlz.sections()->end();
-            ++section) {
-        switch ((*section)->fourcc()) {
-        case rekordbox_anlz_t::SECTION_TAGS_BEAT_GRID: {
-            if (!ignoreCues) {
-                break;
-            }
-
-            rekordbox_anlz_t::beat_grid_tag_t* beatGridTag =
-                    static_cast<rekordbox_anlz_t::beat_grid_tag_t*>(
-                            (*section)->body());
-
-            QVector<mixxx::audio::FramePos> beats;
-
-            for (std::vector<rekordbox_anlz_t::beat_grid_beat_t*>::iterator
-                            beat = beatGridTag->beats()->begin();
-                    beat != beatGridTag->beats()->end();
-                    ++beat) {
-                int time = static_cast<int>((*beat)->time()) - timingOffset;
-                // Ensure no offset times are less than 1
-                if (time < 1) {
-                    time = 1;
-                }
-                beats << mixxx::audio::FramePos(sampleRateKhz * static_cast<double>(time));
-            }
-
-            const auto pBeats = mixxx::Beats::fromBeatPositions(
-                    sampleRate,
-                    beats,
-                    mixxx::rekordboxconstants::beatsSubversion);
-            track->trySetBeats(pBeats);
-        } break;
-        case rekordbox_anlz_t::SECTION_TAGS_CUES: {
-            if (ignoreCues) {
-                break;
-            }
-
-            rekordbox_anlz_t::cue_tag_t* cuesTag =
-                    static_cast<rekordbox_anlz_t::cue_tag_t*>(
-                            (*section)->body());
-
-            for (std::vector<rekordbox_anlz_t::cue_entry_t*>::iterator
-                            cueEntry = cuesTag->cues()->begin();
-                    cueEntry != cuesTag->cues()->end();
-                    ++cueEntry) {
-                int time = static_cast<int>((*cueEntry)->time()) - timingOffset;
-                // Ensure no offset times are less than 1
-                if (time < 1) {
-                    time = 1;
-                }
-                const auto position = mixxx::audio::FramePos(
-                        sampleRateKhz * static_cast<double>(time));
-
-                switch (cuesTag->type()) {
-                case rekordbox_anlz_t::CUE_LIST_TYPE_MEMORY_CUES: {
-                    switch ((*cueEntry)->type()) {
-                    case rekordbox_anlz_t::CUE_ENTRY_TYPE_MEMORY_CUE: {
-                        memory_cue_loop_t memoryCue;
-                        memoryCue.startPosition = position;
-                        memoryCue.endPosition = mixxx::audio::kInvalidFramePos;
-                        memoryCue.color = mixxx::RgbColor::nullopt();
-                        memoryCuesAndLoops << memoryCue;
-                    } break;
-                    case rekordbox_anlz_t::CUE_ENTRY_TYPE_LOOP: {
-                        int endTime = static_cast<int>((*cueEntry)->loop_time()) - timingOffset;
-                        // Ensure no offset times are less than 1
-                        if (endTime < 1) {
-                            endTime = 1;
-                        }
-
-                        memory_cue_loop_t loop;
-                        loop.startPosition = position;
-                        loop.endPosition = mixxx::audio::FramePos(
-                                sampleRateKhz * static_cast<double>(endTime));
-                        loop.color = mixxx::RgbColor::nullopt();
-                        memoryCuesAndLoops << loop;
-                    } break;
-                    }
-                } break;
-                case rekordbox_anlz_t::CUE_LIST_TYPE_HOT_CUES: {
-                    int hotCueIndex = static_cast<int>((*cueEntry)->hot_cue() - 1);
-                    if (hotCueIndex > lastHotCueIndex) {
-                        lastHotCueIndex = hotCueIndex;
-                    }
-                    setHotCue(
-                            track,
-                            position,
-                            mixxx::audio::kInvalidFramePos,
-                            hotCueIndex,
-                            QString(),
-                            mixxx::RgbColor::nullopt());
-                } break;
-                }
+    for (const auto& cue : pAnlzData->cues) {
+        const auto position = framePos(cue.timeMs);
+
+        switch (cue.list) {
+        case RekordboxAnlzData::CueList::MemoryCues: {
+            memory_cue_loop_t memoryCueOrLoop;
+            memoryCueOrLoop.startPosition = position;
+            memoryCueOrLoop.endPosition = cue.isLoop
+                    ? framePos(cue.loopTimeMs)
+                    : mixxx::audio::kInvalidFramePos;
+            if (cue.extended) {
+                memoryCueOrLoop.comment = cue.comment;
+                memoryCueOrLoop.color = colorFromID(cue.colorId);
+            } else {
+                memoryCueOrLoop.color = mixxx::RgbColor::nullopt();
             }
+            memoryCuesAndLoops << memoryCueOrLoop;
         } break;
-        case rekordbox_anlz_t::SECTION_TAGS_CUES_2: {
-            if (ignoreCues) {
-                break;
-            }
-
-            rekordbox_anlz_t::cue_extended_tag_t* cuesExtendedTag =
-                    static_cast<rekordbox_anlz_t::cue_extended_tag_t*>(
-                            (*section)->body());
-
-            for (std::vector<rekordbox_anlz_t::cue_extended_entry_t*>::iterator
-                            cueExtendedEntry = cuesExtendedTag->cues()->begin();
-                    cueExtendedEntry != cuesExtendedTag->cues()->end();
-                    ++cueExtendedEntry) {
-                int time = static_cast<int>((*cueExtendedEntry)->time()) - timingOffset;
-                // Ensure no offset times are less than 1
-                if (time < 1) {
-                    time = 1;
-                }
-                const auto position = mixxx::audio::FramePos(
-                        sampleRateKhz * static_cast<double>(time));
-
-                switch (cuesExtendedTag->type()) {
-                case rekordbox_anlz_t::CUE_LIST_TYPE_MEMORY_CUES: {
-                    switch ((*cueExtendedEntry)->type()) {
-                    case rekordbox_anlz_t::CUE_ENTRY_TYPE_MEMORY_CUE: {
-                        memory_cue_loop_t memoryCue;
-                        memoryCue.startPosition = position;
-                        memoryCue.endPosition = mixxx::audio::kInvalidFramePos;
-                        memoryCue.comment = toUnicode((*cueExtendedEntry)->comment());
-                        memoryCue.color = colorFromID(static_cast<int>(
-                                (*cueExtendedEntry)->color_id()));
-                        memoryCuesAndLoops << memoryCue;
-                    } break;
-                    case rekordbox_anlz_t::CUE_ENTRY_TYPE_LOOP: {
-                        int endTime =
-                                static_cast<int>(
-                                        (*cueExtendedEntry)->loop_time()) -
-                                timingOffset;
-                        // Ensure no offset times are less than 1
-                        if (endTime < 1) {
-                            endTime = 1;
-                        }
-
-                        memory_cue_loop_t loop;
-                        loop.startPosition = position;
-                        loop.endPosition = mixxx::audio::FramePos(
-                                sampleRateKhz * static_cast<double>(endTime));
-                        loop.comment = toUnicode((*cueExtendedEntry)->comment());
-                        loop.color = colorFromID(static_cast<int>((*cueExtendedEntry)->color_id()));
-                        memoryCuesAndLoops << loop;
-                    } break;
-                    }
-                } break;
-                case rekordbox_anlz_t::CUE_LIST_TYPE_HOT_CUES: {
-                    int hotCueIndex = static_cast<int>((*cueExtendedEntry)->hot_cue() - 1);
-                    if (hotCueIndex > lastHotCueIndex) {
-                        lastHotCueIndex = hotCueIndex;
-                    }
-                    setHotCue(track,
-                            position,
-                            mixxx::audio::kInvalidFramePos,
-                            hotCueIndex,
-                            toUnicode((*cueExtendedEntry)->comment()),
-                            mixxx::RgbColor(qRgb(
-                                    static_cast<int>(
-                                            (*cueExtendedEntry)->color_red()),
-                                    static_cast<int>(
-                                            (*cueExtendedEntry)->color_green()),
-                                    static_cast<int>((*cueExtendedEntry)
-                                                             ->color_blue()))));
-                } break;
-                }
+        case RekordboxAnlzData::CueList::HotCues: {
+            int hotCueIndex = cue.hotCue - 1;
+            if (hotCueIndex > lastHotCueIndex) {
+                lastHotCueIndex = hotCueIndex;
             }
+            setHotCue(track,
+                    position,
+                    mixxx::audio::kInvalidFramePos,
+                    hotCueIndex,
+                    cue.comment,
+                    cue.extended ? mixxx::RgbColor::optional(cue.hotCueColor)
+                                 : mixxx::RgbColor::nullopt());
         } break;
-        default:
-            break;
         }
     }
 
@@ -1105,7 +953,9 @@ void readAnalyze(TrackPointer track,
                 track->setMainCuePosition(memoryCueOrLoop.startPosition);
                 CuePointer pMainCue = track->findCueByType(mixxx::CueType::MainCue);
                 pMainCue->setLabel(memoryCueOrLoop.comment);
-                pMainCue->setColor(*memoryCueOrLoop.color);
+                if (memoryCueOrLoop.color) {
+                    pMainCue->setColor(*memoryCueOrLoop.color);
+                }
                 mainCueFound = true;
             } else {
                 // Mixxx v2.4 will feature multiple loops, so these saved here will be usable
@@ -1127,13 +977,15 @@ void readAnalyze(TrackPointer track,
 
 RekordboxPlaylistModel::RekordboxPlaylistModel(QObject* parent,
         TrackCollectionManager* trackCollectionManager,
-        QSharedPointer<BaseTrackCache> trackSource)
+        QSharedPointer<BaseTrackCache> trackSource,
+        std::shared_ptr<RekordboxAnlzCache> pAnlzCache)
         : BaseExternalPlaylistModel(parent,
                   trackCollectionManager,
                   "mixxx.db.model.rekordbox.playlistmodel",
                   kRekordboxPlaylistsTable,
                   kRekordboxPlaylistTracksTable,
-                  trackSource) {
+                  trackSource),
+          m_pAnlzCache(std::move(pAnlzCache)) {
 }
 
 void RekordboxPlaylistModel::initSortColumnMapping() {
@@ -1295,10 +1147,10 @@ TrackPointer RekordboxPlaylistModel::getTrack(const QModelIndex& index) const {
 
     if (QFile(anlzPathExt).exists()) {
         // Beatgrids appear to be only correct in legacy ANLZ file
-        readAnalyze(track, sampleRate, timingOffset, true, anlzPath);
-        readAnalyze(track, sampleRate, timingOffset, false, anlzPathExt);
+        applyAnalyze(track, sampleRate, timingOffset, true, m_pAnlzCache.get(), anlzPath);
+        applyAnalyze(track, sampleRate, timingOffset, false, m_pAnlzCache.get(), anlzPathExt);
     } else {
-        readAnalyze(track, sampleRate, timingOffset, false, anlzPath);
+        applyAnalyze(track, sampleRate, timingOffset, false, m_pAnlzCache.get(), anlzPath);
     }
 
     // Assume that the key of the file the has been analyzed in Recordbox is correct
@@ -1367,8 +1219,10 @@ RekordboxFeature::RekordboxFeature(
             << LIBRARYTABLE_KEY;
     m_trackSource->setSearchColumns(searchColumns);
 
+    m_pAnlzCache = std::make_shared<RekordboxAnlzCache>();
+
     m_pRekordboxPlaylistModel = new RekordboxPlaylistModel(
-            this, pLibrary->trackCollectionManager(), m_trackSource);
+            this, pLibrary->trackCollectionManager(), m_trackSource, m_pAnlzCache);
 
     m_title = tr("Rekordbox");
 
@@ -1432,7 +1286,7 @@ void RekordboxFeature::htmlLinkClicked(const QUrl& link) {
 
 BaseSqlTableModel* RekordboxFeature::getPlaylistModelForPlaylist(const QString& playlist) {
     RekordboxPlaylistModel* model = new RekordboxPlaylistModel(
-            this, m_pLibrary->trackCollectionManager(), m_trackSource);
+            this, m_pLibrary->trackCollectionManager(), m_trackSource, m_pAnlzCache);
     model->setPlaylist(playlist);
     return model;
 }
@@ -1537,7 +1391,10 @@ void RekordboxFeature::activateChild(const QModelIndex& index) {
         qDebug() << "Parse Rekordbox Device DB: " << playlist;
 
         // Let a worker thread do the XML parsing
-        m_tracksFuture = QtConcurrent::run(parseDeviceDB, static_cast<Library*>(parent())->dbConnectionPool(), item);
+        m_tracksFuture = QtConcurrent::run(parseDeviceDB,
+                static_cast<Library*>(parent())->dbConnectionPool(),
+                item,
+                m_pAnlzCache);
         m_tracksFutureWatcher.setFuture(m_tracksFuture);
 
         // This device is now a playlist element, future activations should treat is
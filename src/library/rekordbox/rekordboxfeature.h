@@ -28,11 +28,12 @@
 #include <QFutureWatcher>
 #include <QStringListModel>
 #include <QtConcurrentRun>
-#include <fstream>
+#include <memory>
 
 #include "library/baseexternallibraryfeature.h"
 #include "library/baseexternalplaylistmodel.h"
 #include "library/baseexternaltrackmodel.h"
+#include "library/rekordbox/rekordboxanlzcache.h"
 #include "library/treeitemmodel.h"
 #include "util/parented_ptr.h"
 
@@ -44,13 +45,17 @@ class RekordboxPlaylistModel : public BaseExternalPlaylistModel {
   public:
     RekordboxPlaylistModel(QObject* parent,
             TrackCollectionManager* pTrackCollectionManager,
-            QSharedPointer<BaseTrackCache> trackSource);
+            QSharedPointer<BaseTrackCache> trackSource,
+            std::shared_ptr<RekordboxAnlzCache> pAnlzCache);
     TrackPointer getTrack(const QModelIndex& index) const override;
     bool isColumnHiddenByDefault(int column) override;
     bool isColumnInternal(int column) override;
 
   protected:
     void initSortColumnMapping() override;
+
+  private:
+    const std::shared_ptr<RekordboxAnlzCache> m_pAnlzCache;
 };
 
 class RekordboxFeature : public BaseExternalLibraryFeature {
@@ -90,4 +95,6 @@ class RekordboxFeature : public BaseExternalLibraryFeature {
     QString m_title;
 
     QSharedPointer<BaseTrackCache> m_trackSource;
+    // Shared with the playlist models and the import of the devices
+    std::shared_ptr<RekordboxAnlzCache> m_pAnlzCache;
 };
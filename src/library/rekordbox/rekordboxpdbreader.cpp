@@ -0,0 +1,128 @@
+#include "library/rekordbox/rekordboxpdbreader.h"
+
+#include <QtDebug>
+#include <streambuf>
+
+#include "util/assert.h"
+
+/// A read-only stream buffer over memory, e.g. a memory-mapped file,
+/// with the seeking support that kaitai::kstream requires.
+class RekordboxPdbReader::MemoryStreamBuffer : public std::streambuf {
+  public:
+    MemoryStreamBuffer(const uchar* pData, qint64 size) {
+        // The buffer is never written to
+        char* pBegin = const_cast<char*>(reinterpret_cast<const char*>(pData));
+        setg(pBegin, pBegin, pBegin + size);
+    }
+
+  protected:
+    pos_type seekoff(off_type offset,
+            std::ios_base::seekdir direction,
+            std::ios_base::openmode which) override {
+        if (!(which & std::ios_base::in)) {
+            return pos_type(off_type(-1));
+        }
+        char* pTarget;
+        switch (direction) {
+        case std::ios_base::beg:
+            pTarget = eback() + offset;
+            break;
+        case std::ios_base::cur:
+            pTarget = gptr() + offset;
+            break;
+        case std::ios_base::end:
+            pTarget = egptr() + offset;
+            break;
+        default:
+            return pos_type(off_type(-1));
+        }
+        if (pTarget < eback() || pTarget > egptr()) {
+            return pos_type(off_type(-1));
+        }
+        setg(eback(), pTarget, egptr());
+        return pos_type(pTarget - eback());
+    }
+
+    pos_type seekpos(pos_type position, std::ios_base::openmode which) override {
+        return seekoff(off_type(position), std::ios_base::beg, which);
+    }
+};
+
+RekordboxPdbReader::RekordboxPdbReader(const QString& filePath)
+        : m_file(filePath),
+          m_pData(nullptr),
+          m_size(0) {
+}
+
+// Defined here where MemoryStreamBuffer is complete
+RekordboxPdbReader::~RekordboxPdbReader() = default;
+
+bool RekordboxPdbReader::open() {
+    DEBUG_ASSERT(!m_pPdb);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Failed to open" << m_file.fileName() << m_file.errorString();
+        return false;
+    }
+    m_size = m_file.size();
+    m_pData = m_file.map(0, m_size);
+    if (!m_pData) {
+        qWarning() << "Failed to map" << m_file.fileName() << m_file.errorString();
+        return false;
+    }
+    m_pStreamBuffer = std::make_unique<MemoryStreamBuffer>(m_pData, m_size);
+    m_pStream = std::make_unique<std::istream>(m_pStreamBuffer.get());
+    m_pKaitaiStream = std::make_unique<kaitai::kstream>(m_pStream.get());
+    // Only reads the header and the table directory. The pages are
+    // read on demand by forEachRow().
+    m_pPdb = std::make_unique<rekordbox_pdb_t>(m_pKaitaiStream.get());
+    return true;
+}
+
+int RekordboxPdbReader::forEachRow(rekordbox_pdb_t::page_type_t type,
+        const std::function<void(kaitai::kstruct* pRow)>& visitRow) {
+    VERIFY_OR_DEBUG_ASSERT(m_pPdb) {
+        return 0;
+    }
+    const qint64 pageSize = m_pPdb->len_page();
+    VERIFY_OR_DEBUG_ASSERT(pageSize > 0) {
+        return 0;
+    }
+    const qint64 numPages = m_size / pageSize;
+
+    int numRows = 0;
+    for (rekordbox_pdb_t::table_t* pTable : *m_pPdb->tables()) {
+        if (pTable->type() != type) {
+            continue;
+        }
+        const uint32_t lastIndex = pTable->last_page()->index();
+        uint32_t pageIndex = pTable->first_page()->index();
+        // Every page is visited at most once, even if a corrupt file
+        // contains a cycle of pages.
+        for (qint64 numVisitedPages = 0; numVisitedPages < numPages; ++numVisitedPages) {
+            if (pageIndex >= numPages) {
+                qWarning() << "Page" << pageIndex << "of" << m_file.fileName()
+                           << "is out of range";
+                break;
+            }
+            MemoryStreamBuffer pageBuffer(m_pData + pageIndex * pageSize, pageSize);
+            std::istream pageStream(&pageBuffer);
+            kaitai::kstream pageKaitaiStream(&pageStream);
+            rekordbox_pdb_t::page_t page(&pageKaitaiStream, nullptr, m_pPdb.get());
+            if (page.is_data_page()) {
+                for (rekordbox_pdb_t::row_group_t* pRowGroup : *page.row_groups()) {
+                    for (rekordbox_pdb_t::row_ref_t* pRowRef : *pRowGroup->rows()) {
+                        if (pRowRef->present()) {
+                            visitRow(pRowRef->body());
+                            ++numRows;
+                        }
+                    }
+                }
+            }
+            if (pageIndex == lastIndex) {
+                break;
+            }
+            pageIndex = page.next_page()->index();
+        }
+    }
+    return numRows;
+}
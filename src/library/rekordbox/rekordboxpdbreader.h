@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+#include <functional>
+#include <istream>
+#include <memory>
+
+#include "library/rekordbox/rekordbox_pdb.h"
+
+/// Reads the tables of a Rekordbox export.pdb file page by page.
+///
+/// The generated parser keeps every page that has been visited, because
+/// each page owns the reference to the next page. This reader memory-maps
+/// the file and parses each page on its own when it is visited. Only the
+/// current page is held in memory, regardless of the size of the export.
+class RekordboxPdbReader {
+  public:
+    explicit RekordboxPdbReader(const QString& filePath);
+    ~RekordboxPdbReader();
+
+    /// Maps the file and reads the header with the table directory.
+    /// Returns false if the file cannot be mapped. Malformed files cause
+    /// the same exceptions as the generated parser.
+    bool open();
+
+    /// Visits all present rows of the tables of the given type in page
+    /// order. The row must be cast to the row type of the table, e.g.
+    /// rekordbox_pdb_t::track_row_t for PAGE_TYPE_TRACKS. The row is only
+    /// valid during the call. Returns the number of visited rows.
+    int forEachRow(rekordbox_pdb_t::page_type_t type,
+            const std::function<void(kaitai::kstruct* pRow)>& visitRow);
+
+  private:
+    class MemoryStreamBuffer;
+
+    QFile m_file;
+    const uchar* m_pData;
+    qint64 m_size;
+
+    std::unique_ptr<MemoryStreamBuffer> m_pStreamBuffer;
+    std::unique_ptr<std::istream> m_pStream;
+    std::unique_ptr<kaitai::kstream> m_pKaitaiStream;
+    std::unique_ptr<rekordbox_pdb_t> m_pPdb;
+};
@@ -0,0 +1,215 @@
+#include "library/serato/seratodatabasereader.h"
+
+#include <QtDebug>
+#include <QtEndian>
+
+#include "util/assert.h"
+
+namespace {
+
+constexpr int kHeaderSize = 2 * sizeof(quint32);
+
+void warnAboutIncompleteField(const SeratoFieldReader& reader) {
+    qWarning() << "Found "
+               << reader.bytesLeft()
+               << " extra bytes at end of track definition.";
+}
+
+} // anonymous namespace
+
+QString SeratoField::name() const {
+    const quint32 bigEndianId = qToBigEndian(static_cast<quint32>(id));
+    return QString::fromLatin1(reinterpret_cast<const char*>(&bigEndianId),
+            sizeof(bigEndianId));
+}
+
+QString SeratoField::toString() const {
+    // Decoded directly instead of using QTextCodec, which is much slower
+    // for the many short strings of a database.
+    const int length = static_cast<int>(size / 2);
+    QString text(length, Qt::Uninitialized);
+    QChar* pChars = text.data();
+    for (int i = 0; i < length; ++i) {
+        pChars[i] = QChar(qFromBigEndian<quint16>(pData + 2 * i));
+    }
+    return text;
+}
+
+quint32 SeratoField::toUInt32() const {
+    VERIFY_OR_DEBUG_ASSERT(size >= sizeof(quint32)) {
+        return 0;
+    }
+    return qFromBigEndian<quint32>(pData);
+}
+
+bool SeratoField::toBool() const {
+    VERIFY_OR_DEBUG_ASSERT(size > 0) {
+        return false;
+    }
+    return pData[0] != 0;
+}
+
+bool SeratoFieldReader::readNext(SeratoField* pField) {
+    if (bytesLeft() < kHeaderSize) {
+        return false;
+    }
+    const quint32 fieldSize = qFromBigEndian<quint32>(m_pData + sizeof(quint32));
+    if (static_cast<quint64>(fieldSize) >
+            static_cast<quint64>(bytesLeft() - kHeaderSize)) {
+        qWarning() << "Failed to read "
+                   << fieldSize
+                   << " bytes for "
+                   << QString::fromLatin1(m_pData, sizeof(quint32))
+                   << " field.";
+        return false;
+    }
+    pField->id = static_cast<SeratoFieldId>(qFromBigEndian<quint32>(m_pData));
+    pField->pData = m_pData + kHeaderSize;
+    pField->size = fieldSize;
+    m_pData += kHeaderSize + fieldSize;
+    return true;
+}
+
+bool parseSeratoTrack(const SeratoField& trackField, SeratoTrack* pTrack) {
+    SeratoFieldReader reader(trackField);
+    SeratoField field;
+    while (reader.readNext(&field)) {
+        // Parse field data
+        switch (field.id) {
+        case SeratoFieldId::FileType:
+            pTrack->filetype = field.toString();
+            break;
+        case SeratoFieldId::FilePath:
+            pTrack->location = field.toString();
+            break;
+        case SeratoFieldId::SongTitle:
+            pTrack->title = field.toString();
+            break;
+        case SeratoFieldId::Artist:
+            pTrack->artist = field.toString();
+            break;
+        case SeratoFieldId::Album:
+            pTrack->album = field.toString();
+            break;
+        case SeratoFieldId::Genre:
+            pTrack->genre = field.toString();
+            break;
+        case SeratoFieldId::Length: {
+            bool ok;
+            int duration = field.toString().toInt(&ok);
+            if (ok) {
+                pTrack->duration = duration;
+            }
+            break;
+        }
+        case SeratoFieldId::Bitrate:
+            pTrack->bitrate = field.toString();
+            break;
+        case SeratoFieldId::SampleRate:
+            pTrack->samplerate = field.toString();
+            break;
+        case SeratoFieldId::Bpm: {
+            bool ok;
+            double bpm = field.toString().toDouble(&ok);
+            if (ok) {
+                pTrack->bpm = bpm;
+            }
+            break;
+        }
+        case SeratoFieldId::Comment:
+            pTrack->comment = field.toString();
+            break;
+        case SeratoFieldId::Grouping:
+            pTrack->grouping = field.toString();
+            break;
+        case SeratoFieldId::Label:
+            pTrack->label = field.toString();
+            break;
+        case SeratoFieldId::Year: {
+            // 4-digit year as string (YYYY)
+            bool ok;
+            int year = field.toString().toInt(&ok);
+            if (ok) {
+                pTrack->year = year;
+            }
+            break;
+        }
+        case SeratoFieldId::Key:
+            pTrack->key = field.toString();
+            break;
+        case SeratoFieldId::BeatgridLocked:
+            pTrack->beatgridlocked = field.toBool();
+            break;
+        case SeratoFieldId::Missing:
+            if (field.size == 1) {
+                pTrack->missing = field.toBool();
+            }
+            break;
+        case SeratoFieldId::FileTime:
+            // POSIX timestamp
+            if (field.size == sizeof(quint32)) {
+                pTrack->filetime = field.toUInt32();
+            }
+            break;
+        case SeratoFieldId::DateAdded:
+            // POSIX timestamp
+            if (field.size == sizeof(quint32)) {
+                pTrack->datetimeadded = field.toUInt32();
+            }
+            break;
+        case SeratoFieldId::DateAddedText:
+            // Ignore this field, but do not print a debug message. It's the
+            // same as the regular DateAdded field, but this time the timestamp
+            // is a string instead of an unsigned integer. Since we already
+            // parse the integer version, it doesn't make sense to parse this.
+            break;
+        default:
+            qDebug() << "Ignoring unknown field "
+                     << field.name()
+                     << " ("
+                     << field.size
+                     << " bytes).";
+        }
+    }
+
+    if (reader.bytesLeft() != 0) {
+        warnAboutIncompleteField(reader);
+        return false;
+    }
+
+    // Ignore tracks with empty location fields. The track location is used as
+    // identifier by Serato (e.g. it's also used to reference them in Crates).
+    if (pTrack->location.isEmpty()) {
+        qWarning() << "Found track with empty location field.";
+        return false;
+    }
+
+    return true;
+}
+
+QString parseSeratoCrateTrackPath(const SeratoField& trackField) {
+    QString location;
+    SeratoFieldReader reader(trackField);
+    SeratoField field;
+    while (reader.readNext(&field)) {
+        // Parse field data
+        switch (field.id) {
+        case SeratoFieldId::TrackPath:
+            location = field.toString();
+            break;
+        default:
+            qDebug() << "Ignoring unknown field "
+                     << field.name()
+                     << " ("
+                     << field.size
+                     << " bytes).";
+        }
+    }
+
+    if (reader.bytesLeft() != 0) {
+        warnAboutIncompleteField(reader);
+        return QString();
+    }
+
+    return location;
+}
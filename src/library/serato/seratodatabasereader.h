@@ -0,0 +1,111 @@
+#pragma once
+
+#include <QString>
+
+/// Serato Database Field IDs
+/// The "magic" value is the short 4 byte ascii code interpreted as quint32, so
+/// that we can use the value in a switch statement instead of going through
+/// a strcmp if/else ladder.
+enum class SeratoFieldId : quint32 {
+    Version = 0x7672736e,        // vrsn
+    Track = 0x6f74726b,          // otrk
+    FileType = 0x74747970,       // ttyp
+    FilePath = 0x7066696c,       // pfil
+    SongTitle = 0x74736e67,      // tsng
+    Artist = 0x74617274,         // tart
+    Album = 0x74616c62,          // talb
+    Genre = 0x7467656e,          // tgen
+    Comment = 0x74636f6d,        // tcom
+    Grouping = 0x74677270,       // tgrp
+    Label = 0x746c626c,          // tlbl
+    Year = 0x74747972,           // ttyr
+    Length = 0x746c656e,         // tlen
+    Bitrate = 0x74626974,        // tbit
+    SampleRate = 0x74736d70,     // tsmp
+    Bpm = 0x7462706d,            // tbpm
+    DateAddedText = 0x74616464,  // tadd
+    DateAdded = 0x75616464,      // uadd
+    Key = 0x746b6579,            // tkey
+    BeatgridLocked = 0x6262676c, // bbgl
+    FileTime = 0x75746d65,       // utme
+    Missing = 0x626d6973,        // bmis
+    Sorting = 0x7472736f,        // osrt
+    ReverseOrder = 0x62726576,   // brev
+    ColumnTitle = 0x6f766374,    // ovct
+    ColumnName = 0x7476636e,     // tvcn
+    ColumnWidth = 0x74766377,    // tvcw
+    TrackPath = 0x7074726b,      // ptrk
+};
+
+/// A field of a Serato "database V2" or crate file. The data is not
+/// copied and points into the buffer of the reader.
+struct SeratoField {
+    SeratoFieldId id;
+    const char* pData;
+    quint32 size;
+
+    /// The 4 byte ascii code of the id
+    QString name() const;
+    /// Decodes UTF-16BE text
+    QString toString() const;
+    quint32 toUInt32() const;
+    bool toBool() const;
+};
+
+/// Reads the tag-length-value fields of a Serato "database V2" or crate
+/// file in place, e.g. from a memory-mapped file. Each field has a 4 byte
+/// id, a 4 byte big-endian size and the data, which may contain nested
+/// fields.
+class SeratoFieldReader {
+  public:
+    SeratoFieldReader(const char* pData, qint64 size)
+            : m_pData(pData),
+              m_pEnd(pData + size) {
+    }
+    /// Reads the nested fields of a field
+    explicit SeratoFieldReader(const SeratoField& field)
+            : SeratoFieldReader(field.pData, field.size) {
+    }
+
+    /// Returns false at the end of the data or if the next field is
+    /// truncated. Check bytesLeft() to distinguish both cases.
+    bool readNext(SeratoField* pField);
+
+    qint64 bytesLeft() const {
+        return m_pEnd - m_pData;
+    }
+
+  private:
+    const char* m_pData;
+    const char* const m_pEnd;
+};
+
+struct SeratoTrack {
+    QString filetype;
+    QString location;
+    QString title;
+    QString artist;
+    QString album;
+    QString genre;
+    QString comment;
+    QString grouping;
+    QString label;
+    int year = -1;
+    int duration = 0;
+    QString bitrate;
+    QString samplerate;
+    double bpm = -1.0;
+    QString key;
+    bool beatgridlocked = false;
+    bool missing = false;
+    quint32 filetime = 0;
+    quint32 datetimeadded = 0;
+};
+
+/// Parses the nested fields of a track field of a "database V2" file.
+/// Returns false if the track is malformed or has no location.
+bool parseSeratoTrack(const SeratoField& trackField, SeratoTrack* pTrack);
+
+/// Parses the nested fields of a track field of a crate file. Returns
+/// the location of the track or an empty string if it is malformed.
+QString parseSeratoCrateTrackPath(const SeratoField& trackField);
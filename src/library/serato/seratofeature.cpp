@@ -1,14 +1,14 @@
 #include "library/serato/seratofeature.h"
 
-#include <QMap>
+#include <QHash>
 #include <QMessageBox>
 #include <QSettings>
-#include <QTextCodec>
 #include <QtDebug>
 
 #include "library/dao/trackschema.h"
 #include "library/library.h"
 #include "library/queryutil.h"
+#include "library/serato/seratodatabasereader.h"
 #include "library/trackcollection.h"
 #include "library/trackcollectionmanager.h"
 #include "library/treeitem.h"
@@ -19,68 +19,12 @@
 #include "util/color/color.h"
 #include "util/db/dbconnectionpooled.h"
 #include "util/db/dbconnectionpooler.h"
+#include "util/db/sqlbatchinserter.h"
 #include "widget/wlibrary.h"
 #include "widget/wlibrarytextbrowser.h"
 
 namespace {
 
-// Serato Database Field IDs
-// The "magic" value is the short 4 byte ascii code interpreted as quint32, so
-// that we can use the value in a switch statement instead of going through
-// a strcmp if/else ladder.
-enum class FieldId : quint32 {
-    Version = 0x7672736e,        // vrsn
-    Track = 0x6f74726b,          // otrk
-    FileType = 0x74747970,       // ttyp
-    FilePath = 0x7066696c,       // pfil
-    SongTitle = 0x74736e67,      // tsng
-    Artist = 0x74617274,         // tart
-    Album = 0x74616c62,          // talb
-    Genre = 0x7467656e,          // tgen
-    Comment = 0x74636f6d,        // tcom
-    Grouping = 0x74677270,       // tgrp
-    Label = 0x746c626c,          // tlbl
-    Year = 0x74747972,           // ttyr
-    Length = 0x746c656e,         // tlen
-    Bitrate = 0x74626974,        // tbit
-    SampleRate = 0x74736d70,     // tsmp
-    Bpm = 0x7462706d,            // tbpm
-    DateAddedText = 0x74616464,  // tadd
-    DateAdded = 0x75616464,      // uadd
-    Key = 0x746b6579,            // tkey
-    BeatgridLocked = 0x6262676c, // bbgl
-    FileTime = 0x75746d65,       // utme
-    Missing = 0x626d6973,        // bmis
-    Sorting = 0x7472736f,        // osrt
-    ReverseOrder = 0x62726576,   // brev
-    ColumnTitle = 0x6f766374,    // ovct
-    ColumnName = 0x7476636e,     // tvcn
-    ColumnWidth = 0x74766377,    // tvcw
-    TrackPath = 0x7074726b,      // ptrk
-};
-
-struct serato_track_t {
-    QString filetype;
-    QString location;
-    QString title;
-    QString artist;
-    QString album;
-    QString genre;
-    QString comment;
-    QString grouping;
-    QString label;
-    int year = -1;
-    int duration = 0;
-    QString bitrate;
-    QString samplerate;
-    double bpm = -1.0;
-    QString key;
-    bool beatgridlocked = false;
-    bool missing = false;
-    quint32 filetime = 0;
-    quint32 datetimeadded = 0;
-};
-
 const QString kDatabaseDirectory = QStringLiteral("_Serato_");
 const QString kDatabaseFilename = QStringLiteral("database V2");
 const QString kCrateDirectory = QStringLiteral("Subcrates");
@@ -92,7 +36,27 @@ const QString kSeratoLibraryTable = QStringLiteral("serato_library");
 const QString kSeratoPlaylistsTable = QStringLiteral("serato_playlists");
 const QString kSeratoPlaylistTracksTable = QStringLiteral("serato_playlist_tracks");
 
-constexpr int kHeaderSize = 2 * sizeof(quint32);
+// The columns of kSeratoLibraryTable that are inserted by parseTracks()
+const QStringList kLibraryColumns = {
+        LIBRARYTABLE_ID,
+        LIBRARYTABLE_TITLE,
+        LIBRARYTABLE_ARTIST,
+        LIBRARYTABLE_ALBUM,
+        LIBRARYTABLE_GENRE,
+        LIBRARYTABLE_COMMENT,
+        LIBRARYTABLE_GROUPING,
+        LIBRARYTABLE_YEAR,
+        LIBRARYTABLE_DURATION,
+        LIBRARYTABLE_BITRATE,
+        LIBRARYTABLE_SAMPLERATE,
+        LIBRARYTABLE_BPM,
+        LIBRARYTABLE_KEY,
+        TRACKLOCATIONSTABLE_LOCATION,
+        LIBRARYTABLE_BPM_LOCK,
+        LIBRARYTABLE_DATETIMEADDED,
+        QStringLiteral("label"),
+        QStringLiteral("serato_db"),
+};
 
 int createPlaylist(const QSqlDatabase& database, const QString& name, const QString& databasePath) {
     QSqlQuery query(database);
@@ -110,327 +74,265 @@ int createPlaylist(const QSqlDatabase& database, const QString& name, const QStr
     return query.lastInsertId().toInt();
 }
 
-int insertTrackIntoPlaylist(const QSqlDatabase& database, int playlistId, int trackId, int position) {
+bool removePlaylistTracks(const QSqlDatabase& database, int playlistId) {
     QSqlQuery query(database);
     query.prepare(
-            "INSERT INTO serato_playlist_tracks (playlist_id, track_id, position) "
-            "VALUES (:playlist_id, :track_id, :position)");
+            "DELETE FROM serato_playlist_tracks "
+            "WHERE playlist_id=:playlist_id");
     query.bindValue(":playlist_id", playlistId);
-    query.bindValue(":track_id", trackId);
-    query.bindValue(":position", position);
 
     if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
-        return -1;
+        LOG_FAILED_QUERY(query) << "playlistId: " << playlistId;
+        return false;
     }
 
-    return query.lastInsertId().toInt();
-}
-
-inline QString utf16beToQString(const QByteArray& data, const quint32 size) {
-    return QTextCodec::codecForName("UTF-16BE")->toUnicode(data, size);
+    return true;
 }
 
-inline bool bytesToBoolean(const QByteArray& data) {
-    VERIFY_OR_DEBUG_ASSERT(!data.isEmpty()) {
+bool removePlaylist(const QSqlDatabase& database, int playlistId) {
+    if (!removePlaylistTracks(database, playlistId)) {
         return false;
     }
-    return data.at(0) != 0;
-}
 
-inline quint32 bytesToUInt32(const QByteArray& data) {
-    VERIFY_OR_DEBUG_ASSERT(data.size() >= static_cast<int>(sizeof(quint32))) {
-        return 0;
+    QSqlQuery query(database);
+    query.prepare("DELETE FROM serato_playlists WHERE id=:id");
+    query.bindValue(":id", playlistId);
+
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query) << "playlistId: " << playlistId;
+        return false;
     }
-    return qFromBigEndian<quint32>(data.constData());
+
+    return true;
 }
 
-inline bool parseTrack(serato_track_t* track, QIODevice* buffer) {
-    QByteArray headerData = buffer->read(kHeaderSize);
-    while (headerData.length() == kHeaderSize) {
-        quint32 fieldId = bytesToUInt32(headerData.mid(0, sizeof(quint32)));
-        quint32 fieldSize = bytesToUInt32(headerData.mid(sizeof(quint32), kHeaderSize));
-
-        // Read field data
-        QByteArray data = buffer->read(fieldSize);
-        if (static_cast<quint32>(data.length()) != fieldSize) {
-            QString fieldName = QString(headerData.mid(0, sizeof(quint32)));
-            qWarning() << "Failed to read "
-                       << fieldSize
-                       << " bytes for "
-                       << fieldName
-                       << " field.";
+/// Removes all tracks and playlists that have been imported from the
+/// database, including those of a previous session.
+bool removeDatabase(const QSqlDatabase& database, const QString& databasePath) {
+    const QStringList statements = {
+            QStringLiteral(
+                    "DELETE FROM serato_playlist_tracks WHERE playlist_id IN "
+                    "(SELECT id FROM serato_playlists WHERE serato_db=:serato_db)"),
+            QStringLiteral("DELETE FROM serato_playlists WHERE serato_db=:serato_db"),
+            QStringLiteral("DELETE FROM serato_library WHERE serato_db=:serato_db"),
+    };
+    for (const auto& statement : statements) {
+        QSqlQuery query(database);
+        query.prepare(statement);
+        query.bindValue(":serato_db", databasePath);
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query) << "databasePath: " << databasePath;
             return false;
         }
-
-        // Parse field data
-        switch (static_cast<FieldId>(fieldId)) {
-        case FieldId::FileType:
-            track->filetype = utf16beToQString(data, fieldSize);
-            break;
-        case FieldId::FilePath:
-            track->location = utf16beToQString(data, fieldSize);
-            break;
-        case FieldId::SongTitle:
-            track->title = utf16beToQString(data, fieldSize);
-            break;
-        case FieldId::Artist:
-            track->artist = utf16beToQString(data, fieldSize);
-            break;
-        case FieldId::Album:
-            track->album = utf16beToQString(data, fieldSize);
-            break;
-        case FieldId::Genre:
-            track->genre = utf16beToQString(data, fieldSize);
-            break;
-        case FieldId::Length: {
-            bool ok;
-            int duration = utf16beToQString(data, fieldSize).toInt(&ok);
-            if (ok) {
-                track->duration = duration;
-            }
-            break;
-        }
-        case FieldId::Bitrate:
-            track->bitrate = utf16beToQString(data, fieldSize);
-            break;
-        case FieldId::SampleRate:
-            track->samplerate = utf16beToQString(data, fieldSize);
-            break;
-        case FieldId::Bpm: {
-            bool ok;
-            double bpm = utf16beToQString(data, fieldSize).toDouble(&ok);
-            if (ok) {
-                track->bpm = bpm;
-            }
-            break;
-        }
-        case FieldId::Comment:
-            track->comment = utf16beToQString(data, fieldSize);
-            break;
-        case FieldId::Grouping:
-            track->grouping = utf16beToQString(data, fieldSize);
-            break;
-        case FieldId::Label:
-            track->label = utf16beToQString(data, fieldSize);
-            break;
-        case FieldId::Year: {
-            // 4-digit year as string (YYYY)
-            bool ok;
-            int year = utf16beToQString(data, fieldSize).toInt(&ok);
-            if (ok) {
-                track->year = year;
-            }
-            break;
-        }
-        case FieldId::Key:
-            track->key = utf16beToQString(data, fieldSize);
-            break;
-        case FieldId::BeatgridLocked:
-            track->beatgridlocked = bytesToBoolean(data);
-            break;
-        case FieldId::Missing:
-            if (fieldSize == 1) {
-                track->missing = bytesToBoolean(data);
-            }
-            break;
-        case FieldId::FileTime:
-            // POSIX timestamp
-            if (fieldSize == sizeof(quint32)) {
-                track->filetime = bytesToUInt32(data);
-            }
-            break;
-        case FieldId::DateAdded:
-            // POSIX timestamp
-            if (fieldSize == sizeof(quint32)) {
-                track->datetimeadded = bytesToUInt32(data);
-            }
-            break;
-        case FieldId::DateAddedText:
-            // Ignore this field, but do not print a debug message. It's the
-            // same as the regular DateAdded field, but this time the timestamp
-            // is a string instead of an unsigned integer. Since we already
-            // parse the integer version, it doesn't make sense to parse this.
-            break;
-        default: {
-            QString fieldName = QString(headerData.mid(0, sizeof(quint32)));
-            qDebug() << "Ignoring unknown field "
-                     << fieldName
-                     << " ("
-                     << fieldSize
-                     << " bytes).";
-        }
-        }
-
-        headerData = buffer->read(kHeaderSize);
     }
+    return true;
+}
 
-    if (headerData.length() != 0) {
-        qWarning() << "Found "
-                   << headerData.length()
-                   << " extra bytes at end of track definition.";
-        return false;
+/// Maps the whole file into memory. The mapping is released when the
+/// file is closed.
+const char* mapFile(QFile* pFile) {
+    mixxx::FileInfo fileInfo(pFile->fileName());
+    if (!Sandbox::askForAccess(&fileInfo) || !pFile->open(QIODevice::ReadOnly)) {
+        qWarning() << "Failed to open file "
+                   << pFile->fileName()
+                   << " for reading.";
+        return nullptr;
     }
-
-    // Ignore tracks with empty location fields. The track location is used as
-    // identifier by Serato (e.g. it's also used to reference them in Crates).
-    if (track->location.isEmpty()) {
-        qWarning() << "Found track with empty location field.";
-        return false;
+    if (pFile->size() == 0) {
+        // Empty files cannot be mapped
+        return "";
     }
-
-    return true;
+    const uchar* pData = pFile->map(0, pFile->size());
+    if (!pData) {
+        qWarning() << "Failed to map file "
+                   << pFile->fileName()
+                   << pFile->errorString();
+    }
+    return reinterpret_cast<const char*>(pData);
 }
 
-inline QString parseCrateTrackPath(QIODevice* buffer) {
-    QString location;
-    QByteArray headerData = buffer->read(kHeaderSize);
-    while (headerData.length() == kHeaderSize) {
-        quint32 fieldId = bytesToUInt32(headerData.mid(0, sizeof(quint32)));
-        quint32 fieldSize = bytesToUInt32(headerData.mid(sizeof(quint32), kHeaderSize));
-
-        // Read field data
-        QByteArray data = buffer->read(fieldSize);
-        if (static_cast<quint32>(data.length()) != fieldSize) {
-            QString fieldName = QString(headerData.mid(0, sizeof(quint32)));
-            qWarning() << "Failed to read "
-                       << fieldSize
-                       << " bytes for "
-                       << fieldName
-                       << " field.";
-            return QString();
-        }
+enum class ParseCrateResult {
+    Parsed,
+    /// The crate is skipped
+    Unreadable,
+    /// Inserting the tracks failed, which fails the whole import
+    Failed,
+};
 
+/// Appends the tracks of the crate to its playlist.
+ParseCrateResult parseCrate(
+        SqlBatchInserter* pPlaylistTracksInserter,
+        const QString& crateFilePath,
+        int playlistId,
+        const QHash<QString, int>& trackIdMap) {
+    qDebug() << "Parsing crate"
+             << QFileInfo(crateFilePath).baseName()
+             << "at" << crateFilePath;
+
+    QFile crateFile(crateFilePath);
+    const char* pCrateData = mapFile(&crateFile);
+    if (!pCrateData) {
+        return ParseCrateResult::Unreadable;
+    }
+
+    int trackCount = 0;
+    SeratoFieldReader reader(pCrateData, crateFile.size());
+    SeratoField field;
+    while (reader.readNext(&field)) {
         // Parse field data
-        switch (static_cast<FieldId>(fieldId)) {
-        case FieldId::TrackPath:
-            location = utf16beToQString(data, fieldSize);
+        switch (field.id) {
+        case SeratoFieldId::Version: {
+            qDebug() << "Serato Database Version: "
+                     << field.toString();
             break;
+        }
+        case SeratoFieldId::Track: {
+            QString location = parseSeratoCrateTrackPath(field);
+            if (!location.isEmpty()) {
+                int trackId = trackIdMap.value(location, -1);
+                if (!pPlaylistTracksInserter->append({playlistId, trackId, trackCount})) {
+                    return ParseCrateResult::Failed;
+                }
+                trackCount++;
+            }
+            break;
+        }
         default: {
-            QString fieldName = QString(headerData.mid(0, sizeof(quint32)));
             qDebug() << "Ignoring unknown field "
-                     << fieldName
+                     << field.name()
                      << " ("
-                     << fieldSize
-                     << " bytes).";
+                     << field.size
+                     << " bytes) in database "
+                     << crateFilePath
+                     << ".";
         }
         }
-
-        headerData = buffer->read(kHeaderSize);
     }
 
-    if (headerData.length() != 0) {
+    if (reader.bytesLeft() != 0) {
         qWarning() << "Found "
-                   << headerData.length()
-                   << " extra bytes at end of track definition.";
-        return QString();
+                   << reader.bytesLeft()
+                   << " extra bytes at end of Serato database file "
+                   << crateFilePath
+                   << ".";
     }
 
-    return location;
+    return ParseCrateResult::Parsed;
 }
 
-QString parseCrate(
+/// Inserts the tracks of the database into the library table and its
+/// playlist, and records their ids in pImportedDatabase. Returns false
+/// if any row could not be inserted. Rows are buffered, so a failed batch
+/// affects tracks that have been appended before.
+bool parseTracks(
         const QSqlDatabase& database,
-        const QString& databasePath,
-        const QString& crateFilePath,
-        const QMap<QString, int>& trackIdMap) {
-    QString crateName = QFileInfo(crateFilePath).baseName();
-    qDebug() << "Parsing crate"
-             << crateName
-             << "at" << crateFilePath;
-
-    //Open the database connection in this thread.
-    VERIFY_OR_DEBUG_ASSERT(database.isOpen()) {
-        qWarning() << "Failed to open database for Serato parser."
-                   << database.lastError();
-        return QString();
+        SqlBatchInserter* pPlaylistTracksInserter,
+        const QString& databaseFilePath,
+        const QDir& databaseDir,
+        const QDir& databaseRootDir,
+        int playlistId,
+        SeratoImportedDatabase* pImportedDatabase) {
+    QFile databaseFile(databaseFilePath);
+    const char* pDatabaseData = mapFile(&databaseFile);
+    if (!pDatabaseData) {
+        return false;
     }
 
-    mixxx::FileInfo fileInfo(crateFilePath);
-    QFile crateFile(crateFilePath);
-    if (!Sandbox::askForAccess(&fileInfo) || !crateFile.open(QIODevice::ReadOnly)) {
-        qWarning() << "Failed to open file "
-                   << crateFilePath
-                   << " for reading.";
-        return QString();
+    // The ids of the tracks are assigned here, so that the playlists can
+    // refer to them without looking up every inserted track.
+    int lastTrackId = 0;
+    {
+        QSqlQuery maxIdQuery(database);
+        maxIdQuery.prepare("SELECT MAX(id) FROM " + kSeratoLibraryTable);
+        if (!maxIdQuery.exec()) {
+            LOG_FAILED_QUERY(maxIdQuery);
+            return false;
+        }
+        if (maxIdQuery.next()) {
+            lastTrackId = maxIdQuery.value(0).toInt();
+        }
     }
 
-    int playlistId = createPlaylist(database, crateFilePath, databasePath);
-    if (playlistId < 0) {
-        qWarning() << "Failed to create library playlist for "
-                   << crateFilePath;
-        return QString();
-    }
+    SqlBatchInserter libraryInserter(database, kSeratoLibraryTable, kLibraryColumns);
 
     int trackCount = 0;
-    QByteArray headerData = crateFile.read(kHeaderSize);
-    while (headerData.length() == kHeaderSize) {
-        quint32 fieldId = bytesToUInt32(headerData.mid(0, sizeof(quint32)));
-        quint32 fieldSize = bytesToUInt32(headerData.mid(sizeof(quint32), kHeaderSize));
-
-        // Read field data
-        QByteArray data = crateFile.read(fieldSize);
-        if (static_cast<quint32>(data.length()) != fieldSize) {
-            QString fieldName = QString(headerData.mid(0, sizeof(quint32)));
-            qWarning() << "Failed to read "
-                       << fieldSize
-                       << " bytes for "
-                       << fieldName
-                       << " field from "
-                       << crateFilePath
-                       << ".";
-            return QString();
-        }
-
+    SeratoFieldReader reader(pDatabaseData, databaseFile.size());
+    SeratoField field;
+    while (reader.readNext(&field)) {
         // Parse field data
-        switch (static_cast<FieldId>(fieldId)) {
-        case FieldId::Version: {
-            QString version = utf16beToQString(data, fieldSize);
+        switch (field.id) {
+        case SeratoFieldId::Version: {
             qDebug() << "Serato Database Version: "
-                     << version;
+                     << field.toString();
             break;
         }
-        case FieldId::Track: {
-            QBuffer buffer(&data);
-            buffer.open(QIODevice::ReadOnly);
-            QString location = parseCrateTrackPath(&buffer);
-            if (!location.isEmpty()) {
-                int trackId = trackIdMap.value(location, -1);
-                insertTrackIntoPlaylist(database, playlistId, trackId, trackCount);
+        case SeratoFieldId::Track: {
+            SeratoTrack track;
+            if (parseSeratoTrack(field, &track)) {
+                const int trackId = lastTrackId + 1;
+                // In the order of kLibraryColumns
+                if (!libraryInserter.append({
+                            trackId,
+                            track.title,
+                            track.artist,
+                            track.album,
+                            track.genre,
+                            track.comment,
+                            track.grouping,
+                            track.year,
+                            track.duration,
+                            track.bitrate,
+                            track.samplerate,
+                            track.bpm,
+                            track.key,
+                            databaseRootDir.absoluteFilePath(track.location),
+                            track.beatgridlocked,
+                            track.datetimeadded,
+                            track.label,
+                            databaseDir.path(),
+                    }) ||
+                        !pPlaylistTracksInserter->append(
+                                {playlistId, trackId, trackCount})) {
+                    libraryInserter.discard();
+                    return false;
+                }
+                lastTrackId = trackId;
+                pImportedDatabase->trackIds.insert(track.location, trackId);
                 trackCount++;
-                break;
             }
             break;
         }
         default: {
-            QString fieldName = QString(headerData.mid(0, sizeof(quint32)));
             qDebug() << "Ignoring unknown field "
-                     << fieldName
+                     << field.name()
                      << " ("
-                     << fieldSize
+                     << field.size
                      << " bytes) in database "
-                     << crateFilePath
+                     << databaseFilePath
                      << ".";
         }
         }
-
-        headerData = crateFile.read(kHeaderSize);
     }
 
-    if (headerData.length() != 0) {
+    if (reader.bytesLeft() != 0) {
         qWarning() << "Found "
-                   << headerData.length()
+                   << reader.bytesLeft()
                    << " extra bytes at end of Serato database file "
-                   << crateFilePath
+                   << databaseFilePath
                    << ".";
     }
 
-    return crateName;
+    return libraryInserter.flush();
 }
 
-QString parseDatabase(mixxx::DbConnectionPoolPtr dbConnectionPool, TreeItem* databaseItem) {
-    QString databaseName = databaseItem->getLabel();
-    QString databaseFilePath = databaseItem->getData().toList()[0].toString();
+/// Imports the tracks and crates of the database. When it has been
+/// imported before, only the files that have changed since are parsed
+/// again: A changed "database V2" file requires to import everything
+/// again, because the crates refer to its tracks. Otherwise only the
+/// changed, added and removed crates are updated.
+QString parseDatabase(mixxx::DbConnectionPoolPtr dbConnectionPool,
+        const QString& databaseFilePath,
+        std::shared_ptr<SeratoImportedDatabase> pImportedDatabase) {
     QDir databaseDir = QFileInfo(databaseFilePath).dir();
 
     QDir databaseRootDir = QDir(databaseDir);
@@ -459,7 +361,6 @@ QString parseDatabase(mixxx::DbConnectionPoolPtr dbConnectionPool, TreeItem* dat
 #endif
 
     qDebug() << "Parsing Serato database"
-             << databaseName
              << "at" << databaseFilePath;
 
     if (!QFile(databaseFilePath).exists()) {
@@ -484,182 +385,123 @@ QString parseDatabase(mixxx::DbConnectionPoolPtr dbConnectionPool, TreeItem* dat
     QThread* thisThread = QThread::currentThread();
     thisThread->setPriority(QThread::LowPriority);
 
-    ScopedTransaction transaction(database);
-
-    QSqlQuery query(database);
-    query.prepare(
-            "INSERT INTO " +
-            kSeratoLibraryTable + " (" +
-            LIBRARYTABLE_TITLE + ", " +
-            LIBRARYTABLE_ARTIST + ", " +
-            LIBRARYTABLE_ALBUM + ", " +
-            LIBRARYTABLE_GENRE + ", " +
-            LIBRARYTABLE_COMMENT + ", " +
-            LIBRARYTABLE_GROUPING + ", " +
-            LIBRARYTABLE_YEAR + ", " +
-            LIBRARYTABLE_DURATION + ", " +
-            LIBRARYTABLE_BITRATE + ", " +
-            LIBRARYTABLE_SAMPLERATE + ", " +
-            LIBRARYTABLE_BPM + ", " +
-            LIBRARYTABLE_KEY + ", " +
-            TRACKLOCATIONSTABLE_LOCATION + ", " +
-            LIBRARYTABLE_BPM_LOCK + ", " +
-            LIBRARYTABLE_DATETIMEADDED +
-            ", "
-            "label, "
-            "serato_db"
-            ") VALUES ("
-            ":title, "
-            ":artist, "
-            ":album, "
-            ":genre, "
-            ":comment, "
-            ":grouping, "
-            ":year, "
-            ":duration, "
-            ":bitrate, "
-            ":samplerate, "
-            ":bpm, "
-            ":key, "
-            ":location, "
-            ":bpm_lock, "
-            ":datetime_added, "
-            ":label, "
-            ":serato_db"
-            ")");
-
-    mixxx::FileInfo fileInfo(databaseFilePath);
-    QFile databaseFile(databaseFilePath);
-    if (!Sandbox::askForAccess(&fileInfo) || !databaseFile.open(QIODevice::ReadOnly)) {
-        qWarning() << "Failed to open file "
-                   << databaseFilePath
-                   << " for reading.";
+    // parseTracks() assigns the ids of the tracks from MAX(id). No other
+    // connection must insert tracks before the rows have been committed,
+    // so the write lock is acquired before reading MAX(id).
+    ScopedTransaction transaction(database, ScopedTransaction::Mode::Immediate);
+    if (!transaction.active()) {
         return QString();
     }
 
-    int playlistId = createPlaylist(database, databaseFilePath, databaseDir.path());
-    if (playlistId < 0) {
-        qWarning() << "Failed to create library playlist for "
-                   << databaseFilePath;
+    SqlBatchInserter playlistTracksInserter(database,
+            kSeratoPlaylistTracksTable,
+            {QStringLiteral("playlist_id"),
+                    QStringLiteral("track_id"),
+                    QStringLiteral("position")});
+    // Nothing is committed if a batch fails, the transaction is rolled
+    // back when returning. pImportedDatabase is left unchanged, so the
+    // import is repeated the next time.
+    const auto rollback = [&]() {
+        qWarning() << "Failed to import Serato database" << databaseFilePath;
+        playlistTracksInserter.discard();
         return QString();
-    }
-
-    int trackCount = 0;
-    QMap<QString, int> trackIdMap;
-    QByteArray headerData = databaseFile.read(kHeaderSize);
-    while (headerData.length() == kHeaderSize) {
-        quint32 fieldId = bytesToUInt32(headerData.mid(0, sizeof(quint32)));
-        quint32 fieldSize = bytesToUInt32(headerData.mid(sizeof(quint32), kHeaderSize));
-
-        // Read field data
-        QByteArray data = databaseFile.read(fieldSize);
-        if (static_cast<quint32>(data.length()) != fieldSize) {
-            QString fieldName = QString(headerData.mid(0, sizeof(quint32)));
-            qWarning() << "Failed to read "
-                       << fieldSize
-                       << " bytes for "
-                       << fieldName
-                       << " field from "
-                       << databaseFilePath
-                       << ".";
+    };
+
+    const auto databaseFingerprint =
+            SeratoFileFingerprint::fromFileInfo(QFileInfo(databaseFilePath));
+    // Only updated when the transaction has been committed
+    SeratoImportedDatabase importedDatabase = *pImportedDatabase;
+    if (databaseFingerprint == importedDatabase.fingerprint) {
+        qDebug() << "Serato database is unchanged:" << databaseFilePath;
+    } else {
+        if (!removeDatabase(database, databaseDir.path())) {
             return QString();
         }
+        importedDatabase = SeratoImportedDatabase();
 
-        // Parse field data
-        switch (static_cast<FieldId>(fieldId)) {
-        case FieldId::Version: {
-            QString version = utf16beToQString(data, fieldSize);
-            qDebug() << "Serato Database Version: "
-                     << version;
-            break;
-        }
-        case FieldId::Track: {
-            serato_track_t track;
-            QBuffer buffer(&data);
-            buffer.open(QIODevice::ReadOnly);
-            if (parseTrack(&track, &buffer)) {
-                QString location = databaseRootDir.absoluteFilePath(track.location);
-                query.bindValue(":title", track.title);
-                query.bindValue(":artist", track.artist);
-                query.bindValue(":album", track.album);
-                query.bindValue(":genre", track.genre);
-                query.bindValue(":comment", track.comment);
-                query.bindValue(":grouping", track.grouping);
-                query.bindValue(":year", track.year);
-                query.bindValue(":duration", track.duration);
-                query.bindValue(":bitrate", track.bitrate);
-                query.bindValue(":samplerate", track.samplerate);
-                query.bindValue(":bpm", track.bpm);
-                query.bindValue(":key", track.key);
-                query.bindValue(":location", location);
-                query.bindValue(":bpm_lock", track.beatgridlocked);
-                query.bindValue(":datetime_added", track.datetimeadded);
-                query.bindValue(":label", track.label);
-                query.bindValue(":serato_db", databaseDir.path());
-
-                if (!query.exec()) {
-                    LOG_FAILED_QUERY(query);
-                } else {
-                    int trackId = query.lastInsertId().toInt();
-                    insertTrackIntoPlaylist(database, playlistId, trackId, trackCount);
-                    trackIdMap.insert(track.location, trackId);
-                    trackCount++;
-                }
-                break;
-            }
-            break;
-        }
-        default: {
-            QString fieldName = QString(headerData.mid(0, sizeof(quint32)));
-            qDebug() << "Ignoring unknown field "
-                     << fieldName
-                     << " ("
-                     << fieldSize
-                     << " bytes) in database "
-                     << databaseFilePath
-                     << ".";
+        int playlistId = createPlaylist(database, databaseFilePath, databaseDir.path());
+        if (playlistId < 0) {
+            qWarning() << "Failed to create library playlist for "
+                       << databaseFilePath;
+            return QString();
         }
+        if (!parseTracks(database,
+                    &playlistTracksInserter,
+                    databaseFilePath,
+                    databaseDir,
+                    databaseRootDir,
+                    playlistId,
+                    &importedDatabase)) {
+            return rollback();
         }
-
-        headerData = databaseFile.read(kHeaderSize);
-    }
-
-    if (headerData.length() != 0) {
-        qWarning() << "Found "
-                   << headerData.length()
-                   << " extra bytes at end of Serato database file "
-                   << databaseFilePath
-                   << ".";
+        importedDatabase.fingerprint = databaseFingerprint;
     }
 
     // Parse Crates
+    QHash<QString, SeratoImportedDatabase::Crate> importedCrates;
+    for (const auto& crate : std::as_const(importedDatabase.crates)) {
+        importedCrates.insert(crate.filePath, crate);
+    }
+    QList<SeratoImportedDatabase::Crate> crates;
     QDir crateDir = QDir(databaseDir);
     if (crateDir.cd(kCrateDirectory)) {
-        QStringList filters;
-        filters << kCrateFilter;
-        foreach (const QString& entry, crateDir.entryList(filters)) {
-            QString crateFilePath = crateDir.filePath(entry);
-            QString crateName = parseCrate(
-                    database,
-                    databaseDir.path(),
-                    crateFilePath,
-                    trackIdMap);
-            if (!crateName.isEmpty()) {
-                QList<QVariant> data;
-                data << QVariant(crateFilePath)
-                     << QVariant(true);
-                TreeItem* crateItem = databaseItem->appendChild(crateName, data);
-                crateItem->setIcon(QIcon(":/images/library/ic_library_crates.svg"));
+        const QFileInfoList crateFileInfos =
+                crateDir.entryInfoList(QStringList{kCrateFilter});
+        for (const auto& crateFileInfo : crateFileInfos) {
+            SeratoImportedDatabase::Crate crate = importedCrates.take(crateFileInfo.filePath());
+            const auto crateFingerprint = SeratoFileFingerprint::fromFileInfo(crateFileInfo);
+            if (crate.playlistId >= 0 && crate.fingerprint == crateFingerprint) {
+                // Unchanged
+                crates << crate;
+                continue;
             }
+            if (crate.playlistId >= 0) {
+                // Changed, the playlist is reused
+                if (!removePlaylistTracks(database, crate.playlistId)) {
+                    continue;
+                }
+            } else {
+                crate.filePath = crateFileInfo.filePath();
+                crate.name = crateFileInfo.baseName();
+                crate.playlistId = createPlaylist(
+                        database, crate.filePath, databaseDir.path());
+                if (crate.playlistId < 0) {
+                    qWarning() << "Failed to create library playlist for "
+                               << crate.filePath;
+                    continue;
+                }
+            }
+            switch (parseCrate(&playlistTracksInserter,
+                    crate.filePath,
+                    crate.playlistId,
+                    importedDatabase.trackIds)) {
+            case ParseCrateResult::Parsed:
+                break;
+            case ParseCrateResult::Unreadable:
+                removePlaylist(database, crate.playlistId);
+                continue;
+            case ParseCrateResult::Failed:
+                return rollback();
+            }
+            crate.fingerprint = crateFingerprint;
+            crates << crate;
         }
     } else {
         qWarning() << "Failed to open crate directory: "
                    << databaseDir.filePath(kCrateDirectory);
     }
+    // Crates that have been deleted since the last import
+    for (const auto& crate : std::as_const(importedCrates)) {
+        removePlaylist(database, crate.playlistId);
+    }
+    importedDatabase.crates = crates;
 
     // TODO: Parse Smart Crates
 
-    transaction.commit();
+    if (!playlistTracksInserter.flush() || !transaction.commit()) {
+        return rollback();
+    }
+    *pImportedDatabase = std::move(importedDatabase);
 
     return databaseFilePath;
 }
@@ -1025,20 +867,34 @@ void SeratoFeature::activateChild(const QModelIndex& index) {
     //     1. Playlist Name/Path (QString)
     //     2. isPlaylist (boolean)
     //
-    // If the second element is false, then the database does still have to be
-    // parsed.
+    // If the second element is false, then the database has not been
+    // parsed yet. Databases are imported again whenever they are activated,
+    // which only parses the files that have changed since.
     QList<QVariant> data = item->getData().toList();
     VERIFY_OR_DEBUG_ASSERT(data.size() == 2) {
         return;
     }
     QString playlist = data[0].toString();
     bool isPlaylist = data[1].toBool();
+    bool isDatabase = item->parent() == m_pSidebarModel->getRootItem();
 
     qDebug() << "SeratoFeature::activateChild " << item->getLabel();
 
-    if (!isPlaylist) {
+    if (!isPlaylist || isDatabase) {
+        if (m_tracksFuture.isRunning()) {
+            qDebug() << "Serato database import is still running";
+            return;
+        }
+        auto& pImportedDatabase = m_importedDatabases[playlist];
+        if (!pImportedDatabase) {
+            pImportedDatabase = std::make_shared<SeratoImportedDatabase>();
+        }
+
         // Let a worker thread do the parsing
-        m_tracksFuture = QtConcurrent::run(parseDatabase, static_cast<Library*>(parent())->dbConnectionPool(), item);
+        m_tracksFuture = QtConcurrent::run(parseDatabase,
+                static_cast<Library*>(parent())->dbConnectionPool(),
+                playlist,
+                pImportedDatabase);
         m_tracksFutureWatcher.setFuture(m_tracksFuture);
 
         // This device is now a playlist element, future activations should
@@ -1065,6 +921,7 @@ void SeratoFeature::onSeratoDatabasesFound() {
         if (root->childRows() > 0) {
             // Devices have since been unmounted
             m_pSidebarModel->removeRows(0, root->childRows());
+            m_importedDatabases.clear();
         }
     } else {
         for (int databaseIndex = 0; databaseIndex < root->childRows(); databaseIndex++) {
@@ -1082,6 +939,7 @@ void SeratoFeature::onSeratoDatabasesFound() {
 
             if (removeChild) {
                 // Device has since been unmounted, cleanup DB
+                m_importedDatabases.remove(child->getData().toList().value(0).toString());
 
                 m_pSidebarModel->removeRows(databaseIndex, 1);
             }
@@ -1122,9 +980,51 @@ void SeratoFeature::onTracksFound() {
     m_pSidebarModel->triggerRepaint();
 
     QString databasePlaylist = m_tracksFuture.result();
+    updateCrateItems(databasePlaylist);
 
     qDebug() << "Show Serato Database Playlist: " << databasePlaylist;
     emit saveModelState();
     m_pSeratoPlaylistModel->setPlaylist(databasePlaylist);
     emit showTrackModel(m_pSeratoPlaylistModel);
 }
+
+void SeratoFeature::updateCrateItems(const QString& databaseFilePath) {
+    const auto pImportedDatabase = m_importedDatabases.value(databaseFilePath);
+    if (!pImportedDatabase) {
+        return;
+    }
+    QStringList crateFilePaths;
+    for (const auto& crate : std::as_const(pImportedDatabase->crates)) {
+        crateFilePaths << crate.filePath;
+    }
+
+    TreeItem* pRoot = m_pSidebarModel->getRootItem();
+    for (TreeItem* pDatabaseItem : pRoot->children()) {
+        if (pDatabaseItem->getData().toList().value(0).toString() != databaseFilePath) {
+            continue;
+        }
+        QStringList itemFilePaths;
+        for (const TreeItem* pCrateItem : pDatabaseItem->children()) {
+            itemFilePaths << pCrateItem->getData().toList().value(0).toString();
+        }
+        if (itemFilePaths == crateFilePaths) {
+            // Keep the expanded and selected items
+            return;
+        }
+
+        const QModelIndex databaseIndex =
+                m_pSidebarModel->index(pDatabaseItem->parentRow(), 0);
+        m_pSidebarModel->removeRows(0, pDatabaseItem->childRows(), databaseIndex);
+        QList<TreeItem*> crateItems;
+        for (const auto& crate : std::as_const(pImportedDatabase->crates)) {
+            QList<QVariant> data;
+            data << QVariant(crate.filePath)
+                 << QVariant(true);
+            auto* pCrateItem = new TreeItem(crate.name, data);
+            pCrateItem->setIcon(QIcon(":/images/library/ic_library_crates.svg"));
+            crateItems << pCrateItem;
+        }
+        m_pSidebarModel->insertTreeItemRows(crateItems, 0, databaseIndex);
+        return;
+    }
+}
@@ -11,11 +11,14 @@
 //      https://github.com/Holzhaus/serato-tags
 //      https://github.com/Holzhaus/serato-tags/blob/master/scripts/database_v2.py
 
+#include <QDateTime>
+#include <QFileInfo>
 #include <QFuture>
 #include <QFutureWatcher>
+#include <QHash>
 #include <QStringListModel>
 #include <QtConcurrentRun>
-#include <fstream>
+#include <memory>
 
 #include "library/baseexternallibraryfeature.h"
 #include "library/baseexternaltrackmodel.h"
@@ -23,6 +26,40 @@
 #include "library/treeitemmodel.h"
 #include "util/parented_ptr.h"
 
+/// Identifies the version of a file without reading it
+struct SeratoFileFingerprint {
+    qint64 size = -1;
+    qint64 lastModifiedMs = 0;
+
+    static SeratoFileFingerprint fromFileInfo(const QFileInfo& fileInfo) {
+        const QDateTime lastModified = fileInfo.lastModified();
+        return SeratoFileFingerprint{fileInfo.size(),
+                lastModified.isValid() ? lastModified.toMSecsSinceEpoch() : 0};
+    }
+
+    bool operator==(const SeratoFileFingerprint& other) const {
+        return size == other.size && lastModifiedMs == other.lastModifiedMs;
+    }
+};
+
+/// What has been imported from a Serato database, so that importing it
+/// again only needs to parse the files that have changed since.
+struct SeratoImportedDatabase {
+    struct Crate {
+        QString filePath;
+        QString name;
+        SeratoFileFingerprint fingerprint;
+        int playlistId = -1;
+    };
+
+    /// Of the "database V2" file
+    SeratoFileFingerprint fingerprint;
+    /// The ids of the imported tracks by their Serato location
+    QHash<QString, int> trackIds;
+    /// In the order of the sidebar
+    QList<Crate> crates;
+};
+
 class SeratoFeature : public BaseExternalLibraryFeature {
     Q_OBJECT
   public:
@@ -48,6 +85,7 @@ class SeratoFeature : public BaseExternalLibraryFeature {
 
   private:
     QString formatRootViewHtml() const;
+    void updateCrateItems(const QString& databaseFilePath);
     BaseSqlTableModel* getPlaylistModelForPlaylist(const QString& playlist) override;
 
     parented_ptr<TreeItemModel> m_pSidebarModel;
@@ -60,4 +98,8 @@ class SeratoFeature : public BaseExternalLibraryFeature {
     QString m_title;
 
     QSharedPointer<BaseTrackCache> m_trackSource;
+
+    // By the path of the "database V2" file. Only accessed by the import
+    // while it is running.
+    QHash<QString, std::shared_ptr<SeratoImportedDatabase>> m_importedDatabases;
 };
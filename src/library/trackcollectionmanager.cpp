@@ -41,6 +41,7 @@ TrackCollectionManager::TrackCollectionManager(
         deleteTrackFn_t /*only-needed-for-testing*/ deleteTrackForTestingFn)
     : QObject(parent),
       m_pConfig(pConfig),
+      m_pDbConnectionPool(pDbConnectionPool),
       m_pInternalCollection(createInternalTrackCollection(this, pConfig, deleteTrackForTestingFn)) {
     const QSqlDatabase dbConnection = mixxx::DbConnectionPooled(pDbConnectionPool);
 
@@ -53,6 +54,13 @@ TrackCollectionManager::TrackCollectionManager(
     }
 
     m_pInternalCollection->connectDatabase(dbConnection);
+    if (!deleteTrackForTestingFn) {
+        // Tests populate the indices synchronously on first use
+        m_pInternalCollection->getPlaylistDAO().populateMembershipIndexInBackground(
+                pDbConnectionPool);
+        m_pInternalCollection->getStemsMixDAO().populateMembershipIndexInBackground(
+                pDbConnectionPool);
+    }
 
     if (deleteTrackForTestingFn) {
         kLogger.info() << "External collections are disabled in test mode";
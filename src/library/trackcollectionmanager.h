@@ -42,6 +42,12 @@ class TrackCollectionManager: public QObject,
         return m_pInternalCollection;
     }
 
+    /// For reading from the database on worker threads with their
+    /// own thread-local connection.
+    const mixxx::DbConnectionPoolPtr& dbConnectionPool() const {
+        return m_pDbConnectionPool;
+    }
+
     const QList<ExternalTrackCollection*>& externalCollections() const {
         DEBUG_ASSERT_QOBJECT_THREAD_AFFINITY(this);
         return m_externalCollections;
@@ -121,6 +127,8 @@ class TrackCollectionManager: public QObject,
 
     const UserSettingsPointer m_pConfig;
 
+    const mixxx::DbConnectionPoolPtr m_pDbConnectionPool;
+
     const parented_ptr<TrackCollection> m_pInternalCollection;
 
     QList<ExternalTrackCollection*> m_externalCollections;
@@ -159,6 +159,23 @@ class TrackModel {
         Q_UNUSED(sourceIndex);
         Q_UNUSED(destIndex);
     }
+    /// Moves all tracks of sourceIndices at once in front of destIndex,
+    /// or to the end if destIndex is invalid. Returns false without moving
+    /// anything if the model does not support this for the given tracks,
+    /// in which case they have to be moved one by one with moveTrack().
+    virtual bool moveTracks(const QModelIndexList& sourceIndices,
+            const QModelIndex& destIndex) {
+        Q_UNUSED(sourceIndices);
+        Q_UNUSED(destIndex);
+        return false;
+    }
+    /// Called by views before the rows from firstRow to lastRow are
+    /// painted. Models that load their data on demand should load these
+    /// rows at once here instead of one by one from data().
+    virtual void prefetchRows(int firstRow, int lastRow) {
+        Q_UNUSED(firstRow);
+        Q_UNUSED(lastRow);
+    }
     virtual bool isLocked() {
         return false;
     }
@@ -1,5 +1,7 @@
 #include "library/trackset/tracksettablemodel.h"
 
+#include <algorithm>
+
 #include "mixer/playermanager.h"
 #include "moc_tracksettablemodel.cpp"
 
@@ -26,3 +28,40 @@ bool TrackSetTableModel::isColumnInternal(int column) {
             column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_COVERART_DIGEST) ||
             column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_COVERART_HASH);
 }
+
+std::optional<TrackSetTableModel::PositionRangeMove> TrackSetTableModel::positionRangeMove(
+        const QModelIndexList& sourceIndices,
+        const QModelIndex& destIndex,
+        int positionColumn) const {
+    if (sourceIndices.isEmpty()) {
+        return std::nullopt;
+    }
+    QList<int> rows;
+    rows.reserve(sourceIndices.size());
+    for (const QModelIndex& sourceIndex : sourceIndices) {
+        rows.append(sourceIndex.row());
+    }
+    std::sort(rows.begin(), rows.end());
+    const int firstPosition = index(rows.first(), positionColumn).data().toInt();
+    for (int i = 0; i < rows.size(); ++i) {
+        if (rows[i] != rows.first() + i ||
+                index(rows[i], positionColumn).data().toInt() != firstPosition + i) {
+            // Not contiguous or not sorted by position
+            return std::nullopt;
+        }
+    }
+    const int count = rows.size();
+
+    int newPosition = destIndex.sibling(destIndex.row(), positionColumn).data().toInt();
+    if (newPosition >= firstPosition && newPosition < firstPosition + count) {
+        // Dropped inside the moved range
+        newPosition = firstPosition;
+    } else if (newPosition <= 0) {
+        // Dragged out of bounds, which is past the end of the rows...
+        newPosition = 0;
+    } else if (newPosition > firstPosition) {
+        // new position moves up due to closing the gap of the moved range
+        newPosition -= count;
+    }
+    return PositionRangeMove{firstPosition, count, newPosition};
+}
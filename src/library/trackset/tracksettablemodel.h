@@ -1,5 +1,7 @@
 #pragma once
 
+#include <optional>
+
 #include "library/basesqltablemodel.h"
 
 class TrackSetTableModel : public BaseSqlTableModel {
@@ -11,4 +13,21 @@ class TrackSetTableModel : public BaseSqlTableModel {
             const char* settingsNamespace);
 
     bool isColumnInternal(int column) override;
+
+  protected:
+    /// A contiguous range of positions that is moved by drag and drop
+    struct PositionRangeMove {
+        int firstPosition;
+        int count;
+        /// The new position of the first track. 0 if the tracks have been
+        /// dropped past the end, firstPosition if they do not move.
+        int newPosition;
+    };
+
+    /// Returns the move of the tracks at sourceIndices when dropped on
+    /// destIndex, or std::nullopt if their positions are not contiguous.
+    std::optional<PositionRangeMove> positionRangeMove(
+            const QModelIndexList& sourceIndices,
+            const QModelIndex& destIndex,
+            int positionColumn) const;
 };
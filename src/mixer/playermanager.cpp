@@ -581,6 +581,13 @@ Deck* PlayerManager::getDeck(unsigned int deck) const {
     return m_decks[deck - 1];
 }
 
+QSharedPointer<AutoDJTransitionSchedule> PlayerManager::getAutoDJTransitionSchedule() const {
+    if (!m_pEngine) {
+        return nullptr;
+    }
+    return m_pEngine->getAutoDJTransitionSchedule();
+}
+
 PreviewDeck* PlayerManager::getPreviewDeck(unsigned int libPreviewPlayer) const {
     const auto locker = lockMutex(&m_mutex);
     if (libPreviewPlayer < 1 || libPreviewPlayer > numPreviewDecks()) {
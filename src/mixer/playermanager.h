@@ -5,6 +5,7 @@
 #include <QList>
 #include <QMap>
 #include <QObject>
+#include <QSharedPointer>
 
 #include "analyzer/trackanalysisscheduler.h"
 #include "engine/channelhandle.h"
@@ -17,6 +18,7 @@
 #include "util/performancetimer.h"
 
 class Auxiliary;
+class AutoDJTransitionSchedule;
 class BaseTrackPlayer;
 class ControlObject;
 class Deck;
@@ -53,6 +55,10 @@ class PlayerManagerInterface {
     virtual Sampler* getSampler(unsigned int sampler) const = 0;
 
     virtual unsigned int numberOfSamplers() const = 0;
+
+    // Get the schedule of the AutoDJ transitions that are executed by the
+    // engine. Returns nullptr if there is no engine.
+    virtual QSharedPointer<AutoDJTransitionSchedule> getAutoDJTransitionSchedule() const = 0;
 };
 
 class PlayerManager : public QObject, public PlayerManagerInterface {
@@ -119,6 +125,8 @@ class PlayerManager : public QObject, public PlayerManagerInterface {
         return numPreviewDecks();
     }
 
+    QSharedPointer<AutoDJTransitionSchedule> getAutoDJTransitionSchedule() const override;
+
     // Get the sampler by its number. Samplers are numbered starting with 1.
     Sampler* getSampler(unsigned int sampler) const override;
     // Return the number of samplers. Thread-safe.
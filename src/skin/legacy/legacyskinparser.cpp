@@ -1,10 +1,13 @@
 #include "skin/legacy/legacyskinparser.h"
 
+#include <QCryptographicHash>
+#include <QDateTime>
 #include <QDir>
 #include <QGridLayout>
 #include <QLabel>
 #include <QSplitter>
 #include <QStackedWidget>
+#include <QTextStream>
 #include <QVBoxLayout>
 #include <QtDebug>
 #include <QtGlobal>
@@ -100,6 +103,112 @@ QSet<QString> LegacySkinParser::s_sharedGroupStrings;
 
 static bool sDebug = false;
 
+namespace {
+
+// The Paintables loaded by a skin, see paintableCacheFilePath()
+const QString kPaintableCacheDirectory = QStringLiteral("skincache");
+// Each skin, scale factor, color scheme and change of skin.xml has its own
+// file. Only the most recently written ones are kept.
+constexpr int kMaxPaintableCacheFiles = 16;
+
+struct CachedDocument {
+    QDateTime lastModified;
+    qint64 size;
+    QDomElement documentElement;
+};
+
+/// The parsed XML documents of skins and templates, shared by all parsers.
+/// openSkin() is called several times per skin load and a skin switch loads
+/// the same templates again. The widgets are still created from scratch,
+/// because the expansion of the templates depends on the configuration.
+QHash<QString, CachedDocument> s_documentCache;
+
+QDomElement cachedDocument(const QFileInfo& fileInfo) {
+    const auto it = s_documentCache.constFind(fileInfo.absoluteFilePath());
+    if (it == s_documentCache.constEnd() ||
+            it->lastModified != fileInfo.lastModified() ||
+            it->size != fileInfo.size()) {
+        return QDomElement();
+    }
+    return it->documentElement;
+}
+
+void cacheDocument(const QFileInfo& fileInfo, const QDomElement& documentElement) {
+    s_documentCache.insert(fileInfo.absoluteFilePath(),
+            CachedDocument{fileInfo.lastModified(), fileInfo.size(), documentElement});
+}
+
+QList<PaintableFile> readPaintableCache(const QString& filePath) {
+    QList<PaintableFile> files;
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        // Not loaded before
+        return files;
+    }
+    QTextStream stream(&file);
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    DEBUG_ASSERT(stream.encoding() == QStringConverter::Utf8);
+#else
+    stream.setCodec("UTF-8");
+#endif
+    QString line;
+    while (stream.readLineInto(&line)) {
+        // <mode> <scale factor> <path>
+        const QStringList fields = line.split(QChar('\t'));
+        if (fields.size() != 3) {
+            continue;
+        }
+        bool modeOk = false;
+        bool scaleFactorOk = false;
+        const int mode = fields[0].toInt(&modeOk);
+        const double scaleFactor = fields[1].toDouble(&scaleFactorOk);
+        if (!modeOk || !scaleFactorOk || mode < Paintable::FIXED || mode > Paintable::TILE) {
+            continue;
+        }
+        files.append(PaintableFile{
+                fields[2], static_cast<Paintable::DrawMode>(mode), scaleFactor});
+    }
+    return files;
+}
+
+void prunePaintableCache(const QDir& directory) {
+    const QFileInfoList fileInfos = directory.entryInfoList(
+            {QStringLiteral("*.txt")}, QDir::Files, QDir::Time);
+    for (int i = kMaxPaintableCacheFiles; i < fileInfos.size(); ++i) {
+        if (!QFile::remove(fileInfos[i].absoluteFilePath())) {
+            qWarning() << "Failed to remove the stale skin cache"
+                       << fileInfos[i].absoluteFilePath();
+        }
+    }
+}
+
+void writePaintableCache(const QString& filePath, const QList<PaintableFile>& files) {
+    const QDir directory = QFileInfo(filePath).absoluteDir();
+    directory.mkpath(QStringLiteral("."));
+    {
+        QFile file(filePath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
+            qWarning() << "Failed to write the skin cache" << filePath;
+            return;
+        }
+        QTextStream stream(&file);
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+        DEBUG_ASSERT(stream.encoding() == QStringConverter::Utf8);
+#else
+        stream.setCodec("UTF-8");
+#endif
+        for (const auto& paintableFile : files) {
+            stream << static_cast<int>(paintableFile.mode) << '\t'
+                   << QString::number(paintableFile.scaleFactor) << '\t'
+                   << paintableFile.path << '\n';
+        }
+    }
+    // The file of the current skin has just been written and is the newest
+    prunePaintableCache(directory);
+}
+
+} // anonymous namespace
+
 ControlObject* LegacySkinParser::controlFromConfigKey(
         const ConfigKey& key, bool bPersist, bool* pCreated) {
     if (!key.isValid()) {
@@ -224,6 +333,11 @@ QDomElement LegacySkinParser::openSkin(const QString& skinPath) {
     }
 
     QString skinXmlPath = skinDir.filePath("skin.xml");
+    const QFileInfo skinXmlFileInfo(skinXmlPath);
+    QDomElement cachedSkin = cachedDocument(skinXmlFileInfo);
+    if (!cachedSkin.isNull()) {
+        return cachedSkin;
+    }
     QFile skinXmlFile(skinXmlPath);
 
     if (!skinXmlFile.open(QIODevice::ReadOnly)) {
@@ -246,6 +360,7 @@ QDomElement LegacySkinParser::openSkin(const QString& skinPath) {
     }
 
     skinXmlFile.close();
+    cacheDocument(skinXmlFileInfo, skin.documentElement());
     return skin.documentElement();
 }
 
@@ -398,6 +513,16 @@ QWidget* LegacySkinParser::parseSkin(const QString& skinPath, QWidget* pParent)
 
     ColorSchemeParser::setupLegacyColorSchemes(skinDocument, m_pConfig, &m_style, m_pContext.get());
 
+    // Load the images, that have been used by the last load of this skin,
+    // in parallel before the widgets are created. This needs to be done
+    // after the color scheme has been set up.
+    const QString paintableCacheFile = paintableCacheFilePath(skinPath);
+    {
+        ScopedTimer timer("LegacySkinParser::parseSkin prefetchPaintables");
+        WPixmapStore::prefetchPaintables(readPaintableCache(paintableCacheFile));
+    }
+    WPixmapStore::startRecordingPaintableFiles();
+
     // don't parent till here so the first opengl waveform doesn't screw
     // up --bkgood
     // I'm disregarding this return value because I want to return the
@@ -406,6 +531,10 @@ QWidget* LegacySkinParser::parseSkin(const QString& skinPath, QWidget* pParent)
     m_pParent = pParent;
     QList<QWidget*> widgets = parseNode(skinDocument);
 
+    writePaintableCache(paintableCacheFile, WPixmapStore::takeRecordedPaintableFiles());
+    // Images that are no longer used by the skin
+    WPixmapStore::clearPrefetchedPaintables();
+
     if (widgets.empty()) {
         SKIN_WARNING(skinDocument, *m_pContext) << "Skin produced no widgets!";
         return nullptr;
@@ -415,6 +544,21 @@ QWidget* LegacySkinParser::parseSkin(const QString& skinPath, QWidget* pParent)
     return widgets[0];
 }
 
+QString LegacySkinParser::paintableCacheFilePath(const QString& skinPath) const {
+    // The Paintables depend on the skin, the scale factor and the color
+    // scheme. A changed skin.xml invalidates the cache. Changes of templates
+    // only cause missed or unused prefetches.
+    const QFileInfo skinXmlFileInfo(QDir(skinPath).filePath("skin.xml"));
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(skinXmlFileInfo.absoluteFilePath().toUtf8());
+    hash.addData(skinXmlFileInfo.lastModified().toString(Qt::ISODateWithMs).toUtf8());
+    hash.addData(QString::number(m_pContext->getScaleFactor()).toUtf8());
+    hash.addData(m_pConfig->getValueString(ConfigKey("[Config]", "Scheme")).toUtf8());
+    return QDir(m_pConfig->getSettingsPath())
+            .filePath(kPaintableCacheDirectory + QChar('/') +
+                    QString::fromLatin1(hash.result().toHex()) + QStringLiteral(".txt"));
+}
+
 LaunchImage* LegacySkinParser::parseLaunchImage(const QString& skinPath, QWidget* pParent) {
     m_pContext = std::make_unique<SkinContext>(m_pConfig, skinPath + "/skin.xml");
     m_pContext->setSkinBasePath(skinPath);
@@ -1655,6 +1799,13 @@ QDomElement LegacySkinParser::loadTemplate(const QString& path) {
         return it.value();
     }
 
+    QDomElement cachedTemplate = cachedDocument(templateFileInfo);
+    if (!cachedTemplate.isNull()) {
+        m_templateCache[absolutePath] = cachedTemplate;
+        m_pContext->setSkinTemplatePath(templateFileInfo.absoluteDir().absolutePath());
+        return cachedTemplate;
+    }
+
     QFile templateFile(absolutePath);
 
     if (!templateFile.open(QIODevice::ReadOnly)) {
@@ -1675,6 +1826,7 @@ QDomElement LegacySkinParser::loadTemplate(const QString& path) {
     }
 
     m_templateCache[absolutePath] = tmpl.documentElement();
+    cacheDocument(templateFileInfo, tmpl.documentElement());
     m_pContext->setSkinTemplatePath(templateFileInfo.absoluteDir().absolutePath());
     return tmpl.documentElement();
 }
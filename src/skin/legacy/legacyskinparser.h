@@ -65,6 +65,10 @@ class LegacySkinParser : public QObject, public SkinParser {
     // Load the given template from file and return its document element.
     QDomElement loadTemplate(const QString& path);
 
+    /// The file that lists the Paintables loaded by the skin, to prefetch
+    /// them the next time.
+    QString paintableCacheFilePath(const QString& skinPath) const;
+
     // Parsers for each node
 
     // Most widgets can use parseStandardWidget.
@@ -14,6 +14,7 @@
 #include "skin/legacy/legacyskin.h"
 #include "skin/legacy/legacyskinparser.h"
 #include "util/debug.h"
+#include "util/performancetimer.h"
 #include "util/timer.h"
 #include "vinylcontrol/vinylcontrolmanager.h"
 
@@ -133,6 +134,8 @@ QWidget* SkinLoader::loadConfiguredSkin(QWidget* pParent,
         QSet<ControlObject*>* pSkinCreatedControls,
         mixxx::CoreServices* pCoreServices) {
     ScopedTimer timer("SkinLoader::loadConfiguredSkin");
+    PerformanceTimer loadTimer;
+    loadTimer.start();
     SkinPointer pSkin = getConfiguredSkin();
 
     // If we don't have a skin then fail. This makes sense here, because the
@@ -172,7 +175,10 @@ QWidget* SkinLoader::loadConfiguredSkin(QWidget* pParent,
 
     VERIFY_OR_DEBUG_ASSERT(pLoadedSkin != nullptr) {
         qCritical() << "No skin can be loaded, please check your installation.";
+        return nullptr;
     }
+    qInfo() << "Loaded skin" << pSkin->name() << "in"
+            << loadTimer.elapsed().debugMillisWithUnit();
     return pLoadedSkin;
 }
 
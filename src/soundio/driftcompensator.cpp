@@ -0,0 +1,189 @@
+#include "soundio/driftcompensator.h"
+
+#include <algorithm>
+#include <array>
+
+#include "util/assert.h"
+#include "util/math.h"
+#include "util/sample.h"
+
+namespace {
+
+// The filter length. 16 taps keep the aliasing and the pass band ripple
+// far below the audible range for ratios close to 1, as is the case for
+// clock drift.
+constexpr int kTaps = 16;
+constexpr int kHalfTaps = kTaps / 2;
+// The fractional positions are interpolated linearly between the phases
+constexpr int kPhases = 128;
+// Cut off below the Nyquist frequency, to leave room for the transition band
+constexpr double kCutoff = 0.9;
+
+// Crystals deviate by less than 100 ppm. The limits leave room for the
+// transient correction of the fill level.
+constexpr double kMaxDrift = 0.001;
+constexpr double kMaxRatioDeviation = 0.002;
+
+// The fill level jumps by a whole buffer, depending on which of the two
+// callbacks fires first. The low pass averages this out.
+constexpr double kFillLevelLowPassHz = 0.5;
+// Time constants of the proportional and the integral part of the loop.
+// kIntegralSeconds = 4 * kProportionalSeconds results in a critically
+// damped loop.
+constexpr double kProportionalSeconds = 2.0;
+constexpr double kIntegralSeconds = 8.0;
+
+constexpr SINT kMinFramesPerBuffer = 64;
+
+double sinc(double x) {
+    if (x == 0.0) {
+        return 1.0;
+    }
+    return std::sin(M_PI * x) / (M_PI * x);
+}
+
+// Blackman window for 0 <= x <= 1
+double blackman(double x) {
+    return 0.42 - 0.5 * std::cos(2 * M_PI * x) + 0.08 * std::cos(4 * M_PI * x);
+}
+
+} // anonymous namespace
+
+DriftCompensator::DriftCompensator(
+        int channelCount, SINT maxFramesPerBuffer, double sampleRate)
+        : m_channelCount(channelCount),
+          m_maxFramesPerBuffer(std::max(maxFramesPerBuffer, kMinFramesPerBuffer)),
+          m_sampleRate(sampleRate),
+          m_coefficients((kPhases + 1) * kTaps),
+          m_buffer((kTaps + 1 +
+                           static_cast<SINT>(std::ceil(
+                                   m_maxFramesPerBuffer * (1 + kMaxRatioDeviation)))) *
+                  channelCount),
+          m_bufferedFrames(kHalfTaps),
+          m_position(kHalfTaps - 1),
+          m_filteredError(0.0),
+          m_drift(0.0),
+          m_ratio(1.0) {
+    DEBUG_ASSERT(m_channelCount > 0);
+    DEBUG_ASSERT(m_sampleRate > 0);
+    for (int phase = 0; phase <= kPhases; ++phase) {
+        const double fraction = static_cast<double>(phase) / kPhases;
+        CSAMPLE* pRow = &m_coefficients[phase * kTaps];
+        double sum = 0.0;
+        for (int tap = 0; tap < kTaps; ++tap) {
+            // Distance of the tap to the interpolated position
+            const double t = tap - (kHalfTaps - 1) - fraction;
+            const double coefficient = kCutoff * sinc(kCutoff * t) *
+                    blackman((t + kHalfTaps) / kTaps);
+            pRow[tap] = static_cast<CSAMPLE>(coefficient);
+            sum += coefficient;
+        }
+        // Normalize to unity gain at DC
+        for (int tap = 0; tap < kTaps; ++tap) {
+            pRow[tap] = static_cast<CSAMPLE>(pRow[tap] / sum);
+        }
+    }
+    // The window starts with silence
+    SampleUtil::clear(m_buffer.data(), m_bufferedFrames * m_channelCount);
+}
+
+void DriftCompensator::updateFillLevel(
+        SINT fillFrames, SINT targetFrames, SINT framesPerBuffer) {
+    const double callbackSeconds = framesPerBuffer / m_sampleRate;
+    const double error = static_cast<double>(fillFrames - targetFrames);
+    m_filteredError += (1.0 - std::exp(-2 * M_PI * kFillLevelLowPassHz * callbackSeconds)) *
+            (error - m_filteredError);
+
+    // The error in frames is corrected within kProportionalSeconds, the
+    // remaining error accumulates the drift.
+    const double proportional = m_filteredError / (kProportionalSeconds * m_sampleRate);
+    m_drift = math_clamp(
+            m_drift + proportional * callbackSeconds / kIntegralSeconds,
+            -kMaxDrift,
+            kMaxDrift);
+    m_ratio = 1.0 +
+            math_clamp(m_drift + proportional,
+                    -kMaxRatioDeviation,
+                    kMaxRatioDeviation);
+}
+
+SINT DriftCompensator::process(
+        FIFO<CSAMPLE>* pFifo, CSAMPLE* pOutput, SINT framesPerBuffer) {
+    SINT missingFrames = 0;
+    while (framesPerBuffer > 0) {
+        const SINT frames = std::min(framesPerBuffer, m_maxFramesPerBuffer);
+        missingFrames += processChunk(pFifo, pOutput, frames);
+        pOutput += frames * m_channelCount;
+        framesPerBuffer -= frames;
+    }
+    return missingFrames;
+}
+
+SINT DriftCompensator::processChunk(
+        FIFO<CSAMPLE>* pFifo, CSAMPLE* pOutput, SINT frames) {
+    // Fill the window up to the last tap of the last output frame
+    const double lastPosition = m_position + (frames - 1) * m_ratio;
+    const SINT requiredFrames = static_cast<SINT>(lastPosition) + kHalfTaps + 1;
+    DEBUG_ASSERT(requiredFrames * m_channelCount <= static_cast<SINT>(m_buffer.size()));
+    SINT missingFrames = 0;
+    if (requiredFrames > m_bufferedFrames) {
+        const SINT framesToRead = requiredFrames - m_bufferedFrames;
+        const SINT framesRead = std::min(framesToRead,
+                static_cast<SINT>(pFifo->readAvailable() / m_channelCount));
+        CSAMPLE* pWrite = &m_buffer[m_bufferedFrames * m_channelCount];
+        pFifo->read(pWrite, static_cast<int>(framesRead * m_channelCount));
+        missingFrames = framesToRead - framesRead;
+        if (missingFrames > 0) {
+            SampleUtil::clear(&pWrite[framesRead * m_channelCount],
+                    missingFrames * m_channelCount);
+        }
+        m_bufferedFrames = requiredFrames;
+    }
+
+    std::array<CSAMPLE, kTaps> coefficients;
+    double position = m_position;
+    for (SINT frame = 0; frame < frames; ++frame) {
+        const auto index = static_cast<SINT>(position);
+        const double phase = (position - index) * kPhases;
+        const auto phaseIndex = static_cast<int>(phase);
+        const auto weight = static_cast<CSAMPLE>(phase - phaseIndex);
+        const CSAMPLE* pRow = &m_coefficients[phaseIndex * kTaps];
+        const CSAMPLE* pNextRow = pRow + kTaps;
+        // note: LOOP VECTORIZED.
+        for (int tap = 0; tap < kTaps; ++tap) {
+            coefficients[tap] = pRow[tap] + weight * (pNextRow[tap] - pRow[tap]);
+        }
+
+        const CSAMPLE* pWindow = &m_buffer[(index - (kHalfTaps - 1)) * m_channelCount];
+        CSAMPLE* pFrame = &pOutput[frame * m_channelCount];
+        if (m_channelCount == 2) {
+            CSAMPLE left = 0;
+            CSAMPLE right = 0;
+            for (int tap = 0; tap < kTaps; ++tap) {
+                left += coefficients[tap] * pWindow[tap * 2];
+                right += coefficients[tap] * pWindow[tap * 2 + 1];
+            }
+            pFrame[0] = left;
+            pFrame[1] = right;
+        } else {
+            for (int channel = 0; channel < m_channelCount; ++channel) {
+                CSAMPLE sample = 0;
+                for (int tap = 0; tap < kTaps; ++tap) {
+                    sample += coefficients[tap] * pWindow[tap * m_channelCount + channel];
+                }
+                pFrame[channel] = sample;
+            }
+        }
+        position += m_ratio;
+    }
+
+    // Drop the frames that are no longer part of the window
+    const SINT consumedFrames = static_cast<SINT>(position) - (kHalfTaps - 1);
+    DEBUG_ASSERT(consumedFrames >= 0 && consumedFrames <= m_bufferedFrames);
+    std::copy(m_buffer.begin() + consumedFrames * m_channelCount,
+            m_buffer.begin() + m_bufferedFrames * m_channelCount,
+            m_buffer.begin());
+    m_bufferedFrames -= consumedFrames;
+    m_position = position - consumedFrames;
+    return missingFrames;
+}
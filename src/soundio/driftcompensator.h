@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+
+#include "util/fifo.h"
+#include "util/types.h"
+
+/// DriftCompensator keeps the FIFO between the clock reference device and a
+/// secondary output device at its target fill level, by resampling the audio
+/// with a ratio that follows the clock drift between the two devices.
+///
+/// A second order control loop (a DLL) estimates the ratio from the fill
+/// level of the FIFO, measured at the beginning of every callback. A polyphase
+/// FIR resampler applies it. The cost of the resampler is fixed per output
+/// frame and it does not allocate after construction, so both can run in the
+/// audio callback.
+class DriftCompensator {
+  public:
+    DriftCompensator(int channelCount, SINT maxFramesPerBuffer, double sampleRate);
+
+    /// Adjusts the ratio to the fill level of the FIFO in frames, measured
+    /// before reading the frames of the current callback.
+    void updateFillLevel(SINT fillFrames, SINT targetFrames, SINT framesPerBuffer);
+
+    /// Resamples the frames read from pFifo into framesPerBuffer frames at
+    /// pOutput. Returns the number of frames that were missing in pFifo and
+    /// have been replaced by silence.
+    SINT process(FIFO<CSAMPLE>* pFifo, CSAMPLE* pOutput, SINT framesPerBuffer);
+
+    /// The number of input frames consumed per output frame
+    double ratio() const {
+        return m_ratio;
+    }
+
+    /// The estimated drift of the secondary device clock relative to the
+    /// clock reference device in ppm, without the transient correction of
+    /// the fill level.
+    double driftPpm() const {
+        return m_drift * 1000000.0;
+    }
+
+  private:
+    SINT processChunk(FIFO<CSAMPLE>* pFifo, CSAMPLE* pOutput, SINT frames);
+
+    const int m_channelCount;
+    const SINT m_maxFramesPerBuffer;
+    const double m_sampleRate;
+
+    // (kPhases + 1) rows of kTaps coefficients, the additional row allows
+    // interpolating between the phases without a wrap around
+    std::vector<CSAMPLE> m_coefficients;
+
+    // The input frames of the filter window, the oldest first
+    std::vector<CSAMPLE> m_buffer;
+    SINT m_bufferedFrames;
+    // Position of the next output frame in m_buffer
+    double m_position;
+
+    double m_filteredError;
+    double m_drift;
+    double m_ratio;
+};
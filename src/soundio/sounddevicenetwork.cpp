@@ -138,22 +138,17 @@ void SoundDeviceNetwork::readProcess() {
     int writeAvailable = m_inputFifo->writeAvailable();
     int copyCount = qMin(writeAvailable, readAvailable);
     if (copyCount > 0) {
-        CSAMPLE* dataPtr1;
-        ring_buffer_size_t size1;
-        CSAMPLE* dataPtr2;
-        ring_buffer_size_t size2;
-        (void)m_inputFifo->aquireWriteRegions(copyCount,
-                &dataPtr1, &size1, &dataPtr2, &size2);
+        const auto regions = m_inputFifo->reserveWrite(copyCount);
         // Fetch fresh samples and write to the the input buffer
-        m_pNetworkStream->read(dataPtr1,
-                size1 / m_iNumInputChannels);
-        CSAMPLE* lastFrame = &dataPtr1[size1 - m_iNumInputChannels];
-        if (size2 > 0) {
-            m_pNetworkStream->read(dataPtr2,
-                    size2 / m_iNumInputChannels);
-            lastFrame = &dataPtr2[size2 - m_iNumInputChannels];
+        m_pNetworkStream->read(regions.first.data(),
+                regions.first.size() / m_iNumInputChannels);
+        CSAMPLE* lastFrame = &regions.first[regions.first.size() - m_iNumInputChannels];
+        if (!regions.second.empty()) {
+            m_pNetworkStream->read(regions.second.data(),
+                    regions.second.size() / m_iNumInputChannels);
+            lastFrame = &regions.second[regions.second.size() - m_iNumInputChannels];
         }
-        m_inputFifo->releaseWriteRegions(copyCount);
+        m_inputFifo->commitWrite(regions.size());
 
         if (readAvailable > writeAvailable + inChunkSize / 2) {
             // we are not able to consume all frames
@@ -161,7 +156,7 @@ void SoundDeviceNetwork::readProcess() {
                 // Skip one frame
                 //kLogger.debug() << "readProcess() skip one frame"
                 //                << (float)writeAvailable / inChunkSize << (float)readAvailable / inChunkSize;
-                m_pNetworkStream->read(dataPtr1, 1);
+                m_pNetworkStream->read(regions.first.data(), 1);
             } else {
                 m_inputDrift = true;
             }
@@ -171,12 +166,12 @@ void SoundDeviceNetwork::readProcess() {
                 // duplicate one frame
                 //kLogger.debug() << "readProcess() duplicate one frame"
                 //                << (float)writeAvailable / inChunkSize << (float)readAvailable / inChunkSize;
-                (void) m_inputFifo->aquireWriteRegions(
-                        m_iNumInputChannels, &dataPtr1, &size1,
-                        &dataPtr2, &size2);
-                if (size1) {
-                    SampleUtil::copy(dataPtr1, lastFrame, size1);
-                    m_inputFifo->releaseWriteRegions(size1);
+                const auto frameRegions = m_inputFifo->reserveWrite(m_iNumInputChannels);
+                if (!frameRegions.first.empty()) {
+                    SampleUtil::copy(frameRegions.first.data(),
+                            lastFrame,
+                            frameRegions.first.size());
+                    m_inputFifo->commitWrite(static_cast<int>(frameRegions.first.size()));
                 }
             } else {
                 m_inputDrift = true;
@@ -194,24 +189,18 @@ void SoundDeviceNetwork::readProcess() {
         //qDebug() << "readProcess()" << (float)readAvailable / inChunkSize << "underflow";
     }
     if (readCount) {
-        CSAMPLE* dataPtr1;
-        ring_buffer_size_t size1;
-        CSAMPLE* dataPtr2;
-        ring_buffer_size_t size2;
-        // We use size1 and size2, so we can ignore the return value
-        (void) m_inputFifo->aquireReadRegions(readCount, &dataPtr1, &size1,
-                &dataPtr2, &size2);
+        const auto regions = m_inputFifo->reserveRead(readCount);
         // Fetch fresh samples and write to the the output buffer
-        composeInputBuffer(dataPtr1,
-                size1 / m_iNumInputChannels, 0,
+        composeInputBuffer(regions.first.data(),
+                regions.first.size() / m_iNumInputChannels, 0,
                 m_iNumInputChannels);
-        if (size2 > 0) {
-            composeInputBuffer(dataPtr2,
-                    size2 / m_iNumInputChannels,
-                    size1 / m_iNumInputChannels,
+        if (!regions.second.empty()) {
+            composeInputBuffer(regions.second.data(),
+                    regions.second.size() / m_iNumInputChannels,
+                    regions.first.size() / m_iNumInputChannels,
                     m_iNumInputChannels);
         }
-        m_inputFifo->releaseReadRegions(readCount);
+        m_inputFifo->commitRead(regions.size());
     }
     if (readCount < inChunkSize) {
         // Fill remaining buffers with zeros
@@ -236,35 +225,27 @@ void SoundDeviceNetwork::writeProcess() {
     }
     //qDebug() << "writeProcess():" << (float) writeAvailable / outChunkSize;
     if (writeCount > 0) {
-        CSAMPLE* dataPtr1;
-        ring_buffer_size_t size1;
-        CSAMPLE* dataPtr2;
-        ring_buffer_size_t size2;
-        // We use size1 and size2, so we can ignore the return value
-        (void)m_outputFifo->aquireWriteRegions(writeCount, &dataPtr1,
-                &size1, &dataPtr2, &size2);
+        const auto regions = m_outputFifo->reserveWrite(writeCount);
         // Fetch fresh samples and write to the the output buffer
-        composeOutputBuffer(dataPtr1, size1 / m_iNumOutputChannels, 0, m_iNumOutputChannels);
-        if (size2 > 0) {
-            composeOutputBuffer(dataPtr2,
-                    size2 / m_iNumOutputChannels,
-                    size1 / m_iNumOutputChannels,
+        composeOutputBuffer(regions.first.data(),
+                regions.first.size() / m_iNumOutputChannels,
+                0,
+                m_iNumOutputChannels);
+        if (!regions.second.empty()) {
+            composeOutputBuffer(regions.second.data(),
+                    regions.second.size() / m_iNumOutputChannels,
+                    regions.first.size() / m_iNumOutputChannels,
                     m_iNumOutputChannels);
         }
-        m_outputFifo->releaseWriteRegions(writeCount);
+        m_outputFifo->commitWrite(regions.size());
     }
 
     int readAvailable = m_outputFifo->readAvailable();
 
-    CSAMPLE* dataPtr1;
-    ring_buffer_size_t size1;
-    CSAMPLE* dataPtr2;
-    ring_buffer_size_t size2;
     // Try to read as most frames as possible.
     // NetworkStreamWorker::processWrite takes care of
     // keeping every output worker in sync
-    m_outputFifo->aquireReadRegions(readAvailable,
-            &dataPtr1, &size1, &dataPtr2, &size2);
+    const auto regions = m_outputFifo->reserveRead(readAvailable);
 
     QVector<NetworkOutputStreamWorkerPtr> workers =
             m_pNetworkStream->outputWorkers();
@@ -274,18 +255,18 @@ void SoundDeviceNetwork::writeProcess() {
         }
 
         workerWriteProcess(pWorker,
-                outChunkSize, readAvailable,
-                dataPtr1, size1,
-                dataPtr2, size2);
+                outChunkSize,
+                readAvailable,
+                regions);
     }
 
-    m_outputFifo->releaseReadRegions(readAvailable);
+    m_outputFifo->commitRead(readAvailable);
 }
 
 void SoundDeviceNetwork::workerWriteProcess(NetworkOutputStreamWorkerPtr pWorker,
-        int outChunkSize, int readAvailable,
-        CSAMPLE* dataPtr1, ring_buffer_size_t size1,
-        CSAMPLE* dataPtr2, ring_buffer_size_t size2) {
+        int outChunkSize,
+        int readAvailable,
+        const FIFO<CSAMPLE>::ReadRegions& regions) {
     int writeExpected = static_cast<int>(pWorker->getStreamTimeFrames() - pWorker->framesWritten());
 
     int writeAvailable = writeExpected * m_iNumOutputChannels;
@@ -304,7 +285,7 @@ void SoundDeviceNetwork::workerWriteProcess(NetworkOutputStreamWorkerPtr pWorker
                 // duplicate one frame
                 //kLogger.debug() << "workerWriteProcess() duplicate one frame"
                 //                << (float)writeAvailable / outChunkSize << (float)readAvailable / outChunkSize;
-                workerWrite(pWorker, dataPtr1, 1);
+                workerWrite(pWorker, regions.first.data(), 1);
             } else {
                 pWorker->setOutputDrift(true);
             }
@@ -324,9 +305,13 @@ void SoundDeviceNetwork::workerWriteProcess(NetworkOutputStreamWorkerPtr pWorker
             pWorker->setOutputDrift(false);
         }
 
-        workerWrite(pWorker, dataPtr1, size1 / m_iNumOutputChannels);
-        if (size2 > 0) {
-            workerWrite(pWorker, dataPtr2, size2 / m_iNumOutputChannels);
+        workerWrite(pWorker,
+                regions.first.data(),
+                static_cast<int>(regions.first.size()) / m_iNumOutputChannels);
+        if (!regions.second.empty()) {
+            workerWrite(pWorker,
+                    regions.second.data(),
+                    static_cast<int>(regions.second.size()) / m_iNumOutputChannels);
         }
 
         QSharedPointer<FIFO<CSAMPLE>> pFifo = pWorker->getOutputFifo();
@@ -387,18 +372,12 @@ void SoundDeviceNetwork::workerWriteSilence(NetworkOutputStreamWorkerPtr pWorker
 
         int clearCount = math_min(writeAvailable, writeRequired);
         if (clearCount > 0) {
-            CSAMPLE* dataPtr1;
-            ring_buffer_size_t size1;
-            CSAMPLE* dataPtr2;
-            ring_buffer_size_t size2;
-
-            (void)pFifo->aquireWriteRegions(clearCount,
-                    &dataPtr1, &size1, &dataPtr2, &size2);
-            SampleUtil::clear(dataPtr1, size1);
-            if (size2 > 0) {
-                SampleUtil::clear(dataPtr2, size2);
+            const auto regions = pFifo->reserveWrite(clearCount);
+            SampleUtil::clear(regions.first.data(), regions.first.size());
+            if (!regions.second.empty()) {
+                SampleUtil::clear(regions.second.data(), regions.second.size());
             }
-            pFifo->releaseWriteRegions(clearCount);
+            pFifo->commitWrite(regions.size());
 
             // we advance the frame only by the samples we have actually cleared
             pWorker->addFramesWritten(clearCount / m_iNumOutputChannels);
@@ -48,9 +48,9 @@ class SoundDeviceNetwork : public SoundDevice {
     void updateAudioLatencyUsage();
 
     void workerWriteProcess(NetworkOutputStreamWorkerPtr pWorker,
-            int outChunkSize, int readAvailable,
-            CSAMPLE* dataPtr1, ring_buffer_size_t size1,
-            CSAMPLE* dataPtr2, ring_buffer_size_t size2);
+            int outChunkSize,
+            int readAvailable,
+            const FIFO<CSAMPLE>::ReadRegions& regions);
     void workerWrite(NetworkOutputStreamWorkerPtr pWorker,
             const CSAMPLE* buffer, int frames);
     void workerWriteSilence(NetworkOutputStreamWorkerPtr pWorker, int frames);
@@ -8,6 +8,7 @@
 
 #include "control/controlobject.h"
 #include "control/controlproxy.h"
+#include "soundio/driftcompensator.h"
 #include "soundio/sounddevice.h"
 #include "soundio/soundmanager.h"
 #include "soundio/soundmanagerutil.h"
@@ -89,6 +90,7 @@ SoundDevicePortAudio::SoundDevicePortAudio(UserSettingsPointer config,
           m_bSetThreadPriority(false),
           m_masterAudioLatencyUsage("[Master]", "audio_latency_usage"),
           m_framesSinceAudioLatencyUsageUpdate(0),
+          m_framesSinceDriftControlsUpdate(0),
           m_syncBuffers(2),
           m_invalidTimeInfoCount(0),
           m_lastCallbackEntrytoDacSecs(0) {
@@ -262,15 +264,29 @@ SoundDeviceStatus SoundDevicePortAudio::open(bool isClkRefDevice, int syncBuffer
             // callback fires first.
             int writeCount = m_outputParams.channelCount * m_framesPerBuffer *
                     kFifoSize / 2;
-            CSAMPLE* dataPtr1;
-            ring_buffer_size_t size1;
-            CSAMPLE* dataPtr2;
-            ring_buffer_size_t size2;
-            (void)m_outputFifo->aquireWriteRegions(writeCount, &dataPtr1,
-                    &size1, &dataPtr2, &size2);
-            SampleUtil::clear(dataPtr1, size1);
-            SampleUtil::clear(dataPtr2, size2);
-            m_outputFifo->releaseWriteRegions(writeCount);
+            const auto regions = m_outputFifo->reserveWrite(writeCount);
+            SampleUtil::clear(regions.first.data(), regions.first.size());
+            SampleUtil::clear(regions.second.data(), regions.second.size());
+            m_outputFifo->commitWrite(regions.size());
+            m_pOutputDriftCompensator = std::make_unique<DriftCompensator>(
+                    m_outputParams.channelCount, m_framesPerBuffer, m_dSampleRate);
+            if (!m_pDriftPpm) {
+                // Allows to monitor the drift of this device, e.g. in the
+                // developer tools
+                const QString group = QStringLiteral("[SoundDevice%1]")
+                                              .arg(m_deviceId.portAudioIndex);
+                m_pDriftPpm = std::make_unique<ControlObject>(
+                        ConfigKey(group, QStringLiteral("drift_ppm")));
+                m_pDriftPpm->setReadOnly();
+                m_pDriftRatio = std::make_unique<ControlObject>(
+                        ConfigKey(group, QStringLiteral("drift_ratio")),
+                        true,
+                        false,
+                        false,
+                        1.0);
+                m_pDriftRatio->setReadOnly();
+            }
+            m_framesSinceDriftControlsUpdate = 0;
         }
         if (m_inputParams.channelCount) {
             m_inputFifo = new FIFO<CSAMPLE>(
@@ -278,15 +294,10 @@ SoundDeviceStatus SoundDevicePortAudio::open(bool isClkRefDevice, int syncBuffer
             // Clear first 1.5 chunks (see above)
             int writeCount = m_inputParams.channelCount * m_framesPerBuffer *
                     kFifoSize / 2;
-            CSAMPLE* dataPtr1;
-            ring_buffer_size_t size1;
-            CSAMPLE* dataPtr2;
-            ring_buffer_size_t size2;
-            (void)m_inputFifo->aquireWriteRegions(writeCount, &dataPtr1,
-                    &size1, &dataPtr2, &size2);
-            SampleUtil::clear(dataPtr1, size1);
-            SampleUtil::clear(dataPtr2, size2);
-            m_inputFifo->releaseWriteRegions(writeCount);
+            const auto regions = m_inputFifo->reserveWrite(writeCount);
+            SampleUtil::clear(regions.first.data(), regions.first.size());
+            SampleUtil::clear(regions.second.data(), regions.second.size());
+            m_inputFifo->commitWrite(regions.size());
         }
     } else if (m_syncBuffers == 1) { // "Disabled (short delay)"
         // this can be used on a second device when it is driven by the Clock
@@ -429,6 +440,7 @@ SoundDeviceStatus SoundDevicePortAudio::close() {
 
     m_outputFifo = nullptr;
     m_inputFifo = nullptr;
+    m_pOutputDriftCompensator.reset();
     m_bSetThreadPriority = false;
 
     return SoundDeviceStatus::Ok;
@@ -447,18 +459,12 @@ void SoundDevicePortAudio::readProcess() {
             if (m_inputFifo->readAvailable() == 0) {
                 // Initial call or underflow at last call
                 // Init half of the buffer with silence
-                CSAMPLE* dataPtr1;
-                ring_buffer_size_t size1;
-                CSAMPLE* dataPtr2;
-                ring_buffer_size_t size2;
-                (void)m_inputFifo->aquireWriteRegions(inChunkSize,
-                        &dataPtr1, &size1, &dataPtr2, &size2);
-                // Fetch fresh samples and write to the the input buffer
-                SampleUtil::clear(dataPtr1, size1);
-                if (size2 > 0) {
-                    SampleUtil::clear(dataPtr2, size2);
+                const auto regions = m_inputFifo->reserveWrite(inChunkSize);
+                SampleUtil::clear(regions.first.data(), regions.first.size());
+                if (!regions.second.empty()) {
+                    SampleUtil::clear(regions.second.data(), regions.second.size());
                 }
-                m_inputFifo->releaseWriteRegions(inChunkSize);
+                m_inputFifo->commitWrite(regions.size());
             }
 
             // Polling mode
@@ -467,30 +473,27 @@ void SoundDevicePortAudio::readProcess() {
             int copyCount = qMin(writeAvailable, readAvailable);
             //qDebug() << "readProcess()" << (float)writeAvailable / inChunkSize << (float)readAvailable / inChunkSize;
             if (copyCount > 0) {
-                CSAMPLE* dataPtr1;
-                ring_buffer_size_t size1;
-                CSAMPLE* dataPtr2;
-                ring_buffer_size_t size2;
-                (void)m_inputFifo->aquireWriteRegions(copyCount,
-                        &dataPtr1, &size1, &dataPtr2, &size2);
+                const auto regions = m_inputFifo->reserveWrite(copyCount);
                 // Fetch fresh samples and write to the the input buffer
-                PaError err = Pa_ReadStream(pStream, dataPtr1,
-                        size1 / m_inputParams.channelCount);
-                CSAMPLE* lastFrame = &dataPtr1[size1 - m_inputParams.channelCount];
+                PaError err = Pa_ReadStream(pStream, regions.first.data(),
+                        regions.first.size() / m_inputParams.channelCount);
+                CSAMPLE* lastFrame = &regions.first[
+                        regions.first.size() - m_inputParams.channelCount];
                 if (err == paInputOverflowed) {
                     //qDebug() << "SoundDevicePortAudio::readProcess() Pa_ReadStream paInputOverflowed" << m_deviceId;
                     m_pSoundManager->underflowHappened(12);
                 }
-                if (size2 > 0) {
-                    PaError err = Pa_ReadStream(pStream, dataPtr2,
-                            size2 / m_inputParams.channelCount);
-                    lastFrame = &dataPtr2[size2 - m_inputParams.channelCount];
+                if (!regions.second.empty()) {
+                    PaError err = Pa_ReadStream(pStream, regions.second.data(),
+                            regions.second.size() / m_inputParams.channelCount);
+                    lastFrame = &regions.second[
+                            regions.second.size() - m_inputParams.channelCount];
                     if (err == paInputOverflowed) {
                         //qDebug() << "SoundDevicePortAudio::readProcess() Pa_ReadStream paInputOverflowed" << m_deviceId;
                         m_pSoundManager->underflowHappened(13);
                     }
                 }
-                m_inputFifo->releaseWriteRegions(copyCount);
+                m_inputFifo->commitWrite(regions.size());
 
                 if (readAvailable > writeAvailable + inChunkSize / 2) {
                     // we are not able to consume enough frames
@@ -498,7 +501,7 @@ void SoundDevicePortAudio::readProcess() {
                         // Skip one frame
                         //qDebug() << "SoundDevicePortAudio::readProcess() skip one frame"
                         //        << (float)writeAvailable / inChunkSize << (float)readAvailable / inChunkSize;
-                        PaError err = Pa_ReadStream(pStream, dataPtr1, 1);
+                        PaError err = Pa_ReadStream(pStream, regions.first.data(), 1);
                         if (err == paInputOverflowed) {
                             //qDebug()
                             //        << "SoundDevicePortAudio::readProcess() Pa_ReadStream paInputOverflowed"
@@ -516,12 +519,14 @@ void SoundDevicePortAudio::readProcess() {
                         // duplicate one frame
                         //qDebug() << "SoundDevicePortAudio::readProcess() duplicate one frame"
                         //        << (float)writeAvailable / inChunkSize << (float)readAvailable / inChunkSize;
-                        (void) m_inputFifo->aquireWriteRegions(
-                                m_inputParams.channelCount, &dataPtr1, &size1,
-                                &dataPtr2, &size2);
-                        if (size1) {
-                            SampleUtil::copy(dataPtr1, lastFrame, size1);
-                            m_inputFifo->releaseWriteRegions(size1);
+                        const auto frameRegions =
+                                m_inputFifo->reserveWrite(m_inputParams.channelCount);
+                        if (!frameRegions.first.empty()) {
+                            SampleUtil::copy(frameRegions.first.data(),
+                                    lastFrame,
+                                    frameRegions.first.size());
+                            m_inputFifo->commitWrite(
+                                    static_cast<int>(frameRegions.first.size()));
                         }
                     } else {
                         m_inputDrift = true;
@@ -541,24 +546,18 @@ void SoundDevicePortAudio::readProcess() {
         }
         //qDebug() << "readProcess()" << (float)readAvailable / inChunkSize;
         if (readCount) {
-            CSAMPLE* dataPtr1;
-            ring_buffer_size_t size1;
-            CSAMPLE* dataPtr2;
-            ring_buffer_size_t size2;
-            // We use size1 and size2, so we can ignore the return value
-            (void) m_inputFifo->aquireReadRegions(readCount, &dataPtr1, &size1,
-                    &dataPtr2, &size2);
+            const auto regions = m_inputFifo->reserveRead(readCount);
             // Fetch fresh samples and write to the the output buffer
-            composeInputBuffer(dataPtr1,
-                    size1 / m_inputParams.channelCount, 0,
+            composeInputBuffer(regions.first.data(),
+                    regions.first.size() / m_inputParams.channelCount, 0,
                     m_inputParams.channelCount);
-            if (size2 > 0) {
-                composeInputBuffer(dataPtr2,
-                        size2 / m_inputParams.channelCount,
-                        size1 / m_inputParams.channelCount,
+            if (!regions.second.empty()) {
+                composeInputBuffer(regions.second.data(),
+                        regions.second.size() / m_inputParams.channelCount,
+                        regions.first.size() / m_inputParams.channelCount,
                         m_inputParams.channelCount);
             }
-            m_inputFifo->releaseReadRegions(readCount);
+            m_inputFifo->commitRead(regions.size());
         }
         if (readCount < inChunkSize) {
             // Fill remaining buffers with zeros
@@ -582,23 +581,19 @@ void SoundDevicePortAudio::writeProcess() {
             //qDebug() << "writeProcess():" << (float) writeAvailable / outChunkSize << "Overflow";
         }
         if (writeCount > 0) {
-            CSAMPLE* dataPtr1;
-            ring_buffer_size_t size1;
-            CSAMPLE* dataPtr2;
-            ring_buffer_size_t size2;
-            // We use size1 and size2, so we can ignore the return value
-            (void) m_outputFifo->aquireWriteRegions(writeCount, &dataPtr1,
-                    &size1, &dataPtr2, &size2);
+            const auto regions = m_outputFifo->reserveWrite(writeCount);
             // Fetch fresh samples and write to the the output buffer
-            composeOutputBuffer(dataPtr1, size1 / m_outputParams.channelCount, 0,
-            		            m_outputParams.channelCount);
-            if (size2 > 0) {
-                composeOutputBuffer(dataPtr2,
-                        size2 / m_outputParams.channelCount,
-                        size1 / m_outputParams.channelCount,
+            composeOutputBuffer(regions.first.data(),
+                    regions.first.size() / m_outputParams.channelCount,
+                    0,
+                    m_outputParams.channelCount);
+            if (!regions.second.empty()) {
+                composeOutputBuffer(regions.second.data(),
+                        regions.second.size() / m_outputParams.channelCount,
+                        regions.first.size() / m_outputParams.channelCount,
                         m_outputParams.channelCount);
             }
-            m_outputFifo->releaseWriteRegions(writeCount);
+            m_outputFifo->commitWrite(regions.size());
         }
 
         if (m_syncBuffers == 0) { // "Experimental (no delay)"
@@ -609,12 +604,8 @@ void SoundDevicePortAudio::writeProcess() {
             int copyCount = qMin(readAvailable, writeAvailable);
             //qDebug() << "SoundDevicePortAudio::writeProcess()" << (float)readAvailable / outChunkSize << (float)writeAvailable / outChunkSize;
             if (copyCount > 0) {
-                CSAMPLE* dataPtr1;
-                ring_buffer_size_t size1;
-                CSAMPLE* dataPtr2;
-                ring_buffer_size_t size2;
-                m_outputFifo->aquireReadRegions(copyCount,
-                        &dataPtr1, &size1, &dataPtr2, &size2);
+                const auto regions = m_outputFifo->reserveRead(copyCount);
+                const CSAMPLE* dataPtr1 = regions.first.data();
                 if (writeAvailable >= outChunkSize * 2) {
                     // Underflow (2 is max for native ALSA devices)
                     //qDebug() << "SoundDevicePortAudio::writeProcess() fill buffer" << (float)(writeAvailable - copyCount) / outChunkSize;
@@ -654,21 +645,21 @@ void SoundDevicePortAudio::writeProcess() {
                 } else {
                     m_outputDrift = false;
                 }
-                PaError err = Pa_WriteStream(pStream, dataPtr1,
-                        size1 / m_outputParams.channelCount);
+                PaError err = Pa_WriteStream(pStream, regions.first.data(),
+                        regions.first.size() / m_outputParams.channelCount);
                 if (err == paOutputUnderflowed) {
                     //qDebug() << "SoundDevicePortAudio::writeProcess() Pa_ReadStream paOutputUnderflowed" << m_deviceId;
                     m_pSoundManager->underflowHappened(19);
                 }
-                if (size2 > 0) {
-                    PaError err = Pa_WriteStream(pStream, dataPtr2,
-                            size2 / m_outputParams.channelCount);
+                if (!regions.second.empty()) {
+                    PaError err = Pa_WriteStream(pStream, regions.second.data(),
+                            regions.second.size() / m_outputParams.channelCount);
                     if (err == paOutputUnderflowed) {
                         //qDebug() << "SoundDevicePortAudio::writeProcess() Pa_WriteStream paOutputUnderflowed" << m_deviceId;
                         m_pSoundManager->underflowHappened(20);
                     }
                 }
-                m_outputFifo->releaseReadRegions(copyCount);
+                m_outputFifo->commitRead(copyCount);
             }
         }
     }
@@ -757,53 +748,25 @@ int SoundDevicePortAudio::callbackProcessDrift(
     }
 
     if (m_outputParams.channelCount) {
-        int outChunkSize = framesPerBuffer * m_outputParams.channelCount;
-        int readAvailable = m_outputFifo->readAvailable();
-
-        if (readAvailable > outChunkSize * (kDriftReserve + 1)) {
-            m_outputFifo->read(out, outChunkSize);
-            if (m_outputDrift) {
-                // Risk of overflow, skip one frame
-                m_outputFifo->releaseReadRegions(m_outputParams.channelCount);
-                //qDebug() << "callbackProcessDrift read:" << (float)readAvailable / outChunkSize << "Skip";
-            } else {
-                m_outputDrift = true;
-                //qDebug() << "callbackProcessDrift read:" << (float)readAvailable / outChunkSize << "Jitter Skip";
-            }
-        } else if (readAvailable == outChunkSize * (kDriftReserve + 1)) {
-            m_outputFifo->read(out, outChunkSize);
-            m_outputDrift = false;
-            //qDebug() << "callbackProcessDrift read:" << (float)readAvailable / outChunkSize << "Normal";
-        } else if (readAvailable >= outChunkSize) {
-            if (m_outputDrift) {
-                // Risk of underflow, duplicate one frame
-                m_outputFifo->read(out,
-                        outChunkSize - m_outputParams.channelCount);
-                SampleUtil::copy(
-                        &out[outChunkSize - m_outputParams.channelCount],
-                        &out[outChunkSize - (2 * m_outputParams.channelCount)],
-                        m_outputParams.channelCount);
-                //qDebug() << "callbackProcessDrift read:" << (float)readAvailable / outChunkSize << "Save";
-            } else {
-                m_outputFifo->read(out, outChunkSize);
-                m_outputDrift = true;
-                //qDebug() << "callbackProcessDrift read:" << (float)readAvailable / outChunkSize << "Jitter Save";
-            }
-        } else if (readAvailable) {
-            m_outputFifo->read(out,
-                    readAvailable);
+        // The clock reference device writes one chunk per callback. Depending
+        // on which callback fires first, the fill level at this point is
+        // between one and two chunks above the reserve. The compensator
+        // resamples the output, to keep it there in average.
+        const SINT fillFrames = m_outputFifo->readAvailable() / m_outputParams.channelCount;
+        m_pOutputDriftCompensator->updateFillLevel(fillFrames,
+                framesPerBuffer * (kDriftReserve + 1),
+                framesPerBuffer);
+        const SINT missingFrames = m_pOutputDriftCompensator->process(
+                m_outputFifo, out, framesPerBuffer);
+        if (missingFrames >= framesPerBuffer) {
+            // Buffer empty
+            m_pSoundManager->underflowHappened(11);
+        } else if (missingFrames > 0) {
             // underflow
-            SampleUtil::clear(&out[readAvailable],
-                    outChunkSize - readAvailable);
             m_pSoundManager->underflowHappened(10);
-            //qDebug() << "callbackProcessDrift read:" << (float)readAvailable / outChunkSize << "Underflow";
-        } else {
-            // underflow
-            SampleUtil::clear(out, outChunkSize);
-            m_pSoundManager->underflowHappened(11);
-            //qDebug() << "callbackProcess read:" << (float)readAvailable / outChunkSize << "Buffer empty";
         }
-     }
+        updateDriftCompensationControls(framesPerBuffer);
+    }
     return paContinue;
 }
 
@@ -1070,3 +1033,13 @@ void SoundDevicePortAudio::updateAudioLatencyUsage(
     // measure time in Audio callback at the very last
     m_timeInAudioCallback += m_clkRefTimer.elapsed();
 }
+
+void SoundDevicePortAudio::updateDriftCompensationControls(
+        const SINT framesPerBuffer) {
+    m_framesSinceDriftControlsUpdate += framesPerBuffer;
+    if (m_framesSinceDriftControlsUpdate > (m_dSampleRate / kCpuUsageUpdateRate)) {
+        m_pDriftPpm->setAndConfirm(m_pOutputDriftCompensator->driftPpm());
+        m_pDriftRatio->setAndConfirm(m_pOutputDriftCompensator->ratio());
+        m_framesSinceDriftControlsUpdate = 0;
+    }
+}
@@ -3,6 +3,7 @@
 #include <portaudio.h>
 
 #include <QString>
+#include <memory>
 
 #include "control/pollingcontrolproxy.h"
 #include "soundio/sounddevice.h"
@@ -10,7 +11,9 @@
 #include "util/performancetimer.h"
 
 class SoundManager;
+class ControlObject;
 class ControlProxy;
+class DriftCompensator;
 
 class SoundDevicePortAudio : public SoundDevice {
   public:
@@ -53,6 +56,7 @@ class SoundDevicePortAudio : public SoundDevice {
   private:
     void updateCallbackEntryToDacTime(const PaStreamCallbackTimeInfo* timeInfo);
     void updateAudioLatencyUsage(const SINT framesPerBuffer);
+    void updateDriftCompensationControls(const SINT framesPerBuffer);
 
     // PortAudio stream for this device.
     PaStream* volatile m_pStream;
@@ -68,6 +72,11 @@ class SoundDevicePortAudio : public SoundDevice {
     FIFO<CSAMPLE>* m_inputFifo;
     bool m_outputDrift;
     bool m_inputDrift;
+    // Resamples the output of a device that is not the clock reference
+    std::unique_ptr<DriftCompensator> m_pOutputDriftCompensator;
+    std::unique_ptr<ControlObject> m_pDriftPpm;
+    std::unique_ptr<ControlObject> m_pDriftRatio;
+    int m_framesSinceDriftControlsUpdate;
 
     // A string describing the last PortAudio error to occur.
     QString m_lastError;
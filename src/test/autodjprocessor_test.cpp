@@ -137,6 +137,11 @@ class MockPlayerManager : public PlayerManagerInterface {
     MOCK_CONST_METHOD1(getPreviewDeck, PreviewDeck*(unsigned int));
     MOCK_CONST_METHOD1(getSampler, Sampler*(unsigned int));
 
+    // There is no engine, so AutoDJProcessor moves the crossfader itself
+    QSharedPointer<AutoDJTransitionSchedule> getAutoDJTransitionSchedule() const {
+        return nullptr;
+    }
+
     unsigned int numberOfDecks() const {
         return static_cast<unsigned int>(numDecks.get());
     }
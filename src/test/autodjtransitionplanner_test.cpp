@@ -0,0 +1,226 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include "library/autodj/autodjtransitionplanner.h"
+#include "test/librarytest.h"
+#include "track/track.h"
+
+namespace {
+
+constexpr auto kSampleRate = mixxx::audio::SampleRate(44100);
+// 120 BPM, one bar lasts two seconds
+constexpr auto kBpm = mixxx::Bpm(120.0);
+
+mixxx::audio::FramePos secondsToFrames(double seconds) {
+    return mixxx::audio::FramePos(seconds * kSampleRate.value());
+}
+
+double framesToSeconds(mixxx::audio::FramePos position) {
+    return position.value() / kSampleRate.value();
+}
+
+AutoDJTrackSnapshot createSnapshot(TrackId trackId, double durationSeconds) {
+    AutoDJTrackSnapshot snapshot;
+    snapshot.trackId = trackId;
+    snapshot.sampleRate = kSampleRate;
+    snapshot.endPosition = secondsToFrames(durationSeconds);
+    return snapshot;
+}
+
+class AutoDJTransitionPlannerTest : public LibraryTest {
+  protected:
+    TrackPointer addTrack(const QString& trackLocation) {
+        return getOrAddTrackByLocation(getTestDir().filePath(trackLocation));
+    }
+
+    void waitForPlanner(const AutoDJTransitionPlanner& planner) {
+        while (!planner.isIdle()) {
+            application()->processEvents();
+        }
+    }
+};
+
+TEST(AutoDJTransitionPlannerStaticTest, FullIntroOutroWithoutBeats) {
+    AutoDJTrackSnapshot from = createSnapshot(TrackId(1), 120.0);
+    from.outroStartPosition = secondsToFrames(100.0);
+    from.outroEndPosition = secondsToFrames(110.0);
+    AutoDJTrackSnapshot to = createSnapshot(TrackId(2), 120.0);
+    to.introStartPosition = secondsToFrames(1.0);
+    to.introEndPosition = secondsToFrames(9.0);
+
+    const auto plan = AutoDJTransitionPlanner::planTransition(from, to);
+    ASSERT_TRUE(plan.isValid());
+    EXPECT_FALSE(plan.barAligned);
+    // The shorter intro determines the length of the transition
+    EXPECT_DOUBLE_EQ(102.0, framesToSeconds(plan.fadeBeginPosition));
+    EXPECT_DOUBLE_EQ(110.0, framesToSeconds(plan.fadeEndPosition));
+    EXPECT_DOUBLE_EQ(1.0, framesToSeconds(plan.toStartPosition));
+    EXPECT_EQ(from.outroStartPosition, plan.fromOutroStartPosition);
+    EXPECT_EQ(to.introEndPosition, plan.toIntroEndPosition);
+}
+
+TEST(AutoDJTransitionPlannerStaticTest, NoIntroAndOutro) {
+    const auto plan = AutoDJTransitionPlanner::planTransition(
+            createSnapshot(TrackId(1), 120.0), createSnapshot(TrackId(2), 120.0));
+    // The transition time from the preferences is used
+    EXPECT_FALSE(plan.isValid());
+    EXPECT_EQ(TrackId(1), plan.fromTrackId);
+    EXPECT_EQ(TrackId(2), plan.toTrackId);
+}
+
+TEST(AutoDJTransitionPlannerStaticTest, AlignsFadeToBars) {
+    AutoDJTrackSnapshot from = createSnapshot(TrackId(1), 120.0);
+    from.pBeats = mixxx::Beats::fromConstTempo(
+            kSampleRate, mixxx::audio::kStartFramePos, kBpm);
+    from.outroStartPosition = secondsToFrames(100.0);
+    from.outroEndPosition = secondsToFrames(110.0);
+    AutoDJTrackSnapshot to = createSnapshot(TrackId(2), 120.0);
+    to.pBeats = mixxx::Beats::fromConstTempo(
+            kSampleRate, secondsToFrames(0.1), kBpm);
+    to.introStartPosition = secondsToFrames(0.05);
+    to.introEndPosition = secondsToFrames(8.55);
+
+    const auto plan = AutoDJTransitionPlanner::planTransition(from, to);
+    ASSERT_TRUE(plan.isValid());
+    EXPECT_TRUE(plan.barAligned);
+    // The unaligned fade lasts from 101.5 to 110 seconds. It is moved to the
+    // closest bar and lasts 4 bars.
+    EXPECT_DOUBLE_EQ(102.0, framesToSeconds(plan.fadeBeginPosition));
+    EXPECT_DOUBLE_EQ(110.0, framesToSeconds(plan.fadeEndPosition));
+    // The next track starts on its first beat
+    EXPECT_DOUBLE_EQ(0.1, framesToSeconds(plan.toStartPosition));
+}
+
+TEST(AutoDJTransitionPlannerStaticTest, AlignedFadeEndsBeforeTrackEnd) {
+    AutoDJTrackSnapshot from = createSnapshot(TrackId(1), 107.5);
+    from.pBeats = mixxx::Beats::fromConstTempo(
+            kSampleRate, mixxx::audio::kStartFramePos, kBpm);
+    from.outroStartPosition = secondsToFrames(103.2);
+    from.outroEndPosition = secondsToFrames(107.4);
+    AutoDJTrackSnapshot to = createSnapshot(TrackId(2), 120.0);
+
+    const auto plan = AutoDJTransitionPlanner::planTransition(from, to);
+    ASSERT_TRUE(plan.isValid());
+    EXPECT_TRUE(plan.barAligned);
+    // Two bars would end after the end of the track
+    EXPECT_DOUBLE_EQ(104.0, framesToSeconds(plan.fadeBeginPosition));
+    EXPECT_DOUBLE_EQ(106.0, framesToSeconds(plan.fadeEndPosition));
+}
+
+TEST(AutoDJTransitionPlannerStaticTest, ClashingKeysShortenFade) {
+    using namespace mixxx::track::io::key;
+    AutoDJTrackSnapshot from = createSnapshot(TrackId(1), 120.0);
+    from.key = C_MAJOR;
+    from.outroStartPosition = secondsToFrames(100.0);
+    from.outroEndPosition = secondsToFrames(110.0);
+    AutoDJTrackSnapshot to = createSnapshot(TrackId(2), 120.0);
+    to.key = F_SHARP_MAJOR;
+    to.introStartPosition = secondsToFrames(1.0);
+    to.introEndPosition = secondsToFrames(9.0);
+
+    const auto plan = AutoDJTransitionPlanner::planTransition(from, to);
+    ASSERT_TRUE(plan.isValid());
+    EXPECT_DOUBLE_EQ(0.0, plan.keyCompatibility);
+    // The fade still ends at the end of the outro
+    EXPECT_DOUBLE_EQ(106.0, framesToSeconds(plan.fadeBeginPosition));
+    EXPECT_DOUBLE_EQ(110.0, framesToSeconds(plan.fadeEndPosition));
+    EXPECT_DOUBLE_EQ(1.0, framesToSeconds(plan.toStartPosition));
+}
+
+TEST(AutoDJTransitionPlannerStaticTest, KeyCompatibility) {
+    using namespace mixxx::track::io::key;
+    EXPECT_DOUBLE_EQ(1.0, AutoDJTransitionPlanner::keyCompatibility(C_MAJOR, C_MAJOR));
+    // Relative minor
+    EXPECT_DOUBLE_EQ(0.75, AutoDJTransitionPlanner::keyCompatibility(C_MAJOR, A_MINOR));
+    // Dominant
+    EXPECT_DOUBLE_EQ(0.75, AutoDJTransitionPlanner::keyCompatibility(C_MAJOR, G_MAJOR));
+    // Opposite side of the Circle of Fifths
+    EXPECT_DOUBLE_EQ(0.0, AutoDJTransitionPlanner::keyCompatibility(C_MAJOR, F_SHARP_MAJOR));
+    EXPECT_LT(AutoDJTransitionPlanner::keyCompatibility(C_MAJOR, B_FLAT_MAJOR),
+            AutoDJTransitionPlanner::keyCompatibility(C_MAJOR, G_MAJOR));
+    EXPECT_DOUBLE_EQ(0.5, AutoDJTransitionPlanner::keyCompatibility(C_MAJOR, INVALID));
+}
+
+TEST_F(AutoDJTransitionPlannerTest, PlansConsecutiveTracks) {
+    const TrackPointer pTrack1 = addTrack(QStringLiteral("id3-test-data/cover-test-png.mp3"));
+    const TrackPointer pTrack2 = addTrack(QStringLiteral("id3-test-data/cover-test-jpg.mp3"));
+    const TrackPointer pTrack3 = addTrack(QStringLiteral("id3-test-data/artist.mp3"));
+    ASSERT_TRUE(pTrack1 && pTrack2 && pTrack3);
+    const TrackId id1 = pTrack1->getId();
+    const TrackId id2 = pTrack2->getId();
+    const TrackId id3 = pTrack3->getId();
+
+    AutoDJTransitionPlanner planner(nullptr, trackCollectionManager(), nullptr);
+    planner.setQueue({id1, id2, id3});
+    waitForPlanner(planner);
+    EXPECT_EQ(2, planner.numPlannedTransitions());
+    EXPECT_EQ(id1, planner.plannedTransition(id1, id2).fromTrackId);
+    EXPECT_EQ(id2, planner.plannedTransition(id2, id3).fromTrackId);
+
+    // Removing the last track keeps the first plan
+    planner.setQueue({id1, id2});
+    EXPECT_TRUE(planner.isIdle());
+    EXPECT_EQ(1, planner.numPlannedTransitions());
+    EXPECT_EQ(id1, planner.plannedTransition(id1, id2).fromTrackId);
+    EXPECT_FALSE(planner.plannedTransition(id2, id3).fromTrackId.isValid());
+
+    // Moving a track only plans the new pairs
+    planner.setQueue({id1, id2, id3, id1});
+    EXPECT_EQ(1, planner.numPlannedTransitions());
+    waitForPlanner(planner);
+    EXPECT_EQ(3, planner.numPlannedTransitions());
+}
+
+TEST_F(AutoDJTransitionPlannerTest, AnalysisInvalidatesPlans) {
+    const TrackPointer pTrack1 = addTrack(QStringLiteral("id3-test-data/cover-test-png.mp3"));
+    const TrackPointer pTrack2 = addTrack(QStringLiteral("id3-test-data/cover-test-jpg.mp3"));
+    ASSERT_TRUE(pTrack1 && pTrack2);
+    const TrackId id1 = pTrack1->getId();
+    const TrackId id2 = pTrack2->getId();
+    pTrack1->setKey(mixxx::track::io::key::C_MAJOR, mixxx::track::io::key::USER);
+    pTrack2->setKey(mixxx::track::io::key::C_MAJOR, mixxx::track::io::key::USER);
+    // The planner reads the tracks from the database
+    trackCollectionManager()->saveTrack(pTrack1);
+    trackCollectionManager()->saveTrack(pTrack2);
+
+    AutoDJTransitionPlanner planner(nullptr, trackCollectionManager(), nullptr);
+    planner.setQueue({id1, id2});
+    waitForPlanner(planner);
+    EXPECT_DOUBLE_EQ(1.0, planner.plannedTransition(id1, id2).keyCompatibility);
+
+    pTrack2->setKey(mixxx::track::io::key::F_SHARP_MAJOR, mixxx::track::io::key::USER);
+    trackCollectionManager()->saveTrack(pTrack2);
+    EXPECT_EQ(0, planner.numPlannedTransitions());
+    waitForPlanner(planner);
+    EXPECT_EQ(1, planner.numPlannedTransitions());
+    EXPECT_DOUBLE_EQ(0.0, planner.plannedTransition(id1, id2).keyCompatibility);
+}
+
+} // namespace
+
+static void BM_AutoDJPlanQueue(benchmark::State& state) {
+    using namespace mixxx::track::io::key;
+    const int numTracks = static_cast<int>(state.range(0));
+    QList<AutoDJTrackSnapshot> snapshots;
+    for (int i = 0; i < numTracks; ++i) {
+        const double duration = 180.0 + i % 120;
+        AutoDJTrackSnapshot snapshot = createSnapshot(TrackId(i + 1), duration);
+        snapshot.pBeats = mixxx::Beats::fromConstTempo(kSampleRate,
+                secondsToFrames(0.01 * (i % 50)),
+                mixxx::Bpm(110.0 + i % 30));
+        snapshot.key = static_cast<ChromaticKey>(1 + i % 24);
+        snapshot.introStartPosition = secondsToFrames(0.5);
+        snapshot.introEndPosition = secondsToFrames(8.0 + i % 24);
+        snapshot.outroStartPosition = secondsToFrames(duration - 20.0 - i % 10);
+        snapshot.outroEndPosition = secondsToFrames(duration - 1.0);
+        snapshots.append(snapshot);
+    }
+    QList<AutoDJTransitionPlanner::SnapshotPair> pairs;
+    for (int i = 1; i < snapshots.size(); ++i) {
+        pairs.append(AutoDJTransitionPlanner::SnapshotPair(snapshots[i - 1], snapshots[i]));
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(AutoDJTransitionPlanner::planTransitions(pairs));
+    }
+}
+BENCHMARK(BM_AutoDJPlanQueue)->Arg(500);
@@ -0,0 +1,179 @@
+#include "library/basesqltablemodel.h"
+
+#include <gtest/gtest.h>
+
+#include <QSqlQuery>
+
+#include "mixer/playerinfo.h"
+#include "test/librarytest.h"
+
+namespace {
+
+// Must match the page size of BaseSqlTableModel
+constexpr int kRowsPerPage = 256;
+constexpr int kMaxCachedPages = 64;
+
+const QString kTableName = QStringLiteral("lazy_rows");
+
+/// A table with an id and a value column, for inspecting when the
+/// values are loaded from the database.
+class LazyRowsTableModel : public BaseSqlTableModel {
+  public:
+    explicit LazyRowsTableModel(TrackCollectionManager* pTrackCollectionManager)
+            : BaseSqlTableModel(nullptr, pTrackCollectionManager, "mixxx.db.model.test") {
+    }
+
+    bool createTable(int numRows) {
+        QSqlQuery query(m_database);
+        if (!query.exec(QStringLiteral(
+                    "CREATE TEMP TABLE %1 (id INTEGER PRIMARY KEY, value INTEGER)")
+                                .arg(kTableName))) {
+            return false;
+        }
+        // The rows have the ids 1 to numRows and initially their id as value
+        if (!query.exec(QStringLiteral(
+                    "INSERT INTO %1 (id, value) "
+                    "WITH RECURSIVE ids(id) AS "
+                    "(SELECT 1 UNION ALL SELECT id + 1 FROM ids WHERE id < %2) "
+                    "SELECT id, id FROM ids")
+                                .arg(kTableName, QString::number(numRows)))) {
+            return false;
+        }
+        setTable(kTableName,
+                QStringLiteral("id"),
+                {QStringLiteral("id"), QStringLiteral("value")},
+                nullptr);
+        return true;
+    }
+
+    /// Changes the value in the database without notifying the model
+    bool updateValue(int row, int value) {
+        QSqlQuery query(m_database);
+        query.prepare(QStringLiteral("UPDATE %1 SET value=:value WHERE id=:id")
+                              .arg(kTableName));
+        query.bindValue(":value", value);
+        query.bindValue(":id", row + 1);
+        return query.exec();
+    }
+
+    QVariant value(int row) const {
+        return rawValue(index(row, 1));
+    }
+
+    bool isColumnInternal(int column) override {
+        Q_UNUSED(column);
+        return false;
+    }
+    bool isColumnHiddenByDefault(int column) override {
+        Q_UNUSED(column);
+        return false;
+    }
+};
+
+class BaseSqlTableModelTest : public LibraryTest {
+  protected:
+    BaseSqlTableModelTest() {
+        PlayerInfo::create();
+        m_pModel = std::make_unique<LazyRowsTableModel>(trackCollectionManager());
+    }
+
+    ~BaseSqlTableModelTest() override {
+        m_pModel.reset();
+        PlayerInfo::destroy();
+    }
+
+    void createTable(int numRows) {
+        ASSERT_TRUE(m_pModel->createTable(numRows));
+        m_pModel->select();
+        ASSERT_EQ(numRows, m_pModel->rowCount());
+    }
+
+    std::unique_ptr<LazyRowsTableModel> m_pModel;
+};
+
+TEST_F(BaseSqlTableModelTest, LoadsValuesOfAllPages) {
+    // The last page is incomplete
+    const int numRows = 3 * kRowsPerPage + 10;
+    createTable(numRows);
+
+    for (int row : {0,
+                 kRowsPerPage - 1,
+                 kRowsPerPage,
+                 2 * kRowsPerPage - 1,
+                 2 * kRowsPerPage,
+                 numRows - 1}) {
+        EXPECT_EQ(row + 1, m_pModel->value(row).toInt()) << "row" << row;
+    }
+    EXPECT_FALSE(m_pModel->value(numRows).isValid());
+}
+
+TEST_F(BaseSqlTableModelTest, PrefetchLoadsAdjacentPages) {
+    createTable(4 * kRowsPerPage);
+
+    // Loads the first and the second page
+    m_pModel->prefetchRows(0, 10);
+
+    // The values of loaded pages are not queried again
+    for (int row : {0, kRowsPerPage - 1, kRowsPerPage, 2 * kRowsPerPage - 1}) {
+        ASSERT_TRUE(m_pModel->updateValue(row, -1));
+        EXPECT_EQ(row + 1, m_pModel->value(row).toInt()) << "row" << row;
+    }
+    // The third page has not been loaded
+    ASSERT_TRUE(m_pModel->updateValue(2 * kRowsPerPage, -1));
+    EXPECT_EQ(-1, m_pModel->value(2 * kRowsPerPage).toInt());
+}
+
+TEST_F(BaseSqlTableModelTest, PrefetchLoadsPagesOfAllRows) {
+    createTable(5 * kRowsPerPage);
+
+    // Loads the second page because of the first row and the fourth
+    // page because of the last row, the first and the fifth page as
+    // adjacent pages
+    m_pModel->prefetchRows(kRowsPerPage + 10, 3 * kRowsPerPage + 10);
+
+    for (int page = 0; page < 5; ++page) {
+        const int row = page * kRowsPerPage;
+        ASSERT_TRUE(m_pModel->updateValue(row, -1));
+        EXPECT_EQ(row + 1, m_pModel->value(row).toInt()) << "page" << page;
+    }
+}
+
+TEST_F(BaseSqlTableModelTest, EvictsLeastRecentlyUsedPages) {
+    const int numPages = kMaxCachedPages + 2;
+    createTable(numPages * kRowsPerPage);
+
+    EXPECT_EQ(1, m_pModel->value(0).toInt());
+    ASSERT_TRUE(m_pModel->updateValue(0, -1));
+    EXPECT_EQ(1, m_pModel->value(0).toInt());
+
+    // Loads as many other pages as are cached
+    for (int page = 2; page < numPages; ++page) {
+        const int row = page * kRowsPerPage;
+        EXPECT_EQ(row + 1, m_pModel->value(row).toInt()) << "page" << page;
+    }
+
+    // The first page has been evicted and is loaded again
+    EXPECT_EQ(-1, m_pModel->value(0).toInt());
+}
+
+TEST_F(BaseSqlTableModelTest, SelectInvalidatesLoadedPages) {
+    createTable(10);
+
+    EXPECT_EQ(1, m_pModel->value(0).toInt());
+    ASSERT_TRUE(m_pModel->updateValue(0, -1));
+    EXPECT_EQ(1, m_pModel->value(0).toInt());
+
+    m_pModel->select();
+    EXPECT_EQ(-1, m_pModel->value(0).toInt());
+}
+
+TEST_F(BaseSqlTableModelTest, GetTrackRows) {
+    createTable(kRowsPerPage + 1);
+
+    EXPECT_EQ(QVector<int>{0}, m_pModel->getTrackRows(TrackId(1)));
+    EXPECT_EQ(QVector<int>{kRowsPerPage},
+            m_pModel->getTrackRows(TrackId(kRowsPerPage + 1)));
+    EXPECT_TRUE(m_pModel->getTrackRows(TrackId(kRowsPerPage + 2)).isEmpty());
+}
+
+} // namespace
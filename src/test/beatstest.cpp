@@ -1,3 +1,4 @@
+#include <benchmark/benchmark.h>
 #include <gtest/gtest.h>
 
 #include <QtDebug>
@@ -537,4 +538,119 @@ TEST(BeatsTest, ConstTempoFindPrevNextBeatWhenNotOnBeat) {
     EXPECT_NEAR(nextBeat.value(), foundNextBeat.value(), kMaxBeatError);
 }
 
+// Creates a beat map with a slightly different tempo for every few beats,
+// which results in one beat marker every `beatsPerMarker` beats.
+BeatsPointer createVariableTempoBeats(int numBeats, int beatsPerMarker) {
+    QVector<audio::FramePos> beatPositions;
+    beatPositions.reserve(numBeats);
+    auto position = kStartPosition;
+    for (int i = 0; i < numBeats; i++) {
+        beatPositions.append(position);
+        const int section = i / beatsPerMarker;
+        position += kSampleRate.value() / 2 + (section % 2 == 0 ? 0 : 5 * (section % 7 + 1));
+    }
+    return Beats::fromBeatPositions(kSampleRate, beatPositions, QString());
+}
+
+QVector<audio::FramePos> allBeatPositions(const Beats& beats) {
+    QVector<audio::FramePos> beatPositions;
+    for (auto it = beats.cfirstmarker(); it != beats.clastmarker() + 1; it++) {
+        beatPositions.append(*it);
+    }
+    return beatPositions;
+}
+
+TEST(BeatsTest, NonConstTempoIteratorArithmetic) {
+    const auto pBeats = createVariableTempoBeats(200, 3);
+    ASSERT_NE(nullptr, pBeats);
+    ASSERT_FALSE(pBeats->hasConstantTempo());
+    const QVector<audio::FramePos> beatPositions = allBeatPositions(*pBeats);
+    ASSERT_EQ(200, beatPositions.size());
+
+    auto first = pBeats->cfirstmarker();
+    for (int i = 0; i < beatPositions.size(); i++) {
+        for (int j = 0; j < beatPositions.size(); j += 7) {
+            auto it = first + i;
+            EXPECT_NEAR(beatPositions[i].value(), it->value(), kMaxBeatError);
+            it += j - i;
+            EXPECT_NEAR(beatPositions[j].value(), it->value(), kMaxBeatError);
+            EXPECT_EQ(j - i, it - (first + i));
+            EXPECT_EQ(first + j, it);
+        }
+    }
+
+    // Iterating beyond the markers continues with the first and last tempo
+    auto it = first + 5;
+    it -= 10;
+    EXPECT_EQ(-5, it - first);
+    EXPECT_NEAR((beatPositions[0] - 5 * (beatPositions[1] - beatPositions[0])).value(),
+            it->value(),
+            kMaxBeatError);
+    it += 210;
+    EXPECT_EQ(205, it - first);
+}
+
+TEST(BeatsTest, NonConstTempoIteratorFrom) {
+    const auto pBeats = createVariableTempoBeats(200, 3);
+    ASSERT_NE(nullptr, pBeats);
+    const QVector<audio::FramePos> beatPositions = allBeatPositions(*pBeats);
+
+    for (int i = 1; i < beatPositions.size(); i++) {
+        // On a beat
+        EXPECT_EQ(beatPositions[i], *pBeats->iteratorFrom(beatPositions[i]));
+        // Between two beats
+        const auto position = beatPositions[i - 1] +
+                (beatPositions[i] - beatPositions[i - 1]) / 3;
+        EXPECT_EQ(beatPositions[i], *pBeats->iteratorFrom(position));
+        EXPECT_NEAR(beatPositions[i].value(),
+                pBeats->findNextBeat(position).value(),
+                kMaxBeatError);
+        EXPECT_NEAR(beatPositions[i - 1].value(),
+                pBeats->findPrevBeat(position).value(),
+                kMaxBeatError);
+    }
+}
+
+TEST(BeatsTest, NonConstTempoNumBeatsInRange) {
+    const auto pBeats = createVariableTempoBeats(200, 3);
+    ASSERT_NE(nullptr, pBeats);
+    const QVector<audio::FramePos> beatPositions = allBeatPositions(*pBeats);
+
+    for (int i = 0; i < beatPositions.size(); i += 3) {
+        for (int j = i; j < beatPositions.size(); j += 11) {
+            // The range excludes the end position
+            EXPECT_EQ(j - i, pBeats->numBeatsInRange(beatPositions[i], beatPositions[j]));
+            EXPECT_EQ(j - i + 1,
+                    pBeats->numBeatsInRange(beatPositions[i], beatPositions[j] + 1));
+        }
+    }
+    EXPECT_EQ(0, pBeats->numBeatsInRange(beatPositions[10], beatPositions[5]));
+}
+
 } // namespace
+
+static void BM_BeatsFindNthBeat(benchmark::State& state) {
+    const auto pBeats = createVariableTempoBeats(
+            static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    const auto lastBeatPosition = *pBeats->clastmarker();
+    const audio::FrameDiff_t step = (lastBeatPosition - kStartPosition) / 997;
+    auto position = kStartPosition;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(pBeats->findNthBeat(position, 4));
+        position += step;
+        if (position > lastBeatPosition) {
+            position = kStartPosition;
+        }
+    }
+}
+BENCHMARK(BM_BeatsFindNthBeat)->Ranges({{256, 8 << 10}, {1, 16}});
+
+static void BM_BeatsNumBeatsInRange(benchmark::State& state) {
+    const auto pBeats = createVariableTempoBeats(
+            static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    const auto lastBeatPosition = *pBeats->clastmarker();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(pBeats->numBeatsInRange(kStartPosition, lastBeatPosition));
+    }
+}
+BENCHMARK(BM_BeatsNumBeatsInRange)->Ranges({{256, 8 << 10}, {1, 16}});
@@ -268,6 +268,64 @@ TEST_F(ControllerScriptEngineLegacyTest, trigger) {
     EXPECT_DOUBLE_EQ(1.0, pass->get());
 }
 
+TEST_F(ControllerScriptEngineLegacyTest, setValue_AppliedInOrderWhenCallbackReturns) {
+    auto co = std::make_unique<ControlObject>(ConfigKey("[Test]", "co"));
+    auto trigger = std::make_unique<ControlObject>(ConfigKey("[Test]", "trigger"));
+
+    // Every write must arrive, and only after the callback has returned
+    QList<double> values;
+    QList<bool> returned;
+    QObject::connect(co.get(), &ControlObject::valueChanged, [&](double value) {
+        values.append(value);
+        returned.append(cEngine->jsEngine()->globalObject().property("returned").toBool());
+    });
+
+    EXPECT_TRUE(evaluateAndAssert(
+            "var returned = false;"
+            "engine.makeConnection('[Test]', 'trigger', function() {"
+            "  engine.setValue('[Test]', 'co', 1.0);"
+            "  engine.setValue('[Test]', 'co', 0.0);"
+            "  engine.setValue('[Test]', 'co', 2.0);"
+            "  returned = true; });"
+            "engine.trigger('[Test]', 'trigger');"));
+    processEvents();
+
+    EXPECT_EQ(QList<double>({1.0, 0.0, 2.0}), values);
+    EXPECT_EQ(QList<bool>({true, true, true}), returned);
+    EXPECT_DOUBLE_EQ(2.0, co->get());
+}
+
+TEST_F(ControllerScriptEngineLegacyTest, setValue_ReadBackInCallback) {
+    auto co = std::make_unique<ControlObject>(ConfigKey("[Test]", "co"));
+    auto other = std::make_unique<ControlObject>(ConfigKey("[Test]", "other"));
+    auto trigger = std::make_unique<ControlObject>(ConfigKey("[Test]", "trigger"));
+
+    EXPECT_TRUE(evaluateAndAssert(
+            "engine.makeConnection('[Test]', 'trigger', function() {"
+            "  engine.setValue('[Test]', 'co', 1.0);"
+            "  engine.setValue('[Test]', 'other', engine.getValue('[Test]', 'co') + 1.0); });"
+            "engine.trigger('[Test]', 'trigger');"));
+    processEvents();
+
+    EXPECT_DOUBLE_EQ(1.0, co->get());
+    EXPECT_DOUBLE_EQ(2.0, other->get());
+}
+
+TEST_F(ControllerScriptEngineLegacyTest, setValue_OrderedWithOtherControlAccess) {
+    auto co = std::make_unique<ControlObject>(ConfigKey("[Test]", "co"));
+    auto trigger = std::make_unique<ControlObject>(ConfigKey("[Test]", "trigger"));
+
+    EXPECT_TRUE(evaluateAndAssert(
+            "engine.makeConnection('[Test]', 'trigger', function() {"
+            "  engine.setValue('[Test]', 'co', 1.0);"
+            "  engine.reset('[Test]', 'co'); });"
+            "engine.trigger('[Test]', 'trigger');"));
+    processEvents();
+
+    // The reset is not overwritten by the earlier write
+    EXPECT_DOUBLE_EQ(0.0, co->get());
+}
+
 // ControllerEngine::connectControl has a lot of quirky, inconsistent legacy behaviors
 // depending on how it is invoked, so we need a lot of tests to make sure old scripts
 // do not break.
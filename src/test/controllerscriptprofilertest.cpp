@@ -0,0 +1,37 @@
+#include "controllers/scripting/controllerscriptprofiler.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+TEST(ControllerScriptProfilerTest, disabled) {
+    ControllerScriptProfiler profiler(false);
+    {
+        const ControllerScriptProfiler::Scope profile(
+                &profiler, QStringLiteral("handler"));
+    }
+    EXPECT_TRUE(profiler.entries().isEmpty());
+}
+
+TEST(ControllerScriptProfilerTest, mostExpensiveFirst) {
+    ControllerScriptProfiler profiler(true);
+    const QString cheap = QStringLiteral("cheap");
+    const QString expensive = QStringLiteral("expensive");
+    profiler.record(cheap, mixxx::Duration::fromMicros(10));
+    profiler.record(expensive, mixxx::Duration::fromMicros(500));
+    profiler.record(cheap, mixxx::Duration::fromMicros(30));
+    profiler.record(expensive, mixxx::Duration::fromMicros(100));
+
+    const auto entries = profiler.entries();
+    ASSERT_EQ(2, entries.size());
+    EXPECT_EQ(expensive, entries[0].name);
+    EXPECT_EQ(2, entries[0].count);
+    EXPECT_EQ(mixxx::Duration::fromMicros(600), entries[0].total);
+    EXPECT_EQ(mixxx::Duration::fromMicros(500), entries[0].max);
+    EXPECT_EQ(cheap, entries[1].name);
+    EXPECT_EQ(2, entries[1].count);
+    EXPECT_EQ(mixxx::Duration::fromMicros(40), entries[1].total);
+    EXPECT_EQ(mixxx::Duration::fromMicros(30), entries[1].max);
+}
+
+} // anonymous namespace
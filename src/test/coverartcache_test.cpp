@@ -1,7 +1,13 @@
+#include <benchmark/benchmark.h>
 #include <gtest/gtest.h>
+
+#include <QDateTime>
+#include <QFile>
 #include <QFileInfo>
+#include <QTemporaryDir>
 
 #include "library/coverartcache.h"
+#include "library/coverartthumbnailstore.h"
 #include "library/coverartutils.h"
 #include "library/trackcollection.h"
 #include "test/librarytest.h"
@@ -92,3 +98,163 @@ TEST_F(CoverArtCacheTest, loadCoverFromFileAbsolute) {
             getTestDir().filePath(kCoverLocationTest),
             getTestDir().filePath(kCoverLocationTest));
 }
+
+namespace {
+
+constexpr int kThumbnailWidth = 64;
+
+CoverInfo coverInfoFromFile(const QString& coverLocation, int digestSeed) {
+    CoverInfo info;
+    info.type = CoverInfo::FILE;
+    info.source = CoverInfo::GUESSED;
+    info.coverLocation = coverLocation;
+    // Distinct digests for the same image simulate covers of different tracks
+    info.setImageDigest(QByteArray::number(digestSeed).leftJustified(16, '#'));
+    return info;
+}
+
+} // namespace
+
+TEST_F(CoverArtCacheTest, thumbnailStoreRoundTrip) {
+    QTemporaryDir tempDir;
+    ASSERT_TRUE(tempDir.isValid());
+    const CoverArtThumbnailStore store{QDir(tempDir.path())};
+    constexpr mixxx::cache_key_t kCacheKey = 0x1234567890abcdefULL;
+
+    EXPECT_TRUE(store.load(kCacheKey, kThumbnailWidth).isNull());
+
+    QImage image(kThumbnailWidth, 48, QImage::Format_ARGB32);
+    image.fill(Qt::transparent);
+    ASSERT_TRUE(store.save(kCacheKey, image));
+    const QImage loaded = store.load(kCacheKey, kThumbnailWidth);
+    // Images with transparency are stored lossless
+    EXPECT_EQ(image.convertToFormat(loaded.format()), loaded);
+    EXPECT_TRUE(store.load(kCacheKey, kThumbnailWidth + 1).isNull());
+}
+
+TEST_F(CoverArtCacheTest, thumbnailStorePrunesLeastRecentlyUsed) {
+    QTemporaryDir tempDir;
+    ASSERT_TRUE(tempDir.isValid());
+    QImage image(kThumbnailWidth, 48, QImage::Format_ARGB32);
+    image.fill(Qt::transparent);
+
+    // All thumbnails have the same size
+    constexpr int kNumThumbnails = 4;
+    const CoverArtThumbnailStore unlimitedStore{QDir(tempDir.path())};
+    const QDateTime now = QDateTime::currentDateTime();
+    for (int i = 0; i < kNumThumbnails; ++i) {
+        ASSERT_TRUE(unlimitedStore.save(i, image));
+        QFile file(unlimitedStore.filePath(i, kThumbnailWidth));
+        ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+        ASSERT_TRUE(file.setFileTime(
+                now.addDays(i - kNumThumbnails), QFileDevice::FileModificationTime));
+    }
+    EXPECT_EQ(0, unlimitedStore.prune());
+    const qint64 thumbnailBytes = unlimitedStore.estimatedBytes() / kNumThumbnails;
+    ASSERT_GT(thumbnailBytes, 0);
+
+    // Loading the oldest thumbnail marks it as recently used
+    const CoverArtThumbnailStore store{QDir(tempDir.path()), 2 * thumbnailBytes};
+    EXPECT_FALSE(store.load(0, kThumbnailWidth).isNull());
+    // Only a single thumbnail fits into 80% of the budget
+    EXPECT_EQ(kNumThumbnails - 1, store.prune());
+    EXPECT_EQ(thumbnailBytes, store.estimatedBytes());
+    EXPECT_FALSE(store.load(0, kThumbnailWidth).isNull());
+    for (int i = 1; i < kNumThumbnails; ++i) {
+        EXPECT_TRUE(store.load(i, kThumbnailWidth).isNull());
+    }
+
+    // Saving beyond the budget prunes the store
+    ASSERT_TRUE(store.save(kNumThumbnails, image));
+    ASSERT_TRUE(store.save(kNumThumbnails + 1, image));
+    EXPECT_LE(store.estimatedBytes(), 2 * thumbnailBytes);
+}
+
+TEST_F(CoverArtCacheTest, loadCoverFromThumbnailStore) {
+    QTemporaryDir tempDir;
+    ASSERT_TRUE(tempDir.isValid());
+    const auto pStore = std::make_shared<const CoverArtThumbnailStore>(
+            QDir(tempDir.path()));
+    const CoverInfo info = coverInfoFromFile(getTestDir().filePath(kCoverLocationTest), 1);
+
+    // The first request scales the original image and stores the result
+    auto res = CoverArtCache::loadCover(
+            nullptr, TrackPointer(), info, kThumbnailWidth, false, pStore);
+    EXPECT_FALSE(res.loadedFromThumbnailStore);
+    EXPECT_EQ(kThumbnailWidth, res.coverArt.loadedImage.image.width());
+    EXPECT_TRUE(QFile::exists(pStore->filePath(info.cacheKey(), kThumbnailWidth)));
+
+    res = CoverArtCache::loadCover(
+            nullptr, TrackPointer(), info, kThumbnailWidth, false, pStore);
+    EXPECT_TRUE(res.loadedFromThumbnailStore);
+    EXPECT_FALSE(res.coverInfoUpdated);
+    EXPECT_EQ(kThumbnailWidth, res.coverArt.loadedImage.image.width());
+    EXPECT_EQ(CoverInfo::LoadedImage::Result::Ok, res.coverArt.loadedImage.result);
+
+    // Full size covers are never stored
+    res = CoverArtCache::loadCover(nullptr, TrackPointer(), info, 0, false, pStore);
+    EXPECT_FALSE(res.loadedFromThumbnailStore);
+}
+
+TEST_F(CoverArtCacheTest, cancelPendingRequests) {
+    const QString coverLocation = getTestDir().filePath(kCoverLocationTest);
+    constexpr int kNumRequests = 20;
+    for (int i = 0; i < kNumRequests; ++i) {
+        tryLoadCover(this, coverInfoFromFile(coverLocation, i), kThumbnailWidth);
+    }
+    // The first requests are started immediately, one per thread. All
+    // others are pending until a thread becomes available.
+    const auto canceledCacheKeys = cancelPendingRequests(this);
+    ASSERT_FALSE(canceledCacheKeys.isEmpty());
+    ASSERT_LT(canceledCacheKeys.size(), kNumRequests);
+    const int numStartedRequests = kNumRequests - canceledCacheKeys.size();
+    for (int i = numStartedRequests; i < kNumRequests; ++i) {
+        EXPECT_TRUE(canceledCacheKeys.contains(
+                coverInfoFromFile(coverLocation, i).cacheKey()));
+    }
+    EXPECT_TRUE(cancelPendingRequests(this).isEmpty());
+
+    // A canceled cover can be requested again
+    EXPECT_TRUE(tryLoadCover(this,
+            coverInfoFromFile(coverLocation, kNumRequests - 1),
+            kThumbnailWidth)
+                        .isNull());
+    EXPECT_EQ(1, cancelPendingRequests(this).size());
+}
+
+/// Loads the cover of every row that is scrolled into view, once from the
+/// original image and once from a warm thumbnail store.
+static void BM_CoverArtCacheScroll(benchmark::State& state) {
+    const bool useThumbnailStore = state.range(0) != 0;
+    constexpr int kNumRows = 200;
+    QTemporaryDir tempDir;
+    std::shared_ptr<const CoverArtThumbnailStore> pStore;
+    if (useThumbnailStore) {
+        pStore = std::make_shared<const CoverArtThumbnailStore>(QDir(tempDir.path()));
+    }
+    const QString coverLocation =
+            MixxxTest::getOrInitTestDir().filePath(kCoverLocationTest);
+    QList<CoverInfo> rows;
+    for (int i = 0; i < kNumRows; ++i) {
+        rows.append(coverInfoFromFile(coverLocation, i));
+        if (pStore) {
+            CoverArtCache::loadCover(nullptr,
+                    TrackPointer(),
+                    rows.last(),
+                    kThumbnailWidth,
+                    false,
+                    pStore);
+        }
+    }
+    int row = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(CoverArtCache::loadCover(nullptr,
+                TrackPointer(),
+                rows[row],
+                kThumbnailWidth,
+                false,
+                pStore));
+        row = (row + 1) % kNumRows;
+    }
+}
+BENCHMARK(BM_CoverArtCacheScroll)->Arg(0)->Arg(1);
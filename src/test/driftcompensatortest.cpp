@@ -0,0 +1,105 @@
+#include "soundio/driftcompensator.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "util/math.h"
+
+namespace {
+
+constexpr int kChannelCount = 2;
+constexpr SINT kFramesPerBuffer = 256;
+constexpr double kSampleRate = 48000;
+constexpr SINT kTargetFrames = 2 * kFramesPerBuffer;
+
+class DriftCompensatorTest : public testing::Test {
+  protected:
+    DriftCompensatorTest()
+            : m_fifo(kChannelCount * kFramesPerBuffer * 3),
+              m_compensator(kChannelCount, kFramesPerBuffer, kSampleRate),
+              m_producedFrames(0.0),
+              m_phase(0) {
+        // Prefill with 1.5 chunks of silence, like SoundDevicePortAudio
+        std::vector<CSAMPLE> silence(kChannelCount * kFramesPerBuffer * 3 / 2);
+        m_fifo.write(silence.data(), static_cast<int>(silence.size()));
+    }
+
+    /// Simulates the callbacks of the clock reference device, running
+    /// faster by driftPpm, and of the secondary device in alternating order.
+    /// Returns the number of missing frames.
+    SINT processCallbacks(double driftPpm, int callbacks, std::vector<CSAMPLE>* pOutput) {
+        std::vector<CSAMPLE> input(kChannelCount * kFramesPerBuffer * 2);
+        pOutput->resize(kChannelCount * kFramesPerBuffer);
+        SINT missingFrames = 0;
+        for (int i = 0; i < callbacks; ++i) {
+            m_producedFrames += kFramesPerBuffer * (1.0 + driftPpm / 1000000.0);
+            const auto frames = static_cast<SINT>(m_producedFrames);
+            m_producedFrames -= frames;
+            for (SINT frame = 0; frame < frames; ++frame) {
+                const auto sample = static_cast<CSAMPLE>(
+                        std::sin(2 * M_PI * 1000 * m_phase++ / kSampleRate));
+                input[frame * kChannelCount] = sample;
+                input[frame * kChannelCount + 1] = sample;
+            }
+            if (i % 2 == 0) {
+                m_fifo.write(input.data(), static_cast<int>(frames * kChannelCount));
+            }
+            m_compensator.updateFillLevel(m_fifo.readAvailable() / kChannelCount,
+                    kTargetFrames,
+                    kFramesPerBuffer);
+            if (i % 2 != 0) {
+                m_fifo.write(input.data(), static_cast<int>(frames * kChannelCount));
+            }
+            missingFrames += m_compensator.process(&m_fifo, pOutput->data(), kFramesPerBuffer);
+        }
+        return missingFrames;
+    }
+
+    FIFO<CSAMPLE> m_fifo;
+    DriftCompensator m_compensator;
+    double m_producedFrames;
+    SINT m_phase;
+};
+
+TEST_F(DriftCompensatorTest, followsFasterClockReference) {
+    std::vector<CSAMPLE> output;
+    // 60 s
+    EXPECT_EQ(0, processCallbacks(80, 60 * kSampleRate / kFramesPerBuffer, &output));
+    EXPECT_NEAR(80, m_compensator.driftPpm(), 2);
+    EXPECT_NEAR(kTargetFrames, m_fifo.readAvailable() / kChannelCount, kFramesPerBuffer);
+}
+
+TEST_F(DriftCompensatorTest, followsSlowerClockReference) {
+    std::vector<CSAMPLE> output;
+    EXPECT_EQ(0, processCallbacks(-80, 60 * kSampleRate / kFramesPerBuffer, &output));
+    EXPECT_NEAR(-80, m_compensator.driftPpm(), 2);
+    EXPECT_NEAR(kTargetFrames, m_fifo.readAvailable() / kChannelCount, kFramesPerBuffer);
+}
+
+TEST_F(DriftCompensatorTest, preservesSignal) {
+    std::vector<CSAMPLE> output;
+    processCallbacks(50, 10 * kSampleRate / kFramesPerBuffer, &output);
+    // The resampled 1 kHz sine keeps its amplitude
+    CSAMPLE peak = 0;
+    double sumOfSquares = 0;
+    for (SINT frame = 0; frame < kFramesPerBuffer; ++frame) {
+        EXPECT_FLOAT_EQ(output[frame * kChannelCount], output[frame * kChannelCount + 1]);
+        peak = math_max(peak, std::abs(output[frame * kChannelCount]));
+        sumOfSquares += output[frame * kChannelCount] * output[frame * kChannelCount];
+    }
+    EXPECT_NEAR(1.0, peak, 0.01);
+    EXPECT_NEAR(0.5, sumOfSquares / kFramesPerBuffer, 0.02);
+}
+
+TEST_F(DriftCompensatorTest, replacesMissingFramesBySilence) {
+    std::vector<CSAMPLE> output(kChannelCount * kFramesPerBuffer * 4, 1.0f);
+    // The prefilled 1.5 chunks of silence and the window of the filter
+    // are not sufficient for 4 chunks
+    EXPECT_LT(0, m_compensator.process(&m_fifo, output.data(), kFramesPerBuffer * 4));
+    for (CSAMPLE sample : output) {
+        EXPECT_EQ(0.0f, sample);
+    }
+}
+
+} // namespace
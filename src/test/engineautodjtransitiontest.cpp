@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+
+#include "engine/engineautodjtransition.h"
+#include "test/signalpathtest.h"
+#include "util/math.h"
+
+namespace {
+
+using State = AutoDJTransitionProgress::State;
+
+class EngineAutoDJTransitionTest : public SignalPathTest {
+  protected:
+    EngineAutoDJTransitionTest()
+            : m_pSchedule(m_pEngineMaster->getAutoDJTransitionSchedule()),
+              m_pCrossfader(std::make_unique<ControlProxy>(m_sMasterGroup, "crossfader")),
+              m_pPlay1(std::make_unique<ControlProxy>(m_sGroup1, "play")),
+              m_pPlay2(std::make_unique<ControlProxy>(m_sGroup2, "play")) {
+        m_pCrossfader->set(-1.0);
+        m_pPlay1->set(1.0);
+        ProcessBuffer();
+    }
+
+    ~EngineAutoDJTransitionTest() override {
+        m_pSchedule->clearPlan();
+    }
+
+    // Plans a transition from deck 1 on the left to deck 2 on the right
+    // that begins and ends after the given number of frames.
+    void scheduleTransition(double beginFrames, double endFrames) {
+        const auto position = playPosition();
+        AutoDJTransitionPlan plan;
+        plan.fromDeck = 0;
+        plan.toDeck = 1;
+        plan.fadeBeginPosition = position + beginFrames;
+        plan.fadeEndPosition = position + endFrames;
+        plan.crossfaderTarget = 1.0;
+        m_planId = m_pSchedule->setPlan(plan);
+    }
+
+    mixxx::audio::FramePos playPosition() const {
+        return m_pChannel1->getEngineBuffer()->getExactPlayPos();
+    }
+
+    static double framesPerBuffer() {
+        return kProcessBufferSize / mixxx::kEngineChannelCount;
+    }
+
+    QSharedPointer<AutoDJTransitionSchedule> m_pSchedule;
+    std::unique_ptr<ControlProxy> m_pCrossfader;
+    std::unique_ptr<ControlProxy> m_pPlay1;
+    std::unique_ptr<ControlProxy> m_pPlay2;
+    int m_planId = 0;
+};
+
+TEST_F(EngineAutoDJTransitionTest, EngineIsAttached) {
+    EXPECT_TRUE(m_pSchedule->isEngineAttached());
+}
+
+TEST_F(EngineAutoDJTransitionTest, ExecutesCrossfade) {
+    const double kBeginFrames = 10 * framesPerBuffer();
+    const double kEndFrames = 20 * framesPerBuffer();
+    scheduleTransition(kBeginFrames, kEndFrames);
+    const AutoDJTransitionPlan plan = m_pSchedule->plan();
+
+    double lastCrossfader = m_pCrossfader->get();
+    for (int i = 0; i < 30; ++i) {
+        ProcessBuffer();
+        const auto position = playPosition();
+        const AutoDJTransitionProgress progress = m_pSchedule->progress();
+        EXPECT_EQ(m_planId, progress.planId);
+
+        // The to deck is started in the callback that ends closest to the
+        // fade begin position.
+        const bool started = position + framesPerBuffer() / 2 >= plan.fadeBeginPosition;
+        EXPECT_EQ(started, m_pPlay2->toBool());
+
+        const double expectedProgress = math_clamp(
+                (position - plan.fadeBeginPosition) /
+                        (plan.fadeEndPosition - plan.fadeBeginPosition),
+                0.0,
+                1.0);
+        EXPECT_NEAR(expectedProgress, progress.progress, 1e-9);
+        EXPECT_NEAR(-1.0 + 2.0 * expectedProgress, m_pCrossfader->get(), 1e-9);
+        EXPECT_GE(m_pCrossfader->get(), lastCrossfader);
+        lastCrossfader = m_pCrossfader->get();
+    }
+
+    EXPECT_EQ(State::Done, m_pSchedule->progress().state);
+    EXPECT_DOUBLE_EQ(1.0, m_pCrossfader->get());
+    EXPECT_FALSE(m_pPlay1->toBool());
+    EXPECT_TRUE(m_pPlay2->toBool());
+}
+
+TEST_F(EngineAutoDJTransitionTest, JumpCut) {
+    const double kBeginFrames = 5 * framesPerBuffer();
+    scheduleTransition(kBeginFrames, kBeginFrames);
+
+    for (int i = 0; i < 3; ++i) {
+        ProcessBuffer();
+    }
+    EXPECT_EQ(State::Waiting, m_pSchedule->progress().state);
+    EXPECT_DOUBLE_EQ(-1.0, m_pCrossfader->get());
+
+    for (int i = 0; i < 3; ++i) {
+        ProcessBuffer();
+    }
+    EXPECT_EQ(State::Done, m_pSchedule->progress().state);
+    EXPECT_DOUBLE_EQ(1.0, m_pCrossfader->get());
+    EXPECT_FALSE(m_pPlay1->toBool());
+    EXPECT_TRUE(m_pPlay2->toBool());
+}
+
+TEST_F(EngineAutoDJTransitionTest, ClearedPlanIsNotExecuted) {
+    scheduleTransition(2 * framesPerBuffer(), 4 * framesPerBuffer());
+    ProcessBuffer();
+    m_pSchedule->clearPlan();
+
+    for (int i = 0; i < 6; ++i) {
+        ProcessBuffer();
+    }
+    EXPECT_EQ(State::Idle, m_pSchedule->progress().state);
+    EXPECT_DOUBLE_EQ(-1.0, m_pCrossfader->get());
+    EXPECT_TRUE(m_pPlay1->toBool());
+    EXPECT_FALSE(m_pPlay2->toBool());
+}
+
+TEST_F(EngineAutoDJTransitionTest, ReversedCrossfader) {
+    ControlObject::set(ConfigKey("[Mixer Profile]", "xFaderReverse"), 1.0);
+    // Deck 1 is audible with the reversed crossfader on the right side
+    m_pCrossfader->set(1.0);
+    scheduleTransition(framesPerBuffer(), 3 * framesPerBuffer());
+
+    for (int i = 0; i < 6; ++i) {
+        ProcessBuffer();
+    }
+    EXPECT_EQ(State::Done, m_pSchedule->progress().state);
+    EXPECT_DOUBLE_EQ(-1.0, m_pCrossfader->get());
+}
+
+} // namespace
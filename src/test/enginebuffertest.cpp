@@ -236,6 +236,27 @@ TEST_F(EngineBufferE2ETest, BasicProcessingTest) {
                                  kProcessBufferSize, "BasicProcessingTestPause");
 }
 
+TEST_F(RealtimeSafeSignalPathTest, PlayingIsRealtimeSafe) {
+    ControlObject::set(ConfigKey(m_sGroup1, "rate"), 0.05);
+    ControlObject::set(ConfigKey(m_sGroup1, "play"), 1.0);
+    // Let the deck ramp up and the reader fill its cache before checking
+    // the steady state.
+    for (int i = 0; i < 4; ++i) {
+        ProcessBuffer();
+    }
+    // When the reader has queued a chunk request the callback wakes the
+    // worker scheduler, and QWaitCondition::wakeAll() briefly takes the
+    // internal mutex of the wait condition. This is the designed hand-off
+    // to the reader thread. The scheduler thread only holds that mutex
+    // while entering or leaving its wait, never while reading from disk.
+    tolerateViolations({QStringLiteral("EngineWorkerScheduler::runWorkers")});
+    EXPECT_TRUE(isRealtimeSafe([this] {
+        for (int i = 0; i < 10; ++i) {
+            ProcessBuffer();
+        }
+    }));
+}
+
 TEST_F(EngineBufferE2ETest, ScratchTest) {
     // Confirm that vinyl scratching smoothly transitions from one direction
     // to the other.
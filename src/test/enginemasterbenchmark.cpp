@@ -0,0 +1,131 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "test/rtsafetytest.h"
+#include "test/signalpathtest.h"
+#include "util/performancetimer.h"
+
+namespace {
+
+using mixxxtest::RealtimeSafetyMonitor;
+using mixxxtest::RealtimeSafetyViolation;
+
+/// Runs the complete engine without a sound device: EngineMaster with
+/// three decks that have a track loaded, as in SignalPathTest. The
+/// callbacks are processed back to back, as fast as possible.
+///
+/// Run the benchmarks with
+///   mixxx-test --benchmark --benchmark_filter=BM_EngineMaster \
+///           --benchmark_out=engine.json --benchmark_out_format=json
+/// and compare the results of two commits with
+///   lib/benchmark/tools/compare.py benchmarks before.json after.json
+class EngineMasterBenchmark : public SignalPathTest {
+  public:
+    EngineMasterBenchmark(int numPlayingDecks, bool keylock, bool sync) {
+        const QString groups[] = {m_sGroup1, m_sGroup2, m_sGroup3};
+        for (int i = 0; i < numPlayingDecks; ++i) {
+            // Keep the decks playing, no matter how many callbacks the
+            // benchmark processes
+            ControlObject::set(ConfigKey(groups[i], "repeat"), 1.0);
+            ControlObject::set(ConfigKey(groups[i], "keylock"), keylock ? 1.0 : 0.0);
+            // Pitch the decks apart, otherwise the scalers have nothing to do
+            ControlObject::set(ConfigKey(groups[i], "rate"), 0.02 * (i + 1));
+            ControlObject::set(ConfigKey(groups[i], "sync_enabled"), sync ? 1.0 : 0.0);
+            ControlObject::set(ConfigKey(groups[i], "play"), 1.0);
+        }
+        // Let the decks ramp up and the readers fill their caches
+        for (int i = 0; i < 16; ++i) {
+            process();
+        }
+    }
+
+    void TestBody() override {
+    }
+
+    void process() {
+        m_pEngineMaster->process(kProcessBufferSize);
+    }
+
+    static int samplesPerCallback() {
+        return kProcessBufferSize;
+    }
+};
+
+// The number of callbacks in which allocations and locks are counted
+constexpr int kNumCountedCallbacks = 64;
+
+qint64 percentile(const std::vector<qint64>& sortedValues, double fraction) {
+    DEBUG_ASSERT(!sortedValues.empty());
+    const auto index = static_cast<std::size_t>(fraction * (sortedValues.size() - 1));
+    return sortedValues[index];
+}
+
+/// Arguments: number of playing decks, keylock, sync
+///
+/// Besides the average time of a callback the benchmark reports the
+/// percentiles of the callback durations, because the worst callbacks
+/// cause the xruns. Comparing the variants, e.g. with and without keylock,
+/// attributes the time to the stages of the engine.
+///
+/// The allocations and locks per callback are counted after the timed
+/// callbacks, because recording them slows the callback down. They are
+/// only reported if mixxx-test is built with RTSAFETY_TESTS.
+static void BM_EngineMasterProcess(benchmark::State& state) {
+    EngineMasterBenchmark engine(static_cast<int>(state.range(0)),
+            state.range(1) != 0,
+            state.range(2) != 0);
+
+    std::vector<qint64> callbackNanos;
+    callbackNanos.reserve(static_cast<std::size_t>(state.max_iterations));
+    PerformanceTimer timer;
+    for (auto _ : state) {
+        timer.start();
+        engine.process();
+        callbackNanos.push_back(timer.elapsed().toIntegerNanos());
+    }
+
+    std::sort(callbackNanos.begin(), callbackNanos.end());
+    if (!callbackNanos.empty()) {
+        state.counters["p50_us"] = percentile(callbackNanos, 0.5) / 1000.0;
+        state.counters["p99_us"] = percentile(callbackNanos, 0.99) / 1000.0;
+        state.counters["max_us"] = callbackNanos.back() / 1000.0;
+    }
+
+    if (RealtimeSafetyMonitor::isEnabled()) {
+        RealtimeSafetyMonitor::arm();
+        for (int i = 0; i < kNumCountedCallbacks; ++i) {
+            engine.process();
+        }
+        RealtimeSafetyMonitor::disarm();
+
+        int numAllocations = 0;
+        int numLocks = 0;
+        const auto violations = RealtimeSafetyMonitor::violations();
+        for (const auto& violation : violations) {
+            if (violation.type == RealtimeSafetyViolation::Type::Lock) {
+                numLocks += violation.count;
+            } else {
+                numAllocations += violation.count;
+            }
+        }
+        state.counters["allocs"] = static_cast<double>(numAllocations) / kNumCountedCallbacks;
+        state.counters["locks"] = static_cast<double>(numLocks) / kNumCountedCallbacks;
+    } else {
+        state.SetLabel("allocs/locks not counted without RTSAFETY_TESTS");
+    }
+    state.SetItemsProcessed(
+            state.iterations() * EngineMasterBenchmark::samplesPerCallback());
+}
+BENCHMARK(BM_EngineMasterProcess)
+        ->ArgNames({"decks", "keylock", "sync"})
+        ->Args({0, 0, 0})
+        ->Args({1, 0, 0})
+        ->Args({3, 0, 0})
+        ->Args({3, 1, 0})
+        ->Args({3, 0, 1})
+        ->Args({3, 1, 1})
+        ->Unit(benchmark::kMicrosecond);
+
+} // anonymous namespace
@@ -7,6 +7,7 @@
 #include "engine/channels/enginechannel.h"
 #include "engine/enginemaster.h"
 #include "test/mixxxtest.h"
+#include "test/rtsafetytest.h"
 #include "test/signalpathtest.h"
 #include "util/defs.h"
 #include "util/sample.h"
@@ -391,4 +392,20 @@ TEST_F(EngineMasterTest, ThreeChannelPFLOutputWorks) {
     assertHeadphoneBufferMatchesGolden(testName);
 }
 
+class EngineMasterRealtimeSafetyTest
+        : public mixxxtest::RealtimeSafetyTest<EngineMasterTest> {};
+
+TEST_F(EngineMasterRealtimeSafetyTest, IdleMixIsRealtimeSafe) {
+    // The first callbacks perform one-time setup like naming the thread.
+    ProcessBuffer();
+    ProcessBuffer();
+
+    // Mixing the idle decks must neither allocate nor lock.
+    EXPECT_TRUE(isRealtimeSafe([this] {
+        for (int i = 0; i < 10; ++i) {
+            ProcessBuffer();
+        }
+    }));
+}
+
 }  // namespace
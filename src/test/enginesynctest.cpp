@@ -1,10 +1,13 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cmath>
 #include <string>
 
 #include "control/controlobject.h"
 #include "engine/controls/bpmcontrol.h"
+#include "engine/engine.h"
 #include "engine/sync/synccontrol.h"
 #include "mixer/basetrackplayer.h"
 #include "preferences/usersettings.h"
@@ -17,6 +20,22 @@ namespace {
 constexpr double kMaxFloatingPointErrorLowPrecision = 0.005;
 constexpr double kMaxFloatingPointErrorHighPrecision = 0.0000000000000005;
 constexpr double kMaxBeatDistanceEpsilon = 1e-9;
+
+/// Describes how well a follower is pulled into phase with its leader.
+struct SyncDriftMetrics {
+    /// The phase error in beats before the first measured buffer
+    double initialPhaseError = 0.0;
+    /// The phase error in beats after the last measured buffer
+    double finalPhaseError = 0.0;
+    /// The largest phase error in beats after the follower was in phase
+    double maxPhaseErrorInPhase = 0.0;
+    /// The index of the buffer after which the phase error stayed below the
+    /// threshold, or -1 if the follower did not get into phase.
+    int buffersUntilInPhase = -1;
+    /// The largest change of the follower speed between two buffers, which
+    /// is audible as wobble.
+    double maxSpeedStep = 0.0;
+};
 } // namespace
 
 /// Tests for Sync Lock.
@@ -92,6 +111,77 @@ class EngineSyncTest : public MockedEngineBackendTest {
         EXPECT_EQ(NULL, m_pEngineSync->getLeaderSyncable());
     }
 
+    double phaseError(const QString& leaderGroup, const QString& followerGroup) {
+        return BpmControl::shortestPercentageChange(
+                ControlObject::get(ConfigKey(leaderGroup, "beat_distance")),
+                ControlObject::get(ConfigKey(followerGroup, "beat_distance")));
+    }
+
+    /// Processes the given number of buffers and collects the phase error
+    /// of the follower relative to the leader after each of them.
+    SyncDriftMetrics measureSyncDrift(const QString& leaderGroup,
+            const QString& followerGroup,
+            EngineBuffer* pFollowerBuffer,
+            int numBuffers,
+            double inPhaseThreshold) {
+        SyncDriftMetrics metrics;
+        metrics.initialPhaseError = phaseError(leaderGroup, followerGroup);
+        double previousSpeed = pFollowerBuffer->getSpeed();
+        for (int i = 0; i < numBuffers; ++i) {
+            ProcessBuffer();
+            const double error = phaseError(leaderGroup, followerGroup);
+            const double speed = pFollowerBuffer->getSpeed();
+            metrics.maxSpeedStep = std::max(metrics.maxSpeedStep,
+                    std::fabs(speed - previousSpeed));
+            previousSpeed = speed;
+            if (std::fabs(error) >= inPhaseThreshold) {
+                metrics.buffersUntilInPhase = -1;
+                metrics.maxPhaseErrorInPhase = 0.0;
+            } else {
+                if (metrics.buffersUntilInPhase < 0) {
+                    metrics.buffersUntilInPhase = i;
+                }
+                metrics.maxPhaseErrorInPhase = std::max(
+                        metrics.maxPhaseErrorInPhase, std::fabs(error));
+            }
+            metrics.finalPhaseError = error;
+        }
+        return metrics;
+    }
+
+    /// Lets deck 2 follow deck 1 at the same tempo, but with its beats
+    /// shifted by the given fraction of a beat. Quantize is enabled on the
+    /// follower only after both decks play, so the phase is not fixed by a
+    /// seek and needs to be corrected by the sync adjustment.
+    void setUpFollowerOutOfPhase(double phaseOffsetBeats) {
+        constexpr auto kBpm = mixxx::Bpm(128);
+        mixxx::BeatsPointer pBeats1 = mixxx::Beats::fromConstTempo(
+                m_pTrack1->getSampleRate(), mixxx::audio::kStartFramePos, kBpm);
+        m_pTrack1->trySetBeats(pBeats1);
+        const double beatLengthFrames = 60.0 * m_pTrack2->getSampleRate() / kBpm.value();
+        mixxx::BeatsPointer pBeats2 = mixxx::Beats::fromConstTempo(
+                m_pTrack2->getSampleRate(),
+                mixxx::audio::FramePos(std::round(phaseOffsetBeats * beatLengthFrames)),
+                kBpm);
+        m_pTrack2->trySetBeats(pBeats2);
+
+        ControlObject::set(ConfigKey(m_sGroup1, "sync_mode"),
+                static_cast<double>(SyncMode::LeaderExplicit));
+        ControlObject::set(ConfigKey(m_sGroup2, "sync_mode"),
+                static_cast<double>(SyncMode::Follower));
+        ControlObject::set(ConfigKey(m_sGroup1, "playposition"), 0.2);
+        ControlObject::set(ConfigKey(m_sGroup2, "playposition"), 0.2);
+        ControlObject::set(ConfigKey(m_sGroup1, "play"), 1.0);
+        ControlObject::set(ConfigKey(m_sGroup2, "play"), 1.0);
+        ProcessBuffer();
+        ControlObject::set(ConfigKey(m_sGroup2, "quantize"), 1.0);
+    }
+
+    double bufferSeconds() {
+        return kProcessBufferSize / mixxx::kEngineChannelCount /
+                ControlObject::get(ConfigKey("[Master]", "samplerate"));
+    }
+
   private:
     bool isLeader(const QString& group, SyncMode leaderType) {
         if (group == m_sInternalClockGroup) {
@@ -3021,3 +3111,63 @@ TEST_F(EngineSyncTest, ImplicitLeaderToInternalClock) {
     ASSERT_FALSE(isSoftLeader(m_sGroup2));
     ASSERT_FALSE(isSoftLeader(m_sInternalClockGroup));
 }
+
+TEST_F(EngineSyncTest, PredictiveSyncRemovesPhaseError) {
+    ControlObject::set(ConfigKey(m_sInternalClockGroup, "sync_predictive"), 1.0);
+    setUpFollowerOutOfPhase(0.1);
+
+    const SyncDriftMetrics metrics = measureSyncDrift(m_sGroup1,
+            m_sGroup2,
+            m_pChannel2->getEngineBuffer(),
+            500,
+            kMaxFloatingPointErrorLowPrecision);
+    EXPECT_GT(std::fabs(metrics.initialPhaseError), 0.05);
+    EXPECT_LT(std::fabs(metrics.finalPhaseError), kMaxFloatingPointErrorLowPrecision);
+    EXPECT_GE(metrics.buffersUntilInPhase, 0);
+    // The phase must not oscillate around the leader once it is reached.
+    EXPECT_LT(metrics.maxPhaseErrorInPhase, kMaxFloatingPointErrorLowPrecision);
+    // The speed is pulled smoothly instead of in steps.
+    EXPECT_LE(metrics.maxSpeedStep, bufferSeconds() + kMaxBeatDistanceEpsilon);
+}
+
+TEST_F(EngineSyncTest, PredictiveSyncWithKeylockRampsTempo) {
+    ControlObject::set(ConfigKey(m_sInternalClockGroup, "sync_predictive"), 1.0);
+    ControlObject::set(ConfigKey(m_sGroup2, "keylock"), 1.0);
+    setUpFollowerOutOfPhase(0.1);
+
+    const SyncDriftMetrics metrics = measureSyncDrift(m_sGroup1,
+            m_sGroup2,
+            m_pChannel2->getEngineBuffer(),
+            500,
+            kMaxFloatingPointErrorLowPrecision);
+    EXPECT_LT(std::fabs(metrics.finalPhaseError), kMaxFloatingPointErrorLowPrecision);
+    EXPECT_GE(metrics.buffersUntilInPhase, 0);
+    EXPECT_LE(metrics.maxSpeedStep, bufferSeconds() + kMaxBeatDistanceEpsilon);
+    // The keylock scaler ends each buffer with the tempo of the deck.
+    EXPECT_DOUBLE_EQ(m_pChannel2->getEngineBuffer()->getSpeed(),
+            m_pMockScaleKeylock2->getProcessedTempo());
+}
+
+TEST_F(EngineSyncTest, PredictiveSyncConvergesFasterThanProportionalSync) {
+    setUpFollowerOutOfPhase(0.1);
+    const SyncDriftMetrics proportional = measureSyncDrift(m_sGroup1,
+            m_sGroup2,
+            m_pChannel2->getEngineBuffer(),
+            500,
+            kMaxFloatingPointErrorLowPrecision);
+
+    // Restart with the same phase error, now with predictive sync.
+    ControlObject::set(ConfigKey(m_sGroup2, "quantize"), 0.0);
+    ControlObject::set(ConfigKey(m_sInternalClockGroup, "sync_predictive"), 1.0);
+    setUpFollowerOutOfPhase(0.1);
+    const SyncDriftMetrics predictive = measureSyncDrift(m_sGroup1,
+            m_sGroup2,
+            m_pChannel2->getEngineBuffer(),
+            500,
+            kMaxFloatingPointErrorLowPrecision);
+
+    // The proportional control stops correcting within its dead band, the
+    // predictive control keeps following the leader.
+    EXPECT_LE(std::fabs(predictive.finalPhaseError), std::fabs(proportional.finalPhaseError));
+    EXPECT_LE(predictive.maxSpeedStep, proportional.maxSpeedStep);
+}
@@ -0,0 +1,155 @@
+#include "util/fifo.h"
+
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <thread>
+#include <vector>
+
+namespace {
+
+TEST(FifoTest, capacityIsRoundedUpToPowerOf2) {
+    FIFO<int> fifo(100);
+    EXPECT_EQ(128, fifo.capacity());
+    EXPECT_EQ(0, fifo.readAvailable());
+    EXPECT_EQ(128, fifo.writeAvailable());
+}
+
+TEST(FifoTest, readAndWriteWrapAround) {
+    FIFO<int> fifo(8);
+    std::vector<int> input(6);
+    std::iota(input.begin(), input.end(), 0);
+    std::vector<int> output(6);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(6, fifo.write(input.data(), 6));
+        EXPECT_EQ(6, fifo.readAvailable());
+        EXPECT_EQ(6, fifo.read(output.data(), 6));
+        EXPECT_EQ(input, output);
+    }
+}
+
+TEST(FifoTest, writeIsLimitedByWriteAvailable) {
+    FIFO<int> fifo(8);
+    std::vector<int> input(10, 1);
+    EXPECT_EQ(8, fifo.write(input.data(), 10));
+    EXPECT_EQ(0, fifo.write(input.data(), 1));
+    EXPECT_EQ(2, fifo.flushReadData(2));
+    EXPECT_EQ(2, fifo.writeAvailable());
+}
+
+TEST(FifoTest, regionsSplitAtTheEndOfTheBuffer) {
+    FIFO<int> fifo(8);
+    std::vector<int> input(5, 0);
+    fifo.write(input.data(), 5);
+    fifo.flushReadData(5);
+
+    auto writeRegions = fifo.reserveWrite(6);
+    ASSERT_EQ(3u, writeRegions.first.size());
+    ASSERT_EQ(3u, writeRegions.second.size());
+    std::iota(writeRegions.first.begin(), writeRegions.first.end(), 0);
+    std::iota(writeRegions.second.begin(), writeRegions.second.end(), 3);
+    // Nothing is visible before the commit
+    EXPECT_EQ(0, fifo.readAvailable());
+    fifo.commitWrite(writeRegions.size());
+    EXPECT_EQ(6, fifo.readAvailable());
+
+    const auto readRegions = fifo.reserveRead(8);
+    ASSERT_EQ(6, readRegions.size());
+    EXPECT_EQ(0, readRegions.first[0]);
+    EXPECT_EQ(3, readRegions.second[0]);
+    EXPECT_EQ(5, readRegions.second[2]);
+    fifo.commitRead(readRegions.size());
+    EXPECT_EQ(0, fifo.readAvailable());
+}
+
+TEST(FifoTest, writeBlockingWaitsForTheConsumer) {
+    constexpr int kCount = 10000;
+    FIFO<int> fifo(16);
+    std::thread producer([&fifo] {
+        for (int i = 0; i < kCount; ++i) {
+            fifo.writeBlocking(&i, 1);
+        }
+    });
+    for (int i = 0; i < kCount; ++i) {
+        fifo.waitReadAvailable(1);
+        int value = -1;
+        ASSERT_EQ(1, fifo.read(&value, 1));
+        ASSERT_EQ(i, value);
+    }
+    producer.join();
+}
+
+/// Arguments: elements per batch
+static void BM_FifoWriteRead(benchmark::State& state) {
+    const auto batchSize = static_cast<int>(state.range(0));
+    FIFO<float> fifo(4096);
+    std::vector<float> buffer(batchSize);
+    for (auto _ : state) {
+        fifo.write(buffer.data(), batchSize);
+        fifo.read(buffer.data(), batchSize);
+        benchmark::DoNotOptimize(buffer.data());
+    }
+    state.SetItemsProcessed(state.iterations() * batchSize);
+}
+BENCHMARK(BM_FifoWriteRead)->Range(1, 2048);
+
+/// Throughput between a producer and a consumer thread. The consumer waits
+/// for data when the FIFO runs empty.
+///
+/// Arguments: elements per batch
+static void BM_FifoThroughput(benchmark::State& state) {
+    const auto batchSize = static_cast<int>(state.range(0));
+    FIFO<float> fifo(4 * batchSize);
+    std::atomic<bool> stop(false);
+    std::thread producer([&fifo, &stop, batchSize] {
+        std::vector<float> buffer(batchSize);
+        while (!stop.load(std::memory_order_relaxed)) {
+            const auto regions = fifo.reserveWrite(batchSize);
+            std::fill(regions.first.begin(), regions.first.end(), 1.0f);
+            std::fill(regions.second.begin(), regions.second.end(), 1.0f);
+            fifo.commitWrite(regions.size());
+        }
+    });
+    float sum = 0;
+    for (auto _ : state) {
+        fifo.waitReadAvailable(batchSize);
+        const auto regions = fifo.reserveRead(batchSize);
+        sum = std::accumulate(regions.first.begin(), regions.first.end(), sum);
+        sum = std::accumulate(regions.second.begin(), regions.second.end(), sum);
+        fifo.commitRead(regions.size());
+    }
+    stop.store(true);
+    producer.join();
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations() * batchSize);
+}
+BENCHMARK(BM_FifoThroughput)->Range(64, 4096)->UseRealTime();
+
+/// Round trip latency of a single element through two FIFOs with a
+/// blocking echo thread.
+static void BM_FifoRoundTripLatency(benchmark::State& state) {
+    FIFO<int> request(16);
+    FIFO<int> response(16);
+    std::thread echo([&request, &response] {
+        int value = 0;
+        while (value >= 0) {
+            request.waitReadAvailable(1);
+            request.read(&value, 1);
+            response.write(&value, 1);
+        }
+    });
+    int value = 0;
+    for (auto _ : state) {
+        request.write(&value, 1);
+        response.waitReadAvailable(1);
+        response.read(&value, 1);
+        ++value;
+    }
+    value = -1;
+    request.write(&value, 1);
+    echo.join();
+}
+BENCHMARK(BM_FifoRoundTripLatency)->UseRealTime();
+
+} // namespace
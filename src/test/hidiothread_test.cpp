@@ -0,0 +1,164 @@
+#include "controllers/hid/hidiothread.h"
+
+#include <gtest/gtest.h>
+
+#include <QByteArray>
+
+#include "controllers/hid/hidiooutputreport.h"
+
+namespace {
+
+constexpr int kReportSize = 8;
+
+const RuntimeLoggingCategory kLogger(QString("test").toLocal8Bit());
+
+mixxx::Duration millis(qint64 millis) {
+    return mixxx::Duration::fromMillis(millis);
+}
+
+mixxx::hid::DeviceInfo makeDeviceInfo() {
+    hid_device_info info{};
+    info.path = const_cast<char*>("test");
+    info.serial_number = const_cast<wchar_t*>(L"1");
+    info.manufacturer_string = const_cast<wchar_t*>(L"Mixxx");
+    info.product_string = const_cast<wchar_t*>(L"Test");
+    return mixxx::hid::DeviceInfo(info);
+}
+
+/// Selects the output reports like the run loop of HidIoThread, without
+/// writing them to a device.
+class HidIoOutputReportSchedulingTest : public testing::Test {
+  protected:
+    HidIoOutputReportSchedulingTest()
+            : m_deviceInfo(makeDeviceInfo()),
+              m_lastSentIt(m_reports.end()),
+              m_nextData(0) {
+    }
+
+    void addReport(quint8 reportId, mixxx::Duration minimumInterval, int priority) {
+        auto& pReport = m_reports[reportId];
+        pReport = std::make_unique<HidIoOutputReport>(reportId, kReportSize);
+        pReport->setSchedule(minimumInterval, priority);
+    }
+
+    /// Caches data that differ from all previous data
+    void cacheData(quint8 reportId) {
+        m_reports.at(reportId)->updateCachedData(
+                QByteArray(kReportSize, static_cast<char>(++m_nextData)),
+                m_deviceInfo,
+                kLogger,
+                false);
+    }
+
+    /// Returns the id of the report that is sent, or -1 if none is ready
+    int sendNext(mixxx::Duration now) {
+        const auto it = HidIoThread::selectNextOutputReport(
+                m_reports, m_lastSentIt, now, false);
+        if (it == m_reports.end()) {
+            return -1;
+        }
+        m_lastSentIt = it;
+        EXPECT_TRUE(it->second->takeCachedData(now, m_deviceInfo, kLogger));
+        return it->first;
+    }
+
+    HidIoOutputReport* report(quint8 reportId) {
+        return m_reports.at(reportId).get();
+    }
+
+    const mixxx::hid::DeviceInfo m_deviceInfo;
+    HidIoThread::OutputReportMap m_reports;
+    HidIoThread::OutputReportMapIterator m_lastSentIt;
+    int m_nextData;
+};
+
+TEST_F(HidIoOutputReportSchedulingTest, NothingCached) {
+    addReport(1, millis(0), 0);
+    EXPECT_EQ(-1, sendNext(millis(1)));
+}
+
+TEST_F(HidIoOutputReportSchedulingTest, HigherPriorityFirst) {
+    addReport(1, millis(0), 0);
+    addReport(2, millis(0), 1);
+    addReport(3, millis(0), 0);
+    cacheData(1);
+    cacheData(2);
+    cacheData(3);
+
+    EXPECT_EQ(2, sendNext(millis(1)));
+    // Then the reports with the same priority in turn after the last one
+    EXPECT_EQ(3, sendNext(millis(1)));
+    EXPECT_EQ(1, sendNext(millis(1)));
+    EXPECT_EQ(-1, sendNext(millis(1)));
+}
+
+TEST_F(HidIoOutputReportSchedulingTest, SamePriorityTakesTurns) {
+    addReport(1, millis(0), 0);
+    addReport(2, millis(0), 0);
+    addReport(3, millis(0), 0);
+    cacheData(1);
+    cacheData(2);
+    cacheData(3);
+
+    // A report that is updated all the time does not starve the others
+    EXPECT_EQ(1, sendNext(millis(1)));
+    cacheData(1);
+    EXPECT_EQ(2, sendNext(millis(2)));
+    cacheData(1);
+    EXPECT_EQ(3, sendNext(millis(3)));
+    cacheData(1);
+    EXPECT_EQ(1, sendNext(millis(4)));
+    EXPECT_EQ(-1, sendNext(millis(5)));
+}
+
+TEST_F(HidIoOutputReportSchedulingTest, MinimumIntervalYieldsToLowerPriority) {
+    addReport(1, millis(10), 1);
+    addReport(2, millis(0), 0);
+    cacheData(1);
+    cacheData(2);
+
+    EXPECT_EQ(1, sendNext(millis(1)));
+    cacheData(1);
+    // The report with the higher priority waits for its interval
+    EXPECT_EQ(2, sendNext(millis(2)));
+    cacheData(2);
+    EXPECT_EQ(2, sendNext(millis(5)));
+    cacheData(2);
+    EXPECT_EQ(1, sendNext(millis(11)));
+    EXPECT_EQ(2, sendNext(millis(11)));
+}
+
+TEST_F(HidIoOutputReportSchedulingTest, MinimumIntervalIsEnforced) {
+    addReport(1, millis(10), 0);
+    cacheData(1);
+    EXPECT_EQ(1, sendNext(millis(1)));
+
+    // Data cached within the interval supersede each other
+    cacheData(1);
+    EXPECT_EQ(-1, sendNext(millis(5)));
+    cacheData(1);
+    EXPECT_FALSE(report(1)->isReadyToSend(millis(10), false));
+    EXPECT_TRUE(report(1)->isReadyToSend(millis(10), true));
+
+    EXPECT_EQ(1, sendNext(millis(11)));
+    EXPECT_EQ(-1, sendNext(millis(30)));
+    EXPECT_EQ(1, report(1)->takeNumSkippedReports());
+}
+
+TEST_F(HidIoOutputReportSchedulingTest, UnchangedDataIsSkipped) {
+    addReport(1, millis(0), 0);
+    const QByteArray data(kReportSize, 'a');
+    report(1)->updateCachedData(data, m_deviceInfo, kLogger, false);
+    EXPECT_EQ(1, sendNext(millis(1)));
+
+    report(1)->updateCachedData(data, m_deviceInfo, kLogger, false);
+    EXPECT_TRUE(report(1)->isReadyToSend(millis(2), false));
+    EXPECT_FALSE(report(1)->takeCachedData(millis(2), m_deviceInfo, kLogger));
+    EXPECT_FALSE(report(1)->isReadyToSend(millis(3), false));
+
+    // Unless the mapping requests to resend it
+    report(1)->updateCachedData(data, m_deviceInfo, kLogger, true);
+    EXPECT_TRUE(report(1)->takeCachedData(millis(3), m_deviceInfo, kLogger));
+}
+
+} // namespace
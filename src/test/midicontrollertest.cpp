@@ -1,3 +1,4 @@
+#include <benchmark/benchmark.h>
 #include <gmock/gmock.h>
 
 #include <QScopedPointer>
@@ -18,6 +19,8 @@ class MockMidiController : public MidiController {
     }
     ~MockMidiController() override { }
 
+    using MidiController::receivedShortMessage;
+
     MOCK_METHOD0(open, int());
     MOCK_METHOD0(close, int());
     MOCK_METHOD3(sendShortMsg, void(unsigned char status,
@@ -596,3 +599,71 @@ TEST_F(MidiControllerTest, ReceiveMessage_PotMeterCO_14BitPitchBend) {
     receivedShortMessage(MidiOpCode::PitchBendChange, channel, 0x01, 0x40);
     EXPECT_LT(kMiddleValue, potmeter.get());
 }
+
+TEST_F(MidiControllerTest, ReceiveMessage_ControlCreatedAfterMapping) {
+    ConfigKey key("[Channel1]", "playposition");
+    unsigned char channel = 0x01;
+    unsigned char control = 0x10;
+
+    addMapping(MidiInputMapping(
+            MidiKey(MidiUtils::statusFromOpCodeAndChannel(
+                            MidiOpCode::ControlChange, channel),
+                    control),
+            MidiOptions(),
+            key));
+    m_pController->setMapping(m_pMapping->clone());
+
+    // The control does not exist yet and the message is ignored.
+    receivedShortMessage(MidiOpCode::ControlChange, channel, control, 0x7F);
+
+    {
+        ControlPotmeter potmeter(key, 0.0, 1.0);
+        receivedShortMessage(MidiOpCode::ControlChange, channel, control, 0x7F);
+        EXPECT_DOUBLE_EQ(1.0, potmeter.get());
+    }
+
+    // The control is created again after it has been deleted
+    ControlPotmeter potmeter(key, 0.0, 1.0);
+    receivedShortMessage(MidiOpCode::ControlChange, channel, control, 0x7F);
+    EXPECT_DOUBLE_EQ(1.0, potmeter.get());
+    receivedShortMessage(MidiOpCode::ControlChange, channel, control, 0x00);
+    EXPECT_DOUBLE_EQ(0.0, potmeter.get());
+}
+
+static void BM_MidiControllerReceiveJogMessages(benchmark::State& state) {
+    const int numMappings = static_cast<int>(state.range(0));
+    const unsigned char channel = 0x01;
+    const unsigned char jogControl = 0x22;
+    const unsigned char jogStatus = MidiUtils::statusFromOpCodeAndChannel(
+            MidiOpCode::ControlChange, channel);
+
+    auto pMapping = std::make_shared<LegacyMidiControllerMapping>();
+    std::vector<std::unique_ptr<ControlPotmeter>> controls;
+    for (int i = 0; i < numMappings; ++i) {
+        const ConfigKey key("[Test]", QStringLiteral("control_%1").arg(i));
+        controls.push_back(std::make_unique<ControlPotmeter>(key, -1000.0, 1000.0));
+        // Use all channels and controls except for the jog wheel
+        const MidiKey midiKey(
+                MidiUtils::statusFromOpCodeAndChannel(
+                        MidiOpCode::ControlChange, static_cast<unsigned char>(i % 15 + 2)),
+                static_cast<unsigned char>(i / 15 % 128));
+        pMapping->addInputMapping(midiKey.key, MidiInputMapping(midiKey, MidiOptions(), key));
+    }
+    const ConfigKey jogKey("[Test]", "jog");
+    ControlPotmeter jog(jogKey, -1000.0, 1000.0);
+    const MidiKey jogMidiKey(jogStatus, jogControl);
+    pMapping->addInputMapping(jogMidiKey.key,
+            MidiInputMapping(jogMidiKey, MidiOptions(MidiOption::Diff), jogKey));
+
+    MockMidiController controller;
+    controller.setMapping(pMapping);
+
+    // A jog wheel that is turned back and forth
+    unsigned char value = 0x01;
+    for (auto _ : state) {
+        controller.receivedShortMessage(jogStatus, jogControl, value, mixxx::Duration());
+        value = value == 0x01 ? 0x7F : 0x01;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MidiControllerReceiveJogMessages)->Arg(16)->Arg(1024);
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+
+#include <QSignalSpy>
+#include <QSqlQuery>
+
+#include "library/dao/playlistdao.h"
+#include "library/dao/stemsmixdao.h"
+#include "library/trackcollection.h"
+#include "test/librarytest.h"
+
+namespace {
+
+QList<TrackId> trackIds(std::initializer_list<int> ids) {
+    QList<TrackId> result;
+    for (const int id : ids) {
+        result.append(TrackId(id));
+    }
+    return result;
+}
+
+class PlaylistDAOTest : public LibraryTest {
+  protected:
+    PlaylistDAOTest()
+            : m_playlistDao(internalCollection()->getPlaylistDAO()) {
+        m_playlistId = m_playlistDao.createPlaylist(QStringLiteral("Bulk"));
+    }
+
+    /// Returns the tracks ordered by position and checks that the positions
+    /// are contiguous.
+    QList<TrackId> tracksInTable(const QString& table,
+            const QString& idColumn,
+            int id) {
+        QSqlQuery query(dbConnection());
+        query.prepare(QStringLiteral("SELECT track_id, position FROM %1 "
+                                     "WHERE %2=:id ORDER BY position")
+                              .arg(table, idColumn));
+        query.bindValue(":id", id);
+        EXPECT_TRUE(query.exec());
+        QList<TrackId> result;
+        while (query.next()) {
+            result.append(TrackId(query.value(0)));
+            EXPECT_EQ(result.size(), query.value(1).toInt());
+        }
+        return result;
+    }
+
+    QList<TrackId> playlistTracks() {
+        return tracksInTable(QStringLiteral(PLAYLIST_TRACKS_TABLE),
+                PLAYLISTTRACKSTABLE_PLAYLISTID,
+                m_playlistId);
+    }
+
+    PlaylistDAO& m_playlistDao;
+    int m_playlistId;
+};
+
+TEST_F(PlaylistDAOTest, InsertTracks) {
+    ASSERT_TRUE(m_playlistDao.appendTracksToPlaylist(trackIds({1, 2, 3, 4, 5}), m_playlistId));
+
+    QSignalSpy tracksChangedSpy(&m_playlistDao, &PlaylistDAO::tracksChanged);
+    QSignalSpy trackAddedSpy(&m_playlistDao, &PlaylistDAO::trackAdded);
+    EXPECT_EQ(3,
+            m_playlistDao.insertTracksIntoPlaylist(
+                    trackIds({10, 11, 12}), m_playlistId, 3));
+    EXPECT_EQ(trackIds({1, 2, 10, 11, 12, 3, 4, 5}), playlistTracks());
+    EXPECT_EQ(1, tracksChangedSpy.count());
+    ASSERT_EQ(3, trackAddedSpy.count());
+    EXPECT_EQ(5, trackAddedSpy.last().at(2).toInt());
+    EXPECT_TRUE(m_playlistDao.isTrackInPlaylist(TrackId(11), m_playlistId));
+
+    // Positions behind the end append
+    EXPECT_EQ(1,
+            m_playlistDao.insertTracksIntoPlaylist(
+                    trackIds({20}), m_playlistId, 100));
+    EXPECT_EQ(trackIds({1, 2, 10, 11, 12, 3, 4, 5, 20}), playlistTracks());
+}
+
+TEST_F(PlaylistDAOTest, RemoveTracks) {
+    ASSERT_TRUE(m_playlistDao.appendTracksToPlaylist(
+            trackIds({1, 2, 3, 4, 5, 6, 7, 8}), m_playlistId));
+
+    QSignalSpy tracksChangedSpy(&m_playlistDao, &PlaylistDAO::tracksChanged);
+    QSignalSpy trackRemovedSpy(&m_playlistDao, &PlaylistDAO::trackRemoved);
+    m_playlistDao.removeTracksFromPlaylist(m_playlistId, {7, 2, 3, 3});
+    EXPECT_EQ(trackIds({1, 4, 5, 6, 8}), playlistTracks());
+    EXPECT_EQ(1, tracksChangedSpy.count());
+    EXPECT_EQ(3, trackRemovedSpy.count());
+    EXPECT_FALSE(m_playlistDao.isTrackInPlaylist(TrackId(7), m_playlistId));
+    EXPECT_TRUE(m_playlistDao.isTrackInPlaylist(TrackId(8), m_playlistId));
+
+    m_playlistDao.removeTracksFromPlaylist(m_playlistId, {1, 5});
+    EXPECT_EQ(trackIds({4, 5, 6}), playlistTracks());
+}
+
+TEST_F(PlaylistDAOTest, MoveTracks) {
+    ASSERT_TRUE(m_playlistDao.appendTracksToPlaylist(
+            trackIds({1, 2, 3, 4, 5, 6, 7, 8}), m_playlistId));
+
+    QSignalSpy tracksChangedSpy(&m_playlistDao, &PlaylistDAO::tracksChanged);
+    // Move 5, 6, 7 to the top
+    EXPECT_TRUE(m_playlistDao.moveTracks(m_playlistId, 5, 3, 1));
+    EXPECT_EQ(trackIds({5, 6, 7, 1, 2, 3, 4, 8}), playlistTracks());
+    EXPECT_EQ(1, tracksChangedSpy.count());
+
+    // Move 5, 6 behind 3
+    EXPECT_TRUE(m_playlistDao.moveTracks(m_playlistId, 1, 2, 5));
+    EXPECT_EQ(trackIds({7, 1, 2, 3, 5, 6, 4, 8}), playlistTracks());
+
+    // The range is clamped to the end of the playlist
+    EXPECT_TRUE(m_playlistDao.moveTracks(m_playlistId, 1, 2, 8));
+    EXPECT_EQ(trackIds({2, 3, 5, 6, 4, 8, 7, 1}), playlistTracks());
+
+    // A single track
+    m_playlistDao.moveTrack(m_playlistId, 8, 2);
+    EXPECT_EQ(trackIds({2, 1, 3, 5, 6, 4, 8, 7}), playlistTracks());
+
+    EXPECT_FALSE(m_playlistDao.moveTracks(m_playlistId, 7, 3, 1));
+    EXPECT_EQ(trackIds({2, 1, 3, 5, 6, 4, 8, 7}), playlistTracks());
+}
+
+TEST_F(PlaylistDAOTest, StemsMixBulkOperations) {
+    StemsMixDAO& stemsMixDao = internalCollection()->getStemsMixDAO();
+    const int stemsMixId = stemsMixDao.createStemsMix(QStringLiteral("Bulk"));
+    const auto stemsMixTracks = [&] {
+        return tracksInTable(QStringLiteral(STEMSMIX_TRACKS_TABLE),
+                STEMSMIXTRACKSTABLE_STEMSMIXID,
+                stemsMixId);
+    };
+    ASSERT_TRUE(stemsMixDao.appendTracksToStemsMix(trackIds({1, 2, 3, 4}), stemsMixId));
+
+    EXPECT_EQ(2, stemsMixDao.insertTracksIntoStemsMix(trackIds({10, 11}), stemsMixId, 1));
+    EXPECT_EQ(trackIds({10, 11, 1, 2, 3, 4}), stemsMixTracks());
+
+    EXPECT_TRUE(stemsMixDao.moveTracks(stemsMixId, 1, 2, 3));
+    EXPECT_EQ(trackIds({1, 2, 10, 11, 3, 4}), stemsMixTracks());
+
+    stemsMixDao.removeTracksFromStemsMix(stemsMixId, {2, 3, 6});
+    EXPECT_EQ(trackIds({1, 11, 3}), stemsMixTracks());
+}
+
+} // namespace
@@ -12,3 +12,50 @@ TEST_F(QueryUtilTest, FieldEscaperEscapesQuotes) {
     EXPECT_STREQ(qPrintable(QString("'foobar''s'")),
             qPrintable(fieldEscaper.escapeString("foobar's")));
 }
+
+namespace {
+
+int numValuesBelow(const QSqlDatabase& database, const QString& expression, int position) {
+    QSqlQuery query(database);
+    query.prepare(QStringLiteral("SELECT %1 FROM (SELECT :position AS position) AS t")
+                          .arg(expression));
+    query.bindValue(":position", position);
+    if (!query.exec() || !query.next()) {
+        LOG_FAILED_QUERY(query);
+        return -1;
+    }
+    return query.value(0).toInt();
+}
+
+} // namespace
+
+TEST_F(QueryUtilTest, NumValuesBelowExpression) {
+    const QString expression = sqlNumValuesBelowExpression(
+            dbConnection(), QStringLiteral("t.position"), {2, 3, 6, 7});
+    ASSERT_FALSE(expression.isNull());
+    EXPECT_EQ(0, numValuesBelow(dbConnection(), expression, 1));
+    EXPECT_EQ(0, numValuesBelow(dbConnection(), expression, 2));
+    EXPECT_EQ(2, numValuesBelow(dbConnection(), expression, 4));
+    EXPECT_EQ(2, numValuesBelow(dbConnection(), expression, 5));
+    EXPECT_EQ(4, numValuesBelow(dbConnection(), expression, 8));
+}
+
+TEST_F(QueryUtilTest, NumValuesBelowExpressionDoesNotGrowWithValues) {
+    // Far more values than a CASE expression could hold without
+    // exceeding the expression depth limit of SQLite
+    QList<int> sortedValues;
+    for (int i = 0; i < 10000; ++i) {
+        sortedValues.append(2 * i);
+    }
+    const QString expression = sqlNumValuesBelowExpression(
+            dbConnection(), QStringLiteral("t.position"), sortedValues);
+    ASSERT_FALSE(expression.isNull());
+    EXPECT_LT(expression.size(), 200);
+    EXPECT_EQ(5000, numValuesBelow(dbConnection(), expression, 9999));
+    EXPECT_EQ(10000, numValuesBelow(dbConnection(), expression, 20001));
+
+    // The previous values are replaced
+    const QString otherExpression = sqlNumValuesBelowExpression(
+            dbConnection(), QStringLiteral("t.position"), {5});
+    EXPECT_EQ(1, numValuesBelow(dbConnection(), otherExpression, 9999));
+}
@@ -0,0 +1,407 @@
+#include "test/rtsafetytest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#define MIXXX_RTSAFETY_HAVE_DEMANGLE
+#endif
+
+#include "util/assert.h"
+
+#if __has_include(<execinfo.h>)
+#include <execinfo.h>
+#define MIXXX_RTSAFETY_HAVE_BACKTRACE
+#endif
+
+// The hooks are only installed if enabled by the RTSAFETY_TESTS build
+// option, which is off for sanitizer builds.
+#if defined(MIXXX_RTSAFETY_TESTS) && defined(__GLIBC__)
+#include <dlfcn.h>
+#include <pthread.h>
+// Interpose the C allocator and the pthread lock functions. This catches
+// allocations from Qt and the standard library that do not pass through
+// a replaceable operator new.
+#define MIXXX_RTSAFETY_INTERPOSE_LIBC
+#endif
+
+namespace {
+
+using Type = mixxxtest::RealtimeSafetyViolation::Type;
+
+// Frames of the recording function and the interposed hook itself.
+constexpr int kSkippedFrames = 2;
+constexpr int kMaxStackDepth = 24;
+constexpr int kMaxCallSites = 256;
+
+struct CallSite {
+    Type type;
+    int depth;
+    void* frames[kMaxStackDepth];
+    std::atomic<int> count;
+    std::atomic<bool> complete;
+};
+
+CallSite s_callSites[kMaxCallSites];
+std::atomic<int> s_numCallSites{0};
+std::atomic<int> s_droppedViolations{0};
+std::atomic<bool> s_armed{false};
+
+// Prevents recursion when capturing the stack itself allocates or locks.
+thread_local bool t_inHook = false;
+
+bool sameCallSite(const CallSite& callSite, Type type, void* const* frames, int depth) {
+    return callSite.complete.load(std::memory_order_acquire) &&
+            callSite.type == type &&
+            callSite.depth == depth &&
+            std::memcmp(callSite.frames, frames, sizeof(void*) * depth) == 0;
+}
+
+[[maybe_unused]] void recordViolation(Type type) {
+    if (!s_armed.load(std::memory_order_relaxed) ||
+            !mixxx::rtsafety::isRealtimeContext() ||
+            t_inHook) {
+        return;
+    }
+    t_inHook = true;
+
+    void* frames[kMaxStackDepth + kSkippedFrames];
+    int depth = 0;
+#ifdef MIXXX_RTSAFETY_HAVE_BACKTRACE
+    depth = backtrace(frames, kMaxStackDepth + kSkippedFrames) - kSkippedFrames;
+    if (depth < 0) {
+        depth = 0;
+    }
+#endif
+    void* const* callerFrames = frames + kSkippedFrames;
+
+    const int numCallSites = s_numCallSites.load(std::memory_order_acquire);
+    for (int i = 0; i < numCallSites && i < kMaxCallSites; ++i) {
+        CallSite& callSite = s_callSites[i];
+        if (sameCallSite(callSite, type, callerFrames, depth)) {
+            callSite.count.fetch_add(1, std::memory_order_relaxed);
+            t_inHook = false;
+            return;
+        }
+    }
+
+    const int index = s_numCallSites.fetch_add(1, std::memory_order_acq_rel);
+    if (index >= kMaxCallSites) {
+        s_droppedViolations.fetch_add(1, std::memory_order_relaxed);
+        t_inHook = false;
+        return;
+    }
+    CallSite& callSite = s_callSites[index];
+    callSite.type = type;
+    callSite.depth = depth;
+    std::memcpy(callSite.frames, callerFrames, sizeof(void*) * depth);
+    callSite.count.store(1, std::memory_order_relaxed);
+    callSite.complete.store(true, std::memory_order_release);
+
+    t_inHook = false;
+}
+
+// Demangles the symbol in a backtrace_symbols() line of the form
+// "module(symbol+offset) [address]" so that stack frames can be matched
+// against readable function names.
+QString demangleFrame(const char* frame) {
+    QString result = QString::fromLocal8Bit(frame);
+#ifdef MIXXX_RTSAFETY_HAVE_DEMANGLE
+    const char* begin = std::strchr(frame, '(');
+    const char* end = begin ? std::strchr(begin, '+') : nullptr;
+    if (!begin || !end || end - begin <= 1) {
+        return result;
+    }
+    const std::string mangled(begin + 1, end);
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(mangled.c_str(), nullptr, nullptr, &status);
+    if (status == 0 && demangled) {
+        result.replace(QString::fromStdString(mangled), QString::fromLocal8Bit(demangled));
+    }
+    std::free(demangled);
+#endif
+    return result;
+}
+
+QStringList symbolize(void* const* frames, int depth) {
+    QStringList stackTrace;
+#ifdef MIXXX_RTSAFETY_HAVE_BACKTRACE
+    char** symbols = backtrace_symbols(frames, depth);
+    if (symbols) {
+        for (int i = 0; i < depth; ++i) {
+            stackTrace.append(demangleFrame(symbols[i]));
+        }
+        std::free(symbols);
+        return stackTrace;
+    }
+#endif
+    for (int i = 0; i < depth; ++i) {
+        stackTrace.append(QStringLiteral("0x%1").arg(
+                reinterpret_cast<quintptr>(frames[i]), 0, 16));
+    }
+    return stackTrace;
+}
+
+QString typeToString(Type type) {
+    switch (type) {
+    case Type::Allocation:
+        return QStringLiteral("allocation");
+    case Type::Deallocation:
+        return QStringLiteral("deallocation");
+    case Type::Lock:
+        return QStringLiteral("lock");
+    }
+    return QString();
+}
+
+} // anonymous namespace
+
+namespace mixxxtest {
+
+QString RealtimeSafetyViolation::toString() const {
+    QString result = QStringLiteral("%1 x %2").arg(
+            QString::number(count), typeToString(type));
+    for (const auto& frame : stackTrace) {
+        result += QStringLiteral("\n    ") + frame;
+    }
+    return result;
+}
+
+bool RealtimeSafetyViolation::hasFramesMatching(const QStringList& framePatterns) const {
+    for (const auto& pattern : framePatterns) {
+        const bool found = std::any_of(stackTrace.cbegin(),
+                stackTrace.cend(),
+                [&pattern](const QString& frame) {
+                    return frame.contains(pattern);
+                });
+        if (!found) {
+            return false;
+        }
+    }
+    return !framePatterns.isEmpty();
+}
+
+// static
+bool RealtimeSafetyMonitor::isEnabled() {
+#ifdef MIXXX_RTSAFETY_TESTS
+    return true;
+#else
+    return false;
+#endif
+}
+
+// static
+bool RealtimeSafetyMonitor::hasStackTraces() {
+#ifdef MIXXX_RTSAFETY_HAVE_BACKTRACE
+    return true;
+#else
+    return false;
+#endif
+}
+
+// static
+void RealtimeSafetyMonitor::arm() {
+    DEBUG_ASSERT(!isArmed());
+#ifdef MIXXX_RTSAFETY_HAVE_BACKTRACE
+    // The first call of backtrace() may load libgcc and allocate.
+    // Do this before recording starts.
+    void* frames[1];
+    backtrace(frames, 1);
+#endif
+    const int numCallSites = std::min(
+            s_numCallSites.load(std::memory_order_acquire), kMaxCallSites);
+    for (int i = 0; i < numCallSites; ++i) {
+        s_callSites[i].complete.store(false, std::memory_order_relaxed);
+    }
+    s_numCallSites.store(0, std::memory_order_release);
+    s_droppedViolations.store(0, std::memory_order_relaxed);
+    s_armed.store(true, std::memory_order_release);
+}
+
+// static
+void RealtimeSafetyMonitor::disarm() {
+    s_armed.store(false, std::memory_order_release);
+}
+
+// static
+bool RealtimeSafetyMonitor::isArmed() {
+    return s_armed.load(std::memory_order_acquire);
+}
+
+// static
+QList<RealtimeSafetyViolation> RealtimeSafetyMonitor::violations() {
+    DEBUG_ASSERT(!isArmed());
+    QList<RealtimeSafetyViolation> violations;
+    const int numCallSites = std::min(
+            s_numCallSites.load(std::memory_order_acquire), kMaxCallSites);
+    for (int i = 0; i < numCallSites; ++i) {
+        const CallSite& callSite = s_callSites[i];
+        if (!callSite.complete.load(std::memory_order_acquire)) {
+            continue;
+        }
+        violations.append(RealtimeSafetyViolation{
+                callSite.type,
+                callSite.count.load(std::memory_order_relaxed),
+                symbolize(callSite.frames, callSite.depth)});
+    }
+    const int dropped = s_droppedViolations.load(std::memory_order_relaxed);
+    if (dropped > 0) {
+        violations.append(RealtimeSafetyViolation{
+                Type::Allocation,
+                dropped,
+                QStringList{QStringLiteral("<call site table overflow>")}});
+    }
+    return violations;
+}
+
+} // namespace mixxxtest
+
+#ifdef MIXXX_RTSAFETY_INTERPOSE_LIBC
+
+namespace {
+
+// The versioned __pthread_* aliases are not linkable with glibc >= 2.34,
+// so the original lock functions are looked up at runtime. The cached
+// pointers are constant-initialized atomics that do not need a static
+// initialization guard, which might itself lock a mutex.
+template<typename Func>
+Func resolveNext(std::atomic<Func>* pNext, const char* name) {
+    Func next = pNext->load(std::memory_order_acquire);
+    if (!next) {
+        next = reinterpret_cast<Func>(dlsym(RTLD_NEXT, name));
+        pNext->store(next, std::memory_order_release);
+    }
+    return next;
+}
+
+} // anonymous namespace
+
+extern "C" {
+
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* ptr);
+
+void* malloc(size_t size) {
+    recordViolation(Type::Allocation);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    recordViolation(Type::Allocation);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    recordViolation(Type::Allocation);
+    return __libc_realloc(ptr, size);
+}
+
+void* memalign(size_t alignment, size_t size) {
+    recordViolation(Type::Allocation);
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    recordViolation(Type::Allocation);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** ptr, size_t alignment, size_t size) {
+    recordViolation(Type::Allocation);
+    if (alignment % sizeof(void*) != 0 ||
+            (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    void* result = __libc_memalign(alignment, size);
+    if (!result) {
+        return ENOMEM;
+    }
+    *ptr = result;
+    return 0;
+}
+
+void free(void* ptr) {
+    if (ptr) {
+        recordViolation(Type::Deallocation);
+    }
+    __libc_free(ptr);
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) {
+    using Func = int (*)(pthread_mutex_t*);
+    static std::atomic<Func> s_next{nullptr};
+    recordViolation(Type::Lock);
+    return resolveNext(&s_next, "pthread_mutex_lock")(mutex);
+}
+
+int pthread_rwlock_rdlock(pthread_rwlock_t* rwlock) {
+    using Func = int (*)(pthread_rwlock_t*);
+    static std::atomic<Func> s_next{nullptr};
+    recordViolation(Type::Lock);
+    return resolveNext(&s_next, "pthread_rwlock_rdlock")(rwlock);
+}
+
+int pthread_rwlock_wrlock(pthread_rwlock_t* rwlock) {
+    using Func = int (*)(pthread_rwlock_t*);
+    static std::atomic<Func> s_next{nullptr};
+    recordViolation(Type::Lock);
+    return resolveNext(&s_next, "pthread_rwlock_wrlock")(rwlock);
+}
+
+} // extern "C"
+
+#elif defined(MIXXX_RTSAFETY_TESTS)
+
+// Without libc interposition only the replaceable global allocation
+// functions are observed.
+
+void* operator new(std::size_t size) {
+    recordViolation(Type::Allocation);
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    recordViolation(Type::Allocation);
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* ptr) noexcept {
+    if (ptr) {
+        recordViolation(Type::Deallocation);
+    }
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    operator delete(ptr);
+}
+
+#endif
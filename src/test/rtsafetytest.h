@@ -0,0 +1,141 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include "util/rtsafety.h"
+
+namespace mixxxtest {
+
+/// A call site that allocated, freed or locked while the calling thread
+/// was inside a mixxx::rtsafety::ScopedRealtimeContext, i.e. while
+/// EngineMaster::process() was on the stack.
+struct RealtimeSafetyViolation {
+    enum class Type {
+        Allocation,
+        Deallocation,
+        Lock,
+    };
+
+    Type type;
+    int count;
+    QStringList stackTrace;
+
+    /// Returns true if every pattern is contained in at least one frame
+    /// of the stack trace.
+    bool hasFramesMatching(const QStringList& framePatterns) const;
+
+    QString toString() const;
+};
+
+/// Intercepts heap allocations and mutex locks of the test binary.
+///
+/// The hooks are only installed if mixxx-test is built with the
+/// RTSAFETY_TESTS CMake option. It is disabled by default, because it
+/// slows down every allocation of the test binary, and forced off for
+/// sanitizer builds, because it would replace the allocator and lock
+/// interceptors of the sanitizer runtimes.
+///
+/// On glibc malloc/calloc/realloc/free and the pthread lock functions are
+/// interposed, which also covers operator new/delete and all Qt containers.
+/// On other platforms only the global operator new/delete are replaced.
+/// Uncontended QMutex locks are inlined atomics and cannot be observed.
+///
+/// Recording never allocates: call sites are stored in a fixed-size table
+/// together with their raw stack frames, which are only symbolized when
+/// the violations are collected after disarming.
+class RealtimeSafetyMonitor final {
+  public:
+    /// Returns false if the hooks are not compiled into the test binary.
+    static bool isEnabled();
+
+    /// Returns false if stack traces cannot be captured on this platform.
+    static bool hasStackTraces();
+
+    /// Clears all previously recorded violations and starts recording.
+    static void arm();
+    /// Stops recording.
+    static void disarm();
+    static bool isArmed();
+
+    /// Returns all call sites recorded since the last call to arm(),
+    /// ordered by their first occurrence.
+    static QList<RealtimeSafetyViolation> violations();
+};
+
+/// Test fixture mixin that verifies that code running inside the engine
+/// callback neither allocates nor locks. Wrap the fixture of the test, e.g.
+///
+///   class MyRealtimeTest : public RealtimeSafetyTest<SignalPathTest> {};
+///
+///   TEST_F(MyRealtimeTest, Process) {
+///       EXPECT_TRUE(isRealtimeSafe([this] { ProcessBuffer(); }));
+///   }
+///
+/// Only code executed within a ScopedRealtimeContext is checked, so
+/// calling the whole test helper, including logging, is fine.
+///
+/// The tests are skipped if the monitor is not enabled in this build.
+template<typename Fixture>
+class RealtimeSafetyTest : public Fixture {
+  protected:
+    void SetUp() override {
+        Fixture::SetUp();
+        if (!RealtimeSafetyMonitor::isEnabled()) {
+            GTEST_SKIP() << "mixxx-test was built without RTSAFETY_TESTS";
+        }
+    }
+
+    /// Ignores all violations with stack frames matching every pattern,
+    /// see RealtimeSafetyViolation::hasFramesMatching(). Nothing is
+    /// tolerated by default. Each test must tolerate only the call sites
+    /// it is known to hit and document why they are acceptable.
+    void tolerateViolations(const QStringList& framePatterns) {
+        m_toleratedViolations.append(framePatterns);
+    }
+
+    void TearDown() override {
+        RealtimeSafetyMonitor::disarm();
+        Fixture::TearDown();
+    }
+
+    template<typename Func>
+    ::testing::AssertionResult isRealtimeSafe(Func&& func) {
+        RealtimeSafetyMonitor::arm();
+        func();
+        RealtimeSafetyMonitor::disarm();
+        QList<RealtimeSafetyViolation> violations;
+        for (const auto& violation : RealtimeSafetyMonitor::violations()) {
+            if (!isTolerated(violation)) {
+                violations.append(violation);
+            }
+        }
+        if (violations.isEmpty()) {
+            return ::testing::AssertionSuccess();
+        }
+        ::testing::AssertionResult result = ::testing::AssertionFailure();
+        result << violations.size()
+               << " call site(s) allocated or locked in the realtime context:";
+        for (const auto& violation : violations) {
+            result << "\n" << violation.toString().toStdString();
+        }
+        return result;
+    }
+
+  private:
+    bool isTolerated(const RealtimeSafetyViolation& violation) const {
+        for (const auto& framePatterns : m_toleratedViolations) {
+            if (violation.hasFramesMatching(framePatterns)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    QList<QStringList> m_toleratedViolations;
+};
+
+} // namespace mixxxtest
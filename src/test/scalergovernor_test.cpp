@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include "engine/bufferscalers/scalergovernor.h"
+
+namespace {
+
+using ScalerTier = ScalerGovernor::ScalerTier;
+
+// 512 frames at 44.1 kHz
+constexpr double kPeriodSeconds = 512 / 44100.0;
+
+class ScalerGovernorTest : public ::testing::Test {
+  protected:
+    ScalerGovernorTest()
+            : m_decks{
+                      // audible in the master mix
+                      {ScalerTier::RubberBandFiner, ScalerTier::RubberBandFiner, true, 1.0f},
+                      // quiet, but still audible
+                      {ScalerTier::RubberBandFiner, ScalerTier::RubberBandFiner, true, 0.1f},
+                      // muted
+                      {ScalerTier::RubberBandFiner, ScalerTier::RubberBandFiner, true, 0.0f},
+              } {
+    }
+
+    // Runs callbacks with the given load for the given time and returns
+    // the number of callbacks that changed a limit.
+    int run(double load, double seconds) {
+        int changes = 0;
+        for (double t = 0; t < seconds; t += kPeriodSeconds) {
+            if (m_governor.process(load, kPeriodSeconds, m_decks, kNumDecks)) {
+                ++changes;
+            }
+        }
+        return changes;
+    }
+
+    static constexpr int kNumDecks = 3;
+    ScalerGovernor m_governor;
+    ScalerGovernor::Deck m_decks[kNumDecks];
+};
+
+TEST_F(ScalerGovernorTest, NoChangesWithHeadroom) {
+    EXPECT_EQ(0, run(0.3, 30));
+    for (const auto& deck : m_decks) {
+        EXPECT_EQ(ScalerTier::RubberBandFiner, deck.tierLimit);
+    }
+}
+
+TEST_F(ScalerGovernorTest, ShortSpikesAreIgnored) {
+    EXPECT_EQ(0, run(1.5, 0.1));
+    EXPECT_EQ(0, run(0.3, 1));
+}
+
+TEST_F(ScalerGovernorTest, DemotesLeastAudibleDeckFirst) {
+    EXPECT_EQ(1, run(0.9, 1.5));
+    EXPECT_EQ(ScalerTier::RubberBandFiner, m_decks[0].tierLimit);
+    EXPECT_EQ(ScalerTier::RubberBandFiner, m_decks[1].tierLimit);
+    EXPECT_EQ(ScalerTier::RubberBandFaster, m_decks[2].tierLimit);
+}
+
+TEST_F(ScalerGovernorTest, OnlyInaudibleDecksUseLinear) {
+    run(0.9, 60);
+    // The overload persists, so every deck ends at its minimum tier.
+    EXPECT_EQ(ScalerTier::SoundTouch, m_decks[0].tierLimit);
+    EXPECT_EQ(ScalerTier::SoundTouch, m_decks[1].tierLimit);
+    EXPECT_EQ(ScalerTier::Linear, m_decks[2].tierLimit);
+
+    // Unmuting restores key preservation immediately.
+    m_decks[2].audibleGain = 0.5f;
+    EXPECT_EQ(1, run(0.9, kPeriodSeconds / 2));
+    EXPECT_EQ(ScalerTier::SoundTouch, m_decks[2].tierLimit);
+}
+
+TEST_F(ScalerGovernorTest, PromotesMostAudibleDeckFirst) {
+    run(0.9, 60);
+    run(0.2, 7);
+    EXPECT_EQ(ScalerTier::RubberBandFaster, m_decks[0].tierLimit);
+    EXPECT_EQ(ScalerTier::SoundTouch, m_decks[1].tierLimit);
+    EXPECT_EQ(ScalerTier::Linear, m_decks[2].tierLimit);
+
+    run(0.2, 120);
+    for (const auto& deck : m_decks) {
+        EXPECT_EQ(ScalerTier::RubberBandFiner, deck.tierLimit);
+    }
+}
+
+TEST_F(ScalerGovernorTest, RespectsConfiguredTier) {
+    for (auto& deck : m_decks) {
+        deck.configuredTier = ScalerTier::SoundTouch;
+    }
+    run(0.9, 10);
+    // Only the muted deck can go below the configured SoundTouch tier.
+    EXPECT_EQ(ScalerTier::RubberBandFiner, m_decks[0].tierLimit);
+    EXPECT_EQ(ScalerTier::RubberBandFiner, m_decks[1].tierLimit);
+    EXPECT_EQ(ScalerTier::Linear, m_decks[2].tierLimit);
+}
+
+TEST_F(ScalerGovernorTest, InactiveDecksAreNotDemoted) {
+    m_decks[2].keylockActive = false;
+    run(0.9, 1.5);
+    EXPECT_EQ(ScalerTier::RubberBandFiner, m_decks[0].tierLimit);
+    EXPECT_EQ(ScalerTier::RubberBandFaster, m_decks[1].tierLimit);
+    EXPECT_EQ(ScalerTier::RubberBandFiner, m_decks[2].tierLimit);
+}
+
+TEST_F(ScalerGovernorTest, DisablingResetsLimits) {
+    run(0.9, 60);
+    m_governor.setEnabled(false);
+    EXPECT_EQ(1, run(0.9, 1));
+    for (const auto& deck : m_decks) {
+        EXPECT_EQ(ScalerTier::RubberBandFiner, deck.tierLimit);
+    }
+}
+
+} // namespace
@@ -0,0 +1,154 @@
+#include "library/serato/seratodatabasereader.h"
+
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QByteArray>
+#include <QtEndian>
+
+namespace {
+
+void appendUInt32(QByteArray* pData, quint32 value) {
+    char bytes[sizeof(quint32)];
+    qToBigEndian(value, bytes);
+    pData->append(bytes, sizeof(bytes));
+}
+
+void appendField(QByteArray* pData, SeratoFieldId id, const QByteArray& value) {
+    appendUInt32(pData, static_cast<quint32>(id));
+    appendUInt32(pData, static_cast<quint32>(value.size()));
+    pData->append(value);
+}
+
+QByteArray utf16be(const QString& text) {
+    QByteArray data;
+    for (const QChar c : text) {
+        const quint16 unicode = c.unicode();
+        data.append(static_cast<char>(unicode >> 8));
+        data.append(static_cast<char>(unicode & 0xff));
+    }
+    return data;
+}
+
+QByteArray trackField(int index) {
+    QByteArray track;
+    appendField(&track, SeratoFieldId::FileType, utf16be(QStringLiteral("mp3")));
+    appendField(&track,
+            SeratoFieldId::FilePath,
+            utf16be(QStringLiteral("Music/Artist %1/Track %1.mp3").arg(index)));
+    appendField(&track,
+            SeratoFieldId::SongTitle,
+            utf16be(QStringLiteral("Track %1").arg(index)));
+    appendField(&track,
+            SeratoFieldId::Artist,
+            utf16be(QStringLiteral("Artist %1").arg(index)));
+    appendField(&track, SeratoFieldId::Year, utf16be(QStringLiteral("2020")));
+    appendField(&track, SeratoFieldId::Bpm, utf16be(QStringLiteral("123.5")));
+    appendField(&track, SeratoFieldId::BeatgridLocked, QByteArray(1, '\x01'));
+    QByteArray dateAdded;
+    appendUInt32(&dateAdded, 1600000000);
+    appendField(&track, SeratoFieldId::DateAdded, dateAdded);
+    QByteArray data;
+    appendField(&data, SeratoFieldId::Track, track);
+    return data;
+}
+
+QByteArray database(int numTracks) {
+    QByteArray data;
+    appendField(&data,
+            SeratoFieldId::Version,
+            utf16be(QStringLiteral("2.0/Serato Scratch LIVE Database")));
+    for (int i = 0; i < numTracks; ++i) {
+        data.append(trackField(i));
+    }
+    return data;
+}
+
+TEST(SeratoDatabaseReaderTest, ParseTracks) {
+    const QByteArray data = database(2);
+    SeratoFieldReader reader(data.constData(), data.size());
+    SeratoField field;
+
+    ASSERT_TRUE(reader.readNext(&field));
+    EXPECT_EQ(SeratoFieldId::Version, field.id);
+    EXPECT_EQ(QStringLiteral("vrsn"), field.name());
+    EXPECT_EQ(QStringLiteral("2.0/Serato Scratch LIVE Database"), field.toString());
+
+    for (int i = 0; i < 2; ++i) {
+        ASSERT_TRUE(reader.readNext(&field));
+        ASSERT_EQ(SeratoFieldId::Track, field.id);
+        SeratoTrack track;
+        ASSERT_TRUE(parseSeratoTrack(field, &track));
+        EXPECT_EQ(QStringLiteral("mp3"), track.filetype);
+        EXPECT_EQ(QStringLiteral("Music/Artist %1/Track %1.mp3").arg(i), track.location);
+        EXPECT_EQ(QStringLiteral("Track %1").arg(i), track.title);
+        EXPECT_EQ(QStringLiteral("Artist %1").arg(i), track.artist);
+        EXPECT_EQ(2020, track.year);
+        EXPECT_DOUBLE_EQ(123.5, track.bpm);
+        EXPECT_TRUE(track.beatgridlocked);
+        EXPECT_EQ(1600000000u, track.datetimeadded);
+    }
+
+    EXPECT_FALSE(reader.readNext(&field));
+    EXPECT_EQ(0, reader.bytesLeft());
+}
+
+TEST(SeratoDatabaseReaderTest, ParseCrateTrackPath) {
+    QByteArray track;
+    appendField(&track,
+            SeratoFieldId::TrackPath,
+            utf16be(QStringLiteral("Music/Track.mp3")));
+    QByteArray data;
+    appendField(&data, SeratoFieldId::Track, track);
+
+    SeratoFieldReader reader(data.constData(), data.size());
+    SeratoField field;
+    ASSERT_TRUE(reader.readNext(&field));
+    EXPECT_EQ(QStringLiteral("Music/Track.mp3"), parseSeratoCrateTrackPath(field));
+}
+
+TEST(SeratoDatabaseReaderTest, TruncatedField) {
+    QByteArray data = trackField(0);
+    data.chop(1);
+
+    SeratoFieldReader reader(data.constData(), data.size());
+    SeratoField field;
+    EXPECT_FALSE(reader.readNext(&field));
+    EXPECT_EQ(data.size(), reader.bytesLeft());
+}
+
+TEST(SeratoDatabaseReaderTest, TrackWithoutLocation) {
+    QByteArray track;
+    appendField(&track, SeratoFieldId::SongTitle, utf16be(QStringLiteral("Title")));
+    QByteArray data;
+    appendField(&data, SeratoFieldId::Track, track);
+
+    SeratoFieldReader reader(data.constData(), data.size());
+    SeratoField field;
+    ASSERT_TRUE(reader.readNext(&field));
+    SeratoTrack seratoTrack;
+    EXPECT_FALSE(parseSeratoTrack(field, &seratoTrack));
+}
+
+static void BM_SeratoParseDatabase(benchmark::State& state) {
+    const QByteArray data = database(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        SeratoFieldReader reader(data.constData(), data.size());
+        SeratoField field;
+        int numTracks = 0;
+        while (reader.readNext(&field)) {
+            if (field.id != SeratoFieldId::Track) {
+                continue;
+            }
+            SeratoTrack track;
+            if (parseSeratoTrack(field, &track)) {
+                ++numTracks;
+            }
+        }
+        benchmark::DoNotOptimize(numTracks);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SeratoParseDatabase)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+} // anonymous namespace
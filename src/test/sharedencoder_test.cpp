@@ -0,0 +1,195 @@
+#ifdef __BROADCAST__
+
+#include <gtest/gtest.h>
+
+#include "engine/sidechain/sharedencoder.h"
+
+namespace {
+
+constexpr int kMaxQueueBytes = 64;
+
+/// Emits one packet per encoded buffer that contains the number of samples.
+class CountingEncoder : public Encoder {
+  public:
+    explicit CountingEncoder(EncoderCallback* pCallback)
+            : m_pCallback(pCallback),
+              m_numBuffers(0) {
+    }
+
+    int initEncoder(mixxx::audio::SampleRate sampleRate,
+            QString* pUserErrorMessage) override {
+        Q_UNUSED(sampleRate);
+        Q_UNUSED(pUserErrorMessage);
+        return 0;
+    }
+    void encodeBuffer(const CSAMPLE* samples, const int size) override {
+        Q_UNUSED(samples);
+        ++m_numBuffers;
+        const unsigned char body = static_cast<unsigned char>(size);
+        m_pCallback->write(nullptr, &body, 0, 1);
+    }
+    void updateMetaData(const QString& artist,
+            const QString& title,
+            const QString& album) override {
+        Q_UNUSED(artist);
+        Q_UNUSED(title);
+        Q_UNUSED(album);
+    }
+    void flush() override {
+    }
+    void setEncoderSettings(const EncoderSettings& settings) override {
+        Q_UNUSED(settings);
+    }
+
+    int numBuffers() const {
+        return m_numBuffers;
+    }
+
+  private:
+    EncoderCallback* m_pCallback;
+    int m_numBuffers;
+};
+
+class SharedEncoderTest : public ::testing::Test {
+  protected:
+    // The feeder never times out unless a test asks for it
+    explicit SharedEncoderTest(
+            mixxx::Duration feederTimeout = mixxx::Duration::fromSeconds(3600))
+            : m_pSharedEncoder(std::make_shared<SharedEncoder>(feederTimeout)),
+              m_pEncoder(std::make_shared<CountingEncoder>(m_pSharedEncoder.get())),
+              m_sink1(kMaxQueueBytes),
+              m_sink2(kMaxQueueBytes) {
+        m_pSharedEncoder->setEncoder(m_pEncoder);
+    }
+
+    void TearDown() override {
+        m_pSharedEncoder->removeSink(&m_sink1);
+        m_pSharedEncoder->removeSink(&m_sink2);
+    }
+
+    std::shared_ptr<SharedEncoder> m_pSharedEncoder;
+    std::shared_ptr<CountingEncoder> m_pEncoder;
+    SharedEncoder::PacketQueue m_sink1;
+    SharedEncoder::PacketQueue m_sink2;
+    CSAMPLE m_buffer[16] = {};
+};
+
+TEST_F(SharedEncoderTest, EncodesOnceForAllSinks) {
+    m_pSharedEncoder->addSink(&m_sink1);
+    m_pSharedEncoder->addSink(&m_sink2);
+
+    // Both connections pass the same mix, but it is only encoded once.
+    m_pSharedEncoder->encodeBuffer(&m_sink1, m_buffer, 4);
+    m_pSharedEncoder->encodeBuffer(&m_sink2, m_buffer, 4);
+    m_pSharedEncoder->encodeBuffer(&m_sink1, m_buffer, 8);
+    m_pSharedEncoder->encodeBuffer(&m_sink2, m_buffer, 8);
+    EXPECT_EQ(2, m_pEncoder->numBuffers());
+
+    EXPECT_EQ(2, m_sink1.bytesQueued());
+    EXPECT_EQ(2, m_sink2.bytesQueued());
+    QList<QByteArray> packets;
+    EXPECT_TRUE(m_sink2.takeAll(&packets));
+    ASSERT_EQ(2, packets.size());
+    EXPECT_EQ(4, packets[0].at(0));
+    EXPECT_EQ(8, packets[1].at(0));
+    EXPECT_EQ(0, m_sink2.bytesQueued());
+    // The other sink is not affected
+    EXPECT_EQ(2, m_sink1.bytesQueued());
+}
+
+TEST_F(SharedEncoderTest, NextSinkTakesOver) {
+    m_pSharedEncoder->addSink(&m_sink1);
+    m_pSharedEncoder->addSink(&m_sink2);
+    m_pSharedEncoder->removeSink(&m_sink1);
+    EXPECT_EQ(1, m_pSharedEncoder->numSinks());
+
+    m_pSharedEncoder->encodeBuffer(&m_sink1, m_buffer, 4);
+    EXPECT_EQ(0, m_pEncoder->numBuffers());
+    m_pSharedEncoder->encodeBuffer(&m_sink2, m_buffer, 4);
+    EXPECT_EQ(1, m_pEncoder->numBuffers());
+    EXPECT_EQ(0, m_sink1.bytesQueued());
+    EXPECT_EQ(1, m_sink2.bytesQueued());
+}
+
+TEST_F(SharedEncoderTest, OnlyFeederIsEncoded) {
+    m_pSharedEncoder->addSink(&m_sink1);
+    m_pSharedEncoder->addSink(&m_sink2);
+
+    // The FIFO of the second connection may have dropped or duplicated
+    // samples, so its mix is never encoded while the feeder is active.
+    m_pSharedEncoder->encodeBuffer(&m_sink2, m_buffer, 6);
+    EXPECT_EQ(0, m_pEncoder->numBuffers());
+    m_pSharedEncoder->encodeBuffer(&m_sink1, m_buffer, 4);
+    m_pSharedEncoder->encodeBuffer(&m_sink2, m_buffer, 8);
+    m_pSharedEncoder->encodeBuffer(&m_sink1, m_buffer, 4);
+    EXPECT_EQ(2, m_pEncoder->numBuffers());
+
+    QList<QByteArray> packets;
+    EXPECT_TRUE(m_sink2.takeAll(&packets));
+    ASSERT_EQ(2, packets.size());
+    EXPECT_EQ(4, packets[0].at(0));
+    EXPECT_EQ(4, packets[1].at(0));
+}
+
+TEST_F(SharedEncoderTest, LateSinkJoinsCurrentStream) {
+    m_pSharedEncoder->addSink(&m_sink1);
+    m_pSharedEncoder->encodeBuffer(&m_sink1, m_buffer, 4);
+    m_pSharedEncoder->encodeBuffer(&m_sink1, m_buffer, 4);
+
+    // The new connection receives the stream from where it joined and
+    // does not need to catch up with the feeder.
+    m_pSharedEncoder->addSink(&m_sink2);
+    m_pSharedEncoder->encodeBuffer(&m_sink2, m_buffer, 6);
+    m_pSharedEncoder->encodeBuffer(&m_sink1, m_buffer, 8);
+    EXPECT_EQ(3, m_pEncoder->numBuffers());
+    QList<QByteArray> packets;
+    EXPECT_TRUE(m_sink2.takeAll(&packets));
+    ASSERT_EQ(1, packets.size());
+    EXPECT_EQ(8, packets[0].at(0));
+}
+
+class SharedEncoderStalledFeederTest : public SharedEncoderTest {
+  protected:
+    SharedEncoderStalledFeederTest()
+            : SharedEncoderTest(mixxx::Duration::fromMillis(0)) {
+    }
+};
+
+TEST_F(SharedEncoderStalledFeederTest, NextSinkTakesOver) {
+    m_pSharedEncoder->addSink(&m_sink1);
+    m_pSharedEncoder->addSink(&m_sink2);
+    m_pSharedEncoder->encodeBuffer(&m_sink1, m_buffer, 4);
+
+    // The feeder is blocked by its server and has not passed any samples
+    // within the timeout, so the second connection keeps the encoder
+    // running for both.
+    m_pSharedEncoder->encodeBuffer(&m_sink2, m_buffer, 8);
+    EXPECT_EQ(2, m_pEncoder->numBuffers());
+    QList<QByteArray> packets;
+    EXPECT_TRUE(m_sink1.takeAll(&packets));
+    ASSERT_EQ(2, packets.size());
+    EXPECT_EQ(8, packets[1].at(0));
+}
+
+TEST_F(SharedEncoderTest, SlowSinkOverflows) {
+    m_pSharedEncoder->addSink(&m_sink1);
+    m_pSharedEncoder->addSink(&m_sink2);
+
+    QList<QByteArray> packets;
+    for (int i = 0; i < 2 * kMaxQueueBytes; ++i) {
+        m_pSharedEncoder->encodeBuffer(&m_sink1, m_buffer, 1);
+        EXPECT_TRUE(m_sink1.takeAll(&packets));
+    }
+    // The second sink has not been drained and dropped packets
+    EXPECT_LE(m_sink2.bytesQueued(), kMaxQueueBytes + 1);
+    EXPECT_FALSE(m_sink2.takeAll(&packets));
+    EXPECT_EQ(kMaxQueueBytes + 1, packets.size());
+
+    m_pSharedEncoder->encodeBuffer(&m_sink1, m_buffer, 1);
+    EXPECT_TRUE(m_sink2.takeAll(&packets));
+    EXPECT_EQ(1, packets.size());
+}
+
+} // namespace
+
+#endif // __BROADCAST__
@@ -22,6 +22,7 @@
 #include "mixer/sampler.h"
 #include "preferences/usersettings.h"
 #include "test/mixxxtest.h"
+#include "test/rtsafetytest.h"
 #include "test/soundsourceproviderregistration.h"
 #include "track/track.h"
 #include "util/defs.h"
@@ -279,3 +280,8 @@ class SignalPathTest : public BaseSignalPathTest {
         loadTrack(m_pMixerDeck3, pTrack);
     }
 };
+
+// Signal path test with a track loaded on each deck that can verify that
+// processing neither allocates nor locks, see mixxxtest::RealtimeSafetyTest.
+class RealtimeSafeSignalPathTest : public mixxxtest::RealtimeSafetyTest<SignalPathTest> {
+};
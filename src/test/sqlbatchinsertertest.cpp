@@ -0,0 +1,110 @@
+#include "util/db/sqlbatchinserter.h"
+
+#include <gtest/gtest.h>
+
+#include <QSqlQuery>
+
+#include "test/mixxxdbtest.h"
+
+namespace {
+
+const QString kTableName = QStringLiteral("batch_inserter_test");
+
+class SqlBatchInserterTest : public MixxxDbTest {
+  protected:
+    SqlBatchInserterTest() {
+        QSqlQuery query(dbConnection());
+        EXPECT_TRUE(query.exec(
+                "CREATE TEMPORARY TABLE " + kTableName +
+                " (id INTEGER PRIMARY KEY, name TEXT UNIQUE)"));
+    }
+
+    int countRows() const {
+        QSqlQuery query(dbConnection());
+        EXPECT_TRUE(query.exec("SELECT COUNT(*) FROM " + kTableName));
+        EXPECT_TRUE(query.next());
+        return query.value(0).toInt();
+    }
+
+    QString name(int id) const {
+        QSqlQuery query(dbConnection());
+        query.prepare("SELECT name FROM " + kTableName + " WHERE id=:id");
+        query.bindValue(":id", id);
+        EXPECT_TRUE(query.exec());
+        if (!query.next()) {
+            return QString();
+        }
+        return query.value(0).toString();
+    }
+};
+
+TEST_F(SqlBatchInserterTest, InsertsFullAndPartialBatches) {
+    SqlBatchInserter inserter(dbConnection(),
+            kTableName,
+            {QStringLiteral("id"), QStringLiteral("name")});
+    const int numRows = 2 * inserter.batchSize() + 3;
+    for (int id = 1; id <= numRows; ++id) {
+        ASSERT_TRUE(inserter.append({id, QStringLiteral("name%1").arg(id)}));
+    }
+    // Only full batches have been written
+    EXPECT_EQ(2 * inserter.batchSize(), countRows());
+
+    ASSERT_TRUE(inserter.flush());
+    EXPECT_EQ(numRows, countRows());
+    EXPECT_EQ(QStringLiteral("name1"), name(1));
+    EXPECT_EQ(QStringLiteral("name%1").arg(numRows), name(numRows));
+
+    // Nothing is pending
+    EXPECT_TRUE(inserter.flush());
+    EXPECT_EQ(numRows, countRows());
+}
+
+TEST_F(SqlBatchInserterTest, FlushesOnDestruction) {
+    {
+        SqlBatchInserter inserter(dbConnection(),
+                kTableName,
+                {QStringLiteral("name")});
+        ASSERT_TRUE(inserter.append({QStringLiteral("a")}));
+        ASSERT_TRUE(inserter.append({QStringLiteral("b")}));
+        EXPECT_EQ(0, countRows());
+    }
+    EXPECT_EQ(2, countRows());
+}
+
+TEST_F(SqlBatchInserterTest, OnConflict) {
+    {
+        SqlBatchInserter inserter(dbConnection(),
+                kTableName,
+                {QStringLiteral("id"), QStringLiteral("name")},
+                SqlBatchInserter::OnConflict::Ignore);
+        ASSERT_TRUE(inserter.append({1, QStringLiteral("a")}));
+        ASSERT_TRUE(inserter.append({2, QStringLiteral("a")}));
+        ASSERT_TRUE(inserter.flush());
+    }
+    EXPECT_EQ(1, countRows());
+    EXPECT_EQ(QStringLiteral("a"), name(1));
+
+    {
+        SqlBatchInserter inserter(dbConnection(),
+                kTableName,
+                {QStringLiteral("id"), QStringLiteral("name")},
+                SqlBatchInserter::OnConflict::Replace);
+        ASSERT_TRUE(inserter.append({1, QStringLiteral("b")}));
+        ASSERT_TRUE(inserter.flush());
+    }
+    EXPECT_EQ(1, countRows());
+    EXPECT_EQ(QStringLiteral("b"), name(1));
+
+    {
+        SqlBatchInserter inserter(dbConnection(),
+                kTableName,
+                {QStringLiteral("id"), QStringLiteral("name")});
+        ASSERT_TRUE(inserter.append({2, QStringLiteral("b")}));
+        // The whole batch fails
+        ASSERT_TRUE(inserter.append({3, QStringLiteral("c")}));
+        EXPECT_FALSE(inserter.flush());
+    }
+    EXPECT_EQ(1, countRows());
+}
+
+} // anonymous namespace
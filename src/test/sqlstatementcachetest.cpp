@@ -0,0 +1,68 @@
+#include "util/db/sqlstatementcache.h"
+
+#include <gtest/gtest.h>
+
+#include "test/mixxxdbtest.h"
+
+namespace {
+
+const QString kSelectStatement = QStringLiteral("SELECT :value");
+
+class SqlStatementCacheTest : public MixxxDbTest {
+  protected:
+    SqlStatementCache* statementCache() const {
+        return SqlStatementCache::forDatabase(dbConnection());
+    }
+
+    int selectValue(int value) const {
+        CachedSqlQuery query(dbConnection(), kSelectStatement);
+        EXPECT_TRUE(query.isPrepared());
+        query->bindValue(":value", value);
+        EXPECT_TRUE(query.exec());
+        EXPECT_TRUE(query->next());
+        return query->value(0).toInt();
+    }
+};
+
+TEST_F(SqlStatementCacheTest, reuseStatement) {
+    ASSERT_NE(nullptr, statementCache());
+    const int initialSize = statementCache()->size();
+
+    EXPECT_EQ(1, selectValue(1));
+    EXPECT_EQ(initialSize + 1, statementCache()->size());
+
+    // The cached statement is reused with other bound values
+    EXPECT_EQ(2, selectValue(2));
+    EXPECT_EQ(initialSize + 1, statementCache()->size());
+}
+
+TEST_F(SqlStatementCacheTest, nestedStatements) {
+    ASSERT_NE(nullptr, statementCache());
+    const int initialSize = statementCache()->size();
+
+    CachedSqlQuery outer(dbConnection(), kSelectStatement);
+    ASSERT_TRUE(outer.isPrepared());
+    outer->bindValue(":value", 1);
+    ASSERT_TRUE(outer.exec());
+
+    // The borrowed statement is not shared, the same SQL text is
+    // prepared again while the outer query is active.
+    EXPECT_EQ(2, selectValue(2));
+
+    ASSERT_TRUE(outer->next());
+    EXPECT_EQ(1, outer->value(0).toInt());
+    EXPECT_EQ(initialSize + 1, statementCache()->size());
+}
+
+TEST_F(SqlStatementCacheTest, failedStatementIsNotCached) {
+    ASSERT_NE(nullptr, statementCache());
+    const int initialSize = statementCache()->size();
+    {
+        CachedSqlQuery query(dbConnection(),
+                QStringLiteral("SELECT * FROM no_such_table"));
+        EXPECT_FALSE(query.isPrepared());
+    }
+    EXPECT_EQ(initialSize, statementCache()->size());
+}
+
+} // anonymous namespace
@@ -6,6 +6,7 @@
 #include <QDebug>
 #include <QScopedPointer>
 
+#include "library/export/exportfilecopier.h"
 #include "moc_trackexport_test.cpp"
 #include "track/track.h"
 
@@ -300,3 +301,85 @@ TEST_F(TrackExporterTest, MungeFilename) {
     // Remove the track we created.
     tempPath.remove("cover-test.ogg");
 }
+
+TEST_F(TrackExporterTest, ResumeSkipsUnchanged) {
+    mixxx::FileInfo fileinfo1(m_testDataDir.filePath("cover-test.ogg"));
+    TrackPointer track1(Track::newTemporary(mixxx::FileAccess(fileinfo1)));
+    mixxx::FileInfo fileinfo2(m_testDataDir.filePath("cover-test.flac"));
+    TrackPointer track2(Track::newTemporary(mixxx::FileAccess(fileinfo2)));
+
+    TrackPointerList tracks;
+    tracks.append(track1);
+    tracks.append(track2);
+    {
+        TrackExportWorker worker(m_exportDir.canonicalPath(), tracks);
+        m_answerer.reset(new FakeOverwriteAnswerer(&worker));
+        worker.run();
+        EXPECT_TRUE(worker.wait(10000));
+        EXPECT_EQ(2, m_answerer->currentProgress());
+    }
+    EXPECT_TRUE(QFileInfo::exists(
+            mixxx::ExportFileCopier::checkpointFilePath(m_exportDir)));
+
+    // Exporting again must not ask about the existing files, because
+    // they have been copied from the same unchanged sources.
+    TrackExportWorker worker(m_exportDir.canonicalPath(), tracks);
+    m_answerer.reset(new FakeOverwriteAnswerer(&worker));
+    worker.run();
+    EXPECT_TRUE(worker.wait(10000));
+    EXPECT_EQ(2, m_answerer->currentProgress());
+    EXPECT_EQ(2, m_answerer->currentProgressCount());
+}
+
+TEST_F(TrackExporterTest, CheckpointDetectsChanges) {
+    // Export a private copy of a test file that can be modified
+    QTemporaryDir sourceDir;
+    ASSERT_TRUE(sourceDir.isValid());
+    const QString sourcePath = QDir(sourceDir.path()).filePath("cover-test.ogg");
+    ASSERT_TRUE(QFile::copy(m_testDataDir.filePath("cover-test.ogg"), sourcePath));
+    const mixxx::FileInfo sourceFileInfo(sourcePath);
+    const QString destFileName = QStringLiteral("cover-test.ogg");
+
+    {
+        mixxx::ExportFileCopier copier(m_exportDir);
+        EXPECT_FALSE(copier.isUnchanged(sourceFileInfo, destFileName));
+        EXPECT_EQ(mixxx::ExportFileCopier::Status::Copied,
+                copier.copy(sourceFileInfo, destFileName).result().status);
+        EXPECT_TRUE(copier.isUnchanged(sourceFileInfo, destFileName));
+    }
+
+    // An incomplete last line of an interrupted export is ignored
+    {
+        QFile checkpoint(mixxx::ExportFileCopier::checkpointFilePath(m_exportDir));
+        ASSERT_TRUE(checkpoint.open(QIODevice::WriteOnly | QIODevice::Append));
+        checkpoint.write("{\"file\":\"cover-te");
+    }
+
+    mixxx::ExportFileCopier copier(m_exportDir);
+    EXPECT_TRUE(copier.isUnchanged(sourceFileInfo, destFileName));
+    EXPECT_EQ(mixxx::ExportFileCopier::Status::Unchanged,
+            copier.copyIfChanged(sourceFileInfo, destFileName).result().status);
+
+    // Touching the file without modifying it is detected by the hash
+    QFile source(sourcePath);
+    ASSERT_TRUE(source.open(QIODevice::ReadWrite));
+    ASSERT_TRUE(source.setFileTime(
+            QDateTime::currentDateTime().addDays(1),
+            QFileDevice::FileModificationTime));
+    source.close();
+    EXPECT_TRUE(copier.isUnchanged(sourceFileInfo, destFileName));
+
+    // Modifying the contents without changing the size is detected, too
+    ASSERT_TRUE(source.open(QIODevice::ReadWrite));
+    ASSERT_TRUE(source.seek(source.size() / 2));
+    source.write("modified");
+    source.flush();
+    ASSERT_TRUE(source.setFileTime(
+            QDateTime::currentDateTime().addDays(2),
+            QFileDevice::FileModificationTime));
+    source.close();
+    EXPECT_FALSE(copier.isUnchanged(sourceFileInfo, destFileName));
+    EXPECT_EQ(mixxx::ExportFileCopier::Status::Copied,
+            copier.copyIfChanged(sourceFileInfo, destFileName).result().status);
+    EXPECT_TRUE(copier.isUnchanged(sourceFileInfo, destFileName));
+}
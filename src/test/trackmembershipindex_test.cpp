@@ -0,0 +1,323 @@
+#include "library/dao/trackmembershipindex.h"
+
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QMultiHash>
+#include <QSqlQuery>
+#include <QThread>
+
+#include "library/dao/playlistdao.h"
+#include "library/trackcollection.h"
+#include "test/librarytest.h"
+#include "util/db/dbconnectionpooled.h"
+#include "util/db/dbconnectionpooler.h"
+#include "util/performancetimer.h"
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h>
+#define MIXXX_BENCHMARK_HEAP_USAGE
+#endif
+
+namespace {
+
+class TrackMembershipIndexTest : public LibraryTest {
+  protected:
+    void insertRow(int trackId, int playlistId, int position) {
+        QSqlQuery query(dbConnection());
+        query.prepare(QStringLiteral(
+                "INSERT INTO " PLAYLIST_TRACKS_TABLE
+                " (playlist_id, track_id, position) "
+                "VALUES (:playlist_id, :track_id, :position)"));
+        query.bindValue(":playlist_id", playlistId);
+        query.bindValue(":track_id", trackId);
+        query.bindValue(":position", position);
+        ASSERT_TRUE(query.exec());
+    }
+
+    bool populate(TrackMembershipIndex* pIndex) {
+        return pIndex->populate(dbConnection(),
+                QStringLiteral(PLAYLIST_TRACKS_TABLE),
+                PLAYLISTTRACKSTABLE_PLAYLISTID);
+    }
+};
+
+TEST_F(TrackMembershipIndexTest, Populate) {
+    insertRow(1, 10, 1);
+    insertRow(2, 10, 2);
+    insertRow(1, 20, 1);
+    insertRow(1, 5, 1);
+
+    TrackMembershipIndex index;
+    EXPECT_FALSE(index.isPopulated());
+    ASSERT_TRUE(populate(&index));
+    EXPECT_TRUE(index.isPopulated());
+    EXPECT_EQ(4, index.size());
+    EXPECT_EQ(2, index.numTracks());
+    EXPECT_EQ(TrackMembershipIndex::ContainerIds({5, 10, 20}),
+            index.containerIds(TrackId(1)));
+    EXPECT_TRUE(index.contains(TrackId(2), 10));
+    EXPECT_FALSE(index.contains(TrackId(2), 20));
+    EXPECT_TRUE(index.containerIds(TrackId(3)).isEmpty());
+}
+
+TEST_F(TrackMembershipIndexTest, ModificationsBeforePopulateAreIgnored) {
+    TrackMembershipIndex index;
+    index.insert(TrackId(1), 10);
+    EXPECT_EQ(0, index.size());
+
+    insertRow(1, 10, 1);
+    ASSERT_TRUE(populate(&index));
+    EXPECT_EQ(1, index.size());
+
+    index.invalidate();
+    EXPECT_FALSE(index.isPopulated());
+    EXPECT_EQ(0, index.size());
+}
+
+TEST_F(TrackMembershipIndexTest, RemovesSingleOccurrence) {
+    TrackMembershipIndex index;
+    ASSERT_TRUE(populate(&index));
+    index.insert(TrackId(1), 20);
+    index.insert(TrackId(1), 10);
+    index.insert(TrackId(1), 20);
+    index.insert(TrackId(2), 20);
+    EXPECT_EQ(TrackMembershipIndex::ContainerIds({10, 20, 20}),
+            index.containerIds(TrackId(1)));
+    EXPECT_EQ(QSet<int>({10, 20}), index.containerIdSet(TrackId(1)));
+
+    // The track is still in the playlist after removing one of its
+    // occurrences
+    index.remove(TrackId(1), 20);
+    EXPECT_TRUE(index.contains(TrackId(1), 20));
+    index.remove(TrackId(1), 20);
+    EXPECT_FALSE(index.contains(TrackId(1), 20));
+    // Not contained
+    index.remove(TrackId(1), 20);
+    EXPECT_EQ(2, index.size());
+
+    index.removeContainer(20);
+    EXPECT_EQ(1, index.size());
+    EXPECT_EQ(1, index.numTracks());
+    EXPECT_TRUE(index.contains(TrackId(1), 10));
+}
+
+TEST_F(TrackMembershipIndexTest, PopulateInBackground) {
+    insertRow(1, 10, 1);
+
+    TrackMembershipIndex index;
+    index.populateInBackground(dbConnectionPooler(),
+            QStringLiteral(PLAYLIST_TRACKS_TABLE),
+            PLAYLISTTRACKSTABLE_PLAYLISTID);
+    EXPECT_TRUE(index.isPopulatingInBackground());
+    // The worker thread may or may not see this row, so the rows are read
+    // again after the modification
+    insertRow(2, 10, 2);
+    index.insert(TrackId(2), 10);
+    EXPECT_EQ(QSet<int>{10},
+            TrackMembershipIndex::queryContainerIdSet(dbConnection(),
+                    QStringLiteral(PLAYLIST_TRACKS_TABLE),
+                    PLAYLISTTRACKSTABLE_PLAYLISTID,
+                    TrackId(2)));
+
+    while (!index.finishPopulatingInBackground()) {
+        ASSERT_TRUE(index.isPopulatingInBackground());
+        QThread::msleep(1);
+    }
+    EXPECT_FALSE(index.isPopulatingInBackground());
+    EXPECT_EQ(2, index.size());
+    EXPECT_TRUE(index.contains(TrackId(1), 10));
+    EXPECT_TRUE(index.contains(TrackId(2), 10));
+}
+
+TEST_F(TrackMembershipIndexTest, PlaylistDAOKeepsIndexUpToDate) {
+    PlaylistDAO& playlistDao = internalCollection()->getPlaylistDAO();
+    const int playlistId = playlistDao.createPlaylist(QStringLiteral("Membership"));
+    ASSERT_TRUE(playlistDao.appendTracksToPlaylist(
+            {TrackId(1), TrackId(2), TrackId(1)}, playlistId));
+
+    // The first query populates the index
+    EXPECT_TRUE(playlistDao.isTrackInPlaylist(TrackId(1), playlistId));
+    playlistDao.removeTrackFromPlaylist(playlistId, 1);
+    EXPECT_TRUE(playlistDao.isTrackInPlaylist(TrackId(1), playlistId));
+    playlistDao.removeTrackFromPlaylist(playlistId, 2);
+    EXPECT_FALSE(playlistDao.isTrackInPlaylist(TrackId(1), playlistId));
+
+    ASSERT_TRUE(playlistDao.insertTrackIntoPlaylist(TrackId(3), playlistId, 1));
+    QSet<int> playlistIds;
+    playlistDao.getPlaylistsTrackIsIn(TrackId(3), &playlistIds);
+    EXPECT_EQ(QSet<int>{playlistId}, playlistIds);
+
+    playlistDao.deletePlaylist(playlistId);
+    EXPECT_FALSE(playlistDao.isTrackInPlaylist(TrackId(2), playlistId));
+    EXPECT_FALSE(playlistDao.isTrackInPlaylist(TrackId(3), playlistId));
+}
+
+constexpr int kNumBenchmarkTracks = 100000;
+
+/// Fills the table with numRows memberships. Every track is in
+/// numRows / kNumBenchmarkTracks playlists.
+void fillBenchmarkTable(QSqlDatabase database, int numRows) {
+    QSqlQuery query(database);
+    query.exec(QStringLiteral(
+            "CREATE TABLE " PLAYLIST_TRACKS_TABLE
+            " (track_id INTEGER, playlist_id INTEGER)"));
+    QVariantList trackIds;
+    QVariantList playlistIds;
+    trackIds.reserve(numRows);
+    playlistIds.reserve(numRows);
+    for (int i = 0; i < numRows; ++i) {
+        trackIds.append(1 + (i % kNumBenchmarkTracks) * 7919 % kNumBenchmarkTracks);
+        playlistIds.append(1 + i / kNumBenchmarkTracks);
+    }
+    database.transaction();
+    query.prepare(QStringLiteral(
+            "INSERT INTO " PLAYLIST_TRACKS_TABLE
+            " (track_id, playlist_id) VALUES (:track_id, :playlist_id)"));
+    query.bindValue(":track_id", trackIds);
+    query.bindValue(":playlist_id", playlistIds);
+    query.execBatch();
+    database.commit();
+}
+
+QSqlDatabase createBenchmarkDatabase(int numRows) {
+    // The database is shared by all benchmarks with the same number of rows
+    const QString connectionName =
+            QStringLiteral("TrackMembershipIndexBenchmark%1").arg(numRows);
+    if (QSqlDatabase::contains(connectionName)) {
+        return QSqlDatabase::database(connectionName);
+    }
+    QSqlDatabase database =
+            QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connectionName);
+    database.setDatabaseName(QStringLiteral(":memory:"));
+    database.open();
+    fillBenchmarkTable(database, numRows);
+    return database;
+}
+
+#ifdef MIXXX_BENCHMARK_HEAP_USAGE
+/// The number of bytes allocated on the heap, including large blocks
+/// that are mapped separately
+std::size_t heapBytesInUse() {
+    const struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+#endif
+
+} // namespace
+
+static void BM_TrackMembershipIndexPopulate(benchmark::State& state) {
+    const QSqlDatabase database = createBenchmarkDatabase(static_cast<int>(state.range(0)));
+    TrackMembershipIndex index;
+    for (auto _ : state) {
+        index.populate(database,
+                QStringLiteral(PLAYLIST_TRACKS_TABLE),
+                PLAYLISTTRACKSTABLE_PLAYLISTID);
+        benchmark::DoNotOptimize(index.size());
+    }
+    state.counters["tracks"] = index.numTracks();
+#ifdef MIXXX_BENCHMARK_HEAP_USAGE
+    // Measured outside of the timed loop with a new index, all buffers of
+    // the query have been released when populate() returns
+    index.invalidate();
+    const std::size_t heapBytesBefore = heapBytesInUse();
+    TrackMembershipIndex measuredIndex;
+    measuredIndex.populate(database,
+            QStringLiteral(PLAYLIST_TRACKS_TABLE),
+            PLAYLISTTRACKSTABLE_PLAYLISTID);
+    state.counters["heap_bytes"] = static_cast<double>(heapBytesInUse() - heapBytesBefore);
+#endif
+}
+BENCHMARK(BM_TrackMembershipIndexPopulate)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+/// Startup as done by TrackCollectionManager: the rows are read by a
+/// worker thread and only taken over by the calling thread. The time
+/// spent in the calling thread, which is the GUI thread at startup, is
+/// reported as caller_ms.
+static void BM_TrackMembershipIndexPopulateInBackground(benchmark::State& state) {
+    const int numRows = static_cast<int>(state.range(0));
+    // Workers can only access a shared in-memory database with their own
+    // connection, which needs a connection pool
+    mixxx::DbConnection::Params params;
+    params.type = QStringLiteral("QSQLITE");
+    params.connectOptions = QStringLiteral("QSQLITE_OPEN_URI");
+    params.filePath = QStringLiteral(
+            "file:TrackMembershipIndexBackgroundBenchmark%1?mode=memory&cache=shared")
+                              .arg(numRows);
+    const auto pDbConnectionPool = mixxx::DbConnectionPool::create(
+            params, QStringLiteral("TrackMembershipIndexBackgroundBenchmark"));
+    // Keeps the in-memory database alive
+    const mixxx::DbConnectionPooler pooler(pDbConnectionPool);
+    fillBenchmarkTable(mixxx::DbConnectionPooled(pDbConnectionPool), numRows);
+
+    double callerMillis = 0.0;
+    for (auto _ : state) {
+        TrackMembershipIndex index;
+        PerformanceTimer timer;
+        timer.start();
+        index.populateInBackground(pDbConnectionPool,
+                QStringLiteral(PLAYLIST_TRACKS_TABLE),
+                PLAYLISTTRACKSTABLE_PLAYLISTID);
+        callerMillis += timer.elapsed().toDoubleMillis();
+        while (true) {
+            timer.start();
+            const bool populated = index.finishPopulatingInBackground();
+            callerMillis += timer.elapsed().toDoubleMillis();
+            if (populated) {
+                break;
+            }
+            QThread::usleep(100);
+        }
+        benchmark::DoNotOptimize(index.size());
+    }
+    state.counters["caller_ms"] =
+            benchmark::Counter(callerMillis, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_TrackMembershipIndexPopulateInBackground)
+        ->Arg(1000000)
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+/// The multi-hash that has been populated at startup before
+static void BM_TrackMembershipMultiHashPopulate(benchmark::State& state) {
+    const QSqlDatabase database = createBenchmarkDatabase(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        QMultiHash<TrackId, int> playlistsTrackIsIn;
+        QSqlQuery query(database);
+        query.exec(QStringLiteral(
+                "SELECT track_id, playlist_id FROM " PLAYLIST_TRACKS_TABLE));
+        while (query.next()) {
+            playlistsTrackIsIn.insert(TrackId(query.value(0)), query.value(1).toInt());
+        }
+        benchmark::DoNotOptimize(playlistsTrackIsIn.size());
+    }
+#ifdef MIXXX_BENCHMARK_HEAP_USAGE
+    const std::size_t heapBytesBefore = heapBytesInUse();
+    QMultiHash<TrackId, int> playlistsTrackIsIn;
+    {
+        QSqlQuery query(database);
+        query.exec(QStringLiteral(
+                "SELECT track_id, playlist_id FROM " PLAYLIST_TRACKS_TABLE));
+        while (query.next()) {
+            playlistsTrackIsIn.insert(TrackId(query.value(0)), query.value(1).toInt());
+        }
+    }
+    state.counters["heap_bytes"] = static_cast<double>(heapBytesInUse() - heapBytesBefore);
+#endif
+}
+BENCHMARK(BM_TrackMembershipMultiHashPopulate)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+static void BM_TrackMembershipIndexContains(benchmark::State& state) {
+    const QSqlDatabase database = createBenchmarkDatabase(static_cast<int>(state.range(0)));
+    TrackMembershipIndex index;
+    index.populate(database,
+            QStringLiteral(PLAYLIST_TRACKS_TABLE),
+            PLAYLISTTRACKSTABLE_PLAYLISTID);
+    int trackId = 0;
+    for (auto _ : state) {
+        trackId = 1 + (trackId + 7) % kNumBenchmarkTracks;
+        benchmark::DoNotOptimize(index.contains(TrackId(trackId), 5));
+        benchmark::DoNotOptimize(index.containerIdSet(TrackId(trackId)));
+    }
+}
+BENCHMARK(BM_TrackMembershipIndexContains)->Arg(1000000);
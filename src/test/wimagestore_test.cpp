@@ -0,0 +1,122 @@
+#include "widget/wimagestore.h"
+
+#include <gtest/gtest.h>
+
+#include <QSemaphore>
+#include <atomic>
+#include <thread>
+
+#include "skin/legacy/imgloader.h"
+#include "test/mixxxtest.h"
+
+namespace {
+
+// Long enough for a slow CI machine, the test fails instead of hanging
+constexpr int kTimeoutMillis = 10000;
+
+const QString kBlockingFileName = QStringLiteral("blocking.png");
+const QString kOtherFileName = QStringLiteral("other.png");
+
+/// Generates the images instead of loading them. The image of
+/// kBlockingFileName is not returned before the test continues it.
+class BlockingImgSource : public ImgSource {
+  public:
+    BlockingImgSource()
+            : m_numLoadedImages(0),
+              m_continued(true) {
+    }
+
+    QImage* getImage(const QString& fileName, double scaleFactor) const override {
+        Q_UNUSED(scaleFactor);
+        if (fileName == kBlockingFileName) {
+            m_loading.release();
+            if (!m_continue.tryAcquire(1, kTimeoutMillis)) {
+                m_continued = false;
+            }
+        }
+        ++m_numLoadedImages;
+        auto* pImage = new QImage(4, 4, QImage::Format_ARGB32);
+        pImage->fill(Qt::black);
+        return pImage;
+    }
+
+    /// Waits until the image of kBlockingFileName is loaded by numLoads threads
+    bool waitUntilLoading(int numLoads) {
+        return m_loading.tryAcquire(numLoads, kTimeoutMillis);
+    }
+    void continueLoading(int numLoads) {
+        m_continue.release(numLoads);
+    }
+
+    int numLoadedImages() const {
+        return m_numLoadedImages;
+    }
+    /// Returns false if a load has timed out
+    bool continued() const {
+        return m_continued;
+    }
+
+  private:
+    mutable QSemaphore m_loading;
+    mutable QSemaphore m_continue;
+    mutable std::atomic<int> m_numLoadedImages;
+    mutable std::atomic<bool> m_continued;
+};
+
+class WImageStoreTest : public MixxxTest {
+  protected:
+    WImageStoreTest()
+            : m_pLoader(new BlockingImgSource()) {
+        WImageStore::setLoader(m_pLoader);
+    }
+
+    ~WImageStoreTest() override {
+        WImageStore::setLoader(QSharedPointer<ImgSource>(new ImgLoader()));
+    }
+
+    QSharedPointer<BlockingImgSource> m_pLoader;
+};
+
+TEST_F(WImageStoreTest, LoadsOtherImageWhileLoading) {
+    std::shared_ptr<QImage> pBlockingImage;
+    std::thread loader([&pBlockingImage] {
+        pBlockingImage = WImageStore::getImage(kBlockingFileName, 1.0);
+    });
+    ASSERT_TRUE(m_pLoader->waitUntilLoading(1));
+
+    // Would wait for the other load, if the store was locked while loading
+    const auto pOtherImage = WImageStore::getImage(kOtherFileName, 1.0);
+    m_pLoader->continueLoading(1);
+    loader.join();
+
+    EXPECT_TRUE(m_pLoader->continued());
+    EXPECT_TRUE(pOtherImage);
+    EXPECT_TRUE(pBlockingImage);
+    EXPECT_NE(pOtherImage, pBlockingImage);
+}
+
+TEST_F(WImageStoreTest, ConcurrentLoadsReturnSameImage) {
+    std::shared_ptr<QImage> pFirstImage;
+    std::shared_ptr<QImage> pSecondImage;
+    std::thread firstLoader([&pFirstImage] {
+        pFirstImage = WImageStore::getImage(kBlockingFileName, 1.0);
+    });
+    std::thread secondLoader([&pSecondImage] {
+        pSecondImage = WImageStore::getImage(kBlockingFileName, 1.0);
+    });
+    // Both threads miss the cache and load the image
+    EXPECT_TRUE(m_pLoader->waitUntilLoading(2));
+    m_pLoader->continueLoading(2);
+    firstLoader.join();
+    secondLoader.join();
+
+    EXPECT_TRUE(m_pLoader->continued());
+    EXPECT_EQ(2, m_pLoader->numLoadedImages());
+    // Only one of the images has been cached
+    ASSERT_TRUE(pFirstImage);
+    EXPECT_EQ(pFirstImage, pSecondImage);
+    EXPECT_EQ(pFirstImage, WImageStore::getImage(kBlockingFileName, 1.0));
+    EXPECT_EQ(2, m_pLoader->numLoadedImages());
+}
+
+} // namespace
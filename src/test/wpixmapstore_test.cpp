@@ -0,0 +1,97 @@
+#include "widget/wpixmapstore.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+
+#include "skin/legacy/imgloader.h"
+#include "test/mixxxtest.h"
+
+namespace {
+
+const QString kPNGLocationTest = QStringLiteral("id3-test-data/reference_cover.png");
+
+/// Counts the images that are loaded, also by the prefetch threads
+class CountingImgLoader : public ImgLoader {
+  public:
+    CountingImgLoader()
+            : m_numLoadedImages(0) {
+    }
+
+    QImage* getImage(const QString& fileName, double scaleFactor) const override {
+        ++m_numLoadedImages;
+        return ImgLoader::getImage(fileName, scaleFactor);
+    }
+
+    int numLoadedImages() const {
+        return m_numLoadedImages;
+    }
+
+  private:
+    mutable std::atomic<int> m_numLoadedImages;
+};
+
+class WPixmapStoreTest : public MixxxTest {
+  protected:
+    WPixmapStoreTest()
+            : m_pLoader(new CountingImgLoader()) {
+        WPixmapStore::setLoader(m_pLoader);
+    }
+
+    QString pngPath() const {
+        return getTestDir().filePath(kPNGLocationTest);
+    }
+
+    void TearDown() override {
+        WPixmapStore::takeRecordedPaintableFiles();
+        // Also clears the cached and the prefetched Paintables
+        WPixmapStore::setLoader(QSharedPointer<ImgSource>(new ImgLoader()));
+    }
+
+    QSharedPointer<CountingImgLoader> m_pLoader;
+};
+
+TEST_F(WPixmapStoreTest, prefetchedPaintableMatchesLoadedPaintable) {
+    const Paintable loaded(PixmapSource(pngPath()), Paintable::FIXED, 1.0);
+    ASSERT_FALSE(loaded.size().isEmpty());
+    ASSERT_EQ(1, m_pLoader->numLoadedImages());
+
+    WPixmapStore::prefetchPaintables({PaintableFile{pngPath(), Paintable::FIXED, 1.0}});
+    EXPECT_EQ(2, m_pLoader->numLoadedImages());
+    PaintablePointer pPrefetched =
+            WPixmapStore::getPaintable(PixmapSource(pngPath()), Paintable::FIXED, 1.0);
+    ASSERT_TRUE(pPrefetched);
+    EXPECT_EQ(loaded.size(), pPrefetched->size());
+    // The prefetched image has been taken over instead of loading it again
+    EXPECT_EQ(2, m_pLoader->numLoadedImages());
+
+    // Prefetched images are only used once, the Paintable is cached instead
+    WPixmapStore::clearPrefetchedPaintables();
+    EXPECT_EQ(pPrefetched,
+            WPixmapStore::getPaintable(PixmapSource(pngPath()), Paintable::FIXED, 1.0));
+    EXPECT_EQ(2, m_pLoader->numLoadedImages());
+}
+
+TEST_F(WPixmapStoreTest, recordsLoadedPaintableFiles) {
+    WPixmapStore::startRecordingPaintableFiles();
+    PaintablePointer pFirst =
+            WPixmapStore::getPaintable(PixmapSource(pngPath()), Paintable::TILE, 1.0);
+    // Cached, not loaded again
+    PaintablePointer pSecond =
+            WPixmapStore::getPaintable(PixmapSource(pngPath()), Paintable::TILE, 1.0);
+    EXPECT_EQ(pFirst, pSecond);
+    // Inline SVGs are not recorded
+    PixmapSource inlineSvg;
+    inlineSvg.setSVG(QByteArrayLiteral(
+            "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"4\" height=\"4\"/>"));
+    PaintablePointer pInline = WPixmapStore::getPaintable(inlineSvg, Paintable::TILE, 1.0);
+
+    const QList<PaintableFile> files = WPixmapStore::takeRecordedPaintableFiles();
+    ASSERT_EQ(1, files.size());
+    EXPECT_QSTRING_EQ(pngPath(), files.first().path);
+    EXPECT_EQ(Paintable::TILE, files.first().mode);
+    EXPECT_EQ(1.0, files.first().scaleFactor);
+    EXPECT_TRUE(WPixmapStore::takeRecordedPaintableFiles().isEmpty());
+}
+
+} // namespace
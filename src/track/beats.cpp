@@ -1,5 +1,6 @@
 #include "track/beats.h"
 
+#include <algorithm>
 #include <cmath>
 #include <iterator>
 #include <vector>
@@ -72,10 +73,7 @@ Beats::ConstIterator Beats::ConstIterator::operator+=(Beats::ConstIterator::diff
     }
 
     m_beatOffset = beatOffset;
-    while (m_it != m_beats->m_markers.cend() && m_beatOffset >= m_it->beatsTillNextMarker()) {
-        m_beatOffset -= m_it->beatsTillNextMarker();
-        m_it++;
-    }
+    m_beats->seekMarkerSection(&m_it, &m_beatOffset);
     updateValue();
     return *this;
 }
@@ -115,33 +113,22 @@ Beats::ConstIterator Beats::ConstIterator::operator-=(Beats::ConstIterator::diff
     }
 
     m_beatOffset = beatOffset;
-    while (m_it != m_beats->m_markers.cbegin() && m_beatOffset < 0) {
-        m_it--;
-        m_beatOffset += m_it->beatsTillNextMarker();
-    }
+    m_beats->seekMarkerSection(&m_it, &m_beatOffset);
     updateValue();
     return *this;
 }
 
 Beats::ConstIterator::difference_type Beats::ConstIterator::operator-(
         const Beats::ConstIterator& other) const {
-    const int vectorItDiff = m_it - other.m_it;
-    if (vectorItDiff == 0) {
-        return m_beatOffset - other.m_beatOffset;
-    }
-
-    if (vectorItDiff > 0) {
-        return -(other - *this);
-    }
-
-    auto it = m_it;
-    int result = -m_beatOffset + other.m_beatOffset;
-    while (it != m_beats->m_markers.cend() && it != other.m_it) {
-        result += it->beatsTillNextMarker();
-        it++;
-    }
-    DEBUG_ASSERT(it == other.m_it);
-    return -result;
+    DEBUG_ASSERT(m_beats == other.m_beats);
+    const auto& cumulativeBeats = m_beats->m_cumulativeBeats;
+    const qint64 beatIndex =
+            static_cast<qint64>(cumulativeBeats[m_beats->markerIndex(m_it)]) +
+            m_beatOffset;
+    const qint64 otherBeatIndex =
+            static_cast<qint64>(cumulativeBeats[m_beats->markerIndex(other.m_it)]) +
+            other.m_beatOffset;
+    return static_cast<difference_type>(beatIndex - otherBeatIndex);
 }
 
 void Beats::ConstIterator::updateValue() {
@@ -443,8 +430,26 @@ Beats::ConstIterator Beats::iteratorFrom(audio::FramePos position) const {
             return cbegin();
         }
         it -= static_cast<int>(n);
-    } else {
-        it = std::lower_bound(cfirstmarker(), clastmarker() + 1, position);
+    } else if (!m_markers.empty()) {
+        // Lookup position is inside a marker section, so the beat can be
+        // computed directly instead of searching through all beats.
+        const int markerIndex = findMarkerSectionIndex(position);
+        const auto markerIt = m_markers.cbegin() + markerIndex;
+        const audio::FrameDiff_t beatLengthFrames =
+                (markerSectionEndPosition(markerIndex) - markerIt->position()) /
+                markerIt->beatsTillNextMarker();
+        const double n = std::ceil((position - markerIt->position()) / beatLengthFrames);
+        it = ConstIterator(this, markerIt, 0) + static_cast<int>(n);
+
+        // Compensate floating point errors of the division in both
+        // directions, the result must be the first beat at or after the
+        // position.
+        auto previousBeatIt = it - 1;
+        if (*previousBeatIt >= position) {
+            it = previousBeatIt;
+        } else if (*it < position) {
+            it++;
+        }
     }
     DEBUG_ASSERT(it == cbegin() || it == cend() || *it >= position);
     DEBUG_ASSERT(it == cbegin() || it == cend() ||
@@ -692,6 +697,62 @@ mixxx::audio::FrameDiff_t Beats::lastBeatLengthFrames() const {
     return 60.0 * m_sampleRate / m_lastMarkerBpm.value();
 }
 
+void Beats::initCumulativeBeats() {
+    m_cumulativeBeats.reserve(m_markers.size() + 1);
+    int numBeats = 0;
+    m_cumulativeBeats.push_back(numBeats);
+    for (const BeatMarker& marker : m_markers) {
+        numBeats += marker.beatsTillNextMarker();
+        m_cumulativeBeats.push_back(numBeats);
+    }
+}
+
+mixxx::audio::FramePos Beats::markerSectionEndPosition(int markerIndex) const {
+    DEBUG_ASSERT(markerIndex >= 0 && markerIndex < static_cast<int>(m_markers.size()));
+    const int nextMarkerIndex = markerIndex + 1;
+    return (nextMarkerIndex < static_cast<int>(m_markers.size()))
+            ? m_markers[nextMarkerIndex].position()
+            : m_lastMarkerPosition;
+}
+
+int Beats::findMarkerSectionIndex(mixxx::audio::FramePos position) const {
+    DEBUG_ASSERT(!m_markers.empty());
+    DEBUG_ASSERT(position >= m_markers.front().position());
+    DEBUG_ASSERT(position <= m_lastMarkerPosition);
+
+    const auto upperBound = std::upper_bound(m_markers.cbegin(),
+            m_markers.cend(),
+            position,
+            [](mixxx::audio::FramePos position, const BeatMarker& marker) {
+                return position < marker.position();
+            });
+    DEBUG_ASSERT(upperBound != m_markers.cbegin());
+    return markerIndex(std::prev(upperBound));
+}
+
+void Beats::seekMarkerSection(std::vector<BeatMarker>::const_iterator* pMarkerIt,
+        int* pBeatOffset) const {
+    const int index = markerIndex(*pMarkerIt);
+    const bool isFirstSection = index == 0;
+    const bool isLastSection = index == static_cast<int>(m_markers.size());
+    if ((isFirstSection || *pBeatOffset >= 0) &&
+            (isLastSection || *pBeatOffset < m_markers[index].beatsTillNextMarker())) {
+        // Still inside the current section
+        return;
+    }
+
+    // The first and the last section are open-ended, so every beat index
+    // maps to exactly one section.
+    const qint64 beatIndex = static_cast<qint64>(m_cumulativeBeats[index]) + *pBeatOffset;
+    const auto upperBound = std::upper_bound(
+            m_cumulativeBeats.cbegin(), m_cumulativeBeats.cend(), beatIndex);
+    const int newIndex = (upperBound == m_cumulativeBeats.cbegin())
+            ? 0
+            : static_cast<int>(std::prev(upperBound) - m_cumulativeBeats.cbegin());
+    *pMarkerIt = m_markers.cbegin() + newIndex;
+    *pBeatOffset = static_cast<int>(beatIndex - m_cumulativeBeats[newIndex]);
+}
+
 audio::FramePos Beats::snapPosToNearBeat(audio::FramePos position) const {
     audio::FramePos prevBeatPosition;
     audio::FramePos nextBeatPosition;
@@ -708,16 +769,13 @@ audio::FramePos Beats::snapPosToNearBeat(audio::FramePos position) const {
 
 int Beats::numBeatsInRange(audio::FramePos startPosition, audio::FramePos endPosition) const {
     startPosition = snapPosToNearBeat(startPosition);
-    audio::FramePos lastPosition = audio::kStartFramePos;
-    int i = 1;
-    while (lastPosition < endPosition) {
-        lastPosition = findNthBeat(startPosition, i);
-        if (!lastPosition.isValid()) {
-            break;
-        }
-        i++;
+    if (endPosition <= audio::kStartFramePos) {
+        // Preserve the result of the former beat-by-beat implementation,
+        // which never started counting in this case.
+        return -1;
     }
-    return i - 2;
+    const int numBeats = iteratorFrom(endPosition) - iteratorFrom(startPosition);
+    return std::max(numBeats, 0);
 };
 
 audio::FramePos Beats::findNextBeat(audio::FramePos position) const {
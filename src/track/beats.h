@@ -165,6 +165,7 @@ class Beats : private std::enable_shared_from_this<Beats> {
         DEBUG_ASSERT(!m_lastMarkerPosition.isFractional());
         DEBUG_ASSERT(m_lastMarkerBpm.isValid());
         DEBUG_ASSERT(m_sampleRate.isValid());
+        initCumulativeBeats();
     }
 
     Beats(mixxx::audio::FramePos lastMarkerPosition,
@@ -427,6 +428,23 @@ class Beats : private std::enable_shared_from_this<Beats> {
     mixxx::audio::FrameDiff_t firstBeatLengthFrames() const;
     mixxx::audio::FrameDiff_t lastBeatLengthFrames() const;
 
+    void initCumulativeBeats();
+    /// Returns the index of the beat marker at `markerIt`, where the end
+    /// iterator refers to the last marker.
+    int markerIndex(std::vector<BeatMarker>::const_iterator markerIt) const {
+        return static_cast<int>(markerIt - m_markers.cbegin());
+    }
+    /// Returns the position at which the section of the marker with the
+    /// given index ends, i.e. the position of the following marker.
+    mixxx::audio::FramePos markerSectionEndPosition(int markerIndex) const;
+    /// Returns the index of the marker whose section contains `position`,
+    /// which must not be before the first or after the last marker.
+    int findMarkerSectionIndex(mixxx::audio::FramePos position) const;
+    /// Moves the iterator to the marker section that contains the beat with
+    /// the given (possibly out of section) offset.
+    void seekMarkerSection(std::vector<BeatMarker>::const_iterator* pMarkerIt,
+            int* pBeatOffset) const;
+
     std::vector<BeatMarker> m_markers;
     mixxx::audio::FramePos m_lastMarkerPosition;
     mixxx::Bpm m_lastMarkerBpm;
@@ -434,6 +452,11 @@ class Beats : private std::enable_shared_from_this<Beats> {
 
     // The sub-version of this beatgrid.
     const QString m_subVersion;
+
+    // The number of beats before each beat marker, followed by the number of
+    // beats before the last marker. This allows to find the marker section
+    // of a beat with a binary search instead of iterating over all markers.
+    std::vector<int> m_cumulativeBeats;
 };
 
 } // namespace mixxx
@@ -1,5 +1,6 @@
 #include <QSqlDriver>
 #include <QSqlError>
+#include <QSqlQuery>
 
 #ifdef __SQLITE3__
 #include <sqlite3.h>
@@ -305,6 +306,24 @@ bool initDatabase(const QSqlDatabase& database, mixxx::StringCollator* pCollator
                 << "Failed to install custom 3-arg LIKE function for SQLite3:"
                 << result;
     }
+
+    // In WAL mode readers and the writer don't block each other, i.e.
+    // the library views stay responsive while the scanner or analyzer
+    // write. The mode is persistent and has no effect on in-memory
+    // databases.
+    QSqlQuery query(database);
+    if (!query.exec(QStringLiteral("PRAGMA journal_mode=WAL"))) {
+        kLogger.warning()
+                << "Failed to enable write-ahead logging for SQLite3:"
+                << query.lastError();
+    }
+    // Commits are still atomic and durable across crashes of Mixxx.
+    // Only a power loss may roll back the most recent commits.
+    if (!query.exec(QStringLiteral("PRAGMA synchronous=NORMAL"))) {
+        kLogger.warning()
+                << "Failed to set synchronous mode for SQLite3:"
+                << query.lastError();
+    }
 #else
     Q_UNUSED(database);
     Q_UNUSED(pCollator);
@@ -351,10 +370,14 @@ bool DbConnection::open() {
         m_sqlDatabase.close();
         return false; // abort
     }
+    m_statementCache.attach(name());
     return true;
 }
 
 void DbConnection::close() {
+    // The cached statements must be deleted before the connection
+    // is closed and removed.
+    m_statementCache.detach();
     if (m_sqlDatabase.isOpen()) {
         // There should never be an outstanding transaction when this code is
         // called. If there is, it means we probably aren't committing a
@@ -0,0 +1,127 @@
+#include "util/db/sqlbatchinserter.h"
+
+#include <QSqlError>
+
+#include "util/assert.h"
+#include "util/logger.h"
+#include "util/math.h"
+
+namespace {
+
+const mixxx::Logger kLogger("SqlBatchInserter");
+
+// SQLITE_MAX_VARIABLE_NUMBER before SQLite 3.32
+constexpr int kMaxParameters = 999;
+
+// Larger batches do not improve the performance noticeably
+constexpr int kMaxBatchSize = 256;
+
+QString conflictClause(SqlBatchInserter::OnConflict onConflict) {
+    switch (onConflict) {
+    case SqlBatchInserter::OnConflict::Abort:
+        return QString();
+    case SqlBatchInserter::OnConflict::Ignore:
+        return QStringLiteral(" OR IGNORE");
+    case SqlBatchInserter::OnConflict::Replace:
+        return QStringLiteral(" OR REPLACE");
+    }
+    DEBUG_ASSERT(!"unreachable");
+    return QString();
+}
+
+} // anonymous namespace
+
+SqlBatchInserter::SqlBatchInserter(
+        const QSqlDatabase& database,
+        const QString& tableName,
+        const QStringList& columnNames,
+        OnConflict onConflict)
+        : m_database(database),
+          m_tableName(tableName),
+          m_columnNames(columnNames),
+          m_onConflict(onConflict),
+          m_batchSize(math_clamp(
+                  kMaxParameters / math_max(1, static_cast<int>(columnNames.size())),
+                  1,
+                  kMaxBatchSize)),
+          m_batchQuery(database),
+          m_batchQueryPrepared(false) {
+    DEBUG_ASSERT(!columnNames.isEmpty());
+    m_pendingValues.reserve(m_batchSize * m_columnNames.size());
+}
+
+SqlBatchInserter::~SqlBatchInserter() {
+    flush();
+}
+
+QString SqlBatchInserter::statement(int numRows) const {
+    DEBUG_ASSERT(numRows > 0);
+    QString placeholders = QStringLiteral("?");
+    for (int i = 1; i < m_columnNames.size(); ++i) {
+        placeholders += QStringLiteral(",?");
+    }
+    const QString row = QChar('(') + placeholders + QChar(')');
+    QString rows = row;
+    for (int i = 1; i < numRows; ++i) {
+        rows += QChar(',') + row;
+    }
+    return QStringLiteral("INSERT%1 INTO %2 (%3) VALUES %4")
+            .arg(conflictClause(m_onConflict),
+                    m_tableName,
+                    m_columnNames.join(QChar(',')),
+                    rows);
+}
+
+bool SqlBatchInserter::append(const QVariantList& values) {
+    VERIFY_OR_DEBUG_ASSERT(values.size() == m_columnNames.size()) {
+        return false;
+    }
+    m_pendingValues += values;
+    if (m_pendingValues.size() < m_batchSize * m_columnNames.size()) {
+        return true;
+    }
+    if (!m_batchQueryPrepared) {
+        m_batchQueryPrepared = m_batchQuery.prepare(statement(m_batchSize));
+    }
+    if (!m_batchQueryPrepared) {
+        kLogger.warning()
+                << "Failed to prepare insert into"
+                << m_tableName
+                << m_batchQuery.lastError();
+        m_pendingValues.clear();
+        return false;
+    }
+    return exec(&m_batchQuery);
+}
+
+bool SqlBatchInserter::flush() {
+    if (m_pendingValues.isEmpty()) {
+        return true;
+    }
+    // The last batch is usually incomplete and needs its own statement
+    QSqlQuery query(m_database);
+    if (!query.prepare(statement(m_pendingValues.size() / m_columnNames.size()))) {
+        kLogger.warning()
+                << "Failed to prepare insert into"
+                << m_tableName
+                << query.lastError();
+        m_pendingValues.clear();
+        return false;
+    }
+    return exec(&query);
+}
+
+bool SqlBatchInserter::exec(QSqlQuery* pQuery) {
+    for (int i = 0; i < m_pendingValues.size(); ++i) {
+        pQuery->bindValue(i, m_pendingValues.at(i));
+    }
+    m_pendingValues.clear();
+    if (!pQuery->exec()) {
+        kLogger.warning()
+                << "Failed to insert into"
+                << m_tableName
+                << pQuery->lastError();
+        return false;
+    }
+    return true;
+}
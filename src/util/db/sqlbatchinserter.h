@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+
+/// Inserts rows into a table with multi-row INSERT statements.
+///
+/// Rows are buffered and written with a single prepared statement per
+/// batch, which is much faster than executing a statement per row. The
+/// batch size is chosen so that a statement never has more parameters
+/// than SQLite versions before 3.32 support.
+///
+/// Pending rows are written when the inserter is destroyed. Call flush()
+/// explicitly to check for errors.
+class SqlBatchInserter final {
+  public:
+    enum class OnConflict {
+        Abort,
+        Ignore,
+        Replace,
+    };
+
+    SqlBatchInserter(
+            const QSqlDatabase& database,
+            const QString& tableName,
+            const QStringList& columnNames,
+            OnConflict onConflict = OnConflict::Abort);
+    ~SqlBatchInserter();
+
+    int batchSize() const {
+        return m_batchSize;
+    }
+
+    /// The values must be given in the order of the column names.
+    /// Writes a batch when it is full and returns false if that fails.
+    bool append(const QVariantList& values);
+
+    /// Writes all pending rows
+    bool flush();
+
+    /// Drops all pending rows, e.g. before rolling back a failed import
+    void discard() {
+        m_pendingValues.clear();
+    }
+
+    // Disable copy construction and copy/move assignment
+    SqlBatchInserter(const SqlBatchInserter&) = delete;
+    SqlBatchInserter& operator=(const SqlBatchInserter&) = delete;
+
+  private:
+    QString statement(int numRows) const;
+    bool exec(QSqlQuery* pQuery);
+
+    const QSqlDatabase m_database;
+    const QString m_tableName;
+    const QStringList m_columnNames;
+    const OnConflict m_onConflict;
+    const int m_batchSize;
+
+    // Prepared once for full batches
+    QSqlQuery m_batchQuery;
+    bool m_batchQueryPrepared;
+    QVariantList m_pendingValues;
+};
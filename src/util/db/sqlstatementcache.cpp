@@ -0,0 +1,153 @@
+#include "util/db/sqlstatementcache.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QSqlError>
+
+#include "util/assert.h"
+#include "util/compatibility/qmutex.h"
+#include "util/logger.h"
+#include "util/performancetimer.h"
+#include "util/stat.h"
+
+namespace {
+
+const mixxx::Logger kLogger("SqlStatementCache");
+
+// The number of characters of a statement in its tag, enough to
+// recognize it in the statistics
+constexpr int kMaxStatTagStatementLength = 80;
+
+// Each connection is used by a single thread, but the registry is shared
+QMutex s_registryMutex;
+QHash<QString, SqlStatementCache*> s_cachesByConnectionName;
+
+QString statTag(const QString& sql) {
+    QString tag = sql.simplified();
+    if (tag.size() > kMaxStatTagStatementLength) {
+        tag.truncate(kMaxStatTagStatementLength);
+        tag += QStringLiteral("...");
+    }
+    return QStringLiteral("SQL ") + tag;
+}
+
+/// Rounds the duration up to a power of 2 of microseconds. This limits
+/// the number of distinct values of the histogram.
+double histogramBucketNanos(qint64 nanos) {
+    qint64 bucketNanos = 1000;
+    while (bucketNanos < nanos) {
+        bucketNanos *= 2;
+    }
+    return static_cast<double>(bucketNanos);
+}
+
+} // anonymous namespace
+
+SqlStatementCache::SqlStatementCache(int maxStatements)
+        : m_statements(maxStatements) {
+}
+
+SqlStatementCache::~SqlStatementCache() {
+    detach();
+}
+
+//static
+SqlStatementCache* SqlStatementCache::forDatabase(const QSqlDatabase& database) {
+    const auto locked = lockMutex(&s_registryMutex);
+    return s_cachesByConnectionName.value(database.connectionName());
+}
+
+void SqlStatementCache::attach(const QString& connectionName) {
+    DEBUG_ASSERT(m_connectionName.isEmpty());
+    m_connectionName = connectionName;
+    const auto locked = lockMutex(&s_registryMutex);
+    DEBUG_ASSERT(!s_cachesByConnectionName.contains(connectionName));
+    s_cachesByConnectionName.insert(connectionName, this);
+}
+
+void SqlStatementCache::detach() {
+    if (m_connectionName.isEmpty()) {
+        DEBUG_ASSERT(m_statements.isEmpty());
+        return;
+    }
+    {
+        const auto locked = lockMutex(&s_registryMutex);
+        s_cachesByConnectionName.remove(m_connectionName);
+    }
+    m_connectionName.clear();
+    m_statements.clear();
+}
+
+std::unique_ptr<SqlStatementCache::Statement> SqlStatementCache::take(const QString& sql) {
+    return std::unique_ptr<Statement>(m_statements.take(sql));
+}
+
+void SqlStatementCache::put(const QString& sql, std::unique_ptr<Statement> pStatement) {
+    DEBUG_ASSERT(pStatement);
+    DEBUG_ASSERT(!pStatement->query.isActive());
+    if (m_connectionName.isEmpty()) {
+        // Detached, i.e. the connection is about to be closed
+        return;
+    }
+    // Replaces and deletes a statement with the same SQL text that
+    // has been borrowed and returned in the meantime.
+    m_statements.insert(sql, pStatement.release());
+}
+
+CachedSqlQuery::CachedSqlQuery(
+        const QSqlDatabase& database,
+        const QString& statement)
+        : m_pCache(SqlStatementCache::forDatabase(database)),
+          m_statement(statement),
+          m_prepared(false) {
+    if (m_pCache) {
+        m_pStatement = m_pCache->take(statement);
+        if (m_pStatement) {
+            m_prepared = true;
+            return;
+        }
+    }
+    m_pStatement = std::make_unique<SqlStatementCache::Statement>(database);
+    m_pStatement->query.setForwardOnly(true);
+    m_prepared = m_pStatement->query.prepare(statement);
+    if (!m_prepared) {
+        kLogger.warning()
+                << "Failed to prepare statement"
+                << statement
+                << ":"
+                << m_pStatement->query.lastError();
+        return;
+    }
+    m_pStatement->statTag = statTag(statement);
+    m_pStatement->histogramStatTag =
+            m_pStatement->statTag + QStringLiteral(" histogram");
+}
+
+CachedSqlQuery::~CachedSqlQuery() {
+    if (!m_pCache || !m_prepared) {
+        return;
+    }
+    // Releases the result set and the locks of a SELECT statement
+    m_pStatement->query.finish();
+    m_pCache->put(m_statement, std::move(m_pStatement));
+}
+
+bool CachedSqlQuery::exec() {
+    VERIFY_OR_DEBUG_ASSERT(m_prepared) {
+        return false;
+    }
+    PerformanceTimer timer;
+    timer.start();
+    const bool success = m_pStatement->query.exec();
+    const qint64 nanos = timer.elapsed().toIntegerNanos();
+    Stat::track(m_pStatement->statTag,
+            Stat::DURATION_NANOSEC,
+            Stat::experimentFlags(Stat::COUNT | Stat::SUM | Stat::AVERAGE |
+                    Stat::SAMPLE_VARIANCE | Stat::MIN | Stat::MAX),
+            static_cast<double>(nanos));
+    Stat::track(m_pStatement->histogramStatTag,
+            Stat::DURATION_NANOSEC,
+            Stat::experimentFlags(Stat::COUNT | Stat::HISTOGRAM),
+            histogramBucketNanos(nanos));
+    return success;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <QCache>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <memory>
+
+/// An LRU cache of the prepared statements of a database connection,
+/// keyed by their SQL text.
+///
+/// Preparing a statement parses and plans it, which often takes longer
+/// than executing it. The DAOs execute the same statements again and
+/// again, so each connection keeps the most recently used ones.
+///
+/// The cache is owned by the connection and must only be accessed from
+/// the thread of the connection. Use CachedSqlQuery to access it.
+class SqlStatementCache final {
+  public:
+    static constexpr int kDefaultMaxStatements = 64;
+
+    struct Statement {
+        explicit Statement(const QSqlDatabase& database)
+                : query(database) {
+        }
+
+        QSqlQuery query;
+        /// The tags of the execution times for the StatsManager
+        QString statTag;
+        QString histogramStatTag;
+    };
+
+    explicit SqlStatementCache(int maxStatements = kDefaultMaxStatements);
+    ~SqlStatementCache();
+
+    /// Returns the cache of the connection, or nullptr if it has none.
+    static SqlStatementCache* forDatabase(const QSqlDatabase& database);
+
+    /// Makes the cache available for the connection with the given name
+    void attach(const QString& connectionName);
+    /// Finishes and deletes all statements. Must be invoked before the
+    /// connection is closed.
+    void detach();
+
+    /// Removes the prepared statement from the cache and returns it, or
+    /// nullptr if it has not been cached. Statements are not shared, so
+    /// a statement that is in use is not found.
+    std::unique_ptr<Statement> take(const QString& sql);
+    /// Returns a finished statement to the cache
+    void put(const QString& sql, std::unique_ptr<Statement> pStatement);
+
+    int size() const {
+        return m_statements.size();
+    }
+
+    // Disable copy construction and copy/move assignment
+    SqlStatementCache(const SqlStatementCache&) = delete;
+    SqlStatementCache& operator=(const SqlStatementCache&) = delete;
+
+  private:
+    QString m_connectionName;
+    QCache<QString, Statement> m_statements;
+};
+
+/// A prepared statement that is borrowed from the statement cache of
+/// the connection, if any, and returned to it when it goes out of scope.
+///
+/// Use it instead of QSqlQuery for statements with a constant SQL text
+/// that are executed frequently. Values must be bound as placeholders.
+/// Like FwdSqlQuery, the query is forward-only.
+class CachedSqlQuery final {
+  public:
+    CachedSqlQuery(
+            const QSqlDatabase& database,
+            const QString& statement);
+    ~CachedSqlQuery();
+
+    bool isPrepared() const {
+        return m_prepared;
+    }
+
+    /// Executes the prepared statement and reports the execution time
+    /// to the StatsManager.
+    bool exec();
+
+    QSqlQuery& operator*() {
+        return m_pStatement->query;
+    }
+    QSqlQuery* operator->() {
+        return &m_pStatement->query;
+    }
+
+    // Disable copy construction and copy/move assignment
+    CachedSqlQuery(const CachedSqlQuery&) = delete;
+    CachedSqlQuery& operator=(const CachedSqlQuery&) = delete;
+
+  private:
+    SqlStatementCache* const m_pCache;
+    const QString m_statement;
+    std::unique_ptr<SqlStatementCache::Statement> m_pStatement;
+    bool m_prepared;
+};
@@ -1,69 +1,238 @@
 #pragma once
 
-#include "pa_ringbuffer.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <thread>
+#include <vector>
+#include <version>
 
+#include "util/assert.h"
 #include "util/class.h"
 #include "util/math.h"
 
-template <class DataType>
+namespace mixxx {
+
+namespace fifo {
+
+// Keeps the indices of the producer and the consumer in separate cache
+// lines, to avoid false sharing.
+constexpr std::size_t kCacheLineSize = 64;
+
+using Index = std::uint32_t;
+static_assert(std::atomic<Index>::is_always_lock_free);
+
+} // namespace fifo
+
+} // namespace mixxx
+
+/// A lock-free ring buffer for a single producer thread and a single
+/// consumer thread.
+///
+/// Besides copying read() and write(), the producer can reserve a region
+/// of the buffer, write into it in place and commit it, and the consumer
+/// can do the same for reading. A region consists of up to two contiguous
+/// spans, the second one is only used when the region wraps around the end
+/// of the buffer.
+///
+/// The capacity is rounded up to a power of 2.
+template<class DataType>
 class FIFO {
   public:
-    explicit FIFO(int size)
-            : m_data(roundUpToPowerOf2(size)) {
-        // If we can't represent the next higher power of 2 then bail.
-        if (m_data.size() == 0) {
-            return;
+    /// Up to two contiguous spans of a reserved region
+    template<class T>
+    struct Regions {
+        std::span<T> first;
+        std::span<T> second;
+
+        int size() const {
+            return static_cast<int>(first.size() + second.size());
         }
-        PaUtil_InitializeRingBuffer(&m_ringBuffer,
-                static_cast<ring_buffer_size_t>(sizeof(DataType)),
-                static_cast<ring_buffer_size_t>(m_data.size()),
-                m_data.data());
+    };
+    using WriteRegions = Regions<DataType>;
+    using ReadRegions = Regions<const DataType>;
+
+    explicit FIFO(int size)
+            : m_data(roundUpToPowerOf2(size)),
+              m_mask(static_cast<mixxx::fifo::Index>(m_data.size() - 1)),
+              m_writeIndex(0),
+              m_cachedReadIndex(0),
+              m_readIndex(0),
+              m_cachedWriteIndex(0),
+              m_producerWaiting(false),
+              m_consumerWaiting(false) {
+        // roundUpToPowerOf2() returns 0 if it can't represent the next
+        // higher power of 2.
+        DEBUG_ASSERT(!m_data.empty());
     }
     virtual ~FIFO() {
     }
+
+    int capacity() const {
+        return static_cast<int>(m_data.size());
+    }
     int readAvailable() const {
-        return PaUtil_GetRingBufferReadAvailable(&m_ringBuffer);
+        // Load the read index first, it never overtakes the write index
+        const mixxx::fifo::Index readIndex = m_readIndex.load(std::memory_order_acquire);
+        return static_cast<int>(m_writeIndex.load(std::memory_order_acquire) - readIndex);
     }
     int writeAvailable() const {
-        return PaUtil_GetRingBufferWriteAvailable(&m_ringBuffer);
+        return capacity() - readAvailable();
+    }
+
+    /// Reserves up to count elements for writing. They become visible to
+    /// the consumer by commitWrite(). Only the producer may call this.
+    WriteRegions reserveWrite(int count) {
+        const mixxx::fifo::Index writeIndex = m_writeIndex.load(std::memory_order_relaxed);
+        if (freeSpace(writeIndex) < count) {
+            m_cachedReadIndex = m_readIndex.load(std::memory_order_acquire);
+        }
+        return regions<DataType>(writeIndex, std::min(count, freeSpace(writeIndex)));
+    }
+    /// Publishes count elements of the reserved regions
+    void commitWrite(int count) {
+        DEBUG_ASSERT(count >= 0 && count <= writeAvailable());
+        m_writeIndex.store(m_writeIndex.load(std::memory_order_relaxed) +
+                        static_cast<mixxx::fifo::Index>(count),
+                std::memory_order_release);
+        wakeWaiting(&m_consumerWaiting, &m_writeIndex);
+    }
+
+    /// Reserves up to count elements for reading. They are released to the
+    /// producer by commitRead(). Only the consumer may call this.
+    ReadRegions reserveRead(int count) {
+        const mixxx::fifo::Index readIndex = m_readIndex.load(std::memory_order_relaxed);
+        if (filledSpace(readIndex) < count) {
+            m_cachedWriteIndex = m_writeIndex.load(std::memory_order_acquire);
+        }
+        return regions<const DataType>(readIndex, std::min(count, filledSpace(readIndex)));
+    }
+    /// Releases count elements of the reserved regions
+    void commitRead(int count) {
+        DEBUG_ASSERT(count >= 0 && count <= readAvailable());
+        m_readIndex.store(m_readIndex.load(std::memory_order_relaxed) +
+                        static_cast<mixxx::fifo::Index>(count),
+                std::memory_order_release);
+        wakeWaiting(&m_producerWaiting, &m_readIndex);
     }
+
     int read(DataType* pData, int count) {
-        return PaUtil_ReadRingBuffer(&m_ringBuffer, pData, count);
+        const ReadRegions regions = reserveRead(count);
+        std::copy(regions.first.begin(), regions.first.end(), pData);
+        std::copy(regions.second.begin(),
+                regions.second.end(),
+                pData + regions.first.size());
+        commitRead(regions.size());
+        return regions.size();
     }
     int write(const DataType* pData, int count) {
-        return PaUtil_WriteRingBuffer(&m_ringBuffer, pData, count);
+        const WriteRegions regions = reserveWrite(count);
+        std::copy(pData, pData + regions.first.size(), regions.first.begin());
+        std::copy(pData + regions.first.size(),
+                pData + regions.size(),
+                regions.second.begin());
+        commitWrite(regions.size());
+        return regions.size();
     }
+    /// Writes all elements, waiting for the consumer if the FIFO is full
     void writeBlocking(const DataType* pData, int count) {
         int written = 0;
         while (written < count) {
+            waitWriteAvailable(std::min(count - written, capacity()));
             written += write(pData + written, count - written);
         }
     }
-    int aquireWriteRegions(int count,
-            DataType** dataPtr1, ring_buffer_size_t* sizePtr1,
-            DataType** dataPtr2, ring_buffer_size_t* sizePtr2) {
-        return PaUtil_GetRingBufferWriteRegions(&m_ringBuffer, count,
-                (void**)dataPtr1, sizePtr1, (void**)dataPtr2, sizePtr2);
+    int flushReadData(int count) {
+        const int flush = math_min(readAvailable(), count);
+        commitRead(flush);
+        return flush;
     }
-    int releaseWriteRegions(int count) {
-        return PaUtil_AdvanceRingBufferWriteIndex(&m_ringBuffer, count);
+
+    /// Blocks the producer until count elements can be written. Blocking
+    /// is optional, the consumer only pays for it with a memory fence when
+    /// committing.
+    void waitWriteAvailable(int count) {
+        DEBUG_ASSERT(count <= capacity());
+        waitUntil(&m_producerWaiting, &m_readIndex, [this, count] {
+            return writeAvailable() >= count;
+        });
     }
-    int aquireReadRegions(int count,
-            DataType** dataPtr1, ring_buffer_size_t* sizePtr1,
-            DataType** dataPtr2, ring_buffer_size_t* sizePtr2) {
-        return PaUtil_GetRingBufferReadRegions(&m_ringBuffer, count,
-                (void**)dataPtr1, sizePtr1, (void**)dataPtr2, sizePtr2);
+    /// Blocks the consumer until count elements can be read
+    void waitReadAvailable(int count) {
+        DEBUG_ASSERT(count <= capacity());
+        waitUntil(&m_consumerWaiting, &m_writeIndex, [this, count] {
+            return readAvailable() >= count;
+        });
+    }
+
+  private:
+    int freeSpace(mixxx::fifo::Index writeIndex) const {
+        return capacity() - static_cast<int>(writeIndex - m_cachedReadIndex);
     }
-    int releaseReadRegions(int count) {
-        return PaUtil_AdvanceRingBufferReadIndex(&m_ringBuffer, count);
+    int filledSpace(mixxx::fifo::Index readIndex) const {
+        return static_cast<int>(m_cachedWriteIndex - readIndex);
     }
-    int flushReadData(int count) {
-        int flush = math_min(readAvailable(), count);
-        return PaUtil_AdvanceRingBufferReadIndex(&m_ringBuffer, flush);
+
+    template<class T>
+    Regions<T> regions(mixxx::fifo::Index index, int count) {
+        const std::size_t offset = index & m_mask;
+        const std::size_t size = static_cast<std::size_t>(std::max(count, 0));
+        const std::size_t firstSize = std::min(size, m_data.size() - offset);
+        return Regions<T>{
+                std::span<T>(m_data.data() + offset, firstSize),
+                std::span<T>(m_data.data(), size - firstSize)};
+    }
+
+    template<class Predicate>
+    void waitUntil(std::atomic<bool>* pWaiting,
+            std::atomic<mixxx::fifo::Index>* pIndex,
+            Predicate isAvailable) {
+        while (!isAvailable()) {
+            [[maybe_unused]] const mixxx::fifo::Index index =
+                    pIndex->load(std::memory_order_acquire);
+            pWaiting->store(true, std::memory_order_relaxed);
+            // Pairs with the fence in wakeWaiting(): Either the other thread
+            // sees the flag or we see its update of the index.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!isAvailable()) {
+#ifdef __cpp_lib_atomic_wait
+                // Returns when the other thread has changed the index
+                pIndex->wait(index, std::memory_order_acquire);
+#else
+                // The standard library lacks atomic waiting, e.g. libc++
+                // when targeting macOS before 11
+                std::this_thread::yield();
+#endif
+            }
+            pWaiting->store(false, std::memory_order_relaxed);
+        }
+    }
+
+    void wakeWaiting(std::atomic<bool>* pWaiting,
+            [[maybe_unused]] std::atomic<mixxx::fifo::Index>* pIndex) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (pWaiting->load(std::memory_order_relaxed)) {
+#ifdef __cpp_lib_atomic_wait
+            pIndex->notify_one();
+#endif
+        }
     }
 
-  private:
     std::vector<DataType> m_data;
-    PaUtilRingBuffer m_ringBuffer;
+    const mixxx::fifo::Index m_mask;
+
+    // Written by the producer
+    alignas(mixxx::fifo::kCacheLineSize) std::atomic<mixxx::fifo::Index> m_writeIndex;
+    mixxx::fifo::Index m_cachedReadIndex;
+
+    // Written by the consumer
+    alignas(mixxx::fifo::kCacheLineSize) std::atomic<mixxx::fifo::Index> m_readIndex;
+    mixxx::fifo::Index m_cachedWriteIndex;
+
+    // Rarely written, only while waiting
+    alignas(mixxx::fifo::kCacheLineSize) std::atomic<bool> m_producerWaiting;
+    std::atomic<bool> m_consumerWaiting;
+
     DISALLOW_COPY_AND_ASSIGN(FIFO);
 };
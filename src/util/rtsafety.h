@@ -0,0 +1,66 @@
+#pragma once
+
+/// Helpers for marking code that runs on the realtime audio thread.
+///
+/// The engine enters a ScopedRealtimeContext for the duration of each
+/// audio callback. Debug and test tooling can then ask whether the current
+/// thread is inside the callback, e.g. to detect heap allocations or
+/// blocking locks that may cause xruns. Entering and leaving the context
+/// only touches a thread-local counter and is cheap enough to stay enabled
+/// in release builds.
+
+namespace mixxx {
+
+namespace rtsafety {
+
+namespace detail {
+
+// Must be trivially initialized: the counter is read from within
+// malloc/operator new hooks where no lazy TLS initialization may happen.
+inline thread_local int t_realtimeContextDepth = 0;
+
+} // namespace detail
+
+/// Returns true while the current thread executes realtime audio code.
+inline bool isRealtimeContext() {
+    return detail::t_realtimeContextDepth > 0;
+}
+
+/// RAII guard that marks the current thread as running realtime code.
+/// Guards may be nested.
+class ScopedRealtimeContext final {
+  public:
+    ScopedRealtimeContext() {
+        ++detail::t_realtimeContextDepth;
+    }
+    ~ScopedRealtimeContext() {
+        --detail::t_realtimeContextDepth;
+    }
+
+    ScopedRealtimeContext(const ScopedRealtimeContext&) = delete;
+    ScopedRealtimeContext& operator=(const ScopedRealtimeContext&) = delete;
+};
+
+/// RAII guard that temporarily leaves the realtime context, e.g. for
+/// code that is known to be non-realtime but is invoked from the callback
+/// in test setups.
+class ScopedNonRealtimeContext final {
+  public:
+    ScopedNonRealtimeContext()
+            : m_savedDepth(detail::t_realtimeContextDepth) {
+        detail::t_realtimeContextDepth = 0;
+    }
+    ~ScopedNonRealtimeContext() {
+        detail::t_realtimeContextDepth = m_savedDepth;
+    }
+
+    ScopedNonRealtimeContext(const ScopedNonRealtimeContext&) = delete;
+    ScopedNonRealtimeContext& operator=(const ScopedNonRealtimeContext&) = delete;
+
+  private:
+    const int m_savedDepth;
+};
+
+} // namespace rtsafety
+
+} // namespace mixxx
@@ -178,6 +178,7 @@ void WaveformRenderMark::onSetTrack() {
 }
 
 void WaveformRenderMark::slotCuesUpdated() {
+    m_waveformRenderer->waitUntilFrameDrawn();
     TrackPointer trackInfo = m_waveformRenderer->getTrackInfo();
     if (!trackInfo) {
         return;
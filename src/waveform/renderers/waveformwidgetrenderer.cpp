@@ -19,6 +19,10 @@ const double WaveformWidgetRenderer::s_defaultPlayMarkerPosition = 0.5;
 
 namespace {
 constexpr int kDefaultDimBrightThreshold = 127;
+// Frames without changes of the common parameters are rendered with this
+// interval, to pick up changes that are only known to the renderers, e.g.
+// of cues and loops.
+constexpr mixxx::Duration kMaxUnchangedFrameInterval = mixxx::Duration::fromMillis(100);
 } // namespace
 
 WaveformWidgetRenderer::WaveformWidgetRenderer(const QString& group)
@@ -38,6 +42,7 @@ WaveformWidgetRenderer::WaveformWidgetRenderer(const QString& group)
           m_audioSamplePerPixel(1.0),
           m_audioVisualRatio(1.0),
           m_alphaBeatGrid(90),
+          m_requestedAlphaBeatGrid(90),
           // Really create some to manage those;
           m_visualPlayPosition(nullptr),
           m_playPos(-1),
@@ -50,8 +55,11 @@ WaveformWidgetRenderer::WaveformWidgetRenderer(const QString& group)
           m_pTrackSamplesControlObject(nullptr),
           m_trackSamples(0.0),
           m_scaleFactor(1.0),
-          m_playMarkerPosition(s_defaultPlayMarkerPosition) {
+          m_playMarkerPosition(s_defaultPlayMarkerPosition),
+          m_requestedPlayMarkerPosition(s_defaultPlayMarkerPosition),
+          m_dirty(true) {
     //qDebug() << "WaveformWidgetRenderer";
+    m_timeSinceRendered.start();
 
 #ifdef WAVEFORMWIDGETRENDERER_DEBUG
     m_timer = new QTime();
@@ -104,9 +112,15 @@ bool WaveformWidgetRenderer::init() {
 }
 
 void WaveformWidgetRenderer::onPreRender(VSyncThread* vsyncThread) {
+    // The renderers only see the settings of the GUI at the time of the
+    // snapshot, the frame may be drawn on another thread
+    m_playMarkerPosition = m_requestedPlayMarkerPosition;
+    m_alphaBeatGrid = m_requestedAlphaBeatGrid;
+
     // For a valid track to render we need
     m_trackSamples = static_cast<int>(m_pTrackSamplesControlObject->get());
     if (m_trackSamples <= 0) {
+        updateDirty();
         return;
     }
 
@@ -165,6 +179,7 @@ void WaveformWidgetRenderer::onPreRender(VSyncThread* vsyncThread) {
     } else {
         m_playPos = -1; // disable renderers
     }
+    updateDirty();
 
     //qDebug() << "WaveformWidgetRenderer::onPreRender" <<
     //        "m_group" << m_group <<
@@ -174,6 +189,39 @@ void WaveformWidgetRenderer::onPreRender(VSyncThread* vsyncThread) {
     //        "m_gain" << m_gain;
 }
 
+void WaveformWidgetRenderer::updateDirty() {
+    FrameState state;
+    state.pTrack = m_pTrack.get();
+    if (m_pTrack) {
+        ConstWaveformPointer pWaveform = m_pTrack->getWaveform();
+        state.pWaveform = pWaveform.get();
+        if (pWaveform) {
+            // The waveform grows while the track is analyzed
+            state.waveformCompletion = pWaveform->getCompletion();
+        }
+    }
+    state.trackSamples = m_trackSamples;
+    state.playPos = m_playPos;
+    state.rateRatio = m_rateRatio;
+    state.gain = m_gain;
+    state.visualSamplePerPixel = m_visualSamplePerPixel;
+    state.playMarkerPosition = m_playMarkerPosition;
+    state.alphaBeatGrid = m_alphaBeatGrid;
+    state.width = m_width;
+    state.height = m_height;
+    state.devicePixelRatio = m_devicePixelRatio;
+    if (state != m_renderedFrameState ||
+            m_timeSinceRendered.elapsed() >= kMaxUnchangedFrameInterval) {
+        m_renderedFrameState = state;
+        m_dirty = true;
+    }
+}
+
+void WaveformWidgetRenderer::onRendered() {
+    m_dirty = false;
+    m_timeSinceRendered.start();
+}
+
 void WaveformWidgetRenderer::draw(QPainter* painter, QPaintEvent* event) {
 #ifdef WAVEFORMWIDGETRENDERER_DEBUG
     m_lastSystemFrameTime = m_timer->restart().toIntegerNanos();
@@ -308,6 +356,7 @@ void WaveformWidgetRenderer::drawTriangle(QPainter* painter,
 }
 
 void WaveformWidgetRenderer::resize(int width, int height, float devicePixelRatio) {
+    waitUntilFrameDrawn();
     m_width = width;
     m_height = height;
     m_devicePixelRatio = devicePixelRatio;
@@ -319,6 +368,7 @@ void WaveformWidgetRenderer::resize(int width, int height, float devicePixelRati
 
 void WaveformWidgetRenderer::setup(
         const QDomNode& node, const SkinContext& context) {
+    waitUntilFrameDrawn();
     m_scaleFactor = context.getScaleFactor();
     QString orientationString = context.selectString(node, "Orientation").toLower();
     if (orientationString == "vertical") {
@@ -338,6 +388,7 @@ void WaveformWidgetRenderer::setup(
         m_rendererStack[i]->setScaleFactor(m_scaleFactor);
         m_rendererStack[i]->setup(node, context);
     }
+    m_dirty = true;
 }
 
 void WaveformWidgetRenderer::setZoom(double zoom) {
@@ -346,10 +397,11 @@ void WaveformWidgetRenderer::setZoom(double zoom) {
 }
 
 void WaveformWidgetRenderer::setDisplayBeatGridAlpha(int alpha) {
-    m_alphaBeatGrid = alpha;
+    m_requestedAlphaBeatGrid = alpha;
 }
 
 void WaveformWidgetRenderer::setTrack(TrackPointer track) {
+    waitUntilFrameDrawn();
     m_pTrack = track;
     //used to postpone first display until track sample is actually available
     m_trackSamples = -1.0;
@@ -360,6 +412,8 @@ void WaveformWidgetRenderer::setTrack(TrackPointer track) {
 }
 
 WaveformMarkPointer WaveformWidgetRenderer::getCueMarkAtPoint(QPoint point) const {
+    // The positions and the labels of the marks are updated while drawing
+    waitUntilFrameDrawn();
     for (auto it = m_markPositions.constBegin(); it != m_markPositions.constEnd(); ++it) {
         WaveformMarkPointer pMark = it.key();
         VERIFY_OR_DEBUG_ASSERT(pMark) {
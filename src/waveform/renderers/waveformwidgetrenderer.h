@@ -36,6 +36,20 @@ class WaveformWidgetRenderer {
     void onPreRender(VSyncThread* vsyncThread);
     void draw(QPainter* painter, QPaintEvent* event);
 
+    /// Returns true if the frame prepared by onPreRender() differs from the
+    /// last rendered frame, e.g. because the play position moved, or if the
+    /// last rendered frame is too old. Otherwise rendering can be skipped.
+    bool isDirty() const {
+        return m_dirty;
+    }
+    /// Must be called after the frame has been rendered
+    void onRendered();
+    /// Waits until a frame that is drawn on another thread is finished. It
+    /// must be called before the GUI thread changes the state of the
+    /// renderers outside of onPreRender().
+    virtual void waitUntilFrameDrawn() const {
+    }
+
     const QString& getGroup() const {
         return m_group;
     }
@@ -146,11 +160,12 @@ class WaveformWidgetRenderer {
         return m_playMarkerPosition;
     }
 
+    /// Takes effect with the next onPreRender()
     void setPlayMarkerPosition(double newPos) {
         VERIFY_OR_DEBUG_ASSERT(newPos >= 0.0 && newPos <= 1.0) {
             newPos = math_clamp(newPos, 0.0, 1.0);
         }
-        m_playMarkerPosition = newPos;
+        m_requestedPlayMarkerPosition = newPos;
     }
 
   protected:
@@ -174,6 +189,7 @@ class WaveformWidgetRenderer {
     double m_audioVisualRatio;
 
     int m_alphaBeatGrid;
+    int m_requestedAlphaBeatGrid;
 
     //TODO: vRince create some class to manage control/value
     //ControlConnection
@@ -189,6 +205,7 @@ class WaveformWidgetRenderer {
     int m_trackSamples;
     double m_scaleFactor;
     double m_playMarkerPosition;   // 0.0 - left, 0.5 - center, 1.0 - right
+    double m_requestedPlayMarkerPosition;
 
 #ifdef WAVEFORMWIDGETRENDERER_DEBUG
     PerformanceTimer* m_timer;
@@ -200,9 +217,32 @@ class WaveformWidgetRenderer {
 #endif
 
 private:
+    /// The parameters of a frame, that affect all renderers
+    struct FrameState {
+        const void* pTrack = nullptr;
+        const void* pWaveform = nullptr;
+        int waveformCompletion = -1;
+        int trackSamples = 0;
+        double playPos = -1;
+        double rateRatio = 0;
+        double gain = 0;
+        double visualSamplePerPixel = 0;
+        double playMarkerPosition = 0;
+        int alphaBeatGrid = 0;
+        int width = -1;
+        int height = -1;
+        float devicePixelRatio = 0;
+
+        bool operator==(const FrameState& other) const = default;
+    };
+    void updateDirty();
+
     DISALLOW_COPY_AND_ASSIGN(WaveformWidgetRenderer);
     friend class WaveformWidgetFactory;
     QMap<WaveformMarkPointer, int> m_markPositions;
+    FrameState m_renderedFrameState;
+    bool m_dirty;
+    PerformanceTimer m_timeSinceRendered;
     // draw play position indicator triangles
     void drawPlayPosmarker(QPainter* painter);
     void drawTriangle(QPainter* painter,
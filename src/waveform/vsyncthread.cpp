@@ -10,11 +10,29 @@
 #include "util/performancetimer.h"
 #include "waveform/guitick.h"
 
+namespace {
+
+// The share of the GUI thread's time that rendering the frames may use,
+// the rest is left for the controller scripts, the library and the input
+// events. If rendering takes longer, the frame rate is reduced.
+constexpr double kMaxFrameCostRatio = 0.5;
+// The frame rate is restored once rendering takes less than this share
+constexpr double kRestoreFrameCostRatio = 0.3;
+// The frame rate is never reduced below 15 FPS
+constexpr int kMaxAdaptedSyncIntervalMicros = 66667;
+// Smoothing of the measured frame cost, about 20 frames
+constexpr double kFrameCostSmoothing = 0.05;
+
+} // anonymous namespace
+
 VSyncThread::VSyncThread(QObject* pParent)
         : QThread(pParent),
           m_bDoRendering(true),
           m_vSyncTypeChanged(false),
           m_syncIntervalTimeMicros(33333),  // 30 FPS
+          m_configuredSyncIntervalTimeMicros(33333),
+          m_appliedSyncIntervalTimeMicros(33333),
+          m_averageFrameCostMicros(0),
           m_waitToSwapMicros(0),
           m_vSyncMode(ST_TIMER),
           m_syncOk(false),
@@ -34,7 +52,9 @@ VSyncThread::~VSyncThread() {
 void VSyncThread::run() {
     QThread::currentThread()->setObjectName("VSyncThread");
 
-    m_waitToSwapMicros = m_syncIntervalTimeMicros;
+    m_appliedSyncIntervalTimeMicros = m_configuredSyncIntervalTimeMicros.load();
+    m_syncIntervalTimeMicros = m_appliedSyncIntervalTimeMicros;
+    m_waitToSwapMicros = m_appliedSyncIntervalTimeMicros;
     m_timer.start();
 
     //qDebug() << "VSyncThread::run()";
@@ -53,11 +73,13 @@ void VSyncThread::run() {
             m_waitToSwapMicros = 1000;
             usleep(1000);
         } else { // if (m_vSyncMode == ST_TIMER) {
+            const int renderStartMicros = elapsed();
             emit vsyncRender(); // renders the new waveform.
 
             // wait until rendering was scheduled. It might be delayed due a
             // pending swap (depends one driver vSync settings)
             m_semaVsyncSlot.acquire();
+            const int renderCostMicros = elapsed() - renderStartMicros;
 
             // qDebug() << "ST_TIMER                      " << lastMicros << restMicros;
             int remainingForSwap = m_waitToSwapMicros - static_cast<int>(
@@ -73,6 +95,7 @@ void VSyncThread::run() {
             // wait until swap occurred. It might be delayed due to driver vSync
             // settings.
             m_semaVsyncSlot.acquire();
+            adaptSyncInterval(renderCostMicros);
 
             // <- Assume we are VSynced here ->
             m_sinceLastSwap = m_timer.restart();
@@ -83,8 +106,9 @@ void VSyncThread::run() {
                 m_droppedFrames++; // Count as Real Time Error
             }
             // try to stay in right intervals
-            m_waitToSwapMicros = m_syncIntervalTimeMicros +
-                    ((m_waitToSwapMicros - lastSwapTime) % m_syncIntervalTimeMicros);
+            const int syncIntervalTimeMicros = m_syncIntervalTimeMicros.load();
+            m_waitToSwapMicros = syncIntervalTimeMicros +
+                    ((m_waitToSwapMicros - lastSwapTime) % syncIntervalTimeMicros);
         }
     }
 }
@@ -94,9 +118,11 @@ int VSyncThread::elapsed() {
 }
 
 void VSyncThread::setSyncIntervalTimeMicros(int syncTime) {
-    m_syncIntervalTimeMicros = syncTime;
+    // The VSync thread owns m_syncIntervalTimeMicros and picks up the new
+    // value with the next frame in adaptSyncInterval()
+    m_configuredSyncIntervalTimeMicros = syncTime;
     m_vSyncPerRendering = static_cast<int>(
-            round(m_displayFrameRate * m_syncIntervalTimeMicros / 1000));
+            round(m_displayFrameRate * syncTime / 1000));
 }
 
 void VSyncThread::setVSyncType(int type) {
@@ -112,8 +138,9 @@ int VSyncThread::toNextSyncMicros() {
     int rest = m_waitToSwapMicros - static_cast<int>(m_timer.elapsed().toIntegerMicros());
     // int math is fine here, because we do not expect times > 4.2 s
     if (rest < 0) {
-        rest %= m_syncIntervalTimeMicros;
-        rest += m_syncIntervalTimeMicros;
+        const int syncIntervalTimeMicros = m_syncIntervalTimeMicros.load();
+        rest %= syncIntervalTimeMicros;
+        rest += syncIntervalTimeMicros;
     }
     return rest;
 }
@@ -167,3 +194,37 @@ void VSyncThread::getAvailableVSyncTypes(QList<QPair<int, QString>>* pList) {
 mixxx::Duration VSyncThread::sinceLastSwap() const {
     return m_sinceLastSwap;
 }
+
+void VSyncThread::adaptSyncInterval(int frameCostMicros) {
+    // The time the GUI thread spends in the render slot, including the time
+    // the slot waits in the event queue for the GUI thread. The swap is not
+    // included, because it may block until the next vertical blank.
+    m_averageFrameCostMicros +=
+            kFrameCostSmoothing * (frameCostMicros - m_averageFrameCostMicros);
+
+    const int configuredSyncIntervalMicros = m_configuredSyncIntervalTimeMicros.load();
+    int syncIntervalMicros = m_syncIntervalTimeMicros.load();
+    if (configuredSyncIntervalMicros != m_appliedSyncIntervalTimeMicros) {
+        // The GUI thread has configured a new interval, start over from it
+        m_appliedSyncIntervalTimeMicros = configuredSyncIntervalMicros;
+        m_syncIntervalTimeMicros = configuredSyncIntervalMicros;
+        return;
+    }
+
+    const int maxSyncIntervalMicros = math_max(
+            configuredSyncIntervalMicros, kMaxAdaptedSyncIntervalMicros);
+    if (m_averageFrameCostMicros > syncIntervalMicros * kMaxFrameCostRatio) {
+        // Rendering starves the GUI thread, slow down by about 10 %
+        syncIntervalMicros = math_min(
+                syncIntervalMicros + syncIntervalMicros / 10,
+                maxSyncIntervalMicros);
+    } else if (syncIntervalMicros > configuredSyncIntervalMicros &&
+            m_averageFrameCostMicros <
+                    syncIntervalMicros * kRestoreFrameCostRatio) {
+        // Speed up slowly, to avoid oscillating around the limit
+        syncIntervalMicros = math_max(
+                syncIntervalMicros - syncIntervalMicros / 50,
+                configuredSyncIntervalMicros);
+    }
+    m_syncIntervalTimeMicros = syncIntervalMicros;
+}
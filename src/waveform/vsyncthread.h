@@ -5,6 +5,7 @@
 #include <QSemaphore>
 #include <QPair>
 #include <QGLWidget>
+#include <atomic>
 
 #include "util/performancetimer.h"
 
@@ -43,9 +44,17 @@ class VSyncThread : public QThread {
     void vsyncSwap();
 
   private:
+    void adaptSyncInterval(int frameCostMicros);
+
     bool m_bDoRendering;
     bool m_vSyncTypeChanged;
-    int m_syncIntervalTimeMicros;
+    // Written by the VSync thread only, read by other threads
+    std::atomic<int> m_syncIntervalTimeMicros;
+    // Written by the GUI thread, applied by the VSync thread
+    std::atomic<int> m_configuredSyncIntervalTimeMicros;
+    // The configured interval that has been applied, VSync thread only
+    int m_appliedSyncIntervalTimeMicros;
+    double m_averageFrameCostMicros;
     int m_waitToSwapMicros;
     enum VSyncMode m_vSyncMode;
     bool m_syncOk;
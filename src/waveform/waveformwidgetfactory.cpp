@@ -13,6 +13,7 @@
 #include "control/controlpotmeter.h"
 #include "moc_waveformwidgetfactory.cpp"
 #include "util/cmdlineargs.h"
+#include "util/counter.h"
 #include "util/math.h"
 #include "util/performancetimer.h"
 #include "util/timer.h"
@@ -81,7 +82,8 @@ WaveformWidgetAbstractHandle::WaveformWidgetAbstractHandle()
 WaveformWidgetHolder::WaveformWidgetHolder()
         : m_waveformWidget(nullptr),
           m_waveformViewer(nullptr),
-          m_skinContextCache(UserSettingsPointer(), QString()) {
+          m_skinContextCache(UserSettingsPointer(), QString()),
+          m_rendered(false) {
 }
 
 WaveformWidgetHolder::WaveformWidgetHolder(WaveformWidgetAbstract* waveformWidget,
@@ -91,7 +93,8 @@ WaveformWidgetHolder::WaveformWidgetHolder(WaveformWidgetAbstract* waveformWidge
     : m_waveformWidget(waveformWidget),
       m_waveformViewer(waveformViewer),
       m_skinNodeCache(node.cloneNode()),
-      m_skinContextCache(&parentContext) {
+      m_skinContextCache(&parentContext),
+      m_rendered(false) {
 }
 
 ///////////////////////////////////////////
@@ -410,6 +413,8 @@ bool WaveformWidgetFactory::setWaveformWidget(WWaveformViewer* viewer,
         // add holder
         m_waveformWidgetHolders.push_back(std::move(holder));
         index = static_cast<int>(m_waveformWidgetHolders.size()) - 1;
+        // One render worker per deck
+        m_renderWorkers.setMaxThreadCount(static_cast<int>(m_waveformWidgetHolders.size()));
     } else {
         // update holder
         DEBUG_ASSERT(index >= 0);
@@ -659,26 +664,77 @@ void WaveformWidgetFactory::render() {
                 // Don't bother doing the pre-render work if we aren't going to
                 // render this widget.
                 bool shouldRender = shouldRenderWaveform(pWaveformWidget);
+                if (shouldRender && pWaveformWidget->isRenderingToImage()) {
+                    // The render worker is still busy with the previous
+                    // frame, drop this one instead of waiting for it
+                    if (CmdlineArgs::Instance().getDeveloper()) {
+                        Counter dropped(QStringLiteral("WaveformWidgetRenderer dropped frames ") +
+                                pWaveformWidget->getGroup());
+                        dropped.increment();
+                    }
+                    shouldRender = false;
+                }
                 shouldRenderWaveforms[static_cast<int>(i)] = shouldRender;
                 if (!shouldRender) {
                     continue;
                 }
-                // Calculate play position for the new Frame in following run
+                // Calculate play position for the new Frame in following run.
+                // This is the snapshot of the frame for the render workers.
                 pWaveformWidget->preRender(m_vsyncThread);
             }
             //qDebug() << "prerender" << m_vsyncThread->elapsed();
 
-            // It may happen that there is an artificially delayed due to
-            // anti tearing driver settings
-            // all render commands are delayed until the swap from the previous run is executed
+            // The VSync test widgets animate independent of the play position
+            const bool renderUnchanged = m_type == WaveformWidgetType::GLVSyncTest ||
+                    m_type == WaveformWidgetType::QtVSyncTest;
+
+            // Widgets that rasterize in software are drawn into an image by
+            // the render workers, one per deck. The GUI thread renders the
+            // other widgets in the meantime and blits the images that have
+            // been finished since the last run, without waiting for the
+            // frames that are drawn now.
             for (decltype(m_waveformWidgetHolders)::size_type i = 0;
                     i < m_waveformWidgetHolders.size();
                     i++) {
-                WaveformWidgetAbstract* pWaveformWidget = m_waveformWidgetHolders[i].m_waveformWidget;
+                WaveformWidgetHolder& holder = m_waveformWidgetHolders[i];
+                WaveformWidgetAbstract* pWaveformWidget = holder.m_waveformWidget;
+                holder.m_rendered = false;
+                if (pWaveformWidget->isRenderedToImage() &&
+                        pWaveformWidget->hasNewRenderedImage() &&
+                        shouldRenderWaveform(pWaveformWidget)) {
+                    ScopedTimer t("WaveformWidgetRenderer::render() %1",
+                            pWaveformWidget->getGroup());
+                    pWaveformWidget->render();
+                    holder.m_rendered = true;
+                }
                 if (!shouldRenderWaveforms[static_cast<int>(i)]) {
                     continue;
                 }
-                pWaveformWidget->render();
+                if (!renderUnchanged && !pWaveformWidget->isDirty()) {
+                    // Nothing has changed since the last frame, keep it
+                    if (CmdlineArgs::Instance().getDeveloper()) {
+                        Counter skipped(QStringLiteral("WaveformWidgetRenderer skipped frames ") +
+                                pWaveformWidget->getGroup());
+                        skipped.increment();
+                    }
+                    continue;
+                }
+                if (pWaveformWidget->isRenderedToImage()) {
+                    pWaveformWidget->startRenderToImage(&m_renderWorkers);
+                    pWaveformWidget->onRendered();
+                    continue;
+                }
+
+                // It may happen that there is an artificially delayed due to
+                // anti tearing driver settings
+                // all render commands are delayed until the swap from the previous run is executed
+                {
+                    ScopedTimer t("WaveformWidgetRenderer::render() %1",
+                            pWaveformWidget->getGroup());
+                    pWaveformWidget->render();
+                }
+                pWaveformWidget->onRendered();
+                holder.m_rendered = true;
                 //qDebug() << "render" << i << m_vsyncThread->elapsed();
             }
         }
@@ -732,6 +788,10 @@ void WaveformWidgetFactory::swap() {
                 if (!shouldRenderWaveform(pWaveformWidget)) {
                     continue;
                 }
+                // The front buffer still shows the last rendered frame
+                if (!holder.m_rendered) {
+                    continue;
+                }
                 QGLWidget* glw = qobject_cast<QGLWidget*>(pWaveformWidget->getWidget());
                 if (glw != nullptr) {
                     if (glw->context() != QGLContext::currentContext()) {
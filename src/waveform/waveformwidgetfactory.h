@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QObject>
+#include <QThreadPool>
 #include <QVector>
 #include <vector>
 
@@ -49,6 +50,8 @@ class WaveformWidgetHolder {
     WWaveformViewer* m_waveformViewer;
     QDomNode m_skinNodeCache;
     SkinContext m_skinContextCache;
+    // Only widgets that have been rendered need to swap their buffers
+    bool m_rendered;
 
     friend class WaveformWidgetFactory;
 };
@@ -192,6 +195,8 @@ class WaveformWidgetFactory : public QObject, public Singleton<WaveformWidgetFac
     int m_beatGridAlpha;
 
     VSyncThread* m_vsyncThread;
+    // Rasterizes the widgets that render to an image
+    QThreadPool m_renderWorkers;
     GuiTick* m_pGuiTick;  // not owned
     VisualsManager* m_pVisualsManager;  // not owned
 
@@ -32,6 +32,7 @@ QtRGBWaveformWidget::QtRGBWaveformWidget(const QString& group, QWidget* parent)
 
     setAttribute(Qt::WA_NoSystemBackground);
     setAttribute(Qt::WA_OpaquePaintEvent);
+    setRenderedToImage(true);
 
     setAutoBufferSwap(false);
 
@@ -58,7 +59,7 @@ mixxx::Duration QtRGBWaveformWidget::render() {
     // this may delayed until previous buffer swap finished
     QPainter painter(this);
     t1 = timer.restart();
-    draw(&painter, nullptr);
+    drawRenderedImage(&painter, nullptr);
     //t2 = timer.restart();
     //qDebug() << "GLVSyncTestWidget "<< t1 << t2;
     return t1; // return timer for painter setup
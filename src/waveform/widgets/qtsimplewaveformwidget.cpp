@@ -34,6 +34,7 @@ QtSimpleWaveformWidget::QtSimpleWaveformWidget(
 
     setAttribute(Qt::WA_NoSystemBackground);
     setAttribute(Qt::WA_OpaquePaintEvent);
+    setRenderedToImage(true);
 
     setAutoBufferSwap(false);
 
@@ -61,7 +62,7 @@ mixxx::Duration QtSimpleWaveformWidget::render() {
     // this may delayed until previous buffer swap finished
     QPainter painter(this);
     t1 = timer.restart();
-    draw(&painter, nullptr);
+    drawRenderedImage(&painter, nullptr);
     //t2 = timer.restart();
     //qDebug() << "QtSimpleWaveformWidget" << t1 << t2;
     return t1; // return timer for painter setup
@@ -25,6 +25,7 @@ SoftwareWaveformWidget::SoftwareWaveformWidget(const QString& group, QWidget* pa
 
     setAttribute(Qt::WA_NoSystemBackground);
     setAttribute(Qt::WA_OpaquePaintEvent);
+    setRenderedToImage(true);
 
     m_initSuccess = init();
 }
@@ -38,5 +39,5 @@ void SoftwareWaveformWidget::castToQWidget() {
 
 void SoftwareWaveformWidget::paintEvent(QPaintEvent* event) {
     QPainter painter(this);
-    draw(&painter, event);
+    drawRenderedImage(&painter, event);
 }
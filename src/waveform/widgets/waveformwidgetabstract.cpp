@@ -1,17 +1,25 @@
 #include "waveformwidgetabstract.h"
 
+#include <QPainter>
 #include <QWidget>
+#include <QtConcurrentRun>
 #include <QtDebug>
 
+#include "util/compatibility/qmutex.h"
+#include "util/timer.h"
 #include "waveform/renderers/waveformwidgetrenderer.h"
 
 WaveformWidgetAbstract::WaveformWidgetAbstract(const QString& group)
         : WaveformWidgetRenderer(group),
-          m_initSuccess(false) {
+          m_initSuccess(false),
+          m_renderedToImage(false),
+          m_newRenderedImage(false) {
     m_widget = nullptr;
 }
 
 WaveformWidgetAbstract::~WaveformWidgetAbstract() {
+    // The renderers are deleted by the base class
+    waitUntilFrameDrawn();
 }
 
 void WaveformWidgetAbstract::hold() {
@@ -46,3 +54,61 @@ void WaveformWidgetAbstract::resize(int width, int height) {
     }
     WaveformWidgetRenderer::resize(width, height, static_cast<float>(devicePixelRatio));
 }
+
+void WaveformWidgetAbstract::startRenderToImage(QThreadPool* pRenderWorkers) {
+    DEBUG_ASSERT(m_renderedToImage);
+    VERIFY_OR_DEBUG_ASSERT(!isRenderingToImage()) {
+        return;
+    }
+    m_renderToImageFuture = QtConcurrent::run(pRenderWorkers, [this] { renderToImage(); });
+}
+
+bool WaveformWidgetAbstract::hasNewRenderedImage() {
+    const auto locker = lockMutex(&m_frontImageMutex);
+    return m_newRenderedImage;
+}
+
+void WaveformWidgetAbstract::waitUntilFrameDrawn() const {
+    // Waiting does not modify the future, but QFuture::waitForFinished()
+    // is not const
+    QFuture<void> future = m_renderToImageFuture;
+    future.waitForFinished();
+}
+
+void WaveformWidgetAbstract::renderToImage() {
+    ScopedTimer t("WaveformWidgetAbstract::renderToImage() %1", getGroup());
+    const QSize size = QSize(getWidth(), getHeight()) * getDevicePixelRatio();
+    if (size.isEmpty()) {
+        return;
+    }
+    if (m_backImage.size() != size) {
+        // The renderers paint all pixels, starting with the background
+        m_backImage = QImage(size, QImage::Format_ARGB32_Premultiplied);
+        m_backImage.setDevicePixelRatio(getDevicePixelRatio());
+    }
+    {
+        // Detaches the image, if the GUI thread still blits the previous frame
+        QPainter painter(&m_backImage);
+        draw(&painter, nullptr);
+    }
+    const auto locker = lockMutex(&m_frontImageMutex);
+    m_frontImage.swap(m_backImage);
+    m_newRenderedImage = true;
+}
+
+void WaveformWidgetAbstract::drawRenderedImage(QPainter* painter, QPaintEvent* event) {
+    Q_UNUSED(event);
+    QImage image;
+    {
+        const auto locker = lockMutex(&m_frontImageMutex);
+        // Shallow copy, the worker does not wait for the blit
+        image = m_frontImage;
+        m_newRenderedImage = false;
+    }
+    if (image.isNull()) {
+        // The renderers may be busy with the first frame
+        painter->fillRect(0, 0, getWidth(), getHeight(), getWaveformSignalColors()->getBgColor());
+        return;
+    }
+    painter->drawImage(QPoint(0, 0), image);
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <QFuture>
+#include <QImage>
+#include <QMutex>
 #include <QString>
 #include <QWidget>
 
@@ -7,6 +10,7 @@
 #include "waveform/renderers/waveformwidgetrenderer.h"
 #include "waveformwidgettype.h"
 
+class QThreadPool;
 class VSyncThread;
 
 // NOTE(vRince) This class represent objects the waveformwidgetfactory can
@@ -32,12 +36,49 @@ class WaveformWidgetAbstract : public WaveformWidgetRenderer {
     virtual mixxx::Duration render();
     virtual void resize(int width, int height);
 
+    /// Widgets that rasterize in software draw the frame into an image on a
+    /// render worker thread, the GUI thread only blits it in render().
+    bool isRenderedToImage() const {
+        return m_renderedToImage;
+    }
+    /// Returns true while a render worker draws a frame. The GUI thread must
+    /// neither call preRender() nor start the next frame until it is done.
+    bool isRenderingToImage() const {
+        return !m_renderToImageFuture.isFinished();
+    }
+    /// Draws the frame prepared by preRender() into the back buffer on one of
+    /// the render workers. The finished frame becomes the front buffer.
+    void startRenderToImage(QThreadPool* pRenderWorkers);
+    /// Returns true if a frame has been finished since the front buffer has
+    /// been blitted the last time.
+    bool hasNewRenderedImage();
+
+    void waitUntilFrameDrawn() const override;
+
   protected:
+    void setRenderedToImage(bool renderedToImage) {
+        m_renderedToImage = renderedToImage;
+    }
+    /// Blits the front buffer, or fills the background if no frame has been
+    /// rendered to an image yet.
+    void drawRenderedImage(QPainter* painter, QPaintEvent* event);
+
     QWidget* m_widget;
     bool m_initSuccess;
 
     //this is the factory resposability to trigger QWidget casting after constructor
     virtual void castToQWidget() = 0;
 
+  private:
+    void renderToImage();
+
+    bool m_renderedToImage;
+    QFuture<void> m_renderToImageFuture;
+    // Only accessed by the render worker
+    QImage m_backImage;
+    QMutex m_frontImageMutex;
+    QImage m_frontImage;
+    bool m_newRenderedImage;
+
     friend class WaveformWidgetFactory;
 };
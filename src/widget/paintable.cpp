@@ -1,7 +1,9 @@
 #include "widget/wpixmapstore.h"
 
+#include <QCoreApplication>
 #include <QDir>
 #include <QString>
+#include <QThread>
 #include <QtDebug>
 
 #include "skin/legacy/imgloader.h"
@@ -46,50 +48,70 @@ QString Paintable::DrawModeToString(DrawMode mode) {
     return "FIXED";
 }
 
-Paintable::Paintable(const PixmapSource& source, DrawMode mode, double scaleFactor)
-        : m_drawMode(mode),
-          m_source(source) {
+// static
+Paintable::LoadedImage Paintable::load(
+        const PixmapSource& source, DrawMode mode, double scaleFactor) {
+    LoadedImage loadedImage;
     if (!source.isSVG()) {
-        m_pPixmap.reset(WPixmapStore::getPixmapNoCache(source.getPath(), scaleFactor));
-    } else {
-        auto pSvg = std::make_unique<QSvgRenderer>();
-        if (!source.getSvgSourceData().isEmpty()) {
-            // Call here the different overload for svg content
-            if (!pSvg->load(source.getSvgSourceData())) {
-                // The above line already logs a warning
-                return;
-            }
-        } else if (!source.getPath().isEmpty()) {
-            if (!pSvg->load(source.getPath())) {
-                // The above line already logs a warning
-                return;
-            }
-        } else {
-            return;
+        loadedImage.image = WPixmapStore::getImageNoCache(source.getPath(), scaleFactor);
+        return loadedImage;
+    }
+    auto pSvg = std::make_unique<QSvgRenderer>();
+    if (!source.getSvgSourceData().isEmpty()) {
+        // Call here the different overload for svg content
+        if (!pSvg->load(source.getSvgSourceData())) {
+            // The above line already logs a warning
+            return loadedImage;
+        }
+    } else if (!source.getPath().isEmpty()) {
+        if (!pSvg->load(source.getPath())) {
+            // The above line already logs a warning
+            return loadedImage;
         }
-        m_pSvg.reset(pSvg.release());
+    } else {
+        return loadedImage;
+    }
 #ifdef __APPLE__
-        // Apple does Retina scaling behind the scenes, so we also pass a
-        // Paintable::FIXED image. On the other targets, it is better to
-        // cache the pixmap. We do not do this for TILE and color schemas.
-        // which can result in a correct but possibly blurry picture at a
-        // Retina display. This can be fixed when switching to QT5
-        if (mode == TILE || WPixmapStore::willCorrectColors()) {
+    // Apple does Retina scaling behind the scenes, so we also pass a
+    // Paintable::FIXED image. On the other targets, it is better to
+    // cache the pixmap. We do not do this for TILE and color schemas.
+    // which can result in a correct but possibly blurry picture at a
+    // Retina display. This can be fixed when switching to QT5
+    if (mode == TILE || WPixmapStore::willCorrectColors()) {
 #else
-        if (mode == TILE || mode == Paintable::FIXED || WPixmapStore::willCorrectColors()) {
+    if (mode == TILE || mode == Paintable::FIXED || WPixmapStore::willCorrectColors()) {
 #endif
-            // The SVG renderer doesn't directly support tiling, so we render
-            // it to a pixmap which will then get tiled.
-            QImage copy_buffer(m_pSvg->defaultSize() * scaleFactor, QImage::Format_ARGB32);
-            copy_buffer.fill(0x00000000);  // Transparent black.
-            QPainter painter(&copy_buffer);
-            m_pSvg->render(&painter);
-            WPixmapStore::correctImageColors(&copy_buffer);
+        // The SVG renderer doesn't directly support tiling, so we render
+        // it to a pixmap which will then get tiled.
+        QImage copy_buffer(pSvg->defaultSize() * scaleFactor, QImage::Format_ARGB32);
+        copy_buffer.fill(0x00000000);  // Transparent black.
+        QPainter painter(&copy_buffer);
+        pSvg->render(&painter);
+        painter.end();
+        WPixmapStore::correctImageColors(&copy_buffer);
+        loadedImage.image = std::move(copy_buffer);
+    }
+    // The renderer is used for drawing on the GUI thread
+    QThread* pGuiThread = QCoreApplication::instance()->thread();
+    if (pSvg->thread() != pGuiThread) {
+        pSvg->moveToThread(pGuiThread);
+    }
+    loadedImage.pSvg = std::move(pSvg);
+    return loadedImage;
+}
 
-            m_pPixmap.reset(new QPixmap(copy_buffer.size()));
-            m_pPixmap->convertFromImage(copy_buffer);
-        }
+Paintable::Paintable(const PixmapSource& source, DrawMode mode, double scaleFactor)
+        : Paintable(source, mode, load(source, mode, scaleFactor)) {
+}
+
+Paintable::Paintable(const PixmapSource& source, DrawMode mode, LoadedImage loadedImage)
+        : m_drawMode(mode),
+          m_source(source) {
+    // Bitmaps always have a pixmap, even if loading failed
+    if (!source.isSVG() || !loadedImage.image.isNull()) {
+        m_pPixmap.reset(new QPixmap(QPixmap::fromImage(std::move(loadedImage.image))));
     }
+    m_pSvg.reset(loadedImage.pSvg.release());
 }
 
 bool Paintable::isNull() const {
@@ -9,6 +9,7 @@
 #include <QPainter>
 #include <QRectF>
 #include <QString>
+#include <memory>
 
 #include "skin/legacy/imgsource.h"
 #include "skin/legacy/pixmapsource.h"
@@ -28,7 +29,17 @@ class Paintable {
         TILE
     };
 
+    /// The decoded image data of a Paintable. Loading it doesn't need the
+    /// GUI thread, so it can be prefetched by worker threads.
+    struct LoadedImage {
+        // The bitmap or the pre-rasterized SVG
+        QImage image;
+        std::unique_ptr<QSvgRenderer> pSvg;
+    };
+    static LoadedImage load(const PixmapSource& source, DrawMode mode, double scaleFactor);
+
     Paintable(const PixmapSource& source, DrawMode mode, double scaleFactor);
+    Paintable(const PixmapSource& source, DrawMode mode, LoadedImage loadedImage);
 
     QSize size() const;
     int width() const;
@@ -10,6 +10,7 @@
 
 // static
 QHash<QString, std::weak_ptr<QImage>> WImageStore::m_dictionary;
+QMutex WImageStore::m_dictionaryMutex;
 QSharedPointer<ImgSource> WImageStore::m_loader
         = QSharedPointer<ImgSource>(new ImgLoader());
 
@@ -31,30 +32,53 @@ std::shared_ptr<QImage> WImageStore::getImage(const PixmapSource& source, double
     // Search for Image in list
     QString key = source.getId() + QString::number(scaleFactor);
 
-    QHash<QString, std::weak_ptr<QImage>>::iterator it = m_dictionary.find(key);
-    if (it != m_dictionary.end()) {
-        //qDebug() << "WImageStore returning cached Image for:" << source.getPath();
-        return it.value().lock();
+    {
+        QMutexLocker locker(&m_dictionaryMutex);
+        auto pCachedImage = lookupImage(key);
+        if (pCachedImage) {
+            //qDebug() << "WImageStore returning cached Image for:" << source.getPath();
+            return pCachedImage;
+        }
     }
 
-    // Image wasn't found, construct it
+    // Image wasn't found, construct it. Loading takes long, so other
+    // threads may look up other images in the meantime.
     //qDebug() << "WImageStore Loading Image from file" << source.getPath();
 
-    auto pLoadedImage = std::shared_ptr<QImage>(getImageNoCache(source, scaleFactor), &deleteImage);
-
-    if (!pLoadedImage) {
+    QImage* pImage = getImageNoCache(source, scaleFactor);
+    if (!pImage) {
         return nullptr;
     }
 
-    if (pLoadedImage->isNull()) {
-        qDebug() << "WImageStore couldn't load:" << source.getPath() << (pLoadedImage == nullptr);
+    if (pImage->isNull()) {
+        qDebug() << "WImageStore couldn't load:" << source.getPath();
+        delete pImage;
         return nullptr;
     }
 
+    QMutexLocker locker(&m_dictionaryMutex);
+    // Another thread may have loaded the same image concurrently
+    auto pCachedImage = lookupImage(key);
+    if (pCachedImage) {
+        // Not owned by a shared_ptr yet, deleteImage() would deadlock
+        delete pImage;
+        return pCachedImage;
+    }
+    auto pLoadedImage = std::shared_ptr<QImage>(pImage, &deleteImage);
     m_dictionary.insert(key, pLoadedImage);
     return pLoadedImage;
 }
 
+// static
+std::shared_ptr<QImage> WImageStore::lookupImage(const QString& key) {
+    QHash<QString, std::weak_ptr<QImage>>::const_iterator it = m_dictionary.constFind(key);
+    if (it == m_dictionary.constEnd()) {
+        return nullptr;
+    }
+    // The image may have expired while its deleter waits for the lock
+    return it.value().lock();
+}
+
 // static
 QImage* WImageStore::getImageNoCache(const PixmapSource& source, double scaleFactor) {
     if (source.isSVG()) {
@@ -88,6 +112,7 @@ QImage* WImageStore::getImageNoCache(const PixmapSource& source, double scaleFac
 
 // static
 void WImageStore::deleteImage(QImage* p) {
+    QMutexLocker locker(&m_dictionaryMutex);
     QMutableHashIterator<QString, std::weak_ptr<QImage>> it(m_dictionary);
     while (it.hasNext()) {
         if(it.next().value().expired()) {
@@ -2,6 +2,7 @@
 
 #include <QHash>
 #include <QImage>
+#include <QMutex>
 #include <QSharedPointer>
 #include <unordered_map>
 
@@ -21,9 +22,13 @@ class WImageStore {
     static bool willCorrectColors();
 
   private:
+    /// Returns the cached image, m_dictionaryMutex must be locked
+    static std::shared_ptr<QImage> lookupImage(const QString& key);
     static void deleteImage(QImage* p);
 
-    // Dictionary of Images already instantiated
+    // Dictionary of Images already instantiated. The waveform render
+    // workers access it concurrently with the GUI thread.
     static QHash<QString, std::weak_ptr<QImage>> m_dictionary;
+    static QMutex m_dictionaryMutex;
     static QSharedPointer<ImgSource> m_loader;
 };
@@ -2,15 +2,29 @@
 
 #include <QDir>
 #include <QString>
+#include <QtConcurrentMap>
 #include <QtDebug>
+#include <memory>
+#include <vector>
 
 #include "util/math.h"
 #include "skin/legacy/imgloader.h"
 
+namespace {
+
+QString paintableKey(const QString& sourceId, Paintable::DrawMode mode, double scaleFactor) {
+    return sourceId + QString::number(mode) + QString::number(scaleFactor);
+}
+
+} // anonymous namespace
+
 // static
 QHash<QString, WeakPaintablePointer> WPixmapStore::m_paintableCache;
 QSharedPointer<ImgSource> WPixmapStore::m_loader
         = QSharedPointer<ImgSource>(new ImgLoader());
+QHash<QString, std::shared_ptr<Paintable::LoadedImage>> WPixmapStore::m_prefetchedImages;
+bool WPixmapStore::m_recordPaintableFiles = false;
+QList<PaintableFile> WPixmapStore::m_recordedPaintableFiles;
 
 // static
 PaintablePointer WPixmapStore::getPaintable(const PixmapSource& source,
@@ -19,7 +33,7 @@ PaintablePointer WPixmapStore::getPaintable(const PixmapSource& source,
     if (source.isEmpty()) {
         return PaintablePointer();
     }
-    QString key = source.getId() + QString::number(mode) + QString::number(scaleFactor);
+    QString key = paintableKey(source.getId(), mode, scaleFactor);
 
     // See if we have a cached value for the pixmap.
     PaintablePointer pPaintable = m_paintableCache.value(
@@ -29,7 +43,20 @@ PaintablePointer WPixmapStore::getPaintable(const PixmapSource& source,
         return pPaintable;
     }
 
-    pPaintable = PaintablePointer(new Paintable(source, mode, scaleFactor));
+    // Inline SVGs are generated by the skin, only files are prefetched
+    const bool isFile = source.getSvgSourceData().isEmpty();
+    if (isFile && m_recordPaintableFiles) {
+        m_recordedPaintableFiles.append(PaintableFile{source.getPath(), mode, scaleFactor});
+    }
+
+    std::shared_ptr<Paintable::LoadedImage> pPrefetchedImage =
+            isFile ? m_prefetchedImages.take(key) : nullptr;
+    if (pPrefetchedImage) {
+        pPaintable = PaintablePointer(
+                new Paintable(source, mode, std::move(*pPrefetchedImage)));
+    } else {
+        pPaintable = PaintablePointer(new Paintable(source, mode, scaleFactor));
+    }
 
     m_paintableCache.insert(key, pPaintable);
     return pPaintable;
@@ -39,12 +66,66 @@ PaintablePointer WPixmapStore::getPaintable(const PixmapSource& source,
 QPixmap* WPixmapStore::getPixmapNoCache(
         const QString& fileName,
         double scaleFactor) {
-    QPixmap* pPixmap = nullptr;
-    QImage* img = m_loader->getImage(fileName, scaleFactor);
-    pPixmap = new QPixmap();
-    pPixmap->convertFromImage(*img);
-    delete img;
-    return pPixmap;
+    return new QPixmap(QPixmap::fromImage(getImageNoCache(fileName, scaleFactor)));
+}
+
+// static
+QImage WPixmapStore::getImageNoCache(
+        const QString& fileName,
+        double scaleFactor) {
+    std::unique_ptr<QImage> pImage(m_loader->getImage(fileName, scaleFactor));
+    return std::move(*pImage);
+}
+
+// static
+void WPixmapStore::prefetchPaintables(const QList<PaintableFile>& files) {
+    struct Prefetch {
+        PaintableFile file;
+        std::shared_ptr<Paintable::LoadedImage> pImage;
+    };
+    std::vector<Prefetch> prefetches;
+    prefetches.reserve(files.size());
+    for (const auto& file : files) {
+        const QString key = paintableKey(file.path, file.mode, file.scaleFactor);
+        if (m_paintableCache.contains(key) || m_prefetchedImages.contains(key)) {
+            continue;
+        }
+        prefetches.push_back(Prefetch{file, nullptr});
+    }
+
+    // Decoding and rasterizing the images is independent of each other and
+    // of the GUI thread. m_loader is not modified in the meantime.
+    QtConcurrent::blockingMap(prefetches, [](Prefetch& prefetch) {
+        prefetch.pImage = std::make_shared<Paintable::LoadedImage>(
+                Paintable::load(PixmapSource(prefetch.file.path),
+                        prefetch.file.mode,
+                        prefetch.file.scaleFactor));
+    });
+
+    for (auto& prefetch : prefetches) {
+        m_prefetchedImages.insert(
+                paintableKey(prefetch.file.path, prefetch.file.mode, prefetch.file.scaleFactor),
+                std::move(prefetch.pImage));
+    }
+}
+
+// static
+void WPixmapStore::clearPrefetchedPaintables() {
+    m_prefetchedImages.clear();
+}
+
+// static
+void WPixmapStore::startRecordingPaintableFiles() {
+    m_recordedPaintableFiles.clear();
+    m_recordPaintableFiles = true;
+}
+
+// static
+QList<PaintableFile> WPixmapStore::takeRecordedPaintableFiles() {
+    m_recordPaintableFiles = false;
+    QList<PaintableFile> files;
+    files.swap(m_recordedPaintableFiles);
+    return files;
 }
 
 // static
@@ -63,4 +144,5 @@ void WPixmapStore::setLoader(QSharedPointer<ImgSource> ld) {
     // loader has changed. The pixmaps will get freed once all the widgets
     // referring to them are destroyed.
     m_paintableCache.clear();
+    clearPrefetchedPaintables();
 }
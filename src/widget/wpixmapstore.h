@@ -18,6 +18,14 @@
 typedef QSharedPointer<Paintable> PaintablePointer;
 typedef QWeakPointer<Paintable> WeakPaintablePointer;
 
+/// A Paintable loaded from a file, identified by the arguments of
+/// WPixmapStore::getPaintable()
+struct PaintableFile {
+    QString path;
+    Paintable::DrawMode mode;
+    double scaleFactor;
+};
+
 class WPixmapStore {
   public:
     static PaintablePointer getPaintable(
@@ -25,11 +33,27 @@ class WPixmapStore {
             Paintable::DrawMode mode,
             double scaleFactor);
     static QPixmap* getPixmapNoCache(const QString& fileName, double scaleFactor);
+    /// Loads the image with the current loader. Thread-safe.
+    static QImage getImageNoCache(const QString& fileName, double scaleFactor);
     static void setLoader(QSharedPointer<ImgSource> ld);
     static void correctImageColors(QImage* p);
     static bool willCorrectColors();
 
+    /// Loads the Paintables of the given files in parallel on the global
+    /// thread pool. getPaintable() takes them over instead of loading them
+    /// on the GUI thread, until clearPrefetchedPaintables() is called.
+    static void prefetchPaintables(const QList<PaintableFile>& files);
+    static void clearPrefetchedPaintables();
+
+    /// Records the files of all Paintables that are loaded by
+    /// getPaintable(), until takeRecordedPaintableFiles() is called.
+    static void startRecordingPaintableFiles();
+    static QList<PaintableFile> takeRecordedPaintableFiles();
+
   private:
     static QHash<QString, WeakPaintablePointer> m_paintableCache;
     static QSharedPointer<ImgSource> m_loader;
+    static QHash<QString, std::shared_ptr<Paintable::LoadedImage>> m_prefetchedImages;
+    static bool m_recordPaintableFiles;
+    static QList<PaintableFile> m_recordedPaintableFiles;
 };
@@ -2,6 +2,7 @@
 
 #include <QDrag>
 #include <QModelIndex>
+#include <QPaintEvent>
 #include <QScrollBar>
 #include <QShortcut>
 #include <QUrl>
@@ -561,6 +562,22 @@ void WTrackTableView::mouseMoveEvent(QMouseEvent* pEvent) {
     DragAndDropHelper::dragTrackLocations(locations, this, "library");
 }
 
+void WTrackTableView::paintEvent(QPaintEvent* pEvent) {
+    TrackModel* trackModel = getTrackModel();
+    if (trackModel) {
+        const int firstRow = rowAt(pEvent->rect().top());
+        if (firstRow >= 0) {
+            int lastRow = rowAt(pEvent->rect().bottom());
+            if (lastRow < 0) {
+                // The rows end above the bottom of the viewport
+                lastRow = model()->rowCount() - 1;
+            }
+            trackModel->prefetchRows(firstRow, lastRow);
+        }
+    }
+    WLibraryTableView::paintEvent(pEvent);
+}
+
 // Drag enter event, happens when a dragged item hovers over the track table view
 void WTrackTableView::dragEnterEvent(QDragEnterEvent * event) {
     auto* trackModel = getTrackModel();
@@ -713,6 +730,12 @@ void WTrackTableView::dropEvent(QDropEvent * event) {
             }
         }
 
+        // A contiguous selection is moved at once, otherwise the tracks
+        // are moved one by one.
+        if (trackModel->moveTracks(indices, destIndex)) {
+            selectedRows.clear();
+        }
+
         // For each row that needs to be moved...
         while (!selectedRows.isEmpty()) {
             int movedRow = selectedRows.takeFirst(); // Remember it's row index
@@ -106,6 +106,10 @@ class WTrackTableView : public WLibraryTableView {
     // when dragging.
     void mouseMoveEvent(QMouseEvent *pEvent) override;
 
+    // Lets the model load the rows that are about to be painted at once,
+    // instead of one by one while they are painted.
+    void paintEvent(QPaintEvent* pEvent) override;
+
     // Returns the current TrackModel, or returns NULL if none is set.
     TrackModel* getTrackModel() const;
 